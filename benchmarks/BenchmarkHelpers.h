@@ -0,0 +1,146 @@
+#ifndef MINIMIZEROPTIMIZER_BENCHMARKS_BENCHMARKHELPERS_H_
+#define MINIMIZEROPTIMIZER_BENCHMARKS_BENCHMARKHELPERS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Instrumentation.h"
+#include "Matrix.h"
+#include "Function.h"
+#include "ErrorFunctions.h"
+
+// Shared inputs for the benchmark suite. Everything here is seeded so that
+// two runs of the suite measure exactly the same problems.
+
+namespace bench {
+
+constexpr unsigned kSeed = 20241117;
+
+// Matrix and Function allocations of the timed code, reported per iteration
+// when the library is built with MATH_ENABLE_ALLOCATION_TRACKING
+class AllocationTotals {
+    int64_t matrixAllocs = 0;
+    int64_t matrixBytes = 0;
+    int64_t functionAllocs = 0;
+    int64_t peakBytes = 0;
+
+public:
+    void add(const instrumentation::AllocationScope& scope) {
+        using instrumentation::AllocationKind;
+        matrixAllocs += scope.counts(AllocationKind::Matrix).allocations;
+        matrixBytes += scope.counts(AllocationKind::Matrix).allocatedBytes;
+        functionAllocs += scope.counts(AllocationKind::Function).allocations;
+        peakBytes = std::max(peakBytes, scope.total().peakBytes);
+    }
+
+    void report(benchmark::State& state) const {
+#ifdef MATH_ALLOCATION_TRACKING
+        auto perIteration = benchmark::Counter::kAvgIterations;
+        state.counters["matrixAllocs"] = benchmark::Counter(matrixAllocs, perIteration);
+        state.counters["matrixBytes"] = benchmark::Counter(matrixBytes, perIteration);
+        state.counters["functionAllocs"] = benchmark::Counter(functionAllocs, perIteration);
+        state.counters["peakBytes"] = peakBytes;
+#else
+        (void) state;
+#endif
+    }
+};
+
+// Dense matrix with entries uniformly distributed in [-1, 1]
+inline Matrix<> randomMatrix(size_t rows, size_t cols, unsigned seed = kSeed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix<> result(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            result(i, j) = dist(gen);
+        }
+    }
+    return result;
+}
+
+// Diagonally dominant square matrix, always safely invertible
+inline Matrix<> wellConditionedMatrix(size_t size, unsigned seed = kSeed) {
+    Matrix<> result = randomMatrix(size, size, seed);
+    for (size_t i = 0; i < size; ++i) {
+        result(i, i) += static_cast<double>(size);
+    }
+    return result;
+}
+
+// rows x cols matrix of rank `rank`, built as a product of two random factors
+inline Matrix<> rankDeficientMatrix(size_t rows, size_t cols, size_t rank, unsigned seed = kSeed) {
+    return randomMatrix(rows, rank, seed) * randomMatrix(rank, cols, seed + 1);
+}
+
+// Owns the parameter storage of a benchmark problem. The Variables point into
+// `values`, so the vector is sized once and never grows afterwards.
+struct Parameters {
+    std::vector<double> values;
+    std::vector<Variable*> variables;
+
+    explicit Parameters(const std::vector<double>& init) : values(init) {
+        variables.reserve(values.size());
+        for (auto& value : values) {
+            variables.push_back(new Variable(&value));
+        }
+    }
+
+    ~Parameters() {
+        for (auto variable : variables) {
+            delete variable;
+        }
+    }
+
+    Parameters(const Parameters&) = delete;
+    Parameters& operator=(const Parameters&) = delete;
+};
+
+// A chain of `segments` sections with fixed lengths and every second pair of
+// neighbours perpendicular. The start point is slightly off the solution.
+inline std::unique_ptr<Parameters> sectionChain(size_t segments, unsigned seed = kSeed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> noise(-0.5, 0.5);
+    std::vector<double> init;
+    init.reserve(2 * (segments + 1));
+    for (size_t i = 0; i <= segments; ++i) {
+        init.push_back(10.0 * static_cast<double>(i) + noise(gen));
+        init.push_back(10.0 * static_cast<double>(i % 2) + noise(gen));
+    }
+    return std::make_unique<Parameters>(init);
+}
+
+inline std::vector<Function*> sectionChainResiduals(const Parameters& params) {
+    const auto& x = params.variables;
+    size_t points = x.size() / 2;
+    std::vector<Function*> residuals;
+    for (size_t i = 0; i + 1 < points; ++i) {
+        residuals.push_back(new PointPointDistanceError({x[2 * i], x[2 * i + 1], x[2 * i + 2], x[2 * i + 3]}, 14.0));
+    }
+    for (size_t i = 0; i + 2 < points; i += 2) {
+        residuals.push_back(new SectionSectionPerpendicularError({
+            x[2 * i], x[2 * i + 1], x[2 * i + 2], x[2 * i + 3],
+            x[2 * i + 2], x[2 * i + 3], x[2 * i + 4], x[2 * i + 5]}));
+    }
+    return residuals;
+}
+
+// sum_i (x_i - i)^2, a smooth convex test function with a known minimum
+inline Function* shiftedQuadratic(const Parameters& params) {
+    Function* sum = nullptr;
+    for (size_t i = 0; i < params.variables.size(); ++i) {
+        Function* term = new Power(new Subtraction(params.variables[i], new Constant(static_cast<double>(i))),
+                                   new Constant(2.0));
+        sum = sum ? new Addition(sum, term) : term;
+    }
+    return sum;
+}
+
+}  // namespace bench
+
+#endif // ! MINIMIZEROPTIMIZER_BENCHMARKS_BENCHMARKHELPERS_H_
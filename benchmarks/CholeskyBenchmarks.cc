@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+#include "Cholesky.h"
+#include "LDLT.h"
+#include "MixedPrecisionCholesky.h"
+#include "QR.h"
+
+// J^T J + I, the damped normal matrix of an LM step
+static Matrix<> normalMatrix(size_t n) {
+    Matrix<> J = bench::randomMatrix(2 * n, n);
+    Matrix<> A = J.transpose() * J;
+    A.addDiagonal(1.0);
+    return A;
+}
+
+static void BM_Cholesky_Factorize(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = normalMatrix(n);
+    Cholesky<> chol;
+    for (auto _ : state) {
+        chol.factorize(A);
+        benchmark::ClobberMemory();
+    }
+    state.counters["flops"] = benchmark::Counter(1.0 / 3.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Cholesky_Factorize)->RangeMultiplier(2)->Range(8, 512);
+
+// One rejected LM step: new damping on the same normal matrix, then solve
+static void BM_Cholesky_ShiftAndSolve(benchmark::State& state) {
+    size_t n = state.range(0);
+    Cholesky<> chol(normalMatrix(n));
+    Matrix<> b = bench::randomMatrix(n, 1);
+    Matrix<> x;
+    double lambda = 1.0;
+    for (auto _ : state) {
+        lambda = lambda < 1e3 ? 2.0 * lambda : 1.0;
+        chol.refactorize(lambda);
+        chol.solveInto(b, x);
+        benchmark::DoNotOptimize(x);
+    }
+}
+BENCHMARK(BM_Cholesky_ShiftAndSolve)->RangeMultiplier(2)->Range(8, 512);
+
+static void BM_LDLT_Factorize(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = normalMatrix(n);
+    LDLT<> ldlt;
+    for (auto _ : state) {
+        ldlt.factorize(A);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_LDLT_Factorize)->RangeMultiplier(2)->Range(8, 512);
+
+// The solve LMSolver did before, for comparison with BM_Cholesky_ShiftAndSolve
+static void BM_QR_NormalSolve(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = normalMatrix(n);
+    Matrix<> b = bench::randomMatrix(n, 1);
+    for (auto _ : state) {
+        QR qr(A);
+        qr.qr();
+        Matrix<> x = qr.pseudoInverse() * b;
+        benchmark::DoNotOptimize(x);
+    }
+}
+BENCHMARK(BM_QR_NormalSolve)->RangeMultiplier(2)->Range(8, 512);
+
+// BM_Cholesky_ShiftAndSolve with a float factor and double refinement
+static void BM_MixedPrecisionCholesky_ShiftAndSolve(benchmark::State& state) {
+    size_t n = state.range(0);
+    MixedPrecisionCholesky<> chol(normalMatrix(n));
+    Matrix<> b = bench::randomMatrix(n, 1);
+    Matrix<> x;
+    double lambda = 1.0;
+    for (auto _ : state) {
+        lambda = lambda < 1e3 ? 2.0 * lambda : 1.0;
+        chol.refactorize(lambda);
+        chol.solveInto(b, x);
+        benchmark::DoNotOptimize(x);
+    }
+    state.counters["fallback"] = chol.usesFallback();
+}
+BENCHMARK(BM_MixedPrecisionCholesky_ShiftAndSolve)->RangeMultiplier(2)->Range(8, 512);
@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+#include "Lanczos.h"
+#include "SymmetricEigen.h"
+
+static Matrix<> symmetricMatrix(size_t n) {
+    Matrix<> B = bench::randomMatrix(n, n);
+    return B + B.transpose();
+}
+
+static void BM_SymmetricEigen_Values(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = symmetricMatrix(n);
+    SymmetricEigen<> eigen;
+    for (auto _ : state) {
+        eigen.compute(A, false);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_SymmetricEigen_Values)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_SymmetricEigen_ValuesAndVectors(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = symmetricMatrix(n);
+    SymmetricEigen<> eigen;
+    for (auto _ : state) {
+        eigen.compute(A);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_SymmetricEigen_ValuesAndVectors)->RangeMultiplier(2)->Range(8, 256);
+
+// Smallest eigenvalue only, the question a saddle point check asks
+static void BM_Lanczos_Smallest(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = symmetricMatrix(n);
+    Lanczos<> lanczos;
+    for (auto _ : state) {
+        lanczos.compute(A, 1);
+        benchmark::DoNotOptimize(lanczos.eigenvalues());
+    }
+}
+BENCHMARK(BM_Lanczos_Smallest)->RangeMultiplier(2)->Range(64, 256);
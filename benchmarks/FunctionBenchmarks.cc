@@ -0,0 +1,188 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+#include "LSMTask.h"
+#include "BatchEvaluator.h"
+#include "FastMath.h"
+
+// Function trees share nodes with the trees they were derived from and never
+// free their children, so benchmarks that build new trees run a fixed number
+// of iterations to keep the leaked memory bounded.
+constexpr benchmark::IterationCount kTreeBuildIterations = 200;
+
+static void BM_Function_EvaluateResiduals(benchmark::State& state) {
+    auto params = bench::sectionChain(state.range(0));
+    std::vector<Function*> residuals = bench::sectionChainResiduals(*params);
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (auto residual : residuals) {
+            sum += residual->evaluate();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * residuals.size());
+    for (auto residual : residuals) {
+        delete residual;
+    }
+}
+BENCHMARK(BM_Function_EvaluateResiduals)->RangeMultiplier(4)->Range(4, 256);
+
+// acos/sqrt heavy residual
+static void BM_Function_EvaluateAngle(benchmark::State& state) {
+    auto params = bench::sectionChain(3);
+    const auto& x = params->variables;
+    SectionSectionAngleError angle({x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]}, 45.0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(angle.evaluate());
+    }
+}
+BENCHMARK(BM_Function_EvaluateAngle);
+
+// The same residual at 256 points through a BatchEvaluator, Arg 1 in
+// MathMode::Fast
+static void BM_Function_BatchAngle(benchmark::State& state) {
+    auto params = bench::sectionChain(3);
+    const auto& x = params->variables;
+    std::vector<Variable*> ends(x.begin(), x.begin() + 8);
+    SectionSectionAngleError angle({x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]}, 45.0);
+    BatchEvaluator batch({&angle}, ends);
+    batch.setMathMode(state.range(0) ? MathMode::Fast : MathMode::Strict);
+    constexpr size_t kPoints = 256;
+    std::vector<std::vector<double>> points(ends.size(), std::vector<double>(kPoints));
+    std::vector<const double*> inputs;
+    for (size_t j = 0; j < ends.size(); ++j) {
+        for (size_t p = 0; p < kPoints; ++p) {
+            points[j][p] = ends[j]->evaluate() + 1e-3 * static_cast<double>(p);
+        }
+        inputs.push_back(points[j].data());
+    }
+    std::vector<double> out(kPoints);
+    for (auto _ : state) {
+        batch.evaluate(0, kPoints, inputs.data(), out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * kPoints);
+}
+BENCHMARK(BM_Function_BatchAngle)->Arg(0)->Arg(1);
+
+static void BM_Function_Derivative(benchmark::State& state) {
+    auto params = bench::sectionChain(state.range(0));
+    std::vector<Function*> residuals = bench::sectionChainResiduals(*params);
+    for (auto _ : state) {
+        for (auto residual : residuals) {
+            benchmark::DoNotOptimize(residual->derivative(params->variables[0]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * residuals.size());
+}
+BENCHMARK(BM_Function_Derivative)->Arg(4)->Arg(32)->Iterations(kTreeBuildIterations);
+
+static void BM_Function_EvaluateDerivative(benchmark::State& state) {
+    auto params = bench::sectionChain(state.range(0));
+    std::vector<Function*> residuals = bench::sectionChainResiduals(*params);
+    std::vector<Function*> derivatives;
+    for (auto residual : residuals) {
+        derivatives.push_back(residual->derivative(params->variables[2]));
+    }
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (auto derivative : derivatives) {
+            sum += derivative->evaluate();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * derivatives.size());
+}
+BENCHMARK(BM_Function_EvaluateDerivative)->RangeMultiplier(4)->Range(4, 256);
+
+// Building an LSMTask: gradient, hessian and jacobian trees
+static void BM_Task_Construct(benchmark::State& state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto params = bench::sectionChain(state.range(0));
+        std::vector<Function*> residuals = bench::sectionChainResiduals(*params);
+        state.ResumeTiming();
+        LSMTask task(residuals, params->variables);
+        benchmark::DoNotOptimize(task);
+    }
+}
+BENCHMARK(BM_Task_Construct)->Arg(2)->Arg(8)->Iterations(20)->Unit(benchmark::kMillisecond);
+
+static void BM_Task_Linearize(benchmark::State& state) {
+    auto params = bench::sectionChain(state.range(0));
+    LSMTask task(bench::sectionChainResiduals(*params), params->variables);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(task.linearizeFunction());
+    }
+}
+BENCHMARK(BM_Task_Linearize)->Arg(2)->Arg(8)->Arg(16);
+
+static void BM_Task_Gradient(benchmark::State& state) {
+    auto params = bench::sectionChain(state.range(0));
+    LSMTask task(bench::sectionChainResiduals(*params), params->variables);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(task.gradient());
+    }
+}
+BENCHMARK(BM_Task_Gradient)->Arg(2)->Arg(8)->Arg(16);
+
+static void BM_Task_Hessian(benchmark::State& state) {
+    auto params = bench::sectionChain(state.range(0));
+    LSMTask task(bench::sectionChainResiduals(*params), params->variables);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(task.hessian());
+    }
+}
+BENCHMARK(BM_Task_Hessian)->Arg(2)->Arg(8);
+
+// 4096 values through libm (Arg 0) or the batched fast_math kernels (Arg 1)
+template <double (*Strict)(double), void (*Batched)(const double*, double*, size_t)>
+static void runTranscendental(benchmark::State& state, double lo, double hi) {
+    std::vector<double> x(4096);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = lo + (hi - lo) * static_cast<double>(i) / static_cast<double>(x.size());
+    }
+    std::vector<double> y(x.size());
+    for (auto _ : state) {
+        if (state.range(0)) {
+            Batched(x.data(), y.data(), x.size());
+        } else {
+            for (size_t i = 0; i < x.size(); ++i) {
+                y[i] = Strict(x[i]);
+            }
+        }
+        benchmark::DoNotOptimize(y.data());
+    }
+    state.SetItemsProcessed(state.iterations() * x.size());
+}
+
+static double strictExp(double x) { return std::exp(x); }
+static double strictLog(double x) { return std::log(x); }
+static double strictSin(double x) { return std::sin(x); }
+static double strictAtan(double x) { return std::atan(x); }
+static double strictAcos(double x) { return std::acos(x); }
+
+static void BM_Math_Exp(benchmark::State& state) {
+    runTranscendental<strictExp, fast_math::exp>(state, -20.0, 20.0);
+}
+BENCHMARK(BM_Math_Exp)->Arg(0)->Arg(1);
+
+static void BM_Math_Log(benchmark::State& state) {
+    runTranscendental<strictLog, fast_math::log>(state, 1e-3, 1e3);
+}
+BENCHMARK(BM_Math_Log)->Arg(0)->Arg(1);
+
+static void BM_Math_Sin(benchmark::State& state) {
+    runTranscendental<strictSin, fast_math::sin>(state, -10.0, 10.0);
+}
+BENCHMARK(BM_Math_Sin)->Arg(0)->Arg(1);
+
+static void BM_Math_Atan(benchmark::State& state) {
+    runTranscendental<strictAtan, fast_math::atan>(state, -10.0, 10.0);
+}
+BENCHMARK(BM_Math_Atan)->Arg(0)->Arg(1);
+
+static void BM_Math_Acos(benchmark::State& state) {
+    runTranscendental<strictAcos, fast_math::acos>(state, -1.0, 1.0);
+}
+BENCHMARK(BM_Math_Acos)->Arg(0)->Arg(1);
@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+#include "LU.h"
+
+static void BM_LU_Factorize(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::wellConditionedMatrix(n);
+    LU<> lu;
+    for (auto _ : state) {
+        lu.factorize(A);
+        benchmark::ClobberMemory();
+    }
+    state.counters["flops"] = benchmark::Counter(2.0 / 3.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_LU_Factorize)->RangeMultiplier(2)->Range(8, 512);
+
+static void BM_LU_Solve(benchmark::State& state) {
+    size_t n = state.range(0);
+    LU<> lu(bench::wellConditionedMatrix(n));
+    Matrix<> b = bench::randomMatrix(n, 1);
+    Matrix<> x;
+    for (auto _ : state) {
+        lu.solveInto(b, x);
+        benchmark::DoNotOptimize(x);
+    }
+}
+BENCHMARK(BM_LU_Solve)->RangeMultiplier(2)->Range(8, 512);
+
+// Both from one factorization, compare with BM_Matrix_Determinant + BM_Matrix_Inverse
+static void BM_LU_DeterminantAndInverse(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::wellConditionedMatrix(n);
+    for (auto _ : state) {
+        LU<> lu(A);
+        benchmark::DoNotOptimize(lu.determinant());
+        benchmark::DoNotOptimize(lu.inverse());
+    }
+}
+BENCHMARK(BM_LU_DeterminantAndInverse)->RangeMultiplier(2)->Range(8, 256);
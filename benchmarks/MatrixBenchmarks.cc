@@ -0,0 +1,249 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+#include "FixedMatrix.h"
+
+static void BM_Matrix_Multiply(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::randomMatrix(n, n, bench::kSeed);
+    Matrix<> B = bench::randomMatrix(n, n, bench::kSeed + 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A * B);
+    }
+    state.counters["flops"] = benchmark::Counter(2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Matrix_Multiply)->RangeMultiplier(2)->Range(16, 256);
+
+// Scaling of the tiled product with the shared pool size, args are n and threads
+static void BM_Matrix_MultiplyThreads(benchmark::State& state) {
+    size_t n = state.range(0);
+    size_t previous = ThreadPool::shared().threadCount();
+    ThreadPool::shared().setThreadCount(state.range(1));
+    Matrix<> A = bench::randomMatrix(n, n, bench::kSeed);
+    Matrix<> B = bench::randomMatrix(n, n, bench::kSeed + 1);
+    Matrix<> C;
+    for (auto _ : state) {
+        Matrix<>::multiplyInto(A, B, C);
+        benchmark::DoNotOptimize(C);
+    }
+    ThreadPool::shared().setThreadCount(previous);
+    state.counters["flops"] = benchmark::Counter(2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Matrix_MultiplyThreads)->ArgsProduct({{256, 512}, {1, 2, 4}})->UseRealTime();
+
+// Products by storage order, arg 1 picks row*row, col*col or row*col
+static void BM_Matrix_MultiplyLayouts(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::randomMatrix(n, n, bench::kSeed);
+    Matrix<> B = bench::randomMatrix(n, n, bench::kSeed + 1);
+    Matrix<double, ColMajor> Ac(A);
+    Matrix<double, ColMajor> Bc(B);
+    Matrix<> C;
+    Matrix<double, ColMajor> Cc;
+    for (auto _ : state) {
+        switch (state.range(1)) {
+            case 0: Matrix<>::multiplyInto(A, B, C); break;
+            case 1: Matrix<double, ColMajor>::multiplyInto(Ac, Bc, Cc); break;
+            default: Matrix<>::multiplyInto(A, Bc, C); break;
+        }
+        benchmark::DoNotOptimize(C);
+        benchmark::DoNotOptimize(Cc);
+    }
+    state.counters["flops"] = benchmark::Counter(2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Matrix_MultiplyLayouts)->ArgsProduct({{64, 256}, {0, 1, 2}});
+
+// J^T * J for an m x n Jacobian, the normal-equation product every solver forms
+static void BM_Matrix_NormalProduct(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> J = bench::randomMatrix(m, n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(J.transpose() * J);
+    }
+    state.counters["flops"] = benchmark::Counter(2.0 * m * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Matrix_NormalProduct)->Args({64, 16})->Args({512, 64})->Args({2048, 128});
+
+// The same product without the transpose copy, upper triangle only
+static void BM_Matrix_Syrk(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> J = bench::randomMatrix(m, n);
+    Matrix<> H;
+    for (auto _ : state) {
+        Matrix<>::syrk(J, H);
+        benchmark::DoNotOptimize(H);
+    }
+    state.counters["flops"] = benchmark::Counter(2.0 * m * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Matrix_Syrk)->Args({64, 16})->Args({512, 64})->Args({2048, 128});
+
+// J^T * r
+static void BM_Matrix_TransposedVector(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> J = bench::randomMatrix(m, n);
+    Matrix<> r = bench::randomMatrix(m, 1, bench::kSeed + 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(J.transpose() * r);
+    }
+}
+BENCHMARK(BM_Matrix_TransposedVector)->Args({64, 16})->Args({512, 64})->Args({2048, 128});
+
+static void BM_Matrix_GemvT(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> J = bench::randomMatrix(m, n);
+    Matrix<> r = bench::randomMatrix(m, 1, bench::kSeed + 1);
+    Matrix<> g;
+    for (auto _ : state) {
+        Matrix<>::gemv_t(J, r, g);
+        benchmark::DoNotOptimize(g);
+    }
+}
+BENCHMARK(BM_Matrix_GemvT)->Args({64, 16})->Args({512, 64})->Args({2048, 128});
+
+static void BM_Matrix_Add(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::randomMatrix(n, n, bench::kSeed);
+    Matrix<> B = bench::randomMatrix(n, n, bench::kSeed + 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A + B);
+    }
+}
+BENCHMARK(BM_Matrix_Add)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_Matrix_Transpose(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::randomMatrix(n, n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A.transpose());
+    }
+}
+BENCHMARK(BM_Matrix_Transpose)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_Matrix_Copy(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::randomMatrix(n, n);
+    for (auto _ : state) {
+        Matrix<> copy(A);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_Matrix_Copy)->RangeMultiplier(4)->Range(16, 1024);
+
+static void BM_Matrix_Determinant(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::wellConditionedMatrix(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A.determinant());
+    }
+}
+BENCHMARK(BM_Matrix_Determinant)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_Matrix_Inverse(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::wellConditionedMatrix(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A.inverse());
+    }
+}
+BENCHMARK(BM_Matrix_Inverse)->RangeMultiplier(2)->Range(8, 256);
+
+static void BM_Matrix_Minor(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::wellConditionedMatrix(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A.minor(n / 2, n / 2));
+    }
+}
+BENCHMARK(BM_Matrix_Minor)->RangeMultiplier(2)->Range(8, 128);
+
+// All n^2 minors, from one LU against one determinant each
+static void BM_Matrix_AllMinors(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::wellConditionedMatrix(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(A.minors());
+    }
+}
+BENCHMARK(BM_Matrix_AllMinors)->RangeMultiplier(2)->Range(8, 128);
+
+static void BM_Matrix_AllMinorsByDeterminants(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::wellConditionedMatrix(n);
+    Matrix<> M(n, n);
+    for (auto _ : state) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                M(i, j) = A.minor(i, j);
+            }
+        }
+        benchmark::DoNotOptimize(M.data());
+    }
+}
+BENCHMARK(BM_Matrix_AllMinorsByDeterminants)->RangeMultiplier(2)->Range(8, 32);
+
+// 4x8 local Jacobian block into a solved 2x2 normal block, per constraint:
+// the dynamic Matrix against the fixed-size stack matrix
+static void BM_Matrix_SmallBlocks(benchmark::State& state) {
+    Matrix<> J = bench::randomMatrix(4, 8);
+    Matrix<> r = bench::randomMatrix(4, 1, bench::kSeed + 1);
+    for (auto _ : state) {
+        Matrix<> block = J.getSubmatrix(0, 0, 4, 2);
+        Matrix<> normal = block.transpose() * block;
+        Matrix<> g = block.transpose() * r;
+        benchmark::DoNotOptimize(normal.inverse() * g);
+    }
+}
+BENCHMARK(BM_Matrix_SmallBlocks);
+
+static void BM_FixedMatrix_SmallBlocks(benchmark::State& state) {
+    Matrix<> J = bench::randomMatrix(4, 8);
+    Matrix<> r = bench::randomMatrix(4, 1, bench::kSeed + 1);
+    for (auto _ : state) {
+        auto block = FixedMatrix<double, 4, 2>::block(J, 0, 0);
+        auto normal = block.transpose() * block;
+        auto g = block.transpose() * FixedVector<double, 4>::block(r, 0, 0);
+        benchmark::DoNotOptimize(normal.solve(g));
+    }
+}
+BENCHMARK(BM_FixedMatrix_SmallBlocks);
+
+// Temporaries of one solver iteration: an n x n Hessian, a gradient and a
+// step, created and destroyed every time. Arg 1 selects the allocator.
+template <MatrixAllocator Alloc>
+static void matrixChurn(benchmark::State& state) {
+    size_t n = state.range(0);
+    for (auto _ : state) {
+        Matrix<double, RowMajor, Alloc> H(n, n);
+        Matrix<double, RowMajor, Alloc> g(n, 1, 1.0);
+        Matrix<double, RowMajor, Alloc> delta = g * 2.0;
+        benchmark::DoNotOptimize(H.data());
+        benchmark::DoNotOptimize(delta.data());
+    }
+}
+
+static void BM_Matrix_Churn(benchmark::State& state) {
+    if (state.range(1) == 0) {
+        matrixChurn<HeapAllocator>(state);
+    } else {
+        matrixChurn<PooledAllocator>(state);
+    }
+}
+BENCHMARK(BM_Matrix_Churn)->ArgsProduct({{8, 32, 128, 512}, {0, 1}});
+
+// A residual-style chain; every operator after the product works in the
+// buffer of the temporary it receives
+static void BM_Matrix_ChainedExpression(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::randomMatrix(n, n, bench::kSeed);
+    Matrix<> B = bench::randomMatrix(n, n, bench::kSeed + 1);
+    Matrix<> C = bench::randomMatrix(n, n, bench::kSeed + 2);
+    for (auto _ : state) {
+        Matrix<> R = (A + B) * 0.5 - C + A * 2.0;
+        benchmark::DoNotOptimize(R.data());
+    }
+}
+BENCHMARK(BM_Matrix_ChainedExpression)->RangeMultiplier(4)->Range(16, 1024);
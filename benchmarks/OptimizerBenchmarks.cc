@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+#include "LSMTask.h"
+#include "GradientOptimizer.h"
+#include "LevenbergMarquardtSolver.h"
+#include "NewtonGaussSolver.h"
+#include "NewtonOptimizer.h"
+
+// End-to-end solves. Problem construction is excluded from the timing, every
+// iteration solves the same problem from the same start point.
+
+template <typename Solver>
+static void runLeastSquares(benchmark::State& state, Solver& solver) {
+    bench::AllocationTotals allocations;
+    size_t segments = state.range(0);
+    double finalError = 0.0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto params = bench::sectionChain(segments);
+        LSMTask task(bench::sectionChainResiduals(*params), params->variables);
+        solver.setTask(&task);
+        state.ResumeTiming();
+
+        instrumentation::AllocationScope scope;
+        solver.optimize();
+        allocations.add(scope);
+        finalError = solver.getCurrentError();
+    }
+    state.counters["error"] = finalError;
+    allocations.report(state);
+}
+
+static void BM_Optimizer_LevenbergMarquardt(benchmark::State& state) {
+    LMSolver solver;
+    runLeastSquares(state, solver);
+}
+BENCHMARK(BM_Optimizer_LevenbergMarquardt)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+
+static void BM_Optimizer_NewtonGauss(benchmark::State& state) {
+    NewtonGaussSolver solver(100);
+    runLeastSquares(state, solver);
+}
+BENCHMARK(BM_Optimizer_NewtonGauss)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+
+template <typename Solver>
+static void runQuadratic(benchmark::State& state, Solver& solver) {
+    bench::AllocationTotals allocations;
+    size_t n = state.range(0);
+    double finalError = 0.0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        bench::Parameters params(std::vector<double>(n, 0.5));
+        TaskF task(bench::shiftedQuadratic(params), params.variables);
+        solver.setTask(&task);
+        state.ResumeTiming();
+
+        instrumentation::AllocationScope scope;
+        solver.optimize();
+        allocations.add(scope);
+        finalError = solver.getCurrentError();
+    }
+    state.counters["error"] = finalError;
+    allocations.report(state);
+}
+
+static void BM_Optimizer_Newton(benchmark::State& state) {
+    NewtonOptimizer solver(100);
+    runQuadratic(state, solver);
+}
+BENCHMARK(BM_Optimizer_Newton)->Arg(2)->Arg(8)->Arg(16)->Unit(benchmark::kMillisecond);
+
+static void BM_Optimizer_Gradient(benchmark::State& state) {
+    GradientOptimizer solver(0.1, 1000);
+    runQuadratic(state, solver);
+}
+BENCHMARK(BM_Optimizer_Gradient)->Arg(2)->Arg(8)->Arg(16)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <stdexcept>
+
+#include "BenchmarkHelpers.h"
+#include "QR.h"
+
+using QRMethod = void (QR::*)();
+
+// Floating point operations of a Gram-Schmidt QR of an m x n matrix
+static double qrFlops(size_t m, size_t n) {
+    return 2.0 * static_cast<double>(m) * static_cast<double>(n) * static_cast<double>(n);
+}
+
+static void runQR(benchmark::State& state, QRMethod method, const Matrix<>& A) {
+    for (auto _ : state) {
+        QR qr(A);
+        try {
+            (qr.*method)();
+        } catch (const std::runtime_error& e) {
+            state.SkipWithError(e.what());
+            break;
+        }
+        benchmark::DoNotOptimize(qr);
+    }
+    state.counters["flops"] = benchmark::Counter(qrFlops(A.rows_size(), A.cols_size()),
+                                                 benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// n x n
+static void BM_QR_Square(benchmark::State& state, QRMethod method) {
+    size_t n = state.range(0);
+    runQR(state, method, bench::randomMatrix(n, n));
+}
+
+// m x n, m >> n
+static void BM_QR_TallSkinny(benchmark::State& state, QRMethod method) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    runQR(state, method, bench::randomMatrix(m, n));
+}
+
+// n x n of rank n / 2
+static void BM_QR_RankDeficient(benchmark::State& state, QRMethod method) {
+    size_t n = state.range(0);
+    runQR(state, method, bench::rankDeficientMatrix(n, n, n / 2));
+}
+
+#define MATH_QR_BENCHMARKS(name, method)                                                          \
+    BENCHMARK_CAPTURE(BM_QR_Square, name, method)->RangeMultiplier(4)->Range(16, 256);           \
+    BENCHMARK_CAPTURE(BM_QR_TallSkinny, name, method)->Args({128, 16})->Args({512, 32})->Args({2048, 64}); \
+    BENCHMARK_CAPTURE(BM_QR_RankDeficient, name, method)->Arg(32)->Arg(128)
+
+MATH_QR_BENCHMARKS(CGS, &QR::qrCGS);
+MATH_QR_BENCHMARKS(CGS2, &QR::qrCGS2);
+MATH_QR_BENCHMARKS(MGS, &QR::qrMGS);
+MATH_QR_BENCHMARKS(IMGS, &QR::qrIMGS);
+MATH_QR_BENCHMARKS(BGS, &QR::qrBGS);
+MATH_QR_BENCHMARKS(RGS, &QR::qrRGS);
+
+static void BM_QR_PseudoInverse(benchmark::State& state) {
+    size_t n = state.range(0);
+    QR qr(bench::wellConditionedMatrix(n));
+    qr.qr();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(qr.pseudoInverse());
+    }
+}
+BENCHMARK(BM_QR_PseudoInverse)->RangeMultiplier(4)->Range(16, 256);
@@ -0,0 +1,46 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+#include "SVD.h"
+
+static void BM_SVD(benchmark::State& state, SVDMethod method) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> A = bench::randomMatrix(m, n);
+    SVD<> svd;
+    for (auto _ : state) {
+        svd.compute(A, true, method);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_CAPTURE(BM_SVD, GolubKahan, SVDMethod::GolubKahan)
+        ->Args({8, 8})->Args({16, 16})->Args({64, 64})->Args({256, 64})->Args({256, 256});
+BENCHMARK_CAPTURE(BM_SVD, Jacobi, SVDMethod::Jacobi)
+        ->Args({8, 8})->Args({16, 16})->Args({64, 64})->Args({256, 64});
+
+static void BM_SVD_RankDeficient(benchmark::State& state) {
+    size_t n = state.range(0);
+    Matrix<> A = bench::rankDeficientMatrix(n, n, n / 2);
+    SVD<> svd;
+    for (auto _ : state) {
+        svd.compute(A);
+        benchmark::DoNotOptimize(svd.rank());
+    }
+}
+BENCHMARK(BM_SVD_RankDeficient)->Arg(32)->Arg(128);
+
+// One more lambda after the SVD of the Jacobian, O(n^2)
+static void BM_SVD_DampedSolve(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    SVD<> svd(bench::randomMatrix(m, n));
+    Matrix<> g = bench::randomMatrix(n, 1, bench::kSeed + 1);
+    Matrix<> x;
+    double lambda = 1.0;
+    for (auto _ : state) {
+        lambda *= 1.5;
+        svd.solveDampedInto(g, lambda, x);
+        benchmark::DoNotOptimize(x);
+    }
+}
+BENCHMARK(BM_SVD_DampedSolve)->Args({128, 32})->Args({512, 128})->Args({1024, 256});
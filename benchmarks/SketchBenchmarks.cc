@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+
+#include "SketchGenerator.h"
+#include "FiniteDifference.h"
+#include "LevenbergMarquardtSolver.h"
+#include "NewtonGaussSolver.h"
+
+static SketchOptions sketchOptions(size_t variables) {
+    SketchOptions options;
+    options.seed = 1;
+    options.variableCount = variables;
+    options.couplingDensity = 0.5;
+    options.perturbation = 0.02;
+    return options;
+}
+
+static void BM_Sketch_Generate(benchmark::State& state) {
+    SketchGenerator generator(sketchOptions(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(generator.generate());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Sketch_Generate)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMillisecond);
+
+static void BM_Sketch_EvaluateConstraints(benchmark::State& state) {
+    auto sketch = SketchGenerator(sketchOptions(state.range(0))).generate();
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (auto constraint : sketch->constraints()) {
+            sum += constraint->evaluate();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * sketch->constraints().size());
+}
+BENCHMARK(BM_Sketch_EvaluateConstraints)->RangeMultiplier(10)->Range(10, 100000);
+
+// One frame of a drag: two variables move, then the task is linearized.
+// Arg 1 turns on incremental evaluation.
+static void BM_Sketch_DragLinearize(benchmark::State& state) {
+    auto sketch = SketchGenerator(sketchOptions(state.range(0))).generate();
+    auto task = sketch->makeTask();
+    task->setIncremental(state.range(1) != 0);
+    std::vector<double> x = task->getValues();
+    Matrix<> residuals, jac;
+    double offset = 0.01;
+    for (auto _ : state) {
+        offset = -offset;
+        x[0] += offset;
+        x[1] -= offset;
+        task->setError(x);
+        task->linearizeInto(residuals, jac);
+        benchmark::DoNotOptimize(jac.data());
+    }
+}
+BENCHMARK(BM_Sketch_DragLinearize)->ArgsProduct({{30, 100}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+// Finite difference Jacobian of all constraints. Arg 1 selects the pattern:
+// 0 a dense one, 1 the analysed one. The sketch residuals are batched, every
+// row then perturbs only the columns it reads under either pattern.
+static void BM_Sketch_FiniteDifferenceJacobian(benchmark::State& state) {
+    auto sketch = SketchGenerator(sketchOptions(state.range(0))).generate();
+    const auto& constraints = sketch->constraints();
+    const auto& x = sketch->variables();
+    FiniteDifferenceJacobian fd = state.range(1)
+        ? FiniteDifferenceJacobian(constraints, x)
+        : FiniteDifferenceJacobian(constraints, x, SparsityPattern::dense(constraints.size(), x.size()));
+    Matrix<> residuals, jac;
+    for (auto _ : state) {
+        fd.evaluate(residuals, jac);
+        benchmark::DoNotOptimize(jac.data());
+    }
+    state.counters["batched"] = fd.isBatched() ? 1.0 : 0.0;
+}
+BENCHMARK(BM_Sketch_FiniteDifferenceJacobian)
+    ->ArgsProduct({{100, 1000}, {0, 1}})
+    ->Args({3000, 1})
+    ->Unit(benchmark::kMicrosecond);
+
+template <typename Solver>
+static void solveSketch(benchmark::State& state, Solver& solver) {
+    SketchGenerator generator(sketchOptions(state.range(0)));
+    double finalError = 0.0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto sketch = generator.generate();
+        auto task = sketch->makeTask();
+        solver.setTask(task.get());
+        state.ResumeTiming();
+
+        solver.optimize();
+        finalError = solver.getCurrentError();
+    }
+    state.counters["error"] = finalError;
+}
+
+static void BM_Sketch_LevenbergMarquardt(benchmark::State& state) {
+    LMSolver solver;
+    solveSketch(state, solver);
+}
+BENCHMARK(BM_Sketch_LevenbergMarquardt)->Arg(20)->Arg(60)->Arg(120)->Unit(benchmark::kMillisecond);
+
+static void BM_Sketch_NewtonGauss(benchmark::State& state) {
+    NewtonGaussSolver solver(100);
+    solveSketch(state, solver);
+}
+BENCHMARK(BM_Sketch_NewtonGauss)->Arg(20)->Arg(60)->Arg(120)->Unit(benchmark::kMillisecond);
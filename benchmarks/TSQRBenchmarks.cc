@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+#include "Cholesky.h"
+#include "QR.h"
+#include "TSQR.h"
+
+// R of an m x n Jacobian, args are m and n
+static void BM_TSQR_ROnly(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> J = bench::randomMatrix(m, n);
+    TSQR<> tsqr;
+    for (auto _ : state) {
+        tsqr.factorize(J);
+        benchmark::ClobberMemory();
+    }
+    state.counters["blocks"] = static_cast<double>(tsqr.blockCount());
+}
+BENCHMARK(BM_TSQR_ROnly)->Args({512, 32})->Args({4096, 64})->Args({8192, 128});
+
+static void BM_TSQR_WithQ(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> J = bench::randomMatrix(m, n);
+    TSQR<> tsqr;
+    for (auto _ : state) {
+        tsqr.factorize(J, true);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_TSQR_WithQ)->Args({512, 32})->Args({4096, 64});
+
+// The Gram-Schmidt QR the solvers used before, for comparison
+static void BM_TSQR_GramSchmidtBaseline(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> J = bench::randomMatrix(m, n);
+    for (auto _ : state) {
+        QR qr(J);
+        qr.qr();
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_TSQR_GramSchmidtBaseline)->Args({512, 32})->Args({4096, 64});
+
+// Normal equations through J^T J, cheaper but squares the condition number
+static void BM_TSQR_SyrkCholeskyBaseline(benchmark::State& state) {
+    size_t m = state.range(0);
+    size_t n = state.range(1);
+    Matrix<> J = bench::randomMatrix(m, n);
+    Matrix<> H;
+    Cholesky<> cholesky;
+    for (auto _ : state) {
+        Matrix<>::syrk(J, H);
+        cholesky.factorize(H);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_TSQR_SyrkCholeskyBaseline)->Args({512, 32})->Args({4096, 64})->Args({8192, 128});
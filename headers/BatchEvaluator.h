@@ -0,0 +1,80 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_BATCHEVALUATOR_H_
+#define MINIMIZEROPTIMIZER_HEADERS_BATCHEVALUATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FastMath.h"
+#include "Function.h"
+
+// Evaluates Function graphs at many points at once. Every root is compiled
+// into a tape of operations in evaluation order, one operation per distinct
+// node below it; evaluate() then runs each operation as one loop over all
+// points, so the transcendental nodes call the batched fast_math kernels in
+// MathMode::Fast and nothing is dispatched per node and point.
+//
+// The tape reads the variables x from arrays passed to evaluate(), other
+// Variable nodes are read once per call. It never touches the caches of a
+// DependencyTracker, so tracked graphs can be evaluated from several
+// threads. In MathMode::Strict the results are bitwise those of
+// Function::evaluate(); evaluate() throws where it would, though not
+// necessarily the same exception when several points fail.
+//
+// Only the node types of Function.h and ErrorFunctions are known, supports()
+// tells whether a graph compiles.
+class BatchEvaluator {
+public:
+    enum class Op : uint8_t {
+        Constant, Input, External,
+        Add, Sub, Mul, Div, Pow, Neg, Abs, Sign, Mod,
+        Exp, Ln, Log, Sqrt, Sin, Cos, Asin, Acos, Tan, Atan, Cot, Acot,
+        Max, Min
+    };
+
+private:
+    struct Instruction {
+        Op op;
+        // Operand slots, tape positions within the root
+        uint32_t a = 0;
+        uint32_t b = 0;
+        // Index into x for Input
+        size_t input = 0;
+        double constant = 0.0;
+        // Variable outside x for External
+        const Variable* external = nullptr;
+    };
+
+    std::vector<Instruction> m_tape;
+    // Tape range of root r is [m_offsets[r], m_offsets[r + 1])
+    std::vector<size_t> m_offsets = {0};
+    // Indices into x every root reads, ascending
+    std::vector<std::vector<size_t>> m_inputsOf;
+    size_t m_inputCount = 0;
+    MathMode m_mode = MathMode::Strict;
+
+    static bool kindOf(const Function* node, Op& op);
+
+public:
+    // x are the variables whose values vary between the points
+    BatchEvaluator(const std::vector<Function*>& roots, const std::vector<Variable*>& x);
+
+    // Whether every node below root has a known type
+    static bool supports(const Function* root);
+
+    size_t rootCount() const { return m_offsets.size() - 1; }
+    size_t instructionCount() const { return m_tape.size(); }
+
+    // The x the root depends on, the only inputs evaluate() reads for it
+    const std::vector<size_t>& inputsOf(size_t root) const { return m_inputsOf.at(root); }
+
+    // How Exp, Ln, Sin, Cos, Acos and Atan are evaluated, Strict by default
+    void setMathMode(MathMode mode) { m_mode = mode; }
+    MathMode mathMode() const { return m_mode; }
+
+    // out[p] = roots[root] at point p < count, where x[j] has the value
+    // inputs[j][p]. Only inputsOf(root) are read, others may be nullptr.
+    void evaluate(size_t root, size_t count, const double* const* inputs, double* out) const;
+};
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_BATCHEVALUATOR_H_
@@ -25,6 +25,7 @@ protected:
     Function *c_f;
     std::vector<Variable *> m_X;
     double v_error;
+    bool cacheable() const override { return true; }
 public:
     ErrorFunctions(std::vector<Variable *> x, double error=0) : m_X(x), c_f(nullptr), v_error(error) {}
 
@@ -33,9 +34,12 @@ public:
     }
 
     double evaluate() const override{
-        return c_f->evaluate();
+        return c_f->value();
     }
 
+    size_t childCount() const override { return 1; }
+    Function* child(size_t) const override { return c_f; }
+
     Function *derivative(Variable *var) const override{
         return c_f->derivative(var);
     }
@@ -114,4 +118,11 @@ public:
     Function *clone() const override;
 };
 
+//11
+class PointOnCircleError : public ErrorFunctions {
+public:
+    PointOnCircleError(std::vector<Variable *> x);
+    Function *clone() const override;
+};
+
 #endif // ! MINIMIZEROPTIMIZER_HEADERS_ERRORFUNCTIONS_H_
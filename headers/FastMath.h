@@ -0,0 +1,246 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_FASTMATH_H_
+#define MINIMIZEROPTIMIZER_HEADERS_FASTMATH_H_
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// How a BatchEvaluator evaluates the Exp, Ln, Sin, Cos, Acos and Atan nodes
+enum class MathMode {
+    // The C library, within 1 ulp on glibc
+    Strict,
+    // The fast_math kernels below
+    Fast
+};
+
+// Branch free versions of exp, log, sin, cos, atan and acos: range
+// reduction, the fdlibm polynomials and selects instead of branches. That
+// makes them plain straight-line double code, so the loops of the batched
+// overloads at the end vectorize to whatever the build targets: SSE2 by
+// default, AVX2 or AVX-512 with MATH_ENABLE_NATIVE_ARCH. BatchEvaluator
+// calls those in MathMode::Fast. The Function nodes always use libm, one
+// value at a time the kernels are no faster.
+//
+// Largest error against glibc found on random samples of the domain, the
+// bounds tests/FastMathTest.cc checks:
+//   exp, log, acos  1 ulp
+//   sin, cos        1 ulp for |x| <= 10, 2 ulp up to kMaxTrigArgument
+//   atan            2 ulp
+// Special values match libm: NaN stays NaN, exp overflows to inf and
+// underflows through the subnormals to 0, log(0) = -inf, log of a negative
+// and acos outside [-1, 1] are NaN. Beyond kMaxTrigArgument (and for inf)
+// sin and cos go to libm, the three part pi/2 of the reduction runs out of
+// bits there. sqrt needs no kernel, std::sqrt is a single correctly rounded
+// instruction in both modes.
+namespace fast_math {
+
+namespace detail {
+
+// 1.5 * 2^52: x + kShifter - kShifter rounds x to an integer for |x| < 2^51,
+// and the low bits of x + kShifter hold that integer
+constexpr double kShifter = 0x1.8p52;
+
+inline double roundToInt(double x) {
+    return (x + kShifter) - kShifter;
+}
+
+// 2^k for an integral k in [-1022, 1023]
+inline double pow2(double k) {
+    return std::bit_cast<double>((std::bit_cast<uint64_t>(k + kShifter) + 1023) << 52);
+}
+
+constexpr double kPi = 3.14159265358979311600e+00;
+constexpr double kPi2Hi = 1.57079632679489655800e+00;
+constexpr double kPi2Lo = 6.12323399573676603587e-17;
+constexpr double kPi4Hi = 7.85398163397448278999e-01;
+constexpr double kPi4Lo = 3.06161699786838301793e-17;
+
+// sin(x) for the quadrant offset 0 and cos(x) for 1, |x| <= kMaxTrigArgument
+inline double sinQuadrant(double x, double offset) {
+    // pi/2 in three 33 bit parts, k * part is exact for k < 2^20
+    constexpr double kPio2_1 = 1.57079632673412561417e+00;
+    constexpr double kPio2_2 = 6.07710050630396597660e-11;
+    constexpr double kPio2_3 = 2.02226624871116645580e-21;
+    constexpr double kTwoOverPi = 6.36619772367581382433e-01;
+    double k = roundToInt(x * kTwoOverPi);
+    double r = ((x - k * kPio2_1) - k * kPio2_2) - k * kPio2_3;
+
+    // Quadrant (k + offset) mod 4
+    double n = k + offset;
+    double quarter = roundToInt(n * 0.25);
+    quarter = quarter > n * 0.25 ? quarter - 1.0 : quarter;
+    double q = n - 4.0 * quarter;
+
+    double z = r * r;
+    double sinPoly = 8.33333333332248946124e-03
+        + z * (-1.98412698298579493134e-04
+        + z * (2.75573137070700676789e-06
+        + z * (-2.50507602534068634195e-08
+        + z * 1.58969099521155010221e-10)));
+    double s = r + (z * r) * (-1.66666666666666324348e-01 + z * sinPoly);
+    // Keeps the sign of sin(-0)
+    s = r == 0.0 ? r : s;
+
+    double cosPoly = z * (4.16666666666666019037e-02
+        + z * (-1.38888888888741095749e-03
+        + z * (2.48015872894767294178e-05
+        + z * (-2.75573143513906633035e-07
+        + z * (2.08757232129817482790e-09
+        + z * -1.13596475577881948265e-11)))));
+    double hz = 0.5 * z;
+    double w = 1.0 - hz;
+    double c = w + (((1.0 - w) - hz) + z * cosPoly);
+
+    double value = (q == 1.0 || q == 3.0) ? c : s;
+    return q >= 2.0 ? -value : value;
+}
+
+// (asin(t) - t) / t as a rational function of z = t^2, for |t| <= 0.5
+inline double asinRational(double z) {
+    double p = z * (1.66666666666666657415e-01
+        + z * (-3.25565818622400915405e-01
+        + z * (2.01212532134862925881e-01
+        + z * (-4.00555345006794114027e-02
+        + z * (7.91534994289814532176e-04
+        + z * 3.47933107596021167570e-05)))));
+    double q = 1.0
+        + z * (-2.40339491173441421878e+00
+        + z * (2.02094576023350569471e+00
+        + z * (-6.88283971605453293030e-01
+        + z * 7.70381505559019352791e-02)));
+    return p / q;
+}
+
+} // namespace detail
+
+// sin and cos arguments the fast kernels reduce themselves
+constexpr double kMaxTrigArgument = 1.0e6;
+
+inline double exp(double x) {
+    using namespace detail;
+    constexpr double kLog2e = 1.44269504088896338700e+00;
+    constexpr double kLn2Hi = 6.93147180369123816490e-01;
+    constexpr double kLn2Lo = 1.90821492927058770002e-10;
+    // Past the clamps the result is inf or 0 anyway, NaN passes both
+    double xc = x < -746.0 ? -746.0 : (x > 710.0 ? 710.0 : x);
+    double k = roundToInt(xc * kLog2e);
+    double hi = xc - k * kLn2Hi;
+    double lo = k * kLn2Lo;
+    double r = hi - lo;
+    double t = r * r;
+    double c = r - t * (1.66666666666666019037e-01
+        + t * (-2.77777777770155933842e-03
+        + t * (6.61375632143793436117e-05
+        + t * (-1.65339022054652515390e-06
+        + t * 4.13813679705723846039e-08))));
+    double y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+    // 2^k in two halves, so huge and subnormal results round once
+    double k1 = roundToInt(k * 0.5);
+    return y * pow2(k1) * pow2(k - k1);
+}
+
+inline double log(double x) {
+    using namespace detail;
+    constexpr double kLn2Hi = 6.93147180369123816490e-01;
+    constexpr double kLn2Lo = 1.90821492927058770002e-10;
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    // x = 2^e * m with m in [sqrt(1/2), sqrt(2)), subnormals scaled up first
+    bool tiny = x < 0x1p-1022;
+    double xs = tiny ? x * 0x1p54 : x;
+    uint64_t bits = std::bit_cast<uint64_t>(xs);
+    double e = (std::bit_cast<double>(0x4330000000000000ull | (bits >> 52)) - 0x1p52) - (tiny ? 1077.0 : 1023.0);
+    double m = std::bit_cast<double>((bits & 0x000fffffffffffffull) | 0x3ff0000000000000ull);
+    bool high = m > 1.41421356237309504880;
+    m = high ? 0.5 * m : m;
+    e = high ? e + 1.0 : e;
+
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double z = s * s;
+    double w = z * z;
+    double t1 = w * (3.999999999940941908e-01 + w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+    double t2 = z * (6.666666666666735130e-01 + w * (2.857142874366239149e-01
+        + w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+    double hfsq = 0.5 * f * f;
+    double y = e * kLn2Hi - ((hfsq - (s * (hfsq + t1 + t2) + e * kLn2Lo)) - f);
+
+    double special = x == 0.0 ? -kInf : (x == kInf ? kInf : std::numeric_limits<double>::quiet_NaN());
+    return x > 0.0 && x < kInf ? y : special;
+}
+
+// Vectorizable sin and cos for |x| <= kMaxTrigArgument
+inline double sinReduced(double x) {
+    return detail::sinQuadrant(x, 0.0);
+}
+
+inline double cosReduced(double x) {
+    return detail::sinQuadrant(x, 1.0);
+}
+
+inline double sin(double x) {
+    return std::abs(x) <= kMaxTrigArgument ? sinReduced(x) : std::sin(x);
+}
+
+inline double cos(double x) {
+    return std::abs(x) <= kMaxTrigArgument ? cosReduced(x) : std::cos(x);
+}
+
+inline double atan(double x) {
+    using namespace detail;
+    // atan(a) = pi/2 - atan(1/a) above 1, atan(t) = pi/4 + atan((t-1)/(t+1))
+    // above tan(pi/8), the polynomial covers |u| <= 7/16
+    double a = std::abs(x);
+    bool inverted = a > 1.0;
+    double t = inverted ? 1.0 / a : a;
+    bool shifted = t > 0.41421356237309504880;
+    double u = shifted ? (t - 1.0) / (t + 1.0) : t;
+
+    double z = u * u;
+    double w = z * z;
+    double s1 = z * (3.33333333333329318027e-01 + w * (1.42857142725034663711e-01
+        + w * (9.09088713343650656196e-02 + w * (6.66107313738753120669e-02
+        + w * (4.97687799461593236017e-02 + w * 1.62858201153657823623e-02)))));
+    double s2 = w * (-1.99999999998764832476e-01 + w * (-1.11111104054623557880e-01
+        + w * (-7.69187620504482999495e-02 + w * (-5.83357013379057348645e-02
+        + w * -3.65315727442169155270e-02))));
+    double tail = u * (s1 + s2);
+    double v = shifted ? kPi4Hi - ((tail - kPi4Lo) - u) : u - tail;
+    v = inverted ? kPi2Hi - (v - kPi2Lo) : v;
+    return std::copysign(v, x);
+}
+
+inline double acos(double x) {
+    using namespace detail;
+    // |x| <= 0.5: pi/2 - asin(x); otherwise from asin(sqrt((1 - |x|) / 2))
+    double a = std::abs(x);
+    bool tail = a > 0.5;
+    double z = tail ? 0.5 * (1.0 - a) : x * x;
+    // NaN outside [-1, 1] comes from the sqrt
+    double s = std::sqrt(tail ? z : 0.0);
+    double r = asinRational(z);
+
+    double middle = kPi2Hi - (x - (kPi2Lo - x * r));
+    // s split into a 21 bit head and the correction c = (z - df^2) / (s + df)
+    double df = std::bit_cast<double>(std::bit_cast<uint64_t>(s) & 0xffffffff00000000ull);
+    double c = s > 0.0 ? (z - df * df) / (s + df) : 0.0;
+    double positive = 2.0 * (df + (r * s + c));
+    double negative = kPi - 2.0 * (s + (r * s - kPi2Lo));
+    return tail ? (x > 0.0 ? positive : negative) : middle;
+}
+
+// Batched versions, out[i] = f(in[i]) for i < n. in and out may be the same
+// array. Compiled in src/FastMath.cc without FP exception and errno
+// semantics, which is what lets their loops vectorize. Without AVX2 the
+// batched log is the libm loop, the kernel only wins with wider vectors.
+void exp(const double* in, double* out, size_t n);
+void log(const double* in, double* out, size_t n);
+void sin(const double* in, double* out, size_t n);
+void cos(const double* in, double* out, size_t n);
+void atan(const double* in, double* out, size_t n);
+void acos(const double* in, double* out, size_t n);
+
+} // namespace fast_math
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_FASTMATH_H_
@@ -0,0 +1,79 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_FINITEDIFFERENCE_H_
+#define MINIMIZEROPTIMIZER_HEADERS_FINITEDIFFERENCE_H_
+
+#include <optional>
+#include <vector>
+
+#include "BatchEvaluator.h"
+#include "Function.h"
+#include "Matrix.h"
+#include "Sparsity.h"
+
+// Forward difference Jacobian of residual functions for graphs that cannot
+// be differentiated symbolically. Steps are h_j = sqrt(eps) * max(1, |x_j|),
+// accurate to about half the digits of the residuals.
+//
+// When every residual compiles to a BatchEvaluator tape, row i is one batch
+// of 1 + k_i points: the current values and the perturbation of each of the
+// k_i columns of its pattern row that the residual reads. The tapes read no
+// caches, so blocks of rows run on the shared ThreadPool, and setMathMode()
+// selects libm or the vectorized fast_math kernels. No coloring is built.
+//
+// Other graphs have their columns grouped by ColumnColoring: all columns of a
+// group are perturbed at once and each row reads its column of the group from
+// one evaluation, so the whole Jacobian costs colorCount() + 1 evaluations of
+// every residual instead of x.size() + 1. The groups run in parallel when
+// the variables are the entries 0..n-1 of one VariableStore, every thread
+// then reads its own perturbed copy through VariableStore::Override.
+// Otherwise, and whenever a node is under a DependencyTracker (whose caches
+// an Override does not dirty), the perturbations go through
+// Variable::setValue one group after the other.
+class FiniteDifferenceJacobian {
+    std::vector<Function *> m_functions;
+    std::vector<Variable *> m_X;
+    SparsityPattern m_pattern;
+    // Rows holding each column and their groups, for graphs that are not
+    // batched
+    SparsityPattern m_rowsOf;
+    ColumnColoring m_coloring;
+    VariableStore *m_store = nullptr;
+    std::optional<BatchEvaluator> m_batch;
+    // Points of all rows in one batched evaluation
+    size_t m_batchPoints = 0;
+    // Distinct nodes of graphs that are not batched
+    std::vector<const Function *> m_nodes;
+
+    // Whether a node of the graphs is under a DependencyTracker
+    bool tracked() const;
+    void evaluateBatched(Matrix<> &residuals, Matrix<> &jac, bool parallel) const;
+    void evaluateSerial(const Matrix<> &residuals, Matrix<> &jac) const;
+    void evaluateParallel(const Matrix<> &residuals, Matrix<> &jac) const;
+
+public:
+    // The functions and variables stay owned by the caller
+    FiniteDifferenceJacobian(std::vector<Function *> functions, std::vector<Variable *> x);
+
+    // With a known Jacobian pattern, it must cover every dependency
+    FiniteDifferenceJacobian(std::vector<Function *> functions, std::vector<Variable *> x,
+                             SparsityPattern pattern);
+
+    const SparsityPattern &pattern() const { return m_pattern; }
+    // Empty for batched graphs
+    const ColumnColoring &coloring() const { return m_coloring; }
+    size_t colorCount() const { return m_coloring.colorCount(); }
+
+    // Whether the residuals are evaluated through a BatchEvaluator
+    bool isBatched() const { return m_batch.has_value(); }
+
+    // Math of the batched evaluation, Strict (libm) by default
+    void setMathMode(MathMode mode);
+
+    static double step(double x);
+
+    // Residuals and Jacobian at the current values, which are restored
+    // afterwards. parallel = false keeps every evaluation on the calling
+    // thread.
+    void evaluate(Matrix<> &residuals, Matrix<> &jac, bool parallel = true) const;
+};
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_FINITEDIFFERENCE_H_
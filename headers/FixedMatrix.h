@@ -0,0 +1,465 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_FIXEDMATRIX_H_
+#define MINIMIZEROPTIMIZER_HEADERS_FIXEDMATRIX_H_
+
+#include <array>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+
+#include "Matrix.h"
+
+// Matrix with its size fixed at compile time and its values on the stack,
+// for the small blocks of per-constraint work: 2x2 rotations, local Jacobian
+// blocks, 2x2 and 3x3 normal-equation blocks. Every loop has a constant
+// trip count, so the compiler unrolls them, and nothing allocates. The
+// arithmetic is constexpr.
+//
+// Values are row-major like Matrix<T>. block(), copyTo() and addTo() move
+// values between a FixedMatrix and a block of a dynamic Matrix without
+// temporaries.
+template <Arithmetic T, size_t R, size_t C>
+class FixedMatrix {
+    static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+
+    std::array<T, R * C> m_data{};
+
+public:
+    using size_type = size_t;
+    using iterator_type = size_t;
+
+    static constexpr size_type kRows = R;
+    static constexpr size_type kCols = C;
+
+    // Zero filled
+    constexpr FixedMatrix() = default;
+    constexpr explicit FixedMatrix(const T& value) { m_data.fill(value); }
+    constexpr FixedMatrix(const std::initializer_list<std::initializer_list<T>>& values);
+
+    // Throws std::invalid_argument unless A is R x C
+    explicit FixedMatrix(const Matrix<T>& A);
+
+    // Element Access
+    constexpr T& operator()(iterator_type rowIndex, iterator_type colIndex);
+    constexpr T operator()(iterator_type rowIndex, iterator_type colIndex) const;
+
+    constexpr T* data() { return m_data.data(); }
+    constexpr const T* data() const { return m_data.data(); }
+
+    static constexpr size_type rows_size() { return R; }
+    static constexpr size_type cols_size() { return C; }
+
+    static constexpr FixedMatrix identity();
+    static constexpr FixedMatrix zeroes() { return FixedMatrix(); }
+
+    constexpr FixedMatrix<T, C, R> transpose() const;
+
+    constexpr T trace() const requires (R == C);
+
+    // Gaussian elimination with partial pivoting, zero when singular
+    constexpr T determinant() const requires (R == C && std::floating_point<T>);
+
+    // Throw std::runtime_error when the matrix is singular
+    constexpr FixedMatrix inverse() const requires (R == C && std::floating_point<T>);
+    template <size_t K>
+    constexpr FixedMatrix<T, R, K> solve(const FixedMatrix<T, R, K>& B) const requires (R == C && std::floating_point<T>);
+
+    T norm() const;
+
+    // Interop with the dynamic Matrix
+
+    Matrix<T> toMatrix() const;
+
+    // The R x C block of A at (row, col), throws std::out_of_range when it does not fit
+    static FixedMatrix block(const Matrix<T>& A, size_type row, size_type col);
+
+    // A[row:row+R, col:col+C] = *this, or += *this
+    void copyTo(Matrix<T>& A, size_type row, size_type col) const;
+    void addTo(Matrix<T>& A, size_type row, size_type col) const;
+
+private:
+    static void checkBlock(const Matrix<T>& A, size_type row, size_type col);
+
+    // Eliminates in place with partial pivoting, applying the row operations
+    // to B as well. Returns false for a pivot below the LU tolerance.
+    template <size_t K>
+    static constexpr bool eliminate(FixedMatrix& A, FixedMatrix<T, R, K>& B, int& sign);
+
+    // X = U^{-1} X, false when U is singular
+    template <size_t K>
+    static constexpr bool solveInPlace(FixedMatrix U, FixedMatrix<T, R, K>& X);
+};
+
+template <typename T, size_t N>
+using FixedVector = FixedMatrix<T, N, 1>;
+
+template <Arithmetic T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C>::FixedMatrix(const std::initializer_list<std::initializer_list<T>>& values)
+{
+    if (values.size() != R) {
+        throw std::invalid_argument("FixedMatrix: wrong number of rows");
+    }
+    size_type i = 0;
+    for (const auto& row : values) {
+        if (row.size() != C) {
+            throw std::invalid_argument("FixedMatrix: wrong number of columns");
+        }
+        size_type j = 0;
+        for (const auto& value : row) {
+            m_data[i * C + j++] = value;
+        }
+        ++i;
+    }
+}
+
+template <Arithmetic T, size_t R, size_t C>
+inline FixedMatrix<T, R, C>::FixedMatrix(const Matrix<T>& A)
+{
+    if (A.rows_size() != R || A.cols_size() != C) {
+        throw std::invalid_argument("FixedMatrix: Matrix has a different size");
+    }
+    *this = block(A, 0, 0);
+}
+
+template <Arithmetic T, size_t R, size_t C>
+constexpr T& FixedMatrix<T, R, C>::operator()(iterator_type rowIndex, iterator_type colIndex)
+{
+    if (rowIndex >= R || colIndex >= C) {
+        throw std::out_of_range("Index out of range");
+    }
+    return m_data[rowIndex * C + colIndex];
+}
+
+template <Arithmetic T, size_t R, size_t C>
+constexpr T FixedMatrix<T, R, C>::operator()(iterator_type rowIndex, iterator_type colIndex) const
+{
+    if (rowIndex >= R || colIndex >= C) {
+        throw std::out_of_range("Index out of range");
+    }
+    return m_data[rowIndex * C + colIndex];
+}
+
+template <Arithmetic T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::identity()
+{
+    FixedMatrix result;
+    for (size_type i = 0; i < std::min(R, C); ++i) {
+        result.m_data[i * C + i] = T(1);
+    }
+    return result;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+constexpr FixedMatrix<T, C, R> FixedMatrix<T, R, C>::transpose() const
+{
+    FixedMatrix<T, C, R> result;
+    T* out = result.data();
+    for (size_type i = 0; i < R; ++i) {
+        for (size_type j = 0; j < C; ++j) {
+            out[j * R + i] = m_data[i * C + j];
+        }
+    }
+    return result;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+constexpr T FixedMatrix<T, R, C>::trace() const requires (R == C)
+{
+    T result = T(0);
+    for (size_type i = 0; i < R; ++i) {
+        result += m_data[i * C + i];
+    }
+    return result;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+template <size_t K>
+constexpr bool FixedMatrix<T, R, C>::eliminate(FixedMatrix& A, FixedMatrix<T, R, K>& B, int& sign)
+{
+    auto abs = [](T x) { return x < T(0) ? -x : x; };
+    // The same singularity test as LU, relative to the largest entry of the
+    // pivot's column
+    std::array<T, C> tolerance{};
+    for (size_type i = 0; i < R; ++i) {
+        for (size_type j = 0; j < C; ++j) {
+            tolerance[j] = std::max(tolerance[j], abs(A.m_data[i * C + j]));
+        }
+    }
+    for (T& t : tolerance) {
+        t *= static_cast<T>(R) * std::numeric_limits<T>::epsilon();
+    }
+    T* b = B.data();
+    sign = 1;
+    for (size_type k = 0; k < R; ++k) {
+        size_type pivot = k;
+        for (size_type i = k + 1; i < R; ++i) {
+            if (abs(A.m_data[i * C + k]) > abs(A.m_data[pivot * C + k])) {
+                pivot = i;
+            }
+        }
+        if (!(abs(A.m_data[pivot * C + k]) > tolerance[k])) {
+            return false;
+        }
+        if (pivot != k) {
+            for (size_type j = 0; j < C; ++j) {
+                std::swap(A.m_data[k * C + j], A.m_data[pivot * C + j]);
+            }
+            for (size_type j = 0; j < K; ++j) {
+                std::swap(b[k * K + j], b[pivot * K + j]);
+            }
+            sign = -sign;
+        }
+        for (size_type i = k + 1; i < R; ++i) {
+            T factor = A.m_data[i * C + k] / A.m_data[k * C + k];
+            A.m_data[i * C + k] = T(0);
+            for (size_type j = k + 1; j < C; ++j) {
+                A.m_data[i * C + j] -= factor * A.m_data[k * C + j];
+            }
+            for (size_type j = 0; j < K; ++j) {
+                b[i * K + j] -= factor * b[k * K + j];
+            }
+        }
+    }
+    return true;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+constexpr T FixedMatrix<T, R, C>::determinant() const requires (R == C && std::floating_point<T>)
+{
+    // Also for R <= 2, so a matrix inverse() rejects has determinant zero
+    FixedMatrix U = *this;
+    FixedMatrix<T, R, 1> unused;
+    int sign = 1;
+    if (!eliminate(U, unused, sign)) {
+        return T(0);
+    }
+    T d = static_cast<T>(sign);
+    for (size_type i = 0; i < R; ++i) {
+        d *= U.m_data[i * C + i];
+    }
+    return d;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+template <size_t K>
+constexpr bool FixedMatrix<T, R, C>::solveInPlace(FixedMatrix U, FixedMatrix<T, R, K>& X)
+{
+    int sign = 1;
+    if (!eliminate(U, X, sign)) {
+        return false;
+    }
+    T* x = X.data();
+    for (size_type i = R; i-- > 0;) {
+        for (size_type j = 0; j < K; ++j) {
+            T sum = x[i * K + j];
+            for (size_type k = i + 1; k < R; ++k) {
+                sum -= U.m_data[i * C + k] * x[k * K + j];
+            }
+            x[i * K + j] = sum / U.m_data[i * C + i];
+        }
+    }
+    return true;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+template <size_t K>
+constexpr FixedMatrix<T, R, K> FixedMatrix<T, R, C>::solve(const FixedMatrix<T, R, K>& B) const
+    requires (R == C && std::floating_point<T>)
+{
+    FixedMatrix<T, R, K> X = B;
+    if (!solveInPlace(*this, X)) {
+        throw std::runtime_error("FixedMatrix::solve: matrix is singular");
+    }
+    return X;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::inverse() const requires (R == C && std::floating_point<T>)
+{
+    FixedMatrix X = identity();
+    if (!solveInPlace(*this, X)) {
+        throw std::runtime_error("Matrix is singular and cannot be inverted.");
+    }
+    return X;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+inline T FixedMatrix<T, R, C>::norm() const
+{
+    T sum = T(0);
+    for (const T& value : m_data) {
+        sum += value * value;
+    }
+    return std::sqrt(sum);
+}
+
+template <Arithmetic T, size_t R, size_t C>
+inline Matrix<T> FixedMatrix<T, R, C>::toMatrix() const
+{
+    Matrix<T> result(R, C);
+    copyTo(result, 0, 0);
+    return result;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+inline void FixedMatrix<T, R, C>::checkBlock(const Matrix<T>& A, size_type row, size_type col)
+{
+    if (row + R > A.rows_size() || col + C > A.cols_size()) {
+        throw std::out_of_range("FixedMatrix: block out of range");
+    }
+}
+
+template <Arithmetic T, size_t R, size_t C>
+inline FixedMatrix<T, R, C> FixedMatrix<T, R, C>::block(const Matrix<T>& A, size_type row, size_type col)
+{
+    checkBlock(A, row, col);
+    FixedMatrix result;
+    for (size_type i = 0; i < R; ++i) {
+        const T* a = A.rowData(row + i) + col;
+        for (size_type j = 0; j < C; ++j) {
+            result.m_data[i * C + j] = a[j];
+        }
+    }
+    return result;
+}
+
+template <Arithmetic T, size_t R, size_t C>
+inline void FixedMatrix<T, R, C>::copyTo(Matrix<T>& A, size_type row, size_type col) const
+{
+    checkBlock(A, row, col);
+    for (size_type i = 0; i < R; ++i) {
+        T* a = A.rowData(row + i) + col;
+        for (size_type j = 0; j < C; ++j) {
+            a[j] = m_data[i * C + j];
+        }
+    }
+}
+
+template <Arithmetic T, size_t R, size_t C>
+inline void FixedMatrix<T, R, C>::addTo(Matrix<T>& A, size_type row, size_type col) const
+{
+    checkBlock(A, row, col);
+    for (size_type i = 0; i < R; ++i) {
+        T* a = A.rowData(row + i) + col;
+        for (size_type j = 0; j < C; ++j) {
+            a[j] += m_data[i * C + j];
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////// out operators start
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C>& operator+=(FixedMatrix<V, R, C>& A, const FixedMatrix<V, R, C>& B)
+{
+    V* a = A.data();
+    const V* b = B.data();
+    for (size_t k = 0; k < R * C; ++k) {
+        a[k] += b[k];
+    }
+    return A;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C>& operator-=(FixedMatrix<V, R, C>& A, const FixedMatrix<V, R, C>& B)
+{
+    V* a = A.data();
+    const V* b = B.data();
+    for (size_t k = 0; k < R * C; ++k) {
+        a[k] -= b[k];
+    }
+    return A;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C>& operator*=(FixedMatrix<V, R, C>& A, const V& scalar)
+{
+    V* a = A.data();
+    for (size_t k = 0; k < R * C; ++k) {
+        a[k] *= scalar;
+    }
+    return A;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C>& operator/=(FixedMatrix<V, R, C>& A, const V& scalar)
+{
+    if (scalar == V()) {
+        throw std::runtime_error("scalar shouldn't be zero");
+    }
+    V* a = A.data();
+    for (size_t k = 0; k < R * C; ++k) {
+        a[k] /= scalar;
+    }
+    return A;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C> operator+(FixedMatrix<V, R, C> A, const FixedMatrix<V, R, C>& B)
+{
+    return A += B;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C> operator-(FixedMatrix<V, R, C> A, const FixedMatrix<V, R, C>& B)
+{
+    return A -= B;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C> operator*(FixedMatrix<V, R, C> A, const V& scalar)
+{
+    return A *= scalar;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C> operator*(const V& scalar, FixedMatrix<V, R, C> A)
+{
+    return A *= scalar;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr FixedMatrix<V, R, C> operator/(FixedMatrix<V, R, C> A, const V& scalar)
+{
+    return A /= scalar;
+}
+
+// Sizes are checked at compile time
+template <Arithmetic V, size_t R, size_t K, size_t C>
+constexpr FixedMatrix<V, R, C> operator*(const FixedMatrix<V, R, K>& A, const FixedMatrix<V, K, C>& B)
+{
+    FixedMatrix<V, R, C> result;
+    V* c = result.data();
+    const V* a = A.data();
+    const V* b = B.data();
+    for (size_t i = 0; i < R; ++i) {
+        for (size_t k = 0; k < K; ++k) {
+            V aik = a[i * K + k];
+            for (size_t j = 0; j < C; ++j) {
+                c[i * C + j] += aik * b[k * C + j];
+            }
+        }
+    }
+    return result;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr bool operator==(const FixedMatrix<V, R, C>& A, const FixedMatrix<V, R, C>& B)
+{
+    for (size_t k = 0; k < R * C; ++k) {
+        if (A.data()[k] != B.data()[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <Arithmetic V, size_t R, size_t C>
+constexpr bool operator!=(const FixedMatrix<V, R, C>& A, const FixedMatrix<V, R, C>& B)
+{
+    return !(A == B);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////// out operators end
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_FIXEDMATRIX_H_
@@ -1,7 +1,11 @@
 #ifndef MINIMIZEROPTIMIZER_HEADERS_FUNCTION_H_
 #define MINIMIZEROPTIMIZER_HEADERS_FUNCTION_H_
 #include <cmath>
+#include <cstddef>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // Function
 
@@ -35,6 +39,8 @@
 
 // Forward declaration
 class Variable;
+class VariableStore;
+class DependencyTracker;
 
 // Base abstract class Function
 class Function {
@@ -44,21 +50,69 @@ public:
     // Evaluate the function
     virtual double evaluate() const = 0;
 
+    // evaluate() through the cache of a DependencyTracker: a tracked node
+    // recomputes only after a variable below it changed, an untracked one
+    // just evaluates. The built-in nodes read their operands through here.
+    double value() const {
+        return m_cached && !m_dirty ? m_cache : refresh();
+    }
+
     // Compute the derivative with respect to a specific variable
     virtual Function* derivative(Variable* var) const = 0;
 
     // Clone method
     virtual Function* clone() const = 0;
+
+    // Operands of the node, for walking the expression graph
+    virtual size_t childCount() const { return 0; }
+    virtual Function* child(size_t /*i*/) const { return nullptr; }
+
+#ifdef MATH_ALLOCATION_TRACKING
+    // Heap allocated nodes are reported to the instrumentation registry
+    static void* operator new(std::size_t bytes);
+    static void operator delete(void* ptr, std::size_t bytes);
+#endif
+
+protected:
+    // Whether childCount()/child() list everything evaluate() reads. Only
+    // such nodes are cached, and only when the nodes below them are too;
+    // Unary, Binary and Constant say yes, so their subclasses must read
+    // nothing but their operands. A subclass reading other state keeps the
+    // default and is evaluated afresh, with everything above it.
+    virtual bool cacheable() const { return false; }
+
+private:
+    // Incremental evaluation, set up by DependencyTracker
+    mutable double m_cache = 0.0;
+    mutable bool m_dirty = true;
+    bool m_tracked = false;
+    bool m_cached = false;
+    std::vector<Function*> m_parents;
+
+    // evaluate() into the cache. Operands evaluate() read through evaluate()
+    // rather than value(), or skipped, are brought up to date as well: a
+    // clean node has clean operands, so the ancestors of a dirty node are
+    // dirty and markDirty() may stop there.
+    double refresh() const;
+
+    // Marks the node and its ancestors, stops at nodes that already are
+    void markDirty();
+
+    friend class DependencyTracker;
+    friend class Variable;
 };
 // Class for unary operation
 class Unary: public Function {
 protected:
     Function* operand;
+    bool cacheable() const override { return true; }
 public:
     Unary(Function* op): operand(op){}
     ~Unary(){
         //delete operand;
     }
+    size_t childCount() const override { return 1; }
+    Function* child(size_t) const override { return operand; }
     virtual double evaluate() const override = 0;
     virtual Function* derivative(Variable* var) const override = 0;
     virtual Function* clone() const = 0;
@@ -68,12 +122,15 @@ class Binary: public Function {
 protected:
     Function* left;
     Function* right;
+    bool cacheable() const override { return true; }
 public:
     Binary(Function* l, Function* r): left(l), right(r) {}
     ~Binary(){
         //delete left;
         //delete right;
     }
+    size_t childCount() const override { return 2; }
+    Function* child(size_t i) const override { return i == 0 ? left : right; }
     virtual double evaluate() const override = 0;
     virtual Function* derivative(Variable* var) const override = 0;
     virtual Function* clone() const = 0;
@@ -81,7 +138,10 @@ public:
 // Class Constant (constant function)
 class Constant : public Function {
 private:
-    double value;
+    double m_value;
+
+protected:
+    bool cacheable() const override { return true; }
 
 public:
     explicit Constant(double value);
@@ -97,26 +157,101 @@ public:
 };
 
 // Class Variable
+// Either a handle to an entry of a VariableStore or, for values the caller
+// keeps elsewhere, a reference to a double.
 class Variable : public Function {
 private:
-    double* value; // Reference to the variable's value
+    double* m_value; // Reference to the variable's value, nullptr in a store
+    VariableStore* m_store = nullptr;
+    size_t m_index = 0;
+    // Tracked Variable nodes sharing value, set by DependencyTracker
+    std::vector<Variable*>* m_aliases = nullptr;
+
+    friend class DependencyTracker;
 
 public:
     explicit Variable(double* value);
 
+    // Entry index of store
+    Variable(VariableStore* store, size_t index);
+
     double evaluate() const override;
 
     Function* derivative(Variable* var) const override;
 
     Function* clone() const override;
 
+    // Marks the tracked nodes depending on the value dirty. Values of
+    // tracked variables must change through here, a direct write to the
+    // double is not seen by the caches.
     void setValue(double value);
 
+    // The store of the variable and its index there, nullptr for a variable
+    // referencing a double
+    VariableStore* store() const { return m_store; }
+    size_t index() const { return m_index; }
+
+    // Where the value lives right now, stores may move their array
+    double* address() const;
+
     // Comparison operator to check if two Variables refer to the same double
     bool operator==(Variable* other) const;
 
 };
 
+// Owns the values of a problem in one contiguous array. Variable nodes made
+// by the store hold an index into it, so whole parameter vectors are read and
+// written with one copy and a copy of the store is a private set of values.
+class VariableStore {
+    std::vector<double> m_values;
+
+public:
+    VariableStore() = default;
+
+    explicit VariableStore(std::vector<double> values) : m_values(std::move(values)) {}
+
+    // Appends a value and returns its index. Handles stay valid, the array
+    // may move.
+    size_t add(double value) {
+        m_values.push_back(value);
+        return m_values.size() - 1;
+    }
+
+    void reserve(size_t count) { m_values.reserve(count); }
+
+    // A new node for entry index, owned by the caller
+    Variable* variable(size_t index);
+
+    size_t size() const { return m_values.size(); }
+
+    double* data() { return m_values.data(); }
+    const double* data() const { return m_values.data(); }
+
+    double& operator[](size_t index) { return m_values[index]; }
+    double operator[](size_t index) const { return m_values[index]; }
+
+    const std::vector<double>& values() const { return m_values; }
+
+    // Overwrites every value, tracked Variable nodes are not notified
+    void assign(const std::vector<double>& values);
+
+    // While alive, Variable nodes of store read values instead of the array
+    // of the store on the calling thread, so threads can evaluate the same
+    // untracked graph at different points. values has store.size() entries.
+    // One override per thread is active, nested ones restore the outer one.
+    class Override {
+        const VariableStore* m_previousStore;
+        const double* m_previousValues;
+
+    public:
+        Override(const VariableStore& store, const double* values);
+        ~Override();
+
+        Override(const Override&) = delete;
+        Override& operator=(const Override&) = delete;
+    };
+};
+
 // Class Addition
 class Addition : public Binary {
 
@@ -517,4 +652,51 @@ public:
     Min& operator=(const Min&) = delete;
 };
 
+// Incremental re-evaluation of expression graphs. track() links every node
+// below a root to its parents and groups the Variable nodes sharing a value
+// (derivatives and clones make new Variable nodes for the same double). Store
+// handles are grouped by store and index, so the groups survive the store
+// growing and moving its array; other variables by the double they reference.
+// Variable::setValue() then marks the ancestors of the whole group dirty, and
+// Function::value() recomputes only dirty nodes, so changing a few variables
+// costs the subgraphs that depend on them. Calling evaluate() on a root
+// recomputes the root itself and reads its operands from the caches.
+//
+// A node belongs to at most one tracker. The tracker must be released before
+// tracked nodes are deleted, and cached nodes must not be evaluated from two
+// threads at once.
+class DependencyTracker {
+    // The store and index of a handle, or the double and 0
+    using AliasKey = std::pair<const void*, size_t>;
+
+    struct AliasKeyHash {
+        size_t operator()(const AliasKey& key) const {
+            return std::hash<const void*>()(key.first) ^ std::hash<size_t>()(key.second) * 31;
+        }
+    };
+
+    std::vector<Function*> m_nodes;
+    std::unordered_map<AliasKey, std::vector<Variable*>, AliasKeyHash> m_groups;
+
+    static AliasKey aliasKey(const Variable* var);
+
+public:
+    // Whether node belongs to some tracker, its value may then be cached
+    static bool isTracked(const Function* node);
+
+    DependencyTracker() = default;
+    ~DependencyTracker() { release(); }
+
+    DependencyTracker(const DependencyTracker&) = delete;
+    DependencyTracker& operator=(const DependencyTracker&) = delete;
+
+    // Tracks root and everything below it, nodes tracked before are kept
+    void track(Function* root);
+
+    // Untracks every node, they evaluate from scratch again
+    void release();
+
+    size_t nodeCount() const { return m_nodes.size(); }
+};
+
 #endif // ! MINIMIZEROPTIMIZER_HEADERS_FUNCTION_H_
\ No newline at end of file
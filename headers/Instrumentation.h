@@ -0,0 +1,305 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_INSTRUMENTATION_H_
+#define MINIMIZEROPTIMIZER_HEADERS_INSTRUMENTATION_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Lightweight profiling of the Math hot paths: scoped timers, monotonic
+// counters and log2 histograms, collected in a process wide registry and
+// dumped as JSON or in the Chrome trace format (chrome://tracing, Perfetto).
+//
+// The probes (MATH_SCOPED_TIMER, MATH_COUNTER_ADD, MATH_HISTOGRAM_RECORD) are
+// compiled in only with the MATH_ENABLE_INSTRUMENTATION CMake option, which
+// defines MATH_INSTRUMENTATION. The registry itself is always available, so
+// code that dumps it builds either way.
+//
+// Allocation accounting of Matrix buffers and Function nodes is a separate
+// opt-in: MATH_ENABLE_ALLOCATION_TRACKING defines MATH_ALLOCATION_TRACKING,
+// which turns on MATH_RECORD_ALLOCATION / MATH_RECORD_DEALLOCATION.
+
+namespace instrumentation {
+
+using Clock = std::chrono::steady_clock;
+
+class Counter {
+    std::atomic<int64_t> m_value{0};
+
+public:
+    void add(int64_t n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+    void reset() { m_value.store(0, std::memory_order_relaxed); }
+};
+
+// Durations of a code section in nanoseconds
+class Timer {
+    std::atomic<int64_t> m_count{0};
+    std::atomic<int64_t> m_total{0};
+    std::atomic<int64_t> m_min{INT64_MAX};
+    std::atomic<int64_t> m_max{0};
+
+public:
+    void record(int64_t ns);
+
+    int64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    int64_t totalNs() const { return m_total.load(std::memory_order_relaxed); }
+    int64_t minNs() const { return count() ? m_min.load(std::memory_order_relaxed) : 0; }
+    int64_t maxNs() const { return m_max.load(std::memory_order_relaxed); }
+
+    void reset();
+};
+
+// Distribution of non-negative values. Bucket k holds values in
+// [2^(k - kOffset - 1), 2^(k - kOffset)), bucket 0 also holds zero.
+class Histogram {
+public:
+    static constexpr int kBuckets = 64;
+    static constexpr int kOffset = 16;
+
+private:
+    std::array<std::atomic<int64_t>, kBuckets> m_buckets{};
+    std::atomic<int64_t> m_count{0};
+    std::atomic<double> m_sum{0.0};
+    std::atomic<double> m_min{0.0};
+    std::atomic<double> m_max{0.0};
+
+public:
+    void record(double value);
+
+    static int bucket(double value);
+
+    // Upper bound of the values in a bucket
+    static double upperBound(int bucket);
+
+    int64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    int64_t bucketCount(int bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+    double sum() const { return m_sum.load(std::memory_order_relaxed); }
+    double min() const { return m_min.load(std::memory_order_relaxed); }
+    double max() const { return m_max.load(std::memory_order_relaxed); }
+
+    void reset();
+};
+
+enum class AllocationKind {
+    Matrix,
+    Function
+};
+
+constexpr int kAllocationKinds = 2;
+
+const char *allocationKindName(AllocationKind kind);
+
+struct AllocationCounts {
+    int64_t allocations = 0;
+    int64_t deallocations = 0;
+    int64_t allocatedBytes = 0;
+    int64_t freedBytes = 0;
+    // Bytes allocated and not yet freed, and the highest value it reached
+    int64_t liveBytes = 0;
+    int64_t peakBytes = 0;
+};
+
+// Process wide totals of one allocation kind
+class AllocationTracker {
+    std::atomic<int64_t> m_allocations{0};
+    std::atomic<int64_t> m_deallocations{0};
+    std::atomic<int64_t> m_allocatedBytes{0};
+    std::atomic<int64_t> m_freedBytes{0};
+    std::atomic<int64_t> m_liveBytes{0};
+    std::atomic<int64_t> m_peakBytes{0};
+
+public:
+    void allocated(int64_t bytes);
+    void freed(int64_t bytes);
+
+    AllocationCounts counts() const;
+
+    // Zeroes the totals. Live bytes stay, the peak restarts from them.
+    void reset();
+};
+
+// Accounts the allocations made by the current thread while it is alive.
+// Scopes nest; live and peak bytes are relative to the start of the scope.
+// A named scope adds its totals to the counters "<name>.allocations" and
+// "<name>.bytes" and its peak to the histogram "<name>.peakBytes".
+class AllocationScope {
+    const char *m_name;
+    AllocationScope *m_parent;
+    std::array<AllocationCounts, kAllocationKinds> m_counts{};
+    AllocationCounts m_total;
+
+    void allocated(int kind, int64_t bytes);
+    void freed(int kind, int64_t bytes);
+
+    friend void recordAllocation(AllocationKind kind, size_t bytes);
+    friend void recordDeallocation(AllocationKind kind, size_t bytes);
+
+public:
+    explicit AllocationScope(const char *name = nullptr);
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope &) = delete;
+    AllocationScope &operator=(const AllocationScope &) = delete;
+
+    const AllocationCounts &counts(AllocationKind kind) const { return m_counts[static_cast<int>(kind)]; }
+
+    // All kinds together
+    const AllocationCounts &total() const { return m_total; }
+};
+
+void recordAllocation(AllocationKind kind, size_t bytes);
+void recordDeallocation(AllocationKind kind, size_t bytes);
+
+struct TraceEvent {
+    const char *name;
+    int64_t startNs;
+    int64_t durationNs;
+    int thread;
+};
+
+class Registry {
+    mutable std::mutex m_mutex;
+    // Probes keep references to the entries, so they are never removed
+    std::map<std::string, std::unique_ptr<Counter>> m_counters;
+    std::map<std::string, std::unique_ptr<Timer>> m_timers;
+    std::map<std::string, std::unique_ptr<Histogram>> m_histograms;
+    std::array<AllocationTracker, kAllocationKinds> m_allocations;
+
+    std::atomic<bool> m_tracing{false};
+    std::vector<TraceEvent> m_events;
+    int64_t m_droppedEvents = 0;
+    Clock::time_point m_epoch;
+
+    Registry();
+
+public:
+    // Bounds the memory of a forgotten trace
+    static constexpr size_t kMaxTraceEvents = 1 << 20;
+
+    static Registry &instance();
+
+    Counter &counter(const std::string &name);
+    Timer &timer(const std::string &name);
+    Histogram &histogram(const std::string &name);
+
+    AllocationTracker &allocations(AllocationKind kind) { return m_allocations[static_cast<int>(kind)]; }
+
+    // Scoped timers additionally record trace events while tracing is on
+    void setTracing(bool enabled) { m_tracing.store(enabled, std::memory_order_relaxed); }
+    bool tracing() const { return m_tracing.load(std::memory_order_relaxed); }
+
+    void addTraceEvent(const char *name, Clock::time_point start, Clock::time_point end);
+
+    std::vector<TraceEvent> traceEvents() const;
+
+    // Zeroes every entry and drops the trace
+    void reset();
+
+    // {"counters": {...}, "timers": {...}, "histograms": {...}, "allocations": {...}}
+    void writeJson(std::ostream &out) const;
+
+    // Trace events as complete ("X") events, final counter values as counter ("C") events
+    void writeChromeTrace(std::ostream &out) const;
+};
+
+class ScopedTimer {
+    Timer &m_timer;
+    const char *m_name;
+    Clock::time_point m_start;
+
+public:
+    ScopedTimer(Timer &timer, const char *name) : m_timer(timer), m_name(name), m_start(Clock::now()) {}
+
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+};
+
+// Times only the outermost of recursive calls sharing the depth counter,
+// e.g. a whole Function tree instead of every node
+class NestedScopedTimer {
+    int &m_depth;
+    Timer &m_timer;
+    const char *m_name;
+    Clock::time_point m_start;
+
+public:
+    NestedScopedTimer(Timer &timer, const char *name, int &depth)
+            : m_depth(depth), m_timer(timer), m_name(name) {
+        if (m_depth++ == 0) {
+            m_start = Clock::now();
+        }
+    }
+
+    ~NestedScopedTimer();
+
+    NestedScopedTimer(const NestedScopedTimer &) = delete;
+    NestedScopedTimer &operator=(const NestedScopedTimer &) = delete;
+};
+
+} // namespace instrumentation
+
+#define MATH_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define MATH_INSTRUMENTATION_CONCAT(a, b) MATH_INSTRUMENTATION_CONCAT_(a, b)
+#define MATH_INSTRUMENTATION_NAME(prefix) MATH_INSTRUMENTATION_CONCAT(prefix, __LINE__)
+
+#ifdef MATH_INSTRUMENTATION
+
+#define MATH_SCOPED_TIMER(name)                                                              \
+    static ::instrumentation::Timer &MATH_INSTRUMENTATION_NAME(mathTimer_) =                 \
+            ::instrumentation::Registry::instance().timer(name);                             \
+    ::instrumentation::ScopedTimer MATH_INSTRUMENTATION_NAME(mathScope_)(                    \
+            MATH_INSTRUMENTATION_NAME(mathTimer_), name)
+
+#define MATH_NESTED_SCOPED_TIMER(name, depth)                                                \
+    static ::instrumentation::Timer &MATH_INSTRUMENTATION_NAME(mathTimer_) =                 \
+            ::instrumentation::Registry::instance().timer(name);                             \
+    ::instrumentation::NestedScopedTimer MATH_INSTRUMENTATION_NAME(mathScope_)(              \
+            MATH_INSTRUMENTATION_NAME(mathTimer_), name, depth)
+
+#define MATH_COUNTER_ADD(name, n)                                                            \
+    do {                                                                                     \
+        static ::instrumentation::Counter &mathCounter_ =                                    \
+                ::instrumentation::Registry::instance().counter(name);                       \
+        mathCounter_.add(n);                                                                 \
+    } while (0)
+
+#define MATH_HISTOGRAM_RECORD(name, value)                                                   \
+    do {                                                                                     \
+        static ::instrumentation::Histogram &mathHistogram_ =                                \
+                ::instrumentation::Registry::instance().histogram(name);                     \
+        mathHistogram_.record(value);                                                        \
+    } while (0)
+
+#else
+
+#define MATH_SCOPED_TIMER(name) ((void) 0)
+#define MATH_NESTED_SCOPED_TIMER(name, depth) ((void) 0)
+#define MATH_COUNTER_ADD(name, n) ((void) 0)
+#define MATH_HISTOGRAM_RECORD(name, value) ((void) 0)
+
+#endif // MATH_INSTRUMENTATION
+
+#ifdef MATH_ALLOCATION_TRACKING
+
+#define MATH_RECORD_ALLOCATION(kind, bytes) ::instrumentation::recordAllocation(kind, bytes)
+#define MATH_RECORD_DEALLOCATION(kind, bytes) ::instrumentation::recordDeallocation(kind, bytes)
+
+#else
+
+#define MATH_RECORD_ALLOCATION(kind, bytes) ((void) 0)
+#define MATH_RECORD_DEALLOCATION(kind, bytes) ((void) 0)
+
+#endif // MATH_ALLOCATION_TRACKING
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_INSTRUMENTATION_H_
@@ -1,19 +1,72 @@
 #ifndef MINIMIZEROPTIMIZER_HEADERS_LSMTASK_H_
 #define MINIMIZEROPTIMIZER_HEADERS_LSMTASK_H_
 
+#include <memory>
+#include <optional>
+
 #include "TaskF.h"
+#include "Sparsity.h"
+#include "FiniteDifference.h"
+
+// How LSMTask gets its Jacobian
+enum class Differentiation {
+    // Derivative trees of every structural nonzero, built with the task
+    Symbolic,
+    // Colored forward differences, for functions whose derivative() or
+    // clone() are not implemented. gradient() and hessian() stay symbolic.
+    FiniteDifference
+};
 
 class LSMTask : public Task {
     Function *c_function;
     std::vector<Function *> m_functions;
     std::vector<Variable *> m_X;
-    std::vector<Function *> m_grad;
+    // Set when m_X are the entries 0..n-1 of one store in order, the values
+    // are then copied as a block
+    VariableStore *m_store = nullptr;
+    // gradient and hessian trees are built on first use, most least squares
+    // solvers only ever need the jacobian
+    mutable std::vector<Function *> m_grad;
+    // Entries outside the sparsity patterns are structural zeros and have
+    // no tree, nullptr in their place
     std::vector<std::vector<Function *> > m_jac;
-    std::vector<std::vector<Function *> > m_hess;
+    mutable std::vector<std::vector<Function *> > m_hess;
+    SparsityPattern m_jacPattern;
+    // Set in Differentiation::FiniteDifference mode, m_jac is empty then
+    std::unique_ptr<FiniteDifferenceJacobian> m_finiteDifference;
+    mutable std::optional<SparsityPattern> m_hessPattern;
+    // Set in incremental mode, see setIncremental()
+    mutable std::unique_ptr<DependencyTracker> m_tracker;
+
+    void buildGradient() const {
+        for (int j = 0; j < m_X.size(); j++) {
+            m_grad.push_back(c_function->derivative(m_X[j]));
+            if (m_tracker) {
+                m_tracker->track(m_grad.back());
+            }
+        }
+    }
+
+    void buildHessian() const {
+        if (m_grad.empty()) {
+            buildGradient();
+        }
+        const SparsityPattern &pattern = hessianSparsity();
+        for (int j = 0; j < m_X.size(); j++) {
+            m_hess.push_back(std::vector<Function *>(m_X.size(), nullptr));
+            for (size_t k: pattern.row(j)) {
+                m_hess[j][k] = m_grad[j]->derivative(m_X[k]);
+                if (m_tracker) {
+                    m_tracker->track(m_hess[j][k]);
+                }
+            }
+        }
+    }
 
 public:
-    LSMTask(std::vector<Function *> functions, std::vector<Variable *> x) : m_functions(std::move(functions)),
-                                                                            m_X(std::move(x)) {
+    LSMTask(std::vector<Function *> functions, std::vector<Variable *> x,
+            Differentiation differentiation = Differentiation::Symbolic) : m_functions(std::move(functions)),
+                                                                           m_X(std::move(x)) {
         int i = 0;
         for (auto &function: m_functions) {
             Constant *c = new Constant(2);
@@ -25,28 +78,77 @@ public:
             }
             i++;
         }
-        for (int j = 0; j < m_X.size(); j++) {
-            m_grad.push_back(c_function->derivative(m_X[j]));
+        // A residual usually reads a handful of the variables, the trees of
+        // the other derivatives would only ever evaluate to zero
+        m_jacPattern = DependencyAnalysis(m_X).jacobianPattern(m_functions);
+        if (differentiation == Differentiation::FiniteDifference) {
+            m_finiteDifference = std::make_unique<FiniteDifferenceJacobian>(m_functions, m_X, m_jacPattern);
+            return;
         }
-        for (int j = 0; j < m_X.size(); j++) {
-            m_hess.push_back(std::vector<Function *>());
-            for (int k = 0; k < m_X.size(); k++) {
-                m_hess[j].push_back(c_function->derivative(m_X[j])->derivative(m_X[k]));
+        for (int j = 0; j < m_functions.size(); j++) {
+            m_jac.push_back(std::vector<Function *>(m_X.size(), nullptr));
+            for (size_t k: m_jacPattern.row(j)) {
+                m_jac[j][k] = m_functions[j]->derivative(m_X[k]);
             }
         }
-        for (int j = 0; j < m_functions.size(); j++) {
-            m_jac.push_back(std::vector<Function *>());
-            for (int k = 0; k < m_X.size(); k++) {
-                m_jac[j].push_back(m_functions[j]->derivative(m_X[k]));
+        if (!m_X.empty() && m_X[0]->store() && m_X[0]->store()->size() == m_X.size()) {
+            m_store = m_X[0]->store();
+            for (size_t i = 0; i < m_X.size(); i++) {
+                if (m_X[i]->store() != m_store || m_X[i]->index() != i) {
+                    m_store = nullptr;
+                    break;
+                }
+            }
+        }
+    }
+
+    // In incremental mode every tree caches its value and setError() only
+    // recomputes the residual and jacobian entries depending on variables
+    // that changed; a drag moving two points of a large sketch then costs
+    // the constraints on those points. Variable values must change through
+    // setError() or Variable::setValue() while it is on.
+    void setIncremental(bool enabled) {
+        if (!enabled) {
+            m_tracker.reset();
+            return;
+        }
+        if (m_tracker) {
+            return;
+        }
+        m_tracker = std::make_unique<DependencyTracker>();
+        for (auto &x: m_X) {
+            m_tracker->track(x);
+        }
+        m_tracker->track(c_function);
+        for (auto &row: m_jac) {
+            for (auto f: row) {
+                if (f) {
+                    m_tracker->track(f);
+                }
+            }
+        }
+        for (auto f: m_grad) {
+            m_tracker->track(f);
+        }
+        for (auto &row: m_hess) {
+            for (auto f: row) {
+                if (f) {
+                    m_tracker->track(f);
+                }
             }
         }
     }
 
+    bool isIncremental() const { return m_tracker != nullptr; }
+
     inline double getError() const override {
-        return c_function->evaluate();
+        return c_function->value();
     }
 
     inline std::vector<double> getValues() const override {
+        if (m_store) {
+            return m_store->values();
+        }
         std::vector<double> values;
         for (auto &x: m_X) {
             values.push_back(x->evaluate());
@@ -58,54 +160,104 @@ public:
         if (x.size() != m_X.size()) {
             throw std::invalid_argument("not right vector of variables");
         }
-        for (int i = 0; i < x.size(); i++) {
-            m_X[i]->setValue(x[i]);
+        if (m_store && !m_tracker) {
+            m_store->assign(x);
+        } else {
+            for (int i = 0; i < x.size(); i++) {
+                m_X[i]->setValue(x[i]);
+            }
         }
-        return c_function->evaluate();
+        return c_function->value();
     }
 
     Matrix<> gradient() const override {
+        if (m_grad.empty()) {
+            buildGradient();
+        }
         Matrix<> grad(m_X.size(), 1);
         for (int i = 0; i < m_X.size(); i++) {
-            grad(i, 0) = m_grad[i]->evaluate();
+            grad(i, 0) = m_grad[i]->value();
         }
         return grad;
     }
 
     Matrix<> hessian() const override {
+        if (m_hess.empty()) {
+            buildHessian();
+        }
         Matrix<> hessian(m_X.size(), m_X.size());
         for (int i = 0; i < m_X.size(); i++) {
-            for (int j = 0; j < m_X.size(); j++) {
-                hessian(i, j) = m_hess[i][j]->evaluate();
+            for (size_t j: m_hessPattern->row(i)) {
+                hessian(i, j) = m_hess[i][j]->value();
             }
         }
         return hessian;
     }
 
     Matrix<> jacobian() const {
+        if (m_finiteDifference) {
+            Matrix<> residuals, jac;
+            linearizeInto(residuals, jac);
+            return jac;
+        }
         Matrix<> jac(m_functions.size(), m_X.size());
         for (int i = 0; i < m_functions.size(); i++) {
-            for (int j = 0; j < m_X.size(); j++) {
-                jac(i, j) = m_jac[i][j]->evaluate();
+            for (size_t j: m_jacPattern.row(i)) {
+                jac(i, j) = m_jac[i][j]->value();
             }
         }
         return jac;
     }
 
     std::pair<Matrix<>, Matrix<> > linearizeFunction() const {
-        Matrix<> residuals(m_functions.size(), 1);
-        Matrix<> jac(m_functions.size(), m_X.size());
+        Matrix<> residuals;
+        Matrix<> jac;
+        linearizeInto(residuals, jac);
+        return {std::move(residuals), std::move(jac)};
+    }
+
+    // Same as linearizeFunction, but writes into buffers that are reused
+    // when they already have the right shape
+    void linearizeInto(Matrix<> &residuals, Matrix<> &jac) const {
+        MATH_SCOPED_TIMER("LSMTask::linearizeFunction");
+        MATH_COUNTER_ADD("LSMTask::linearizeFunction.jacobianEntries",
+                         static_cast<int64_t>(m_jacPattern.nonZeros()));
+        if (m_finiteDifference) {
+            // Tracked caches must see every perturbation, stay serial then
+            m_finiteDifference->evaluate(residuals, jac, !m_tracker);
+            return;
+        }
+        residuals.resize(m_functions.size(), 1);
+        jac.resize(m_functions.size(), m_X.size());
+        jac.setZeroes();
 
         for (int i = 0; i < m_functions.size(); ++i) {
-            residuals(i, 0) = m_functions[i]->evaluate();
-            for (int j = 0; j < m_X.size(); ++j) {
-                jac(i, j) = m_jac[i][j]->evaluate();
+            residuals(i, 0) = m_functions[i]->value();
+            for (size_t j: m_jacPattern.row(i)) {
+                jac(i, j) = m_jac[i][j]->value();
             }
         }
-        return {residuals, jac};
+    }
+
+    size_t residualCount() const { return m_functions.size(); }
+
+    // Which variables each residual depends on, found when the task is built
+    const SparsityPattern &jacobianSparsity() const { return m_jacPattern; }
+
+    Differentiation differentiation() const {
+        return m_finiteDifference ? Differentiation::FiniteDifference : Differentiation::Symbolic;
+    }
+
+    // Structural nonzeros of hessian(), computed on first use
+    const SparsityPattern &hessianSparsity() const {
+        if (!m_hessPattern) {
+            m_hessPattern = m_jacPattern.hessianOfSquares();
+        }
+        return *m_hessPattern;
     }
 
     ~LSMTask() {
+        m_tracker.reset();
         delete c_function;
         for (auto func: m_functions) {
             delete func;
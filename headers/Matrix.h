@@ -9,6 +9,11 @@
 #include <type_traits>
 #include <vector>
 #include <concepts>
+#include <algorithm>
+
+#include "Instrumentation.h"
+#include "ThreadPool.h"
+#include "MatrixAllocator.h"
 
 // Main concept
 template <typename T>
@@ -29,12 +34,117 @@ concept VectorType = IsVector<T> && (!IsVector<typename T::value_type>);
 template <typename T>
 concept VectorVectorType = IsVector<T> && IsVector<typename T::value_type>;
 
+// Storage order of a Matrix, chosen at compile time. RowMajor keeps every
+// row contiguous, ColMajor every column; column oriented algorithms (QR,
+// Gram-Schmidt) read whole columns of a ColMajor matrix without strides.
+struct RowMajor {};
+struct ColMajor {};
+
+template <typename L>
+concept MatrixLayout = std::same_as<L, RowMajor> || std::same_as<L, ColMajor>;
+
+// Products and elementwise operations above a size threshold are split
+// into tiles of the result and run on ThreadPool::shared(). Below it, and
+// inside a parallel region, they run serially on the calling thread.
+namespace matrix_parallel {
+
+// Flops of a product before it is split
+constexpr double kMinFlops = 1 << 18;
+// Elements of an elementwise operation before it is split
+constexpr size_t kMinElements = 1 << 16;
+constexpr size_t kTileRows = 64;
+constexpr size_t kTileCols = 256;
+
+inline bool serial(double work, double threshold) {
+    return work < threshold || ThreadPool::inParallelRegion() || ThreadPool::shared().threadCount() == 1;
+}
+
+// body(rowBegin, rowEnd, colBegin, colEnd) over a 2D tiling of a rows x cols
+// result, tiles are written by one thread each
+template <typename Body>
+void forTiles(size_t rows, size_t cols, double flops, Body&& body,
+              size_t tileRows = kTileRows, size_t tileCols = kTileCols) {
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+    if (serial(flops, kMinFlops)) {
+        body(size_t(0), rows, size_t(0), cols);
+        return;
+    }
+    size_t rowTiles = (rows + tileRows - 1) / tileRows;
+    size_t colTiles = (cols + tileCols - 1) / tileCols;
+    ThreadPool::shared().parallelFor(rowTiles * colTiles, [&](size_t tile) {
+        size_t r = tile / colTiles;
+        size_t c = tile % colTiles;
+        body(r * tileRows, std::min(rows, (r + 1) * tileRows), c * tileCols, std::min(cols, (c + 1) * tileCols));
+    });
+}
+
+// body(rowBegin, rowEnd) over blocks of whole rows, for elementwise work
+template <typename Body>
+void forRows(size_t rows, size_t cols, Body&& body) {
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+    if (serial(static_cast<double>(rows * cols), static_cast<double>(kMinElements))) {
+        body(size_t(0), rows);
+        return;
+    }
+    size_t block = std::max<size_t>(1, kMinElements / 4 / cols);
+    size_t blocks = (rows + block - 1) / block;
+    ThreadPool::shared().parallelFor(blocks, [&](size_t b) {
+        body(b * block, std::min(rows, (b + 1) * block));
+    });
+}
+
+} // namespace matrix_parallel
+
+namespace matrix_kernels {
+
+// Dot product of two contiguous runs with four partial sums, so the
+// compiler can keep them in packed registers
+template <typename T>
+inline T dot(const T* a, const T* b, size_t n) {
+    T acc[4] = {};
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        for (size_t l = 0; l < 4; ++l) {
+            acc[l] += a[k + l] * b[k + l];
+        }
+    }
+    T sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    for (; k < n; ++k) {
+        sum += a[k] * b[k];
+    }
+    return sum;
+}
+
+} // namespace matrix_kernels
+
+// Integer matrices are factorized in double
+template <typename T>
+using FactorizationType = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+template <std::floating_point T>
+class LU;
+template <std::floating_point T>
+class Cholesky;
+template <std::floating_point T>
+class LDLT;
+template <std::floating_point T>
+class SVD;
+template <std::floating_point T>
+class SymmetricEigen;
+
 // The matrix class
-template <Arithmetic T = double>
+template <Arithmetic T = double, MatrixLayout Layout = RowMajor, MatrixAllocator Alloc = PooledAllocator>
 class Matrix {
 public:
     using size_type = size_t;
     using iterator_type = size_t;
+    using layout_type = Layout;
+
+    static constexpr bool isRowMajor = std::same_as<Layout, RowMajor>;
 
 public:
     Matrix() = default;
@@ -55,55 +165,78 @@ public:
     Matrix(const std::initializer_list<std::initializer_list<T>>& values);
     Matrix(const std::initializer_list<T> &values);
 
+    // Same values in another storage order or from another allocator
+    template <MatrixLayout Other, MatrixAllocator OtherAlloc>
+        requires (!std::same_as<Matrix<T, Other, OtherAlloc>, Matrix>)
+    explicit Matrix(const Matrix<T, Other, OtherAlloc>& other);
+
 
     // operators
 
-    Matrix<T>& operator=(const Matrix<T>& other);
-    Matrix<T>& operator=(Matrix<T>&& other) noexcept;
-    Matrix<T>& operator=(const std::initializer_list<std::initializer_list<T>>& values);
+    Matrix& operator=(const Matrix& other);
+    Matrix& operator=(Matrix&& other) noexcept;
+    Matrix& operator=(const std::initializer_list<std::initializer_list<T>>& values);
+
+    // Converts from another layout or allocator, reusing the buffer when the
+    // shape is unchanged
+    template <MatrixLayout Other, MatrixAllocator OtherAlloc>
+        requires (!std::same_as<Matrix<T, Other, OtherAlloc>, Matrix>)
+    Matrix& operator=(const Matrix<T, Other, OtherAlloc>& other);
 
     // Matrix and Matrix operators
 
-    //operator+(const Matrix<T>& A, const Matrix<T>& B)
-    //operator-(const Matrix<T>& A, const Matrix<T>& B)
-    //operator*(const Matrix<T>& A, const Matrix<T>& B)
+    //operator+(const Matrix& A, const Matrix& B)
+    //operator-(const Matrix& A, const Matrix& B)
+    //operator*(const Matrix& A, const Matrix& B)
 
-    //Matrix<V>& operator+=(Matrix<T>& A, const Matrix<T>& B)
-    //Matrix<V>& operator-=(Matrix<T>& A, const Matrix<T>& B)
-    //Matrix<V>& operator*=(Matrix<T>& A, const Matrix<T>& B)
+    //Matrix<V>& operator+=(Matrix& A, const Matrix& B)
+    //Matrix<V>& operator-=(Matrix& A, const Matrix& B)
+    //Matrix<V>& operator*=(Matrix& A, const Matrix& B)
 
-    //bool operator==(const Matrix<T>& A, const Matrix<T>& B)
-    //bool operator!=(const Matrix<T>& A, const Matrix<T>& B)
+    //bool operator==(const Matrix& A, const Matrix& B)
+    //bool operator!=(const Matrix& A, const Matrix& B)
 
     // Matrix and scalar operators
 
-    //Matrix<T> operator+(const Matrix<T>& A, const V& scalar)
-    //Matrix<T> operator-(const Matrix<T>& A, const V& scalar)
-    //Matrix<T> operator*(const Matrix<T>& A, const V& scalar)
-    //Matrix<T> operator/(const Matrix<t>& A, const V& scalar)
+    //Matrix operator+(const Matrix& A, const V& scalar)
+    //Matrix operator-(const Matrix& A, const V& scalar)
+    //Matrix operator*(const Matrix& A, const V& scalar)
+    //Matrix operator/(const Matrix<t>& A, const V& scalar)
 
-    //Matrix<T>& operator+=(Matrix<T>& A, const V& scalar)
-    //Matrix<T>& operator-=(Matrix<T>& A, const V& scalar)
-    //Matrix<T>& operator*=(Matrix<T>& A, const V& scalar)
-    //Matrix<T>& operator/=(Matrix<T>& A, const V& scalar)
+    //Matrix& operator+=(Matrix& A, const V& scalar)
+    //Matrix& operator-=(Matrix& A, const V& scalar)
+    //Matrix& operator*=(Matrix& A, const V& scalar)
+    //Matrix& operator/=(Matrix& A, const V& scalar)
 
     // Matrix and List operators
 
-    //Matrix<T> operator+(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
-    //Matrix<T> operator-(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
-    //Matrix<T> operator*(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
+    //Matrix operator+(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
+    //Matrix operator-(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
+    //Matrix operator*(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
 
-    //Matrix<T>& operator+=(Matrix<T>& A, const std::initializer_list<std::initializer_list<T>> L)
-    //Matrix<T>& operator-=(Matrix<T>& A, const std::initializer_list<std::initializer_list<T>> L)
-    //Matrix<T>& operator*=(Matrix<T>& A, const std::initializer_list<std::initializer_list<T>> L)
+    //Matrix& operator+=(Matrix& A, const std::initializer_list<std::initializer_list<T>> L)
+    //Matrix& operator-=(Matrix& A, const std::initializer_list<std::initializer_list<T>> L)
+    //Matrix& operator*=(Matrix& A, const std::initializer_list<std::initializer_list<T>> L)
 
-    //bool operator==(const Matrix<T>& A, const std::initializer_list<std::initializer_list<T>> L)
-    //bool operator!=(const Matrix<T>& A, const std::initializer_list<std::initializer_list<T>> L)
+    //bool operator==(const Matrix& A, const std::initializer_list<std::initializer_list<T>> L)
+    //bool operator!=(const Matrix& A, const std::initializer_list<std::initializer_list<T>> L)
 
     // Element Access
     T& operator()(iterator_type rowIndex, iterator_type colIndex);
     T operator()(iterator_type rowIndex, iterator_type colIndex) const;
 
+    // Row i as cols_size() contiguous values, not bounds checked
+    T* rowData(iterator_type rowIndex) requires isRowMajor { return matrix[rowIndex]; }
+    const T* rowData(iterator_type rowIndex) const requires isRowMajor { return matrix[rowIndex]; }
+
+    // Column j as rows_size() contiguous values, not bounds checked
+    T* colData(iterator_type colIndex) requires (!isRowMajor) { return matrix[colIndex]; }
+    const T* colData(iterator_type colIndex) const requires (!isRowMajor) { return matrix[colIndex]; }
+
+    // All rows_size() * cols_size() values in storage order, nullptr when empty
+    T* data() { return matrix == nullptr ? nullptr : matrix[0]; }
+    const T* data() const { return matrix == nullptr ? nullptr : matrix[0]; }
+
 
     // Matrix function
 
@@ -116,32 +249,43 @@ public:
     void setCol(const std::vector<T>& colV, const iterator_type& colI) const;
     void setRow(const std::vector<T>& rowV, const iterator_type& rowI) const;
 
-    void setCol(const Matrix<T>& A, const iterator_type& colI) const;
-    void setRow(const Matrix<T>& A, const iterator_type& rowI) const;
+    void setCol(const Matrix& A, const iterator_type& colI) const;
+    void setRow(const Matrix& A, const iterator_type& rowI) const;
 
     Matrix getSubmatrix(const size_type& start, const size_type& end, const size_type& num_rows, const size_type& num_cols) const;
-    void setSubmatrix(const size_type& start_row, const size_type& start_col, const Matrix<T>& block);
+    void setSubmatrix(const size_type& start_row, const size_type& start_col, const Matrix& block);
 
     Matrix transpose() const;
     void setTranspose();
 
     T determinant() const;
-    static T determinant(const Matrix<T>& mat);
+    static T determinant(const Matrix& mat);
 
     Matrix inverse() const;
     void setInverse();
 
     Matrix adjoint(const size_type& i, const size_type& j) const;
-    static Matrix adjoint(const size_type& i, const size_type& j, const Matrix<T>& mat);
+    static Matrix adjoint(const size_type& i, const size_type& j, const Matrix& mat);
 
     T minor(const size_type& i, const size_type& j) const;
-    static T minor(const size_type& i, const size_type& j, const Matrix<T>& mat);
+    static T minor(const size_type& i, const size_type& j, const Matrix& mat);
+
+    // adj(A)(j, i) = (-1)^(i + j) minor(i, j), all of it from one LU as
+    // det(A) A^{-1}. A singular A goes through its SVD A = U S V^T instead:
+    // adj(A) = det(U) det(V) V adj(S) U^T, where adj(S) is diagonal with the
+    // products of all singular values but one. O(n^3) either way.
+    Matrix adjugate() const;
+    static Matrix adjugate(const Matrix& mat);
+
+    // M(i, j) = minor(i, j), read off adjugate()
+    Matrix minors() const;
+    static Matrix minors(const Matrix& mat);
 
     T trace() const;
     static T trace(const Matrix& mat);
 
     std::vector<T> diag() const;
-    static std::vector<T> diag(const Matrix<T>& mat);
+    static std::vector<T> diag(const Matrix& mat);
 
     static Matrix ones(const size_type& size);
     static Matrix ones(const size_type& rows, const size_type& cols);
@@ -160,148 +304,264 @@ public:
     void setRandom(const T& leftNum = 0.0, const T& rightNum = 1.0);
     T norm() const;
 
-    static T norm(const Matrix<T>& mat);
+    static T norm(const Matrix& mat);
+
+    // In-place operations, they allocate only when a result changes shape
+
+    // Keeps the values when the shape is unchanged, zero fills otherwise
+    void resize(const size_type& rows, const size_type& cols);
+
+    // A += value * I
+    Matrix& addDiagonal(const T& value);
+
+    // C = A * B, loop order follows the layout
+    static void multiplyInto(const Matrix& A, const Matrix& B, Matrix& C);
+
+    // C = A * B with B in the other layout. RowMajor * ColMajor is a grid of
+    // dot products of contiguous rows and columns.
+    template <MatrixLayout Other>
+        requires (!std::same_as<Other, Layout>)
+    static void multiplyInto(const Matrix& A, const Matrix<T, Other, Alloc>& B, Matrix& C);
+
+    // y = alpha * A * x + beta * y for column vectors x and y
+    static void gemv(const Matrix& A, const Matrix& x, Matrix& y, const T& alpha = T(1), const T& beta = T(0));
+
+    // At = A^T
+    static void transposeInto(const Matrix& A, Matrix& At);
+
+    // Transposed products that read A in place instead of materializing A^T.
+    // All of them stream rows of A, so the normal equations of a tall
+    // Jacobian cost one pass over it.
+
+    // C = A^T * B
+    static void gemm_tn(const Matrix& A, const Matrix& B, Matrix& C);
+
+    // C = A^T * A, only the upper triangle is computed and then mirrored
+    static void syrk(const Matrix& A, Matrix& C);
+
+    // y = alpha * A^T * x + beta * y for column vectors x and y
+    static void gemv_t(const Matrix& A, const Matrix& x, Matrix& y, const T& alpha = T(1), const T& beta = T(0));
+
     inline size_type rows_size() const { return rows; }
     inline size_type cols_size() const { return cols; }
 
 private:
     size_type rows = size_type(0);
     size_type cols = size_type(0);
+    // matrix[k] points at row k (RowMajor) or column k (ColMajor)
     T** matrix = nullptr;
+
+    // Every buffer goes through these, so allocation tracking sees them
+    static T** allocate(size_type rows, size_type cols);
+    static void release(T** data, size_type rows, size_type cols);
+    // Bytes of the line pointers, rounded up to the alignment of T
+    static constexpr size_type valuesOffset(size_type lines) {
+        return (lines * sizeof(T*) + alignof(T) - 1) / alignof(T) * alignof(T);
+    }
+
+    // Element (i, j) without bounds checks. Like matrix[i][j] it is writable
+    // from const members, setCol() and setRow() rely on that.
+    T& at(iterator_type i, iterator_type j) const {
+        if constexpr (isRowMajor) {
+            return matrix[i][j];
+        } else {
+            return matrix[j][i];
+        }
+    }
+
+    template <Arithmetic U, MatrixLayout Other, MatrixAllocator OtherAlloc>
+    friend class Matrix;
+
+    template <std::floating_point U>
+    friend class LU;
+    template <std::floating_point U>
+    friend class Cholesky;
+    template <std::floating_point U>
+    friend class LDLT;
+    template <std::floating_point U>
+    friend class SVD;
+    template <std::floating_point U>
+    friend class SymmetricEigen;
 };
 
-template <Arithmetic T>
-inline Matrix<T>::Matrix(const size_type& rows, const size_type& cols) : rows(rows), cols(cols)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T** Matrix<T, Layout, Alloc>::allocate(size_type rows, size_type cols)
+{
+    // One block from Alloc: the line pointers, then the elements in storage
+    // order; data[k] points at row or column k
+    size_type lines = isRowMajor ? rows : cols;
+    size_type length = isRowMajor ? cols : rows;
+    if (lines == 0) {
+        return nullptr;
+    }
+    size_type offset = valuesOffset(lines);
+    char* block = static_cast<char*>(Alloc::allocate(offset + lines * length * sizeof(T)));
+    T** data = reinterpret_cast<T**>(block);
+    T* values = reinterpret_cast<T*>(block + offset);
+    for (iterator_type k = 0; k < lines; k++) {
+        data[k] = values + k * length;
+    }
+    MATH_RECORD_ALLOCATION(instrumentation::AllocationKind::Matrix, lines * sizeof(T*) + rows * cols * sizeof(T));
+    return data;
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::release(T** data, size_type rows, size_type cols)
+{
+    if (data == nullptr) {
+        return;
+    }
+    size_type lines = isRowMajor ? rows : cols;
+    Alloc::deallocate(data, valuesOffset(lines) + rows * cols * sizeof(T));
+    MATH_RECORD_DEALLOCATION(instrumentation::AllocationKind::Matrix, lines * sizeof(T*) + rows * cols * sizeof(T));
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>::Matrix(const size_type& rows, const size_type& cols) : rows(rows), cols(cols)
 {
-    matrix = new T *[rows];
+    matrix = allocate(rows, cols);
     for (iterator_type i = 0; i < rows; i++) {
-        matrix[i] = new T[cols];
         for (iterator_type j = 0; j < cols; j++) {
-            matrix[i][j] = T();
+            at(i, j) = T();
         }
     }
 }
 
-template<Arithmetic T>
-inline Matrix<T>::Matrix(const size_type& rows, const size_type& cols, const T& value) : rows(rows), cols(cols)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>::Matrix(const size_type& rows, const size_type& cols, const T& value) : rows(rows), cols(cols)
 {
-    matrix = new T * [rows];
+    matrix = allocate(rows, cols);
     for (iterator_type i = 0; i < rows; i++) {
-        matrix[i] = new T[cols];
         for (iterator_type j = 0; j < cols; j++) {
-            matrix[i][j] = value;
+            at(i, j) = value;
         }
     }
 }
-template<Arithmetic T>
-inline T Matrix<T>::norm() const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T Matrix<T, Layout, Alloc>::norm() const
 {
     T sum = 0;
     for (size_type i = 0; i < rows; i++) {
         for (size_type j = 0; j < cols; j++) {
-            sum += matrix[i][j] * matrix[i][j];
+            sum += at(i, j) * at(i, j);
         }
     }
     return std::sqrt(sum);
 }
 
-template <Arithmetic T>
-T Matrix<T>::norm(const Matrix<T>& mat) {
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+T Matrix<T, Layout, Alloc>::norm(const Matrix<T, Layout, Alloc>& mat) {
     return mat.norm();
 }
 
-template<Arithmetic T>
-inline Matrix<T>::Matrix(const size_type& size) : rows(size), cols(size)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>::Matrix(const size_type& size) : rows(size), cols(size)
 {
-    matrix = new T * [size];
-    for (typename Matrix<T>::iterator_type i = 0; i < size; i++) {
-        matrix[i] = new T[cols];
-        for (typename Matrix<T>::iterator_type j = 0; j < size; j++) {
-            matrix[i][j] = T();
+    matrix = allocate(size, size);
+    for (typename Matrix<T, Layout, Alloc>::iterator_type i = 0; i < size; i++) {
+        for (typename Matrix<T, Layout, Alloc>::iterator_type j = 0; j < size; j++) {
+            at(i, j) = T();
         }
     }
 }
 
-template<Arithmetic T>
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
 template<VectorType V>
-inline Matrix<T>::Matrix(const V& vec) : rows(1), cols(vec.size())
+inline Matrix<T, Layout, Alloc>::Matrix(const V& vec) : rows(1), cols(vec.size())
 {
-    matrix = new T * [rows];
-    matrix[0] = new T[cols];
-    for (typename Matrix<T>::iterator_type i = 0; i < cols; i++) {
-        matrix[0][i] = vec[i];
+    matrix = allocate(rows, cols);
+    for (typename Matrix<T, Layout, Alloc>::iterator_type i = 0; i < cols; i++) {
+        at(0, i) = vec[i];
     }
 }
 
-template<Arithmetic T>
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
 template<VectorVectorType V>
-inline Matrix<T>::Matrix(const V& vec) : rows(vec.size()), cols(vec[0].size())
+inline Matrix<T, Layout, Alloc>::Matrix(const V& vec) : rows(vec.size()), cols(vec[0].size())
 {
-    matrix = new T * [rows];
+    matrix = allocate(rows, cols);
     for (iterator_type i = 0; i < rows; i++) {
-        matrix[i] = new T[cols];
         for (iterator_type j = 0; j < cols; j++) {
-            matrix[i][j] = vec[i][j];
+            at(i, j) = vec[i][j];
         }
     }
 }
 
-template <Arithmetic T>
-inline Matrix<T>::Matrix(const Matrix<T>& other) : rows(other.rows), cols(other.cols) {
-    // check matrix and free memory if needed
-    if (matrix != NULL){
-        for (iterator_type i = 0; i < rows; i++)
-        {
-            delete[] matrix[i];
-        }
-        if (rows != 0) delete[] matrix;
-    }
-    // is rows == 0 or cols == 0 we dont need create matrix
-    if (rows != 0 && cols != 0) matrix = new T * [rows];
-
-    for (typename Matrix<T>::iterator_type i = 0; i < rows; i++) {
-        matrix[i] = new T[cols];
-        for (typename Matrix<T>::iterator_type j = 0; j < cols; j++) {
-            matrix[i][j] = other.matrix[i][j];
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>::Matrix(const Matrix<T, Layout, Alloc>& other) : rows(other.rows), cols(other.cols) {
+    matrix = allocate(rows, cols);
+    for (typename Matrix<T, Layout, Alloc>::iterator_type i = 0; i < rows; i++) {
+        for (typename Matrix<T, Layout, Alloc>::iterator_type j = 0; j < cols; j++) {
+            at(i, j) = other.at(i, j);
         }
     }
 
 }
 
-template <Arithmetic T>
-inline Matrix<T>::Matrix(Matrix<T>&& other) noexcept : rows(other.rows), cols(other.cols), matrix(other.matrix) {
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>::Matrix(Matrix<T, Layout, Alloc>&& other) noexcept : rows(other.rows), cols(other.cols), matrix(other.matrix) {
     other.rows = 0;
     other.cols = 0;
     other.matrix = nullptr;
 }
 
-template<Arithmetic T>
-inline Matrix<T>::Matrix(const std::initializer_list<std::initializer_list<T>>& values)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+template <MatrixLayout Other, MatrixAllocator OtherAlloc>
+    requires (!std::same_as<Matrix<T, Other, OtherAlloc>, Matrix<T, Layout, Alloc>>)
+inline Matrix<T, Layout, Alloc>::Matrix(const Matrix<T, Other, OtherAlloc>& other)
+{
+    *this = other;
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+template <MatrixLayout Other, MatrixAllocator OtherAlloc>
+    requires (!std::same_as<Matrix<T, Other, OtherAlloc>, Matrix<T, Layout, Alloc>>)
+inline Matrix<T, Layout, Alloc>& Matrix<T, Layout, Alloc>::operator=(const Matrix<T, Other, OtherAlloc>& other)
+{
+    resize(other.rows, other.cols);
+    if (rows == 0 || cols == 0) {
+        return *this;
+    }
+    if constexpr (std::same_as<Other, Layout>) {
+        std::copy(other.matrix[0], other.matrix[0] + rows * cols, matrix[0]);
+        return *this;
+    }
+    // The buffer of other read in order is this matrix transposed
+    size_type lines = isRowMajor ? rows : cols;
+    size_type length = isRowMajor ? cols : rows;
+    for (size_type k = 0; k < length; ++k) {
+        const T* src = other.matrix[k];
+        for (size_type l = 0; l < lines; ++l) {
+            matrix[l][k] = src[l];
+        }
+    }
+    return *this;
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>::Matrix(const std::initializer_list<std::initializer_list<T>>& values)
 {
     rows = values.size();
     cols = values.begin()->size();
-    if (rows != 0) matrix = new T*[rows];
-    iterator_type i = 0;
     for (const auto& row_values : values) {
         if (row_values.size() != cols) {
-            for (typename Matrix<T>::iterator_type j = 0; j < i; j++) {
-                delete[] matrix[j];
-            }
-            if (rows != 0) delete[] matrix;
             throw std::invalid_argument("All rows must have the same number of columns.");
         }
-        matrix[i] = new T[cols];
+    }
+    matrix = allocate(rows, cols);
+    iterator_type i = 0;
+    for (const auto& row_values : values) {
         iterator_type j = 0;
         for (const auto& val : row_values) {
-            matrix[i][j] = val;
+            at(i, j) = val;
             ++j;
         }
         ++i;
     }
 }
 
-template<Arithmetic T>
-inline Matrix<T>::Matrix(const std::initializer_list<T>& values)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>::Matrix(const std::initializer_list<T>& values)
 {
     rows = 1;
     cols = values.size();
@@ -310,65 +570,63 @@ inline Matrix<T>::Matrix(const std::initializer_list<T>& values)
         matrix = nullptr;
         return;
     }
-    matrix = new T * [rows];
-    matrix[0] = new T[cols];
+    matrix = allocate(rows, cols);
     iterator_type i = 0;
     for (const auto& val : values) {
-        matrix[0][i++] = val;
+        at(0, i++) = val;
     }
 }
 
-template <Arithmetic T>
-inline Matrix<T>::~Matrix() {
-    for (iterator_type i = 0; i < rows; i++)
-    {
-        delete[] matrix[i];
-    }
-    if (rows != 0) delete[] matrix;
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>::~Matrix() {
+    release(matrix, rows, cols);
 }
 
-template<Arithmetic T>
-inline Matrix<T>& Matrix<T>::operator=(const Matrix<T>& other)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>& Matrix<T, Layout, Alloc>::operator=(const Matrix<T, Layout, Alloc>& other)
 {
     if (this == &other) return *this;
-    Matrix<T> temp(other);
+    if (rows == other.rows && cols == other.cols && matrix != nullptr) {
+        // Same shape: reuse the buffer
+        std::copy(other.matrix[0], other.matrix[0] + rows * cols, matrix[0]);
+        return *this;
+    }
+    Matrix<T, Layout, Alloc> temp(other);
     std::swap(rows, temp.rows);
     std::swap(cols, temp.cols);
     std::swap(matrix, temp.matrix);
     return *this;
 }
 
-template<Arithmetic T>
-inline Matrix<T>& Matrix<T>::operator=(Matrix<T>&& other) noexcept
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>& Matrix<T, Layout, Alloc>::operator=(Matrix<T, Layout, Alloc>&& other) noexcept
 {
     if (this == &other) return *this;
-    Matrix<T> temp(std::move(other));
+    Matrix<T, Layout, Alloc> temp(std::move(other));
     std::swap(rows, temp.rows);
     std::swap(cols, temp.cols);
     std::swap(matrix, temp.matrix);
     return *this;
 }
 
-template<Arithmetic T>
-inline Matrix<T>& Matrix<T>::operator=(const std::initializer_list<std::initializer_list<T>>& values)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>& Matrix<T, Layout, Alloc>::operator=(const std::initializer_list<std::initializer_list<T>>& values)
 {
-    for (typename Matrix<T>::iterator_type i = 0; i < rows; ++i) {
-        delete[] matrix[i];
+    for (auto& row_list : values) {
+        if (row_list.size() != values.begin()->size()) {
+            throw std::invalid_argument("All rows must have the same number of columns.");
+        }
     }
-    delete[] matrix;
+    release(matrix, rows, cols);
     rows = values.size();
     cols = values.begin()->size();
-    matrix = new T * [rows];
+    matrix = allocate(rows, cols);
 
-    typename Matrix<T>::iterator_type i = 0;
+    typename Matrix<T, Layout, Alloc>::iterator_type i = 0;
     for (auto& row_list : values) {
-        if (row_list.size() != cols) {
-            throw std::invalid_argument("All rows must have the same number of columns.");
-        }
-        matrix[i] = new T[cols];
-        typename Matrix<T>::iterator_type j = 0;
+        typename Matrix<T, Layout, Alloc>::iterator_type j = 0;
         for (auto& value : row_list) {
-            matrix[i][j++] = value;
+            at(i, j++) = value;
         }
         i++;
     }
@@ -378,207 +636,317 @@ inline Matrix<T>& Matrix<T>::operator=(const std::initializer_list<std::initiali
 
 //////////////////////////////////////////////////////////////////////////////////////// out operators start
 
-template <Arithmetic V>
-inline constexpr Matrix<V> operator+(const Matrix<V>& A, const Matrix<V>& B) {
+// Binary operators taking an expiring operand (a temporary, or std::move)
+// work in place on its buffer and move it into the result, so chains like
+// A * x - b + c allocate once. The const& overloads copy their left operand.
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator+(const Matrix<V, Layout, Alloc>& A, const Matrix<V, Layout, Alloc>& B) {
     if (A.rows_size() != B.rows_size() || A.cols_size() != B.cols_size()) {
         throw std::invalid_argument("Matrices must have the same size for addition.");
     }
-    Matrix<V> result(A);
+    Matrix<V, Layout, Alloc> result(A);
     result += B;
     return result;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V> operator-(const Matrix<V>& A, const Matrix<V>& B)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator+(Matrix<V, Layout, Alloc>&& A, const Matrix<V, Layout, Alloc>& B) {
+    A += B;
+    return std::move(A);
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator+(const Matrix<V, Layout, Alloc>& A, Matrix<V, Layout, Alloc>&& B) {
+    B += A;
+    return std::move(B);
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator+(Matrix<V, Layout, Alloc>&& A, Matrix<V, Layout, Alloc>&& B) {
+    A += B;
+    return std::move(A);
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator-(const Matrix<V, Layout, Alloc>& A, const Matrix<V, Layout, Alloc>& B)
 {
     if (A.rows_size() != B.rows_size() || A.cols_size() != B.cols_size()) {
         throw std::invalid_argument("Matrices must have the same size for subtract.");
     }
-    Matrix<V> result(A);
+    Matrix<V, Layout, Alloc> result(A);
     result -= B;
     return result;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V> operator*(const Matrix<V>& A, const Matrix<V>& B)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator-(Matrix<V, Layout, Alloc>&& A, const Matrix<V, Layout, Alloc>& B)
 {
-    Matrix<V> result(A);
-    result *= B;
-    return result;
+    A -= B;
+    return std::move(A);
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V> operator+(const Matrix<V>& A, const V& scalar)
+// B = A - B in the buffer of B
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator-(const Matrix<V, Layout, Alloc>& A, Matrix<V, Layout, Alloc>&& B)
 {
-    Matrix<V> res(A);
-    for (typename Matrix<V>::iterator_type i = 0; i < A.rows_size(); i++) {
-        for (typename Matrix<V>::iterator_type j = 0; j < A.cols_size(); j++) {
-            res(i, j) += scalar;
-        }
+    if (A.rows_size() != B.rows_size() || A.cols_size() != B.cols_size()) {
+        throw std::invalid_argument("Matrices must have the same size for subtract.");
     }
+    const V* a = A.data();
+    V* b = B.data();
+    size_t n = A.cols_size();
+    matrix_parallel::forRows(A.rows_size(), n, [&](size_t r0, size_t r1) {
+        for (size_t k = r0 * n; k < r1 * n; k++) {
+            b[k] = a[k] - b[k];
+        }
+    });
+    return std::move(B);
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator-(Matrix<V, Layout, Alloc>&& A, Matrix<V, Layout, Alloc>&& B)
+{
+    A -= B;
+    return std::move(A);
+}
+
+// The product cannot overwrite an operand, it goes straight into the result
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator*(const Matrix<V, Layout, Alloc>& A, const Matrix<V, Layout, Alloc>& B)
+{
+    Matrix<V, Layout, Alloc> result;
+    Matrix<V, Layout, Alloc>::multiplyInto(A, B, result);
+    return result;
+}
+
+// The result takes the layout of A
+template<Arithmetic V, MatrixLayout Layout, MatrixLayout Other, MatrixAllocator Alloc>
+    requires (!std::same_as<Layout, Other>)
+inline Matrix<V, Layout, Alloc> operator*(const Matrix<V, Layout, Alloc>& A, const Matrix<V, Other, Alloc>& B)
+{
+    Matrix<V, Layout, Alloc> result;
+    Matrix<V, Layout, Alloc>::multiplyInto(A, B, result);
+    return result;
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator+(const Matrix<V, Layout, Alloc>& A, const V& scalar)
+{
+    Matrix<V, Layout, Alloc> res(A);
+    res += scalar;
     return res;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V> operator-(const Matrix<V>& A, const V& scalar)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator+(Matrix<V, Layout, Alloc>&& A, const V& scalar)
 {
-    Matrix<V> res(A);
-    for (typename Matrix<V>::iterator_type i = 0; i < A.rows_size(); i++) {
-        for (typename Matrix<V>::iterator_type j = 0; j < A.cols_size(); j++) {
-            res(i, j) -= scalar;
-        }
-    }
+    A += scalar;
+    return std::move(A);
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator-(const Matrix<V, Layout, Alloc>& A, const V& scalar)
+{
+    Matrix<V, Layout, Alloc> res(A);
+    res -= scalar;
     return res;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V> operator*(const Matrix<V>& A, const V& scalar)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator-(Matrix<V, Layout, Alloc>&& A, const V& scalar)
 {
-    Matrix<V> res(A);
-    for (typename Matrix<V>::iterator_type i = 0; i < A.rows_size(); i++) {
-        for (typename Matrix<V>::iterator_type j = 0; j < A.cols_size(); j++) {
-            res(i, j) *= scalar;
-        }
-    }
+    A -= scalar;
+    return std::move(A);
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator*(const Matrix<V, Layout, Alloc>& A, const V& scalar)
+{
+    Matrix<V, Layout, Alloc> res(A);
+    res *= scalar;
     return res;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V> operator/(const Matrix<V>& A, const V& scalar)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator*(Matrix<V, Layout, Alloc>&& A, const V& scalar)
+{
+    A *= scalar;
+    return std::move(A);
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator/(const Matrix<V, Layout, Alloc>& A, const V& scalar)
 {
     if (scalar == V())
     {
         throw std::runtime_error("scalar shouldn't be zero");
     }
-    Matrix<V> res(A);
-    for (typename Matrix<V>::iterator_type i = 0; i < A.rows_size(); i++) {
-        for (typename Matrix<V>::iterator_type j = 0; j < A.cols_size(); j++) {
-            res(i, j) /= scalar;
-        }
-    }
+    Matrix<V, Layout, Alloc> res(A);
+    res /= scalar;
     return res;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator+=(Matrix<V>& A, const Matrix<V>& B)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator/(Matrix<V, Layout, Alloc>&& A, const V& scalar)
+{
+    A /= scalar;
+    return std::move(A);
+}
+
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator+=(Matrix<V, Layout, Alloc>& A, const Matrix<V, Layout, Alloc>& B)
 {
     if (A.rows_size() != B.rows_size() || A.cols_size() != B.cols_size()) {
         throw std::invalid_argument("Matrices must have the same size for addition.");
     }
-    for (typename Matrix<V>::iterator_type i = 0; i < A.rows_size(); i++) {
-        for (typename Matrix<V>::iterator_type j = 0; j < B.cols_size(); j++) {
-            A(i, j) += B(i, j);
+    V* a = A.data();
+    const V* b = B.data();
+    size_t n = A.cols_size();
+    matrix_parallel::forRows(A.rows_size(), n, [&](size_t r0, size_t r1) {
+        for (size_t k = r0 * n; k < r1 * n; k++) {
+            a[k] += b[k];
         }
-    }
+    });
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator-=(Matrix<V>& A, const Matrix<V>& B)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator-=(Matrix<V, Layout, Alloc>& A, const Matrix<V, Layout, Alloc>& B)
 {
     if (A.rows_size() != B.rows_size() || A.cols_size() != B.cols_size()) {
         throw std::invalid_argument("Matrices must have the same size for addition.");
     }
-    for (typename Matrix<V>::iterator_type i = 0; i < A.rows_size(); i++) {
-        for (typename Matrix<V>::iterator_type j = 0; j < B.cols_size(); j++) {
-            A(i, j) -= B(i, j);
+    V* a = A.data();
+    const V* b = B.data();
+    size_t n = A.cols_size();
+    matrix_parallel::forRows(A.rows_size(), n, [&](size_t r0, size_t r1) {
+        for (size_t k = r0 * n; k < r1 * n; k++) {
+            a[k] -= b[k];
         }
-    }
+    });
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator*=(Matrix<V>& A, const Matrix<V>& B)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<V, Layout, Alloc>& operator*=(Matrix<V, Layout, Alloc>& A, const Matrix<V, Layout, Alloc>& B)
 {
     if (A.cols_size() != B.rows_size()) {
         throw std::invalid_argument("Matrices must have compatible dimensions for multiplication");
     }
+    MATH_SCOPED_TIMER("Matrix::operator*=");
+    MATH_HISTOGRAM_RECORD("Matrix::operator*=.flops",
+                          2.0 * A.rows_size() * A.cols_size() * B.cols_size());
 
-    Matrix<V> C(A.rows_size(), B.cols_size());
-    for (typename Matrix<V>::iterator_type i = 0; i < A.rows_size(); i++) {
-        for (typename Matrix<V>::iterator_type j = 0; j < B.cols_size(); j++) {
-            for (typename Matrix<V>::iterator_type k = 0; k < A.cols_size(); k++) {
-                C(i, j) += A(i, k) * B(k, j);
-            }
-        }
-    }
-    A = C;
+    Matrix<V, Layout, Alloc> C;
+    Matrix<V, Layout, Alloc>::multiplyInto(A, B, C);
+    A = std::move(C);
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator+=(Matrix<V>& A, const V& scalar)
+// Scalar compound operators, elementwise so blocks of the buffer work for
+// either layout
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator+=(Matrix<V, Layout, Alloc>& A, const V& scalar)
 {
-    A = A + scalar;
+    V* a = A.data();
+    size_t n = A.cols_size();
+    matrix_parallel::forRows(A.rows_size(), n, [&](size_t r0, size_t r1) {
+        for (size_t k = r0 * n; k < r1 * n; k++) {
+            a[k] += scalar;
+        }
+    });
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator-=(Matrix<V>& A, const V& scalar)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator-=(Matrix<V, Layout, Alloc>& A, const V& scalar)
 {
-    A = A - scalar;
+    V* a = A.data();
+    size_t n = A.cols_size();
+    matrix_parallel::forRows(A.rows_size(), n, [&](size_t r0, size_t r1) {
+        for (size_t k = r0 * n; k < r1 * n; k++) {
+            a[k] -= scalar;
+        }
+    });
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator*=(Matrix<V>& A, const V& scalar)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator*=(Matrix<V, Layout, Alloc>& A, const V& scalar)
 {
-    A = A * scalar;
+    V* a = A.data();
+    size_t n = A.cols_size();
+    matrix_parallel::forRows(A.rows_size(), n, [&](size_t r0, size_t r1) {
+        for (size_t k = r0 * n; k < r1 * n; k++) {
+            a[k] *= scalar;
+        }
+    });
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator/=(Matrix<V>& A, const V& scalar)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator/=(Matrix<V, Layout, Alloc>& A, const V& scalar)
 {
-    A = A / scalar;
+    if (scalar == V())
+    {
+        throw std::runtime_error("scalar shouldn't be zero");
+    }
+    V* a = A.data();
+    size_t n = A.cols_size();
+    matrix_parallel::forRows(A.rows_size(), n, [&](size_t r0, size_t r1) {
+        for (size_t k = r0 * n; k < r1 * n; k++) {
+            a[k] /= scalar;
+        }
+    });
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V> operator+(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator+(const Matrix<V, Layout, Alloc>& A, const std::initializer_list<std::initializer_list<V>> L)
 {
-    typename Matrix<V>::size_type r = L.size();
-    typename Matrix<V>::size_type c = L.begin()->size();
+    typename Matrix<V, Layout, Alloc>::size_type r = L.size();
+    typename Matrix<V, Layout, Alloc>::size_type c = L.begin()->size();
     if (A.rows_size() != r || A.cols_size() != c) {
         throw std::invalid_argument("Matrices must have the same size for addition.");
     }
-    Matrix<V> result(A);
+    Matrix<V, Layout, Alloc> result(A);
     auto row_it = L.begin();
-    for (typename Matrix<V>::iterator_type i = 0; i < r; ++i, ++row_it) {
+    for (typename Matrix<V, Layout, Alloc>::iterator_type i = 0; i < r; ++i, ++row_it) {
         auto col_it = row_it->begin();
-        for (typename Matrix<V>::iterator_type j = 0; j < c; ++j, ++col_it) {
+        for (typename Matrix<V, Layout, Alloc>::iterator_type j = 0; j < c; ++j, ++col_it) {
             result(i, j) += *col_it;
         }
     }
     return result;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V> operator-(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator-(const Matrix<V, Layout, Alloc>& A, const std::initializer_list<std::initializer_list<V>> L)
 {
-    typename Matrix<V>::size_type r = L.size();
-    typename Matrix<V>::size_type c = L.begin()->size();
+    typename Matrix<V, Layout, Alloc>::size_type r = L.size();
+    typename Matrix<V, Layout, Alloc>::size_type c = L.begin()->size();
     if (A.rows_size() != r || A.cols_size() != c) {
         throw std::invalid_argument("Matrices must have the same size for addition.");
     }
-    Matrix<V> result(A);
+    Matrix<V, Layout, Alloc> result(A);
     auto row_it = L.begin();
-    for (typename Matrix<V>::iterator_type i = 0; i < r; ++i, ++row_it) {
+    for (typename Matrix<V, Layout, Alloc>::iterator_type i = 0; i < r; ++i, ++row_it) {
         auto col_it = row_it->begin();
-        for (typename Matrix<V>::iterator_type j = 0; j < c; ++j, ++col_it) {
+        for (typename Matrix<V, Layout, Alloc>::iterator_type j = 0; j < c; ++j, ++col_it) {
             result(i, j) -= *col_it;
         }
     }
     return result;
 }
 
-template <Arithmetic V>
-inline constexpr Matrix<V> operator*(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L) {
-    typename Matrix<V>::size_type L_rows = L.size();
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc> operator*(const Matrix<V, Layout, Alloc>& A, const std::initializer_list<std::initializer_list<V>> L) {
+    typename Matrix<V, Layout, Alloc>::size_type L_rows = L.size();
     if (L_rows == 0) {
         throw std::invalid_argument("Second matrix not be empty.");
     }
-    typename Matrix<V>::size_type L_cols = L.begin()->size();
+    typename Matrix<V, Layout, Alloc>::size_type L_cols = L.begin()->size();
     for (const auto& rows : L) {
         if (rows.size() != L_cols) {
             throw std::invalid_argument("All string int second initializer_list should be one count of cols.");
@@ -587,16 +955,16 @@ inline constexpr Matrix<V> operator*(const Matrix<V>& A, const std::initializer_
     if (A.cols_size() != L_rows) {
         throw std::invalid_argument("A rows != B cols.");
     }
-    Matrix<V> C(A.rows_size(), L_cols);
+    Matrix<V, Layout, Alloc> C(A.rows_size(), L_cols);
     std::vector<std::vector<V>> L_matrix;
     L_matrix.reserve(L_rows);
     for (const auto& rows : L) {
         L_matrix.emplace_back(rows);
     }
-    for (typename Matrix<V>::size_type i = 0; i < A.rows_size(); ++i) {
-        for (typename Matrix<V>::size_type j = 0; j < L_cols; ++j) {
+    for (typename Matrix<V, Layout, Alloc>::size_type i = 0; i < A.rows_size(); ++i) {
+        for (typename Matrix<V, Layout, Alloc>::size_type j = 0; j < L_cols; ++j) {
             V sum = V{};
-            for (typename Matrix<V>::size_type k = 0; k < A.cols_size(); ++k) {
+            for (typename Matrix<V, Layout, Alloc>::size_type k = 0; k < A.cols_size(); ++k) {
                 sum += A(i, k) * L_matrix[k][j];
             }
             C(i, j) = sum;
@@ -606,35 +974,35 @@ inline constexpr Matrix<V> operator*(const Matrix<V>& A, const std::initializer_
     return C;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator+=(Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator+=(Matrix<V, Layout, Alloc>& A, const std::initializer_list<std::initializer_list<V>> L)
 {
     A = A + L;
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator-=(Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator-=(Matrix<V, Layout, Alloc>& A, const std::initializer_list<std::initializer_list<V>> L)
 {
     A = A - L;
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr Matrix<V>& operator*=(Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> L)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr Matrix<V, Layout, Alloc>& operator*=(Matrix<V, Layout, Alloc>& A, const std::initializer_list<std::initializer_list<V>> L)
 {
     A = A * L;
     return A;
 }
 
-template<Arithmetic V>
-inline constexpr bool operator==(const Matrix<V>& A, const Matrix<V>& B)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr bool operator==(const Matrix<V, Layout, Alloc>& A, const Matrix<V, Layout, Alloc>& B)
 {
     if (A.rows_size() == B.rows_size() && A.cols_size() == B.cols_size())
     {
-        for (typename Matrix<V>::iterator_type i = 0; i < A.rows_size(); ++i)
+        for (typename Matrix<V, Layout, Alloc>::iterator_type i = 0; i < A.rows_size(); ++i)
         {
-            for (typename Matrix<V>::iterator_type j = 0; j < A.cols_size(); ++j)
+            for (typename Matrix<V, Layout, Alloc>::iterator_type j = 0; j < A.cols_size(); ++j)
             {
                 if (A(i, j) != B(i, j))
                 {
@@ -647,18 +1015,18 @@ inline constexpr bool operator==(const Matrix<V>& A, const Matrix<V>& B)
     return false;
 }
 
-template<Arithmetic V>
-inline constexpr bool operator==(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> values)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr bool operator==(const Matrix<V, Layout, Alloc>& A, const std::initializer_list<std::initializer_list<V>> values)
 {
     if (A.rows_size() != values.size() || A.cols_size() != values.begin()->size())
     {
         throw std::invalid_argument("Matrices must have the same size");
     }
     auto row_it = values.begin();
-    for (typename Matrix<V>::size_type i = 0; i < A.rows_size(); ++i, ++row_it)
+    for (typename Matrix<V, Layout, Alloc>::size_type i = 0; i < A.rows_size(); ++i, ++row_it)
     {
         auto col_it = row_it->begin();
-        for (typename Matrix<V>::size_type j = 0; j < A.cols_size(); ++j, ++col_it)
+        for (typename Matrix<V, Layout, Alloc>::size_type j = 0; j < A.cols_size(); ++j, ++col_it)
         {
             if (A(i, j) != *col_it) {
                 return false;
@@ -668,14 +1036,14 @@ inline constexpr bool operator==(const Matrix<V>& A, const std::initializer_list
     return true;
 }
 
-template<Arithmetic V>
-inline constexpr bool operator!=(const Matrix<V>& A, const Matrix<V>& B)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr bool operator!=(const Matrix<V, Layout, Alloc>& A, const Matrix<V, Layout, Alloc>& B)
 {
     return !(A == B);
 }
 
-template<Arithmetic V>
-inline constexpr bool operator!=(const Matrix<V>& A, const std::initializer_list<std::initializer_list<V>> B)
+template <Arithmetic V, MatrixLayout Layout, MatrixAllocator Alloc>
+inline constexpr bool operator!=(const Matrix<V, Layout, Alloc>& A, const std::initializer_list<std::initializer_list<V>> B)
 {
     return !(A == B);
 }
@@ -684,24 +1052,24 @@ inline constexpr bool operator!=(const Matrix<V>& A, const std::initializer_list
 
 
 
-template <Arithmetic T>
-inline T& Matrix<T>::operator()(iterator_type rowIndex, iterator_type colIndex) {
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T& Matrix<T, Layout, Alloc>::operator()(iterator_type rowIndex, iterator_type colIndex) {
     if (rowIndex >= this->rows || colIndex >= this->cols) {
         throw std::out_of_range("Index out of range");
     }
-    return matrix[rowIndex][colIndex];
+    return at(rowIndex, colIndex);
 }
 
-template <Arithmetic T>
-inline T Matrix<T>::operator()(iterator_type rowIndex, iterator_type colIndex) const {
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T Matrix<T, Layout, Alloc>::operator()(iterator_type rowIndex, iterator_type colIndex) const {
     if (rowIndex >= this->rows || colIndex >= this->cols) {
         throw std::out_of_range("Index out of range");
     }
-    return matrix[rowIndex][colIndex];
+    return at(rowIndex, colIndex);
 }
 
-template<Arithmetic T>
-inline std::vector<T> Matrix<T>::getCol(const iterator_type& colI) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline std::vector<T> Matrix<T, Layout, Alloc>::getCol(const iterator_type& colI) const
 {
     if (colI >= cols)
     {
@@ -710,13 +1078,13 @@ inline std::vector<T> Matrix<T>::getCol(const iterator_type& colI) const
     std::vector<T> res(rows);
     for (iterator_type i = 0; i < rows; i++)
     {
-        res[i] = matrix[i][colI];
+        res[i] = at(i, colI);
     }
     return res;
 }
 
-template<Arithmetic T>
-inline std::vector<T> Matrix<T>::getRow(const iterator_type& rowI) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline std::vector<T> Matrix<T, Layout, Alloc>::getRow(const iterator_type& rowI) const
 {
     if (rowI >= rows)
     {
@@ -725,13 +1093,13 @@ inline std::vector<T> Matrix<T>::getRow(const iterator_type& rowI) const
     std::vector<T> res(cols);
     for (iterator_type i = 0; i < rows; i++)
     {
-        res[i] = matrix[rowI][i];
+        res[i] = at(rowI, i);
     }
     return res;
 }
 
-template<Arithmetic T>
-inline std::vector<T> Matrix<T>::getCol(const iterator_type& colI, const size_type& count) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline std::vector<T> Matrix<T, Layout, Alloc>::getCol(const iterator_type& colI, const size_type& count) const
 {
     if (colI >= cols || count > rows)
     {
@@ -740,13 +1108,13 @@ inline std::vector<T> Matrix<T>::getCol(const iterator_type& colI, const size_ty
     std::vector<T> res(count);
     for (iterator_type i = 0; i < count; i++)
     {
-        res[i] = matrix[i][colI];
+        res[i] = at(i, colI);
     }
     return res;
 }
 
-template<Arithmetic T>
-inline std::vector<T> Matrix<T>::getRow(const iterator_type& rowI, const size_type& count) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline std::vector<T> Matrix<T, Layout, Alloc>::getRow(const iterator_type& rowI, const size_type& count) const
 {
     if (rowI >= rows || count > cols)
     {
@@ -755,13 +1123,13 @@ inline std::vector<T> Matrix<T>::getRow(const iterator_type& rowI, const size_ty
     std::vector<T> res(count);
     for (iterator_type i = 0; i < count; i++)
     {
-        res[i] = matrix[rowI][i];
+        res[i] = at(rowI, i);
     }
     return res;
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setCol(const std::vector<T>& colV, const iterator_type& colI) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setCol(const std::vector<T>& colV, const iterator_type& colI) const
 {
     if (colV.size() > rows || colI >= cols)
     {
@@ -769,12 +1137,12 @@ inline void Matrix<T>::setCol(const std::vector<T>& colV, const iterator_type& c
     }
     for (iterator_type i = 0; i < colV.size(); i++)
     {
-        matrix[i][colI] = colV[i];
+        at(i, colI) = colV[i];
     }
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setRow(const std::vector<T>& rowV, const iterator_type& rowI) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setRow(const std::vector<T>& rowV, const iterator_type& rowI) const
 {
     if (rowV.size() > cols || rowI >= rows)
     {
@@ -782,19 +1150,19 @@ inline void Matrix<T>::setRow(const std::vector<T>& rowV, const iterator_type& r
     }
     for (iterator_type i = 0; i < rowV.size(); i++)
     {
-        matrix[rowI][i] = rowV[i];
+        at(rowI, i) = rowV[i];
     }
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setCol(const Matrix<T>& A, const iterator_type& colI) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setCol(const Matrix<T, Layout, Alloc>& A, const iterator_type& colI) const
 {
     // 1xn
     if (A.cols_size() <= cols && A.rows_size() == 1)
     {
         for (iterator_type i = 0; i < A.cols_size(); i++)
         {
-            matrix[i][colI] = A(0, i);
+            at(i, colI) = A(0, i);
         }
     }
     // nx1
@@ -802,7 +1170,7 @@ inline void Matrix<T>::setCol(const Matrix<T>& A, const iterator_type& colI) con
     {
         for (iterator_type i = 0; i < A.rows_size(); i++)
         {
-            matrix[i][colI] = A(i, 0);
+            at(i, colI) = A(i, 0);
         }
     }
     else {
@@ -810,21 +1178,21 @@ inline void Matrix<T>::setCol(const Matrix<T>& A, const iterator_type& colI) con
     }
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setRow(const Matrix<T>& A, const iterator_type& rowI) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setRow(const Matrix<T, Layout, Alloc>& A, const iterator_type& rowI) const
 {
     if (A.cols_size() <= cols && A.rows_size() == 1)
     {
         for (iterator_type i = 0; i < A.cols_size(); i++)
         {
-            matrix[rowI][i] = A(0, i);
+            at(rowI, i) = A(0, i);
         }
     }
     else if (A.rows_size() <= rows && A.cols_size() == 1)
     {
         for (iterator_type i = 0; i < A.rows_size(); i++)
         {
-            matrix[rowI][i] = A(i, 0);
+            at(rowI, i) = A(i, 0);
         }
     }
     else {
@@ -832,8 +1200,8 @@ inline void Matrix<T>::setRow(const Matrix<T>& A, const iterator_type& rowI) con
     }
 }
 
-template<Arithmetic T>
-Matrix<T> Matrix<T>::getSubmatrix(const size_type& start_row, const size_type& start_col, const size_type& num_rows, const size_type& num_cols) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::getSubmatrix(const size_type& start_row, const size_type& start_col, const size_type& num_rows, const size_type& num_cols) const
 {
     // Check
     if (start_row + num_rows > rows || start_col + num_cols > cols) {
@@ -841,19 +1209,19 @@ Matrix<T> Matrix<T>::getSubmatrix(const size_type& start_row, const size_type& s
     }
 
     // Create target matrix
-    Matrix<T> submatrix(num_rows, num_cols);
+    Matrix<T, Layout, Alloc> submatrix(num_rows, num_cols);
 
     for (size_type i = 0; i < num_rows; ++i) {
         for (size_type j = 0; j < num_cols; ++j) {
-            submatrix(i, j) = matrix[start_row + i][start_col + j];
+            submatrix(i, j) = at(start_row + i, start_col + j);
         }
     }
 
     return submatrix;
 }
 
-template<Arithmetic T>
-void Matrix<T>::setSubmatrix(const size_type& start_row, const size_type& start_col, const Matrix<T>& block) {
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+void Matrix<T, Layout, Alloc>::setSubmatrix(const size_type& start_row, const size_type& start_col, const Matrix<T, Layout, Alloc>& block) {
     size_type block_rows = block.rows_size();
     size_type block_cols = block.cols_size();
 
@@ -864,185 +1232,103 @@ void Matrix<T>::setSubmatrix(const size_type& start_row, const size_type& start_
 
     for (size_type i = 0; i < block_rows; ++i) {
         for (size_type j = 0; j < block_cols; ++j) {
-            matrix[start_row + i][start_col + j] = block(i, j);
+            at(start_row + i, start_col + j) = block(i, j);
         }
     }
 }
 
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::transpose() const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::transpose() const
 {
-    Matrix<T> tra(cols, rows);
-    for (typename Matrix<T>::iterator_type i = 0; i < rows; ++i) {
-        for (typename Matrix<T>::iterator_type j = 0; j < cols; ++j) {
-            tra.matrix[j][i] = matrix[i][j];
+    Matrix<T, Layout, Alloc> tra(cols, rows);
+    for (typename Matrix<T, Layout, Alloc>::iterator_type i = 0; i < rows; ++i) {
+        for (typename Matrix<T, Layout, Alloc>::iterator_type j = 0; j < cols; ++j) {
+            tra.at(j, i) = at(i, j);
         }
     }
     return tra;
 }
 
-template<Arithmetic T>
-inline T Matrix<T>::determinant() const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T Matrix<T, Layout, Alloc>::determinant() const
 {
     if (rows != cols) {
         throw std::runtime_error("rows != cols: matrix is cannot be to find determinant");
     }
-    size_type s = rows;
     if (rows == 0 || cols == 0){
         throw std::runtime_error("rows or cols cannot be equel to zero");
     }
-    T** tempMatrix = new T*[s];
-    for (size_type i = 0; i < s; ++i) {
-        tempMatrix[i] = new T[s];
-        for (size_type j = 0; j < s; ++j) {
-            tempMatrix[i][j] = matrix[i][j];
-        }
-    }
-
-    T d = T(1);
-    T eps = T(10e-20);
-    for (size_t i = 0; i < s; ++i) {
-        if (std::abs(tempMatrix[i][i]) < eps) {
-            for (size_t k = i + 1; k < s; ++k) {
-                if (std::abs(tempMatrix[k][i]) > eps) {
-                    for (size_t j = 0; j < s; ++j) {
-                        std::swap(tempMatrix[i][j], tempMatrix[k][j]);
-                    }
-                    d *= T(-1);
-                    break;
-                }
-            }
-        }
-        if (std::abs(tempMatrix[i][i]) < eps) {
-            for (typename Matrix<T>::iterator_type i = 0; i < s; i++)
-            {
-                delete[] tempMatrix[i];
-            }
-            if (rows != 0) delete[] tempMatrix;
-            return 0;
-        }
-        for (size_t k = i + 1; k < s; ++k) {
-            T factor = tempMatrix[k][i] / tempMatrix[i][i];
-            for (size_t j = i; j < s; ++j) {
-                tempMatrix[k][j] -= factor * tempMatrix[i][j];
-            }
-        }
-        d *= tempMatrix[i][i];
+    // LU works on Matrix<T>
+    FactorizationType<T> d;
+    if constexpr (std::same_as<Matrix, Matrix<T>>) {
+        d = LU<FactorizationType<T>>(*this).determinant();
+    } else {
+        d = LU<FactorizationType<T>>(Matrix<T>(*this)).determinant();
     }
-
-    for (typename Matrix<T>::iterator_type i = 0; i < s; i++)
-    {
-        delete[] tempMatrix[i];
+    if constexpr (std::is_integral_v<T>) {
+        return static_cast<T>(std::llround(d));
+    } else {
+        return d;
     }
-    if (rows != 0) delete[] tempMatrix;
-
-    return d;
 }
 
-template<Arithmetic T>
-inline T Matrix<T>::determinant(const Matrix<T>& mat)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T Matrix<T, Layout, Alloc>::determinant(const Matrix<T, Layout, Alloc>& mat)
 {
     return mat.determinant();
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setTranspose()
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setTranspose()
 {
     (*this) = (*this).transpose();
 }
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::inverse() const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::inverse() const
 {
     if (rows != cols) {
         throw std::invalid_argument("Inverse can only be computed for square matrices.");
     }
+    MATH_SCOPED_TIMER("Matrix::inverse");
+    MATH_HISTOGRAM_RECORD("Matrix::inverse.size", rows);
 
-    T det = (*this).determinant();
-    if (det == 0) {
-        throw std::runtime_error("Matrix is singular and cannot be inverted.");
-    }
-
-    T** invMat = new T * [rows];
-    for (size_type i = 0; i < rows; ++i) {
-        invMat[i] = new T[cols];
+    LU<FactorizationType<T>> lu;
+    if constexpr (std::same_as<Matrix, Matrix<T>>) {
+        lu.factorize(*this);
+    } else {
+        lu.factorize(Matrix<T>(*this));
     }
-
-    T** tempMatrix = new T * [rows];
-    for (size_type i = 0; i < rows; ++i) {
-        tempMatrix[i] = new T[rows];
-        for (size_type j = 0; j < rows; ++j) {
-            tempMatrix[i][j] = matrix[i][j];
-        }
-    }
-
-    for (size_type i = 0; i < rows; ++i) {
-        for (size_type j = 0; j < rows; ++j) {
-            invMat[i][j] = (i == j) ? 1.0 : 0.0;
-        }
+    if (lu.isSingular()) {
+        throw std::runtime_error("Matrix is singular and cannot be inverted.");
     }
-
-    for (size_type i = 0; i < rows; ++i) {
-        if (tempMatrix[i][i] == 0.0) {
-            for (size_type j = i + 1; j < rows; ++j) {
-                if (tempMatrix[j][i] != 0.0) {
-                    for (size_type k = 0; k < rows; ++k) {
-                        std::swap(tempMatrix[i][k], tempMatrix[j][k]);
-                        std::swap(invMat[i][k], invMat[j][k]);
-                    }
-                    break;
-                }
-            }
-        }
-
-        T factor = tempMatrix[i][i];
-        for (size_type j = 0; j < rows; ++j) {
-            tempMatrix[i][j] /= factor;
-            invMat[i][j] /= factor;
-        }
-
-        for (size_type j = 0; j < rows; ++j) {
-            if (j != i) {
-                factor = tempMatrix[j][i];
-                for (size_type k = 0; k < rows; ++k) {
-                    tempMatrix[j][k] -= factor * tempMatrix[i][k];
-                    invMat[j][k] -= factor * invMat[i][k];
-                }
+    if constexpr (std::same_as<Matrix, Matrix<FactorizationType<T>>>) {
+        return lu.inverse();
+    } else {
+        Matrix<FactorizationType<T>> inv = lu.inverse();
+        Matrix<T, Layout, Alloc> result(rows, cols);
+        for (size_type i = 0; i < rows; i++) {
+            for (size_type j = 0; j < cols; j++) {
+                result.at(i, j) = static_cast<T>(inv(i, j));
             }
         }
+        return result;
     }
-
-    Matrix<T> result(rows, cols);
-    for (size_type i = 0; i < rows; i++) {
-        for (size_type j = 0; j < rows; j++) {
-            result(i, j) = invMat[i][j];
-        }
-    }
-
-    for (typename Matrix<T>::iterator_type i = 0; i < rows; i++)
-    {
-        delete[] invMat[i];
-        delete[] tempMatrix[i];
-    }
-    delete[] invMat;
-    delete[] tempMatrix;
-
-    return result;
 }
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::adjoint(const size_type& i, const size_type& j) const {
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::adjoint(const size_type& i, const size_type& j) const {
     return adjoint(i, j, *this);
 }
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::adjoint(const size_type& i, const size_type& j, const Matrix<T>& mat) {
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::adjoint(const size_type& i, const size_type& j, const Matrix<T, Layout, Alloc>& mat) {
     if (i >= mat.rows || j >= mat.cols) {
         throw std::out_of_range("Index out of range");
     }
 
-    Matrix<T> result(mat.rows - 1, mat.cols - 1);
+    Matrix<T, Layout, Alloc> result(mat.rows - 1, mat.cols - 1);
 
     size_type result_row = 0, result_col = 0;
     for (size_type row = 0; row < mat.rows; ++row) {
@@ -1050,7 +1336,7 @@ inline Matrix<T> Matrix<T>::adjoint(const size_type& i, const size_type& j, cons
         result_col = 0;
         for (size_type col = 0; col < mat.cols; ++col) {
             if (col == j) continue;
-            result.matrix[result_row][result_col] = mat.matrix[row][col];
+            result.at(result_row, result_col) = mat.at(row, col);
             ++result_col;
         }
         ++result_row;
@@ -1059,84 +1345,145 @@ inline Matrix<T> Matrix<T>::adjoint(const size_type& i, const size_type& j, cons
     return result;
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setInverse()
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setInverse()
 {
     (*this) = (*this).inverse();
 }
 
-template<Arithmetic T>
-inline T Matrix<T>::minor(const size_type& ix, const size_type& jx) const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T Matrix<T, Layout, Alloc>::minor(const size_type& ix, const size_type& jx) const
 {
     if (rows != cols) {
         throw std::invalid_argument("Matrix should be square!");
     }
-    std::vector<std::vector<T>> subMatrix;
-    for (size_type i = 0; i < rows; ++i)
-    {
-        if (i == ix) continue;
-        std::vector<T> subRow;
-        for (size_type j = 0; j < rows; ++j)
-        {
-            if (j == jx) continue;
-            subRow.push_back(matrix[i][j]);
-        }
-        subMatrix.push_back(subRow);
-    }
-    Matrix<T> res(rows - 1, cols - 1);
-    for (size_type i = 0; i < rows - 1; i++)
-    {
-        for (size_type j = 0; j < cols - 1; j++)
-        {
-            res(i, j) = subMatrix[i][j];
-        }
-    }
-    return determinant(res);
+    return adjoint(ix, jx).determinant();
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T Matrix<T, Layout, Alloc>::minor(const size_type& ix, const size_type& jx, const Matrix<T, Layout, Alloc>& mat)
+{
+    return mat.minor(ix, jx);
 }
 
-template<Arithmetic T>
-inline T Matrix<T>::minor(const size_type& ix, const size_type& jx, const Matrix<T>& mat)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::adjugate() const
 {
-    if (mat.rows != mat.cols) {
+    if (rows != cols) {
         throw std::invalid_argument("Matrix should be square!");
     }
-    std::vector<std::vector<T>> subMatrix;
-    for (size_type i = 0; i < mat.rows; ++i)
-    {
-        if (i == ix) continue;
-        std::vector<T> subRow;
-        for (size_type j = 0; j < mat.rows; ++j)
-        {
-            if (j == jx) continue;
-            subRow.push_back(mat(i, j));
+    if (rows == 0) {
+        throw std::runtime_error("rows or cols cannot be equel to zero");
+    }
+    MATH_SCOPED_TIMER("Matrix::adjugate");
+    MATH_HISTOGRAM_RECORD("Matrix::adjugate.size", rows);
+
+    using F = FactorizationType<T>;
+    size_type n = rows;
+    Matrix<F> A(n, n);
+    for (size_type i = 0; i < n; i++) {
+        for (size_type j = 0; j < n; j++) {
+            A.matrix[i][j] = static_cast<F>(at(i, j));
         }
-        subMatrix.push_back(subRow);
     }
-    Matrix<T> res(mat.rows - 1, mat.cols - 1);
-    for (size_type i = 0; i < mat.rows - 1; i++)
-    {
-        for (size_type j = 0; j < mat.cols - 1; j++)
-        {
-            res(i, j) = subMatrix[i][j];
+
+    Matrix<F> adj;
+    LU<F> lu;
+    if (n > 1) {
+        lu.factorize(A);
+    }
+    if (n == 1) {
+        adj = Matrix<F>(1, 1, F(1));
+    } else if (!lu.isSingular()) {
+        adj = lu.inverse();
+        adj *= lu.determinant();
+    } else {
+        // The full decomposition runs Golub-Kahan, which keeps U orthogonal
+        // for zero singular values; Jacobi leaves those columns at zero
+        SVD<F> svd(A, false);
+        const std::vector<F>& s = svd.singularValues();
+        // p[k] = product of s[l] for l != k, from prefix and suffix products
+        std::vector<F> p(n, F(1));
+        F prefix = F(1);
+        for (size_type k = 0; k < n; k++) {
+            p[k] = prefix;
+            prefix *= s[k];
+        }
+        F suffix = F(1);
+        for (size_type k = n; k-- > 0;) {
+            p[k] *= suffix;
+            suffix *= s[k];
+        }
+        F sign = LU<F>(svd.U()).determinant() * LU<F>(svd.V()).determinant() < F(0) ? F(-1) : F(1);
+
+        // adj = sign * (V diag(p)) U^T, rows of V diag(p) against rows of U
+        Matrix<F> Vp(svd.V());
+        for (size_type i = 0; i < n; i++) {
+            F* v = Vp.matrix[i];
+            for (size_type k = 0; k < n; k++) {
+                v[k] *= sign * p[k];
+            }
+        }
+        adj.resize(n, n);
+        for (size_type i = 0; i < n; i++) {
+            for (size_type j = 0; j < n; j++) {
+                adj.matrix[i][j] = matrix_kernels::dot(Vp.matrix[i], svd.U().matrix[j], n);
+            }
+        }
+    }
+
+    Matrix<T, Layout, Alloc> result(n, n);
+    for (size_type i = 0; i < n; i++) {
+        for (size_type j = 0; j < n; j++) {
+            if constexpr (std::is_integral_v<T>) {
+                result.at(i, j) = static_cast<T>(std::llround(adj.matrix[i][j]));
+            } else {
+                result.at(i, j) = static_cast<T>(adj.matrix[i][j]);
+            }
+        }
+    }
+    return result;
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::adjugate(const Matrix<T, Layout, Alloc>& mat)
+{
+    return mat.adjugate();
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::minors() const
+{
+    Matrix<T, Layout, Alloc> adj = adjugate();
+    Matrix<T, Layout, Alloc> result(rows, cols);
+    for (size_type i = 0; i < rows; i++) {
+        for (size_type j = 0; j < cols; j++) {
+            result.at(i, j) = (i + j) % 2 == 0 ? adj.at(j, i) : -adj.at(j, i);
         }
     }
-    return determinant(res);
+    return result;
 }
 
-template<Arithmetic T>
-inline T Matrix<T>::trace() const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::minors(const Matrix<T, Layout, Alloc>& mat)
+{
+    return mat.minors();
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T Matrix<T, Layout, Alloc>::trace() const
 {
     T result = 0.0;
     size_type min_dim = std::min(rows, cols);
     for (size_type i = 0; i < min_dim; i++)
     {
-        result += matrix[i][i];
+        result += at(i, i);
     }
     return result;
 }
 
-template<Arithmetic T>
-inline T Matrix<T>::trace(const Matrix<T>& mat)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline T Matrix<T, Layout, Alloc>::trace(const Matrix<T, Layout, Alloc>& mat)
 {
     T result = 0.0;
     size_type min_dim = std::min(mat.rows, mat.cols);
@@ -1147,20 +1494,20 @@ inline T Matrix<T>::trace(const Matrix<T>& mat)
     return result;
 }
 
-template<Arithmetic T>
-inline std::vector<T> Matrix<T>::diag() const
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline std::vector<T> Matrix<T, Layout, Alloc>::diag() const
 {
     std::vector<T> result;
     size_type min_dim = std::min(rows, cols);
     for (size_type i = 0; i < min_dim; i++)
     {
-        result.push_back(matrix[i][i]);
+        result.push_back(at(i, i));
     }
     return result;
 }
 
-template<Arithmetic T>
-inline std::vector<T> Matrix<T>::diag(const Matrix<T>& mat)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline std::vector<T> Matrix<T, Layout, Alloc>::diag(const Matrix<T, Layout, Alloc>& mat)
 {
     std::vector<T> result;
     size_type min_dim = std::min(mat.rows_size(), mat.cols_size());
@@ -1171,10 +1518,10 @@ inline std::vector<T> Matrix<T>::diag(const Matrix<T>& mat)
     return result;
 }
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::ones(const size_type& size)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::ones(const size_type& size)
 {
-    Matrix<T> result(size, size);
+    Matrix<T, Layout, Alloc> result(size, size);
     for (size_type i = 0; i < size; i++)
     {
         for (size_type j = 0; j < size; j++)
@@ -1185,10 +1532,10 @@ inline Matrix<T> Matrix<T>::ones(const size_type& size)
     return result;
 }
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::ones(const size_type& rows, const size_type& cols)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::ones(const size_type& rows, const size_type& cols)
 {
-    Matrix<T> result(rows, cols);
+    Matrix<T, Layout, Alloc> result(rows, cols);
     for (size_type i = 0; i < rows; i++)
     {
         for (size_type j = 0; j < cols; j++)
@@ -1199,21 +1546,21 @@ inline Matrix<T> Matrix<T>::ones(const size_type& rows, const size_type& cols)
     return result;
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setOnes()
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setOnes()
 {
     for (size_type i = 0; i < rows; i++)
     {
         for (size_type j = 0; j < cols; j++)
         {
-            matrix[i][j] = T(1);
+            at(i, j) = T(1);
         }
     }
 }
 
-template<Arithmetic T>
-Matrix<T> Matrix<T>::identity(const Matrix::size_type &size) {
-    Matrix<T> result(size, size);
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::identity(const Matrix::size_type &size) {
+    Matrix<T, Layout, Alloc> result(size, size);
     for (size_type i = 0; i < size; i++)
     {
         result(i, i) = T(1);
@@ -1221,27 +1568,27 @@ Matrix<T> Matrix<T>::identity(const Matrix::size_type &size) {
     return result;
 }
 
-template<Arithmetic T>
-Matrix<T> Matrix<T>::identity(const size_type& rows, const size_type& cols) {
-    Matrix<T> result(rows, cols);
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::identity(const size_type& rows, const size_type& cols) {
+    Matrix<T, Layout, Alloc> result(rows, cols);
     for (size_type i = 0; i < rows; i++) {
         result(i, i) = T(1);
     }
     return result;
 }
 
-template<Arithmetic T>
-void Matrix<T>::setIdentity() {
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+void Matrix<T, Layout, Alloc>::setIdentity() {
     for (size_type i = 0; i < rows; i++)
     {
-        matrix[i][i] = T(1);
+        at(i, i) = T(1);
     }
 }
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::zeroes(const size_type& size)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::zeroes(const size_type& size)
 {
-    Matrix<T> result(size, size);
+    Matrix<T, Layout, Alloc> result(size, size);
     for (size_type i = 0; i < size; i++)
     {
         for (size_type j = 0; j < size; j++)
@@ -1253,10 +1600,10 @@ inline Matrix<T> Matrix<T>::zeroes(const size_type& size)
 }
 
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::zeroes(const size_type& rows, const size_type& cols)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::zeroes(const size_type& rows, const size_type& cols)
 {
-    Matrix<T> result(rows, cols);
+    Matrix<T, Layout, Alloc> result(rows, cols);
     for (size_type i = 0; i < rows; i++)
     {
         for (size_type j = 0; j < cols; j++)
@@ -1267,21 +1614,21 @@ inline Matrix<T> Matrix<T>::zeroes(const size_type& rows, const size_type& cols)
     return result;
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setZeroes()
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setZeroes()
 {
     for (size_type i = 0; i < rows; i++)
     {
         for (size_type j = 0; j < cols; j++)
         {
-            matrix[i][j] = T(0);
+            at(i, j) = T(0);
         }
     }
 }
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::random(const size_type& size, const T& min, const T& max) {
-    Matrix<T> result(size, size);
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::random(const size_type& size, const T& min, const T& max) {
+    Matrix<T, Layout, Alloc> result(size, size);
     // random generator
     std::random_device rd;  // start random number
     std::mt19937 gen(rd()); // Mersenne Twister for generation
@@ -1307,9 +1654,9 @@ inline Matrix<T> Matrix<T>::random(const size_type& size, const T& min, const T&
     return result;
 }
 
-template<Arithmetic T>
-inline Matrix<T> Matrix<T>::random(const size_type& rows, const size_type& cols, const T& min, const T& max) {
-    Matrix<T> result(rows, cols);
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc> Matrix<T, Layout, Alloc>::random(const size_type& rows, const size_type& cols, const T& min, const T& max) {
+    Matrix<T, Layout, Alloc> result(rows, cols);
     // random generator
     std::random_device rd;  // start random number
     std::mt19937 gen(rd()); // Mersenne Twister for generation
@@ -1335,8 +1682,8 @@ inline Matrix<T> Matrix<T>::random(const size_type& rows, const size_type& cols,
     return result;
 }
 
-template<Arithmetic T>
-inline void Matrix<T>::setRandom(const T& min, const T& max)
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::setRandom(const T& min, const T& max)
 {
     // random generator
     std::random_device rd;  // start random number
@@ -1345,7 +1692,7 @@ inline void Matrix<T>::setRandom(const T& min, const T& max)
         std::uniform_real_distribution<T> dist(min, max);
         for (size_type i = 0; i < rows; ++i) {
             for (size_type j = 0; j < cols; ++j) {
-                matrix(i, j) = dist(gen);
+                at(i, j) = dist(gen);
             }
         }
     }
@@ -1353,7 +1700,7 @@ inline void Matrix<T>::setRandom(const T& min, const T& max)
         std::uniform_int_distribution<T> dist(min, max);
         for (size_type i = 0; i < rows; ++i) {
             for (size_type j = 0; j < cols; ++j) {
-                matrix(i, j) = dist(gen);
+                at(i, j) = dist(gen);
             }
         }
     }
@@ -1362,4 +1709,332 @@ inline void Matrix<T>::setRandom(const T& min, const T& max)
     }
 }
 
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::resize(const size_type& newRows, const size_type& newCols)
+{
+    if (rows == newRows && cols == newCols) {
+        return;
+    }
+    Matrix<T, Layout, Alloc> temp(newRows, newCols);
+    std::swap(rows, temp.rows);
+    std::swap(cols, temp.cols);
+    std::swap(matrix, temp.matrix);
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline Matrix<T, Layout, Alloc>& Matrix<T, Layout, Alloc>::addDiagonal(const T& value)
+{
+    size_type n = std::min(rows, cols);
+    for (size_type i = 0; i < n; ++i) {
+        at(i, i) += value;
+    }
+    return *this;
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::multiplyInto(const Matrix<T, Layout, Alloc>& A, const Matrix<T, Layout, Alloc>& B, Matrix<T, Layout, Alloc>& C)
+{
+    if (A.cols != B.rows) {
+        throw std::invalid_argument("Matrices must have compatible dimensions for multiplication");
+    }
+    if (&C == &A || &C == &B) {
+        throw std::invalid_argument("multiplyInto: result must not alias an operand");
+    }
+    MATH_SCOPED_TIMER("Matrix::multiplyInto");
+    C.resize(A.rows, B.cols);
+    double flops = 2.0 * A.rows * A.cols * B.cols;
+    if constexpr (isRowMajor) {
+        // i-k-j order streams rows of B and C
+        matrix_parallel::forTiles(A.rows, B.cols, flops, [&](size_type r0, size_type r1, size_type c0, size_type c1) {
+            for (size_type i = r0; i < r1; ++i) {
+                T* c = C.matrix[i];
+                std::fill(c + c0, c + c1, T(0));
+                for (size_type k = 0; k < A.cols; ++k) {
+                    T a = A.matrix[i][k];
+                    const T* b = B.matrix[k];
+                    for (size_type j = c0; j < c1; ++j) {
+                        c[j] += a * b[j];
+                    }
+                }
+            }
+        });
+    } else {
+        // j-k-i order streams columns of A and C
+        matrix_parallel::forTiles(A.rows, B.cols, flops, [&](size_type r0, size_type r1, size_type c0, size_type c1) {
+            for (size_type j = c0; j < c1; ++j) {
+                T* c = C.matrix[j];
+                std::fill(c + r0, c + r1, T(0));
+                for (size_type k = 0; k < A.cols; ++k) {
+                    T b = B.matrix[j][k];
+                    const T* a = A.matrix[k];
+                    for (size_type i = r0; i < r1; ++i) {
+                        c[i] += b * a[i];
+                    }
+                }
+            }
+        }, matrix_parallel::kTileCols, matrix_parallel::kTileRows);
+    }
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+template <MatrixLayout Other>
+    requires (!std::same_as<Other, Layout>)
+inline void Matrix<T, Layout, Alloc>::multiplyInto(const Matrix<T, Layout, Alloc>& A, const Matrix<T, Other, Alloc>& B, Matrix<T, Layout, Alloc>& C)
+{
+    if (A.cols != B.rows) {
+        throw std::invalid_argument("Matrices must have compatible dimensions for multiplication");
+    }
+    if (&C == &A) {
+        throw std::invalid_argument("multiplyInto: result must not alias an operand");
+    }
+    MATH_SCOPED_TIMER("Matrix::multiplyInto");
+    C.resize(A.rows, B.cols);
+    double flops = 2.0 * A.rows * A.cols * B.cols;
+    if constexpr (isRowMajor) {
+        // Rows of A against columns of B, both contiguous
+        matrix_parallel::forTiles(A.rows, B.cols, flops, [&](size_type r0, size_type r1, size_type c0, size_type c1) {
+            for (size_type i = r0; i < r1; ++i) {
+                const T* a = A.matrix[i];
+                for (size_type j = c0; j < c1; ++j) {
+                    const T* b = B.matrix[j];
+                    T sum = matrix_kernels::dot(a, b, A.cols);
+                    C.matrix[i][j] = sum;
+                }
+            }
+        });
+    } else {
+        // Columns of C as combinations of columns of A, B read by rows
+        matrix_parallel::forTiles(A.rows, B.cols, flops, [&](size_type r0, size_type r1, size_type c0, size_type c1) {
+            for (size_type j = c0; j < c1; ++j) {
+                std::fill(C.matrix[j] + r0, C.matrix[j] + r1, T(0));
+            }
+            for (size_type k = 0; k < A.cols; ++k) {
+                const T* a = A.matrix[k];
+                const T* b = B.matrix[k];
+                for (size_type j = c0; j < c1; ++j) {
+                    T bkj = b[j];
+                    T* c = C.matrix[j];
+                    for (size_type i = r0; i < r1; ++i) {
+                        c[i] += bkj * a[i];
+                    }
+                }
+            }
+        }, matrix_parallel::kTileCols, matrix_parallel::kTileRows);
+    }
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::gemv(const Matrix<T, Layout, Alloc>& A, const Matrix<T, Layout, Alloc>& x, Matrix<T, Layout, Alloc>& y, const T& alpha, const T& beta)
+{
+    if (x.cols != 1 || A.cols != x.rows) {
+        throw std::invalid_argument("gemv: x must be a column vector with A.cols rows");
+    }
+    if (&y == &x || &y == &A) {
+        throw std::invalid_argument("gemv: result must not alias an operand");
+    }
+    if (beta == T(0)) {
+        y.resize(A.rows, 1);
+    } else if (y.rows != A.rows || y.cols != 1) {
+        throw std::invalid_argument("gemv: y must be a column vector with A.rows rows");
+    }
+    if (A.rows == 0) {
+        return;
+    }
+    // Column vectors are contiguous in either layout
+    const T* in = x.data();
+    T* out = y.data();
+    if constexpr (isRowMajor) {
+        matrix_parallel::forTiles(A.rows, 1, 2.0 * A.rows * A.cols, [&](size_type r0, size_type r1, size_type, size_type) {
+            for (size_type i = r0; i < r1; ++i) {
+                const T* a = A.matrix[i];
+                T sum = matrix_kernels::dot(a, in, A.cols);
+                out[i] = alpha * sum + (beta == T(0) ? T(0) : beta * out[i]);
+            }
+        });
+    } else {
+        // y += alpha x_k a_k column by column
+        matrix_parallel::forTiles(A.rows, 1, 2.0 * A.rows * A.cols, [&](size_type r0, size_type r1, size_type, size_type) {
+            for (size_type i = r0; i < r1; ++i) {
+                out[i] = beta == T(0) ? T(0) : beta * out[i];
+            }
+            for (size_type k = 0; k < A.cols; ++k) {
+                T xk = alpha * in[k];
+                if (xk == T(0)) {
+                    continue;
+                }
+                const T* a = A.matrix[k];
+                for (size_type i = r0; i < r1; ++i) {
+                    out[i] += xk * a[i];
+                }
+            }
+        }, matrix_parallel::kTileCols);
+    }
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::transposeInto(const Matrix<T, Layout, Alloc>& A, Matrix<T, Layout, Alloc>& At)
+{
+    if (&A == &At) {
+        throw std::invalid_argument("transposeInto: result must not alias the operand");
+    }
+    At.resize(A.cols, A.rows);
+    for (size_type i = 0; i < A.rows; ++i) {
+        for (size_type j = 0; j < A.cols; ++j) {
+            At.at(j, i) = A.at(i, j);
+        }
+    }
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::gemm_tn(const Matrix<T, Layout, Alloc>& A, const Matrix<T, Layout, Alloc>& B, Matrix<T, Layout, Alloc>& C)
+{
+    if (A.rows != B.rows) {
+        throw std::invalid_argument("gemm_tn: A and B must have the same number of rows");
+    }
+    if (&C == &A || &C == &B) {
+        throw std::invalid_argument("gemm_tn: result must not alias an operand");
+    }
+    MATH_SCOPED_TIMER("Matrix::gemm_tn");
+    C.resize(A.cols, B.cols);
+    double flops = 2.0 * A.rows * A.cols * B.cols;
+    if constexpr (isRowMajor) {
+        // Rank one updates C += a_k^T b_k per row k, Jacobian rows are mostly zeros
+        matrix_parallel::forTiles(A.cols, B.cols, flops, [&](size_type r0, size_type r1, size_type c0, size_type c1) {
+            for (size_type i = r0; i < r1; ++i) {
+                std::fill(C.matrix[i] + c0, C.matrix[i] + c1, T(0));
+            }
+            for (size_type k = 0; k < A.rows; ++k) {
+                const T* a = A.matrix[k];
+                const T* b = B.matrix[k];
+                for (size_type i = r0; i < r1; ++i) {
+                    T aki = a[i];
+                    if (aki == T(0)) {
+                        continue;
+                    }
+                    T* c = C.matrix[i];
+                    for (size_type j = c0; j < c1; ++j) {
+                        c[j] += aki * b[j];
+                    }
+                }
+            }
+        });
+    } else {
+        // C(i, j) is the dot product of columns i of A and j of B
+        matrix_parallel::forTiles(A.cols, B.cols, flops, [&](size_type r0, size_type r1, size_type c0, size_type c1) {
+            for (size_type j = c0; j < c1; ++j) {
+                const T* b = B.matrix[j];
+                for (size_type i = r0; i < r1; ++i) {
+                    const T* a = A.matrix[i];
+                    T sum = matrix_kernels::dot(a, b, A.rows);
+                    C.matrix[j][i] = sum;
+                }
+            }
+        });
+    }
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::syrk(const Matrix<T, Layout, Alloc>& A, Matrix<T, Layout, Alloc>& C)
+{
+    if (&C == &A) {
+        throw std::invalid_argument("syrk: result must not alias the operand");
+    }
+    MATH_SCOPED_TIMER("Matrix::syrk");
+    size_type n = A.cols;
+    C.resize(n, n);
+    // Tiles below the diagonal have nothing to do
+    matrix_parallel::forTiles(n, n, 1.0 * A.rows * n * n,
+                              [&](size_type r0, size_type r1, size_type c0, size_type c1) {
+        if (c1 <= r0) {
+            return;
+        }
+        if constexpr (isRowMajor) {
+            for (size_type i = r0; i < r1; ++i) {
+                std::fill(C.matrix[i] + std::max(i, c0), C.matrix[i] + c1, T(0));
+            }
+            for (size_type k = 0; k < A.rows; ++k) {
+                const T* a = A.matrix[k];
+                for (size_type i = r0; i < r1; ++i) {
+                    T aki = a[i];
+                    if (aki == T(0)) {
+                        continue;
+                    }
+                    T* c = C.matrix[i];
+                    for (size_type j = std::max(i, c0); j < c1; ++j) {
+                        c[j] += aki * a[j];
+                    }
+                }
+            }
+        } else {
+            // Dot products of contiguous columns, C(i, j) is stored in column j
+            for (size_type j = c0; j < c1; ++j) {
+                const T* b = A.matrix[j];
+                for (size_type i = r0; i < std::min(r1, j + 1); ++i) {
+                    const T* a = A.matrix[i];
+                    T sum = matrix_kernels::dot(a, b, A.rows);
+                    C.matrix[j][i] = sum;
+                }
+            }
+        }
+    });
+    for (size_type i = 1; i < n; ++i) {
+        for (size_type j = 0; j < i; ++j) {
+            C.at(i, j) = C.at(j, i);
+        }
+    }
+}
+
+template <Arithmetic T, MatrixLayout Layout, MatrixAllocator Alloc>
+inline void Matrix<T, Layout, Alloc>::gemv_t(const Matrix<T, Layout, Alloc>& A, const Matrix<T, Layout, Alloc>& x, Matrix<T, Layout, Alloc>& y, const T& alpha, const T& beta)
+{
+    if (x.cols != 1 || A.rows != x.rows) {
+        throw std::invalid_argument("gemv_t: x must be a column vector with A.rows rows");
+    }
+    if (&y == &x || &y == &A) {
+        throw std::invalid_argument("gemv_t: result must not alias an operand");
+    }
+    if (beta == T(0)) {
+        y.resize(A.cols, 1);
+    } else if (y.rows != A.cols || y.cols != 1) {
+        throw std::invalid_argument("gemv_t: y must be a column vector with A.cols rows");
+    }
+    if (A.cols == 0) {
+        return;
+    }
+    const T* in = x.data();
+    T* out = y.data();
+    if constexpr (isRowMajor) {
+        // y += alpha x_k a_k^T row by row, y is one contiguous column; threads
+        // take disjoint ranges of y
+        matrix_parallel::forTiles(A.cols, 1, 2.0 * A.rows * A.cols, [&](size_type r0, size_type r1, size_type, size_type) {
+            for (size_type i = r0; i < r1; ++i) {
+                out[i] = beta == T(0) ? T(0) : beta * out[i];
+            }
+            for (size_type k = 0; k < A.rows; ++k) {
+                T xk = alpha * in[k];
+                if (xk == T(0)) {
+                    continue;
+                }
+                const T* a = A.matrix[k];
+                for (size_type i = r0; i < r1; ++i) {
+                    out[i] += xk * a[i];
+                }
+            }
+        }, matrix_parallel::kTileCols);
+    } else {
+        // y_i is the dot product of column i of A with x
+        matrix_parallel::forTiles(A.cols, 1, 2.0 * A.rows * A.cols, [&](size_type r0, size_type r1, size_type, size_type) {
+            for (size_type i = r0; i < r1; ++i) {
+                const T* a = A.matrix[i];
+                T sum = matrix_kernels::dot(a, in, A.rows);
+                out[i] = alpha * sum + (beta == T(0) ? T(0) : beta * out[i]);
+            }
+        });
+    }
+}
+
+// Matrix::determinant(), inverse() and adjugate() are built on them
+#include "decomposition/LU.h"
+#include "decomposition/SVD.h"
+
 #endif // ! MINIMIZEROPTIMIZER_HEADERS_MATRIX_H_
\ No newline at end of file
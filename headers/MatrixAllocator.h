@@ -0,0 +1,192 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_MATRIXALLOCATOR_H_
+#define MINIMIZEROPTIMIZER_HEADERS_MATRIXALLOCATOR_H_
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "Instrumentation.h"
+
+// Where Matrix buffers come from. An allocator is a stateless type:
+//   static void* allocate(size_t bytes);
+//   static void deallocate(void* p, size_t bytes);
+// deallocate() gets the byte count allocate() was called with.
+template <typename A>
+concept MatrixAllocator = requires(void* p, size_t bytes) {
+    { A::allocate(bytes) } -> std::same_as<void*>;
+    { A::deallocate(p, bytes) } -> std::same_as<void>;
+};
+
+// Every buffer from operator new
+struct HeapAllocator {
+    static void* allocate(size_t bytes) { return ::operator new(bytes); }
+    static void deallocate(void* p, size_t) { ::operator delete(p); }
+};
+
+// Per-thread cache of freed buffers in size classes, four per power of two
+// so a block is at most 25% larger than its request. Solver loops destroy
+// and recreate same-sized Hessians, gradients and Jacobians every
+// iteration; the second iteration on gets them from the free lists.
+//
+// A buffer may be released on another thread than it was taken on, it then
+// joins that thread's lists. The cache of a thread is freed at its exit.
+class BufferPool {
+public:
+    // Smallest and largest pooled classes, larger buffers bypass the pool
+    static constexpr size_t kMinClassBits = 6;
+    static constexpr size_t kMaxClassBits = 26;
+    // Freed buffers kept per class and in total, beyond that they are deleted
+    static constexpr size_t kMaxCachedPerClass = 8;
+    static constexpr size_t kMaxCachedBytes = size_t(64) << 20;
+
+    struct Stats {
+        int64_t hits = 0;
+        int64_t misses = 0;
+        size_t cachedBytes = 0;
+    };
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct FreeList {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+    };
+
+    // 2^kMinClassBits, then four classes in every following octave
+    static constexpr size_t kStepsPerOctave = 4;
+    static constexpr size_t kClasses = 1 + kStepsPerOctave * (kMaxClassBits - kMinClassBits);
+
+    std::array<FreeList, kClasses> m_lists{};
+    Stats m_stats;
+    bool* m_destroyed;
+
+    explicit BufferPool(bool* destroyed) : m_destroyed(destroyed) {}
+
+    // Class of a request, kClasses when it is too large to pool. Octave
+    // (2^(bits-1), 2^bits] is cut in steps of 2^(bits-3).
+    static size_t classOf(size_t bytes) {
+        size_t bits = std::bit_width(bytes - 1);
+        if (bits <= kMinClassBits) {
+            return 0;
+        }
+        if (bits > kMaxClassBits) {
+            return kClasses;
+        }
+        size_t step = size_t(1) << (bits - 3);
+        size_t steps = (bytes - (size_t(1) << (bits - 1)) + step - 1) / step;
+        return 1 + kStepsPerOctave * (bits - kMinClassBits - 1) + (steps - 1);
+    }
+
+    static size_t classBytes(size_t c) {
+        if (c == 0) {
+            return size_t(1) << kMinClassBits;
+        }
+        size_t bits = kMinClassBits + 1 + (c - 1) / kStepsPerOctave;
+        size_t steps = (c - 1) % kStepsPerOctave + 1;
+        return (size_t(1) << (bits - 1)) + steps * (size_t(1) << (bits - 3));
+    }
+
+public:
+    // Bytes of the block newBlock() allocates for a request
+    static size_t blockBytes(size_t bytes) {
+        size_t c = classOf(bytes);
+        return c == kClasses ? bytes : classBytes(c);
+    }
+
+    // A block for bytes rounded up to its class, so any pool can cache it
+    static void* newBlock(size_t bytes) { return ::operator new(blockBytes(bytes)); }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    ~BufferPool() {
+        trim();
+        *m_destroyed = true;
+    }
+
+    // The pool of the calling thread, nullptr while the thread is exiting
+    // after the pool was destroyed
+    static BufferPool* local() {
+        static thread_local bool destroyed = false;
+        if (destroyed) {
+            return nullptr;
+        }
+        static thread_local BufferPool pool(&destroyed);
+        return &pool;
+    }
+
+    void* take(size_t bytes) {
+        size_t c = classOf(bytes);
+        if (c == kClasses) {
+            return newBlock(bytes);
+        }
+        FreeList& list = m_lists[c];
+        if (list.head != nullptr) {
+            FreeBlock* block = list.head;
+            list.head = block->next;
+            --list.count;
+            m_stats.cachedBytes -= classBytes(c);
+            ++m_stats.hits;
+            MATH_COUNTER_ADD("BufferPool::hits", 1);
+            return block;
+        }
+        ++m_stats.misses;
+        MATH_COUNTER_ADD("BufferPool::misses", 1);
+        return newBlock(bytes);
+    }
+
+    void give(void* p, size_t bytes) {
+        size_t c = classOf(bytes);
+        if (c == kClasses) {
+            ::operator delete(p);
+            return;
+        }
+        FreeList& list = m_lists[c];
+        if (list.count == kMaxCachedPerClass || m_stats.cachedBytes + classBytes(c) > kMaxCachedBytes) {
+            ::operator delete(p);
+            return;
+        }
+        FreeBlock* block = ::new (p) FreeBlock{list.head};
+        list.head = block;
+        ++list.count;
+        m_stats.cachedBytes += classBytes(c);
+    }
+
+    // Deletes the cached buffers of this thread
+    void trim() {
+        for (FreeList& list : m_lists) {
+            while (list.head != nullptr) {
+                FreeBlock* next = list.head->next;
+                ::operator delete(list.head);
+                list.head = next;
+            }
+            list.count = 0;
+        }
+        m_stats.cachedBytes = 0;
+    }
+
+    const Stats& stats() const { return m_stats; }
+};
+
+// Buffers from the BufferPool of the calling thread, the Matrix default
+struct PooledAllocator {
+    static void* allocate(size_t bytes) {
+        BufferPool* pool = BufferPool::local();
+        return pool ? pool->take(bytes) : BufferPool::newBlock(bytes);
+    }
+    static void deallocate(void* p, size_t bytes) {
+        BufferPool* pool = BufferPool::local();
+        if (pool) {
+            pool->give(p, bytes);
+        } else {
+            ::operator delete(p);
+        }
+    }
+};
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_MATRIXALLOCATOR_H_
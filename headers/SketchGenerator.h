@@ -0,0 +1,82 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_SKETCHGENERATOR_H_
+#define MINIMIZEROPTIMIZER_HEADERS_SKETCHGENERATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "Function.h"
+#include "LSMTask.h"
+
+// Deterministic generator of synthetic CAD sketches for solver tests and
+// benchmarks. A sketch consists of polylines (points joined by sections) and
+// circles, constrained with the ErrorFunctions types: section lengths and
+// point distances, parallel / perpendicular / angle relations between
+// sections and points lying on circles.
+//
+// The constraints are measured on a consistent "true" geometry, so every
+// sketch has an exact solution with zero error; the start values are that
+// solution plus noise. The same options always produce the same sketch.
+
+struct SketchOptions {
+    unsigned seed = 0;
+    // Exact number of variables in the sketch (points have 2, circles 3)
+    size_t variableCount = 100;
+    // Extra constraints between different sections per section
+    double couplingDensity = 0.5;
+    // Share of constraints duplicated on top of the generated ones
+    double redundancy = 0.0;
+    // Noise of the start values relative to a typical section length
+    double perturbation = 0.05;
+};
+
+class Sketch {
+    VariableStore m_store;
+    std::vector<double> m_solution;
+    std::vector<Variable *> m_X;
+    std::vector<Function *> m_constraints;
+    size_t m_points = 0;
+    size_t m_sections = 0;
+    size_t m_circles = 0;
+
+    friend class SketchGenerator;
+
+public:
+    Sketch() = default;
+    ~Sketch();
+
+    Sketch(const Sketch &) = delete;
+    Sketch &operator=(const Sketch &) = delete;
+
+    const std::vector<Variable *> &variables() const { return m_X; }
+
+    // Values of the variables, in order
+    const VariableStore &store() const { return m_store; }
+
+    const std::vector<Function *> &constraints() const { return m_constraints; }
+
+    std::vector<double> values() const;
+
+    // The geometry every constraint was measured on
+    const std::vector<double> &solution() const { return m_solution; }
+
+    void setValues(const std::vector<double> &x);
+
+    size_t pointCount() const { return m_points; }
+    size_t sectionCount() const { return m_sections; }
+    size_t circleCount() const { return m_circles; }
+
+    // Hands the constraints over to a new LSMTask, which deletes them. The
+    // sketch keeps owning the variables and must outlive the task.
+    std::unique_ptr<LSMTask> makeTask(Differentiation differentiation = Differentiation::Symbolic);
+};
+
+class SketchGenerator {
+    SketchOptions m_options;
+
+public:
+    explicit SketchGenerator(const SketchOptions &options);
+
+    std::unique_ptr<Sketch> generate() const;
+};
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_SKETCHGENERATOR_H_
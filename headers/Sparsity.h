@@ -0,0 +1,90 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_SPARSITY_H_
+#define MINIMIZEROPTIMIZER_HEADERS_SPARSITY_H_
+
+#include <cstddef>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "Function.h"
+
+// Structural nonzeros of a rows x cols matrix in compressed row form: the
+// column indices of row i are sorted and unique. An entry outside the pattern
+// is zero for every value of the variables.
+class SparsityPattern {
+    size_t m_rows = 0;
+    size_t m_cols = 0;
+    std::vector<size_t> m_offsets = {0};
+    std::vector<size_t> m_columns;
+
+public:
+    SparsityPattern() = default;
+
+    // Column lists of every row, they are sorted and deduplicated here
+    SparsityPattern(size_t cols, std::vector<std::vector<size_t>> rows);
+
+    // Every entry of a rows x cols matrix
+    static SparsityPattern dense(size_t rows, size_t cols);
+
+    size_t rows() const { return m_rows; }
+    size_t cols() const { return m_cols; }
+    size_t nonZeros() const { return m_columns.size(); }
+
+    // Share of structural nonzeros, 1 for a dense pattern
+    double density() const;
+
+    std::span<const size_t> row(size_t i) const {
+        return {m_columns.data() + m_offsets[i], m_offsets[i + 1] - m_offsets[i]};
+    }
+
+    bool contains(size_t i, size_t j) const;
+
+    // Pattern of the transpose, row j lists the rows holding column j
+    SparsityPattern transpose() const;
+
+    // Pattern of the Hessian of sum_i f_i^2 for the Jacobian pattern of the
+    // f_i: (j, k) is a nonzero when some f_i depends on both. It also covers
+    // the Gauss-Newton matrix J^T J.
+    SparsityPattern hessianOfSquares() const;
+
+    bool operator==(const SparsityPattern& other) const = default;
+};
+
+// Curtis-Powell-Reid grouping of the columns of a Jacobian pattern: columns
+// of one color share no row, so one perturbation of all of them yields every
+// column of the group from a single residual evaluation. Greedy, columns
+// with more nonzeros are colored first; the count is at least the longest
+// row of the pattern.
+struct ColumnColoring {
+    std::vector<size_t> colorOf;
+    std::vector<std::vector<size_t>> groups;
+
+    ColumnColoring() = default;
+    explicit ColumnColoring(const SparsityPattern& pattern);
+
+    size_t colorCount() const { return groups.size(); }
+};
+
+// Which of the variables x a Function reads. Variables are matched by the
+// double they refer to, so derivatives and clones with their own Variable
+// nodes count; variables outside x are ignored. Every node below a root is
+// visited once, shared subgraphs included, so the cost is linear in the node
+// count of the graph.
+class DependencyAnalysis {
+    std::unordered_map<const double*, size_t> m_index;
+    // Pass a variable was last collected in, collects each of them once
+    std::vector<size_t> m_seenInPass;
+    size_t m_pass = 0;
+    std::vector<const Function*> m_stack;
+
+public:
+    explicit DependencyAnalysis(const std::vector<Variable*>& x);
+
+    // Sorted indices into x of the variables f depends on
+    std::vector<size_t> dependencies(const Function* f);
+
+    // Row i lists the dependencies of functions[i]
+    SparsityPattern jacobianPattern(const std::vector<Function*>& functions);
+};
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_SPARSITY_H_
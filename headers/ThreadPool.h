@@ -0,0 +1,78 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_THREADPOOL_H_
+#define MINIMIZEROPTIMIZER_HEADERS_THREADPOOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data parallel loops, shared by the Matrix
+// kernels (see Matrix.h). parallelFor() hands out the indices of one loop
+// to the workers and to the calling thread and returns when all are done.
+//
+// There is no nested parallelism: a parallelFor() from inside a loop body,
+// from a pool worker, under a SerialScope or while another thread is using
+// the pool runs serially on the calling thread. Code that already runs on
+// its own threads (e.g. parallel task assembly) opens a SerialScope so the
+// Matrix kernels it calls do not oversubscribe the cores.
+//
+// The shared pool starts with std::thread::hardware_concurrency() threads,
+// or with MATH_THREADS when that environment variable is set.
+
+class ThreadPool {
+    struct Job;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    // Held by the thread whose loop is running, one loop at a time
+    std::mutex m_submit;
+    Job *m_job = nullptr;
+    size_t m_generation = 0;
+    size_t m_active = 0;
+    bool m_stop = false;
+
+    void start(size_t threads);
+    void stop();
+    void workerLoop();
+    static void run(Job &job);
+
+public:
+    // Total threads including the caller, 0 picks hardware_concurrency()
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    static ThreadPool &shared();
+
+    // Threads that take part in a loop, the caller included
+    size_t threadCount() const { return m_workers.size() + 1; }
+
+    // Restarts the workers, 1 makes every loop serial. Must not be called
+    // while a loop is running.
+    void setThreadCount(size_t threads);
+
+    // Calls body(i) for every i in [0, count), in no particular order. The
+    // first exception thrown by a body is rethrown once all indices are done.
+    void parallelFor(size_t count, const std::function<void(size_t)> &body);
+
+    // True on pool workers, inside a loop body and under a SerialScope
+    static bool inParallelRegion();
+
+    // Keeps parallelFor() serial on this thread while alive
+    class SerialScope {
+    public:
+        SerialScope();
+        ~SerialScope();
+
+        SerialScope(const SerialScope &) = delete;
+        SerialScope &operator=(const SerialScope &) = delete;
+    };
+};
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_THREADPOOL_H_
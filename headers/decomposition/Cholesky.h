@@ -0,0 +1,225 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_CHOLESKY_H_
+#define MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_CHOLESKY_H_
+
+#include <cmath>
+#include <concepts>
+#include <stdexcept>
+#include "Matrix.h"
+
+// A + shift * I = L L^T for a symmetric positive definite A, only the lower
+// triangle of A is read.
+// Right-looking and blocked like LU: the diagonal block of a panel of
+// kBlockSize columns is factorized, the panel below it solved, and the
+// trailing lower triangle gets one rank-kBlockSize update. All inner loops
+// are dot products of contiguous row segments.
+//
+// A copy of A is kept, so refactorize() can try another diagonal shift
+// (the Levenberg-Marquardt damping) without the caller assembling A again.
+// Neither allocates once the size is fixed.
+
+template <std::floating_point T = double>
+class Cholesky {
+public:
+    using size_type = typename Matrix<T>::size_type;
+
+    static constexpr size_type kBlockSize = 32;
+
+private:
+    Matrix<T> _A;
+    Matrix<T> _L;
+    T _shift = T(0);
+    bool _positiveDefinite = false;
+
+    void decompose();
+    // Factorizes the lower triangle of rows [start, end) against columns [start, end)
+    bool factorBlock(size_type start, size_type end);
+
+public:
+    // Empty, factorize() must be called before use
+    Cholesky() = default;
+
+    explicit Cholesky(const Matrix<T>& A, T shift = T(0));
+
+    // A must be square
+    void factorize(const Matrix<T>& A, T shift = T(0));
+
+    // Factorizes A + shift * I for the A of the last factorize()
+    void refactorize(T shift);
+
+    size_type size() const { return _A.rows_size(); }
+    T shift() const { return _shift; }
+
+    // False when a pivot was not positive, the factor is then unusable
+    bool isPositiveDefinite() const { return _positiveDefinite; }
+
+    Matrix<T> L() const;
+
+    T determinant() const;
+
+    // x = (A + shift * I)^{-1} b. Throws if A is not positive definite.
+    void solveInto(const Matrix<T>& b, Matrix<T>& x) const;
+    Matrix<T> solve(const Matrix<T>& b) const;
+};
+
+template <std::floating_point T>
+Cholesky<T>::Cholesky(const Matrix<T>& A, T shift)
+{
+    factorize(A, shift);
+}
+
+template <std::floating_point T>
+void Cholesky<T>::factorize(const Matrix<T>& A, T shift)
+{
+    if (A.rows_size() != A.cols_size()) {
+        throw std::invalid_argument("Cholesky: matrix must be square");
+    }
+    if (A.rows_size() == 0) {
+        throw std::runtime_error("Cholesky: matrix is empty");
+    }
+    _A = A;
+    _shift = shift;
+    decompose();
+}
+
+template <std::floating_point T>
+void Cholesky<T>::refactorize(T shift)
+{
+    if (_A.rows_size() == 0) {
+        throw std::runtime_error("Cholesky: nothing was factorized");
+    }
+    _shift = shift;
+    decompose();
+}
+
+template <std::floating_point T>
+void Cholesky<T>::decompose()
+{
+    size_type n = _A.rows_size();
+    MATH_SCOPED_TIMER("Cholesky::factorize");
+    MATH_HISTOGRAM_RECORD("Cholesky::factorize.size", n);
+
+    _L.resize(n, n);
+    T** a = _A.matrix;
+    T** l = _L.matrix;
+    for (size_type i = 0; i < n; ++i) {
+        std::copy(a[i], a[i] + i + 1, l[i]);
+        std::fill(l[i] + i + 1, l[i] + n, T(0));
+        l[i][i] += _shift;
+    }
+
+    _positiveDefinite = false;
+    for (size_type start = 0; start < n; start += kBlockSize) {
+        size_type end = std::min(start + kBlockSize, n);
+        if (!factorBlock(start, end)) {
+            return;
+        }
+        // L21 = A21 L11^{-T}
+        for (size_type i = end; i < n; ++i) {
+            for (size_type j = start; j < end; ++j) {
+                T s = l[i][j] - matrix_kernels::dot(l[i] + start, l[j] + start, j - start);
+                l[i][j] = s / l[j][j];
+            }
+        }
+        // A22 -= L21 L21^T, lower triangle only
+        for (size_type i = end; i < n; ++i) {
+            for (size_type j = end; j <= i; ++j) {
+                l[i][j] -= matrix_kernels::dot(l[i] + start, l[j] + start, end - start);
+            }
+        }
+    }
+    _positiveDefinite = true;
+}
+
+template <std::floating_point T>
+bool Cholesky<T>::factorBlock(size_type start, size_type end)
+{
+    T** l = _L.matrix;
+    for (size_type i = start; i < end; ++i) {
+        for (size_type j = start; j <= i; ++j) {
+            T s = l[i][j];
+            for (size_type k = start; k < j; ++k) {
+                s -= l[i][k] * l[j][k];
+            }
+            if (i != j) {
+                l[i][j] = s / l[j][j];
+            } else if (s > T(0)) {
+                l[i][i] = std::sqrt(s);
+            } else {
+                // not positive, or NaN
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <std::floating_point T>
+Matrix<T> Cholesky<T>::L() const
+{
+    return _L;
+}
+
+template <std::floating_point T>
+T Cholesky<T>::determinant() const
+{
+    if (!_positiveDefinite) {
+        throw std::runtime_error("Cholesky: matrix is not positive definite");
+    }
+    T d = T(1);
+    for (size_type i = 0; i < _L.rows_size(); ++i) {
+        d *= _L.matrix[i][i] * _L.matrix[i][i];
+    }
+    return d;
+}
+
+template <std::floating_point T>
+void Cholesky<T>::solveInto(const Matrix<T>& b, Matrix<T>& x) const
+{
+    size_type n = _L.rows_size();
+    if (b.rows_size() != n) {
+        throw std::invalid_argument("Cholesky::solve: b must have as many rows as A");
+    }
+    if (!_positiveDefinite) {
+        throw std::runtime_error("Cholesky::solve: matrix is not positive definite");
+    }
+    MATH_SCOPED_TIMER("Cholesky::solve");
+
+    size_type k = b.cols_size();
+    if (&b != &x) {
+        x = b;
+    }
+    T** l = _L.matrix;
+    T** y = x.matrix;
+    // L y = b
+    for (size_type i = 0; i < n; ++i) {
+        for (size_type j = 0; j < i; ++j) {
+            for (size_type c = 0; c < k; ++c) {
+                y[i][c] -= l[i][j] * y[j][c];
+            }
+        }
+        for (size_type c = 0; c < k; ++c) {
+            y[i][c] /= l[i][i];
+        }
+    }
+    // L^T x = y, row i of L^T is column i of L
+    for (size_type i = n; i-- > 0;) {
+        for (size_type c = 0; c < k; ++c) {
+            y[i][c] /= l[i][i];
+        }
+        for (size_type j = 0; j < i; ++j) {
+            for (size_type c = 0; c < k; ++c) {
+                y[j][c] -= l[i][j] * y[i][c];
+            }
+        }
+    }
+}
+
+template <std::floating_point T>
+Matrix<T> Cholesky<T>::solve(const Matrix<T>& b) const
+{
+    Matrix<T> x;
+    solveInto(b, x);
+    return x;
+}
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_CHOLESKY_H_
@@ -0,0 +1,208 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LDLT_H_
+#define MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LDLT_H_
+
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "Matrix.h"
+
+// A + shift * I = L D L^T with unit lower triangular L and diagonal D, for a
+// symmetric positive semidefinite A such as J^T J of a rank deficient
+// Jacobian. Only the lower triangle of A is read, there is no pivoting.
+//
+// A pivot not larger than n * epsilon * max|a_ii| is taken as zero: its
+// column of L is dropped and solve() sets the matching component to zero,
+// which still solves A x = b for every b in the range of A (though not with
+// the minimum norm x). Cholesky is cheaper for definite matrices.
+//
+// Rows are computed one after another (Crout order), every inner loop is
+// a dot product of contiguous row segments.
+
+template <std::floating_point T = double>
+class LDLT {
+public:
+    using size_type = typename Matrix<T>::size_type;
+
+private:
+    Matrix<T> _A;
+    Matrix<T> _L;
+    std::vector<T> _D;
+    // Row i of L scaled by D, one row at a time
+    std::vector<T> _work;
+    T _shift = T(0);
+    size_type _rank = 0;
+    bool _negativePivot = false;
+
+    void decompose();
+
+public:
+    // Empty, factorize() must be called before use
+    LDLT() = default;
+
+    explicit LDLT(const Matrix<T>& A, T shift = T(0));
+
+    // A must be square
+    void factorize(const Matrix<T>& A, T shift = T(0));
+
+    // Factorizes A + shift * I for the A of the last factorize()
+    void refactorize(T shift);
+
+    size_type size() const { return _A.rows_size(); }
+    T shift() const { return _shift; }
+
+    // Number of nonzero pivots
+    size_type rank() const { return _rank; }
+
+    bool isPositiveSemidefinite() const { return !_negativePivot; }
+
+    Matrix<T> L() const;
+    const std::vector<T>& D() const { return _D; }
+
+    // x = (A + shift * I)^{+} b, zero pivots give zero components
+    void solveInto(const Matrix<T>& b, Matrix<T>& x) const;
+    Matrix<T> solve(const Matrix<T>& b) const;
+};
+
+template <std::floating_point T>
+LDLT<T>::LDLT(const Matrix<T>& A, T shift)
+{
+    factorize(A, shift);
+}
+
+template <std::floating_point T>
+void LDLT<T>::factorize(const Matrix<T>& A, T shift)
+{
+    if (A.rows_size() != A.cols_size()) {
+        throw std::invalid_argument("LDLT: matrix must be square");
+    }
+    if (A.rows_size() == 0) {
+        throw std::runtime_error("LDLT: matrix is empty");
+    }
+    _A = A;
+    _shift = shift;
+    decompose();
+}
+
+template <std::floating_point T>
+void LDLT<T>::refactorize(T shift)
+{
+    if (_A.rows_size() == 0) {
+        throw std::runtime_error("LDLT: nothing was factorized");
+    }
+    _shift = shift;
+    decompose();
+}
+
+template <std::floating_point T>
+void LDLT<T>::decompose()
+{
+    size_type n = _A.rows_size();
+    MATH_SCOPED_TIMER("LDLT::factorize");
+    MATH_HISTOGRAM_RECORD("LDLT::factorize.size", n);
+
+    _L.resize(n, n);
+    _D.resize(n);
+    _work.resize(n);
+    T** a = _A.matrix;
+    T** l = _L.matrix;
+
+    T maxDiagonal = T(0);
+    for (size_type i = 0; i < n; ++i) {
+        maxDiagonal = std::max(maxDiagonal, std::abs(a[i][i] + _shift));
+    }
+    T tolerance = static_cast<T>(n) * std::numeric_limits<T>::epsilon() * maxDiagonal;
+
+    _rank = 0;
+    _negativePivot = false;
+    T* w = _work.data();
+    for (size_type i = 0; i < n; ++i) {
+        for (size_type j = 0; j < i; ++j) {
+            // w_j = l_ij d_j
+            T s = a[i][j];
+            for (size_type k = 0; k < j; ++k) {
+                s -= w[k] * l[j][k];
+            }
+            w[j] = s;
+            l[i][j] = _D[j] == T(0) ? T(0) : s / _D[j];
+        }
+        T d = a[i][i] + _shift;
+        for (size_type k = 0; k < i; ++k) {
+            d -= w[k] * l[i][k];
+        }
+        if (std::abs(d) <= tolerance) {
+            // the column of L below is dropped by the _D[j] == 0 check
+            d = T(0);
+        } else {
+            ++_rank;
+            _negativePivot = _negativePivot || d < T(0);
+        }
+        _D[i] = d;
+        l[i][i] = T(1);
+        std::fill(l[i] + i + 1, l[i] + n, T(0));
+    }
+}
+
+template <std::floating_point T>
+Matrix<T> LDLT<T>::L() const
+{
+    return _L;
+}
+
+template <std::floating_point T>
+void LDLT<T>::solveInto(const Matrix<T>& b, Matrix<T>& x) const
+{
+    size_type n = _L.rows_size();
+    if (b.rows_size() != n) {
+        throw std::invalid_argument("LDLT::solve: b must have as many rows as A");
+    }
+    MATH_SCOPED_TIMER("LDLT::solve");
+
+    size_type k = b.cols_size();
+    if (&b != &x) {
+        x = b;
+    }
+    T** l = _L.matrix;
+    T** y = x.matrix;
+    // L z = b
+    for (size_type i = 1; i < n; ++i) {
+        for (size_type j = 0; j < i; ++j) {
+            T lij = l[i][j];
+            if (lij == T(0)) {
+                continue;
+            }
+            for (size_type c = 0; c < k; ++c) {
+                y[i][c] -= lij * y[j][c];
+            }
+        }
+    }
+    // D y = z
+    for (size_type i = 0; i < n; ++i) {
+        for (size_type c = 0; c < k; ++c) {
+            y[i][c] = _D[i] == T(0) ? T(0) : y[i][c] / _D[i];
+        }
+    }
+    // L^T x = y
+    for (size_type i = n; i-- > 0;) {
+        for (size_type j = 0; j < i; ++j) {
+            T lij = l[i][j];
+            if (lij == T(0)) {
+                continue;
+            }
+            for (size_type c = 0; c < k; ++c) {
+                y[j][c] -= lij * y[i][c];
+            }
+        }
+    }
+}
+
+template <std::floating_point T>
+Matrix<T> LDLT<T>::solve(const Matrix<T>& b) const
+{
+    Matrix<T> x;
+    solveInto(b, x);
+    return x;
+}
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LDLT_H_
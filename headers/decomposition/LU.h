@@ -0,0 +1,309 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LU_H_
+#define MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LU_H_
+
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Matrix.h"
+
+// PA = LU with partial (row) pivoting.
+// L is unit lower triangular and U upper triangular, both stored in one
+// matrix. The factorization is right-looking and blocked: a panel of
+// kBlockSize columns is eliminated column by column, then the rows of U to
+// its right are solved and the trailing matrix gets a single rank-kBlockSize
+// update, which is where almost all of the flops are spent.
+//
+// determinant(), solve() and inverse() reuse one factorization, and
+// factorize() keeps the buffers when the size is unchanged.
+
+template <std::floating_point T = double>
+class LU {
+public:
+    using size_type = typename Matrix<T>::size_type;
+
+    static constexpr size_type kBlockSize = 32;
+
+private:
+    Matrix<T> _LU;
+    // Row i of PA is row _P[i] of A
+    std::vector<size_type> _P;
+    // Zero pivot threshold of every column
+    std::vector<T> _tolerance;
+    int _sign = 1;
+    bool _singular = false;
+
+    void factorPanel(size_type start, size_type end);
+    void updateTrailing(size_type start, size_type end);
+    void swapRows(size_type i, size_type j);
+
+public:
+    // Empty, factorize() must be called before use
+    LU() = default;
+
+    // A must be square
+    template <Arithmetic S>
+    explicit LU(const Matrix<S>& A);
+
+    template <Arithmetic S>
+    void factorize(const Matrix<S>& A);
+
+    size_type size() const { return _LU.rows_size(); }
+
+    // A pivot not larger than n * epsilon * max_i |a_ij| of its column j
+    // counts as zero, so scaling a column does not change the answer
+    bool isSingular() const { return _singular; }
+
+    // Zero for a singular matrix
+    T determinant() const;
+
+    Matrix<T> L() const;
+    Matrix<T> U() const;
+    Matrix<T> P() const;
+    const std::vector<size_type>& permutation() const { return _P; }
+
+    // x = A^{-1} b for every column of b. Throws for a singular matrix.
+    void solveInto(const Matrix<T>& b, Matrix<T>& x) const;
+    Matrix<T> solve(const Matrix<T>& b) const;
+
+    Matrix<T> inverse() const;
+};
+
+template <std::floating_point T>
+template <Arithmetic S>
+LU<T>::LU(const Matrix<S>& A)
+{
+    factorize(A);
+}
+
+template <std::floating_point T>
+template <Arithmetic S>
+void LU<T>::factorize(const Matrix<S>& A)
+{
+    size_type n = A.rows_size();
+    if (n != A.cols_size()) {
+        throw std::invalid_argument("LU: matrix must be square");
+    }
+    if (n == 0) {
+        throw std::runtime_error("LU: matrix is empty");
+    }
+    MATH_SCOPED_TIMER("LU::factorize");
+    MATH_HISTOGRAM_RECORD("LU::factorize.size", n);
+
+    _LU.resize(n, n);
+    _P.resize(n);
+    _tolerance.assign(n, T(0));
+    for (size_type i = 0; i < n; ++i) {
+        for (size_type j = 0; j < n; ++j) {
+            _LU.matrix[i][j] = static_cast<T>(A.matrix[i][j]);
+            _tolerance[j] = std::max(_tolerance[j], std::abs(_LU.matrix[i][j]));
+        }
+        _P[i] = i;
+    }
+    for (T& tolerance : _tolerance) {
+        tolerance *= static_cast<T>(n) * std::numeric_limits<T>::epsilon();
+    }
+    _sign = 1;
+    _singular = false;
+
+    for (size_type start = 0; start < n; start += kBlockSize) {
+        size_type end = std::min(start + kBlockSize, n);
+        factorPanel(start, end);
+        updateTrailing(start, end);
+    }
+}
+
+template <std::floating_point T>
+void LU<T>::swapRows(size_type i, size_type j)
+{
+    std::swap_ranges(_LU.matrix[i], _LU.matrix[i] + _LU.cols_size(), _LU.matrix[j]);
+    std::swap(_P[i], _P[j]);
+    _sign = -_sign;
+}
+
+// Unblocked elimination of columns [start, end), touching only those columns
+template <std::floating_point T>
+void LU<T>::factorPanel(size_type start, size_type end)
+{
+    size_type n = _LU.rows_size();
+    T** a = _LU.matrix;
+    for (size_type j = start; j < end; ++j) {
+        size_type pivot = j;
+        for (size_type i = j + 1; i < n; ++i) {
+            if (std::abs(a[i][j]) > std::abs(a[pivot][j])) {
+                pivot = i;
+            }
+        }
+        if (pivot != j) {
+            swapRows(j, pivot);
+        }
+        // NaN pivots fail too
+        if (!(std::abs(a[j][j]) > _tolerance[j])) {
+            // Nothing to eliminate with, the column of L stays zero
+            _singular = true;
+            for (size_type i = j + 1; i < n; ++i) {
+                a[i][j] = T(0);
+            }
+            continue;
+        }
+        for (size_type i = j + 1; i < n; ++i) {
+            T l = a[i][j] / a[j][j];
+            a[i][j] = l;
+            for (size_type c = j + 1; c < end; ++c) {
+                a[i][c] -= l * a[j][c];
+            }
+        }
+    }
+}
+
+// U12 = L11^{-1} A12, then A22 -= L21 * U12
+template <std::floating_point T>
+void LU<T>::updateTrailing(size_type start, size_type end)
+{
+    size_type n = _LU.rows_size();
+    if (end == n) {
+        return;
+    }
+    T** a = _LU.matrix;
+    for (size_type r = start + 1; r < end; ++r) {
+        for (size_type k = start; k < r; ++k) {
+            T l = a[r][k];
+            if (l == T(0)) {
+                continue;
+            }
+            for (size_type c = end; c < n; ++c) {
+                a[r][c] -= l * a[k][c];
+            }
+        }
+    }
+    for (size_type i = end; i < n; ++i) {
+        for (size_type k = start; k < end; ++k) {
+            T l = a[i][k];
+            if (l == T(0)) {
+                continue;
+            }
+            for (size_type c = end; c < n; ++c) {
+                a[i][c] -= l * a[k][c];
+            }
+        }
+    }
+}
+
+template <std::floating_point T>
+T LU<T>::determinant() const
+{
+    if (_singular) {
+        return T(0);
+    }
+    T d = static_cast<T>(_sign);
+    for (size_type i = 0; i < _LU.rows_size(); ++i) {
+        d *= _LU.matrix[i][i];
+    }
+    return d;
+}
+
+template <std::floating_point T>
+Matrix<T> LU<T>::L() const
+{
+    size_type n = _LU.rows_size();
+    Matrix<T> res(n, n);
+    for (size_type i = 0; i < n; ++i) {
+        for (size_type j = 0; j < i; ++j) {
+            res.matrix[i][j] = _LU.matrix[i][j];
+        }
+        res.matrix[i][i] = T(1);
+    }
+    return res;
+}
+
+template <std::floating_point T>
+Matrix<T> LU<T>::U() const
+{
+    size_type n = _LU.rows_size();
+    Matrix<T> res(n, n);
+    for (size_type i = 0; i < n; ++i) {
+        for (size_type j = i; j < n; ++j) {
+            res.matrix[i][j] = _LU.matrix[i][j];
+        }
+    }
+    return res;
+}
+
+template <std::floating_point T>
+Matrix<T> LU<T>::P() const
+{
+    size_type n = _LU.rows_size();
+    Matrix<T> res(n, n);
+    for (size_type i = 0; i < n; ++i) {
+        res.matrix[i][_P[i]] = T(1);
+    }
+    return res;
+}
+
+template <std::floating_point T>
+void LU<T>::solveInto(const Matrix<T>& b, Matrix<T>& x) const
+{
+    size_type n = _LU.rows_size();
+    if (b.rows_size() != n) {
+        throw std::invalid_argument("LU::solve: b must have as many rows as A");
+    }
+    if (_singular) {
+        throw std::runtime_error("LU::solve: matrix is singular");
+    }
+    if (&b == &x) {
+        throw std::invalid_argument("LU::solve: b and x must be different matrices");
+    }
+    MATH_SCOPED_TIMER("LU::solve");
+
+    size_type k = b.cols_size();
+    x.resize(n, k);
+    T** a = _LU.matrix;
+    T** y = x.matrix;
+    for (size_type i = 0; i < n; ++i) {
+        std::copy(b.matrix[_P[i]], b.matrix[_P[i]] + k, y[i]);
+    }
+    // L y = P b
+    for (size_type i = 1; i < n; ++i) {
+        for (size_type j = 0; j < i; ++j) {
+            T l = a[i][j];
+            if (l == T(0)) {
+                continue;
+            }
+            for (size_type c = 0; c < k; ++c) {
+                y[i][c] -= l * y[j][c];
+            }
+        }
+    }
+    // U x = y
+    for (size_type i = n; i-- > 0;) {
+        for (size_type j = i + 1; j < n; ++j) {
+            T u = a[i][j];
+            for (size_type c = 0; c < k; ++c) {
+                y[i][c] -= u * y[j][c];
+            }
+        }
+        for (size_type c = 0; c < k; ++c) {
+            y[i][c] /= a[i][i];
+        }
+    }
+}
+
+template <std::floating_point T>
+Matrix<T> LU<T>::solve(const Matrix<T>& b) const
+{
+    Matrix<T> x;
+    solveInto(b, x);
+    return x;
+}
+
+template <std::floating_point T>
+Matrix<T> LU<T>::inverse() const
+{
+    Matrix<T> x;
+    solveInto(Matrix<T>::identity(_LU.rows_size()), x);
+    return x;
+}
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LU_H_
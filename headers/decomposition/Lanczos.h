@@ -0,0 +1,191 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LANCZOS_H_
+#define MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LANCZOS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "Matrix.h"
+#include "SymmetricEigen.h"
+
+// A few of the smallest or largest eigenpairs of a symmetric n x n operator
+// that is only available as a product y = A x, e.g. a large sparse Hessian.
+//
+// Runs `steps` Lanczos iterations from a seeded start vector with full
+// reorthogonalization of the Krylov basis, then takes the Ritz pairs of
+// the projected tridiagonal matrix (SymmetricEigen::tridiagonalQL). There
+// are no restarts: more steps give more accurate pairs, and the residual
+// norms |A y - theta y| tell how far each pair is from converged.
+
+enum class LanczosWhich {
+    Smallest,
+    Largest
+};
+
+template <std::floating_point T = double>
+class Lanczos {
+public:
+    using size_type = typename Matrix<T>::size_type;
+
+    static constexpr unsigned kSeed = 12345;
+
+private:
+    std::vector<T> _values;
+    Matrix<T> _vectors;
+    std::vector<T> _residuals;
+
+public:
+    Lanczos() = default;
+
+    // apply(x, y) writes y = A x for pointers to n values. steps == 0 picks
+    // max(2 * count + 20, 40), capped at n.
+    template <typename Apply>
+    void compute(size_type n, Apply&& apply, size_type count,
+                 LanczosWhich which = LanczosWhich::Smallest, size_type steps = 0);
+
+    // For a dense symmetric matrix
+    void compute(const Matrix<T>& A, size_type count,
+                 LanczosWhich which = LanczosWhich::Smallest, size_type steps = 0);
+
+    // Ascending for Smallest, descending for Largest
+    const std::vector<T>& eigenvalues() const { return _values; }
+
+    // n x count, column i belongs to eigenvalues()[i]
+    const Matrix<T>& eigenvectors() const { return _vectors; }
+
+    // |A y_i - theta_i y_i| of every pair
+    const std::vector<T>& residuals() const { return _residuals; }
+};
+
+template <std::floating_point T>
+template <typename Apply>
+void Lanczos<T>::compute(size_type n, Apply&& apply, size_type count, LanczosWhich which, size_type steps)
+{
+    if (n == 0) {
+        throw std::runtime_error("Lanczos: operator is empty");
+    }
+    if (count == 0 || count > n) {
+        throw std::invalid_argument("Lanczos: count must be in [1, n]");
+    }
+    MATH_SCOPED_TIMER("Lanczos::compute");
+    if (steps == 0) {
+        steps = std::max<size_type>(2 * count + 20, 40);
+    }
+    steps = std::max(std::min(steps, n), count);
+
+    // Rows are the orthonormal Krylov basis vectors q_0 .. q_{steps-1}
+    Matrix<T> Q(steps, n);
+    std::vector<T> alpha(steps);
+    std::vector<T> beta(steps);
+    std::vector<T> w(n);
+
+    auto dot = [n](const T* x, const T* y) {
+        T sum = T(0);
+        for (size_type i = 0; i < n; ++i) {
+            sum += x[i] * y[i];
+        }
+        return sum;
+    };
+
+    std::mt19937 gen(kSeed);
+    std::uniform_real_distribution<T> dist(T(-1), T(1));
+    T* q0 = &Q(0, 0);
+    for (size_type i = 0; i < n; ++i) {
+        q0[i] = dist(gen);
+    }
+    T norm0 = std::sqrt(dot(q0, q0));
+    for (size_type i = 0; i < n; ++i) {
+        q0[i] /= norm0;
+    }
+
+    T scale = T(0);
+    size_type m = steps;
+    for (size_type j = 0; j < steps; ++j) {
+        T* qj = &Q(j, 0);
+        apply(static_cast<const T*>(qj), w.data());
+        alpha[j] = dot(w.data(), qj);
+        // Two passes of Gram-Schmidt against the whole basis keep it orthonormal
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_type i = 0; i <= j; ++i) {
+                T* qi = &Q(i, 0);
+                T h = dot(w.data(), qi);
+                for (size_type r = 0; r < n; ++r) {
+                    w[r] -= h * qi[r];
+                }
+            }
+        }
+        beta[j] = std::sqrt(dot(w.data(), w.data()));
+        scale = std::max(scale, std::abs(alpha[j]) + beta[j]);
+        if (j + 1 == steps) {
+            break;
+        }
+        if (beta[j] <= std::numeric_limits<T>::epsilon() * scale * static_cast<T>(n)) {
+            // The basis spans an invariant subspace, its Ritz pairs are exact
+            m = j + 1;
+            beta[j] = T(0);
+            break;
+        }
+        T* next = &Q(j + 1, 0);
+        for (size_type r = 0; r < n; ++r) {
+            next[r] = w[r] / beta[j];
+        }
+    }
+    count = std::min(count, m);
+
+    // Eigenpairs of the m x m tridiagonal T_m, Zt starts as the identity
+    std::vector<T> d(alpha.begin(), alpha.begin() + m);
+    std::vector<T> e(beta.begin(), beta.begin() + m);
+    Matrix<T> Zt = Matrix<T>::identity(m);
+    SymmetricEigen<T>::tridiagonalQL(d, e, &Zt);
+
+    std::vector<size_type> order(m);
+    for (size_type i = 0; i < m; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_type a, size_type b) {
+        return which == LanczosWhich::Smallest ? d[a] < d[b] : d[a] > d[b];
+    });
+
+    _values.resize(count);
+    _residuals.resize(count);
+    _vectors.resize(n, count);
+    for (size_type c = 0; c < count; ++c) {
+        size_type k = order[c];
+        _values[c] = d[k];
+        // Ritz vector y = Q^T s, residual beta_{m-1} |s_{m-1}|
+        _residuals[c] = beta[m - 1] * std::abs(Zt(k, m - 1));
+        for (size_type i = 0; i < n; ++i) {
+            _vectors(i, c) = T(0);
+        }
+        for (size_type j = 0; j < m; ++j) {
+            T s = Zt(k, j);
+            const T* qj = &Q(j, 0);
+            for (size_type i = 0; i < n; ++i) {
+                _vectors(i, c) += s * qj[i];
+            }
+        }
+    }
+}
+
+template <std::floating_point T>
+void Lanczos<T>::compute(const Matrix<T>& A, size_type count, LanczosWhich which, size_type steps)
+{
+    if (A.rows_size() != A.cols_size()) {
+        throw std::invalid_argument("Lanczos: matrix must be square");
+    }
+    size_type n = A.rows_size();
+    compute(n, [&A, n](const T* x, T* y) {
+        for (size_type i = 0; i < n; ++i) {
+            T sum = T(0);
+            for (size_type j = 0; j < n; ++j) {
+                sum += A(i, j) * x[j];
+            }
+            y[i] = sum;
+        }
+    }, count, which, steps);
+}
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_LANCZOS_H_
@@ -0,0 +1,234 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_MIXEDPRECISIONCHOLESKY_H_
+#define MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_MIXEDPRECISIONCHOLESKY_H_
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include "Matrix.h"
+#include "Cholesky.h"
+
+// (A + shift * I) x = b for a symmetric positive definite A, factorized in
+// the lower precision Low and refined in T:
+//   x_0 = solve_Low(b),  r_k = b - (A + shift * I) x_k,  x_{k+1} = x_k + solve_Low(r_k)
+// The O(n^3) factorization runs on half the bytes, the O(n^2) residuals keep
+// T accuracy. Refinement converges while cond(A) * eps(Low) is well below 1.
+//
+// Falls back to a T Cholesky when the Low factorization is not positive
+// definite, or for a solve whose residual stops shrinking by
+// kMinReduction per step. The fallback factor is kept until the next
+// factorize() or refactorize().
+//
+// A is copied as in Cholesky, and must be fully stored: the residuals read
+// both triangles.
+
+template <std::floating_point T = double, std::floating_point Low = float>
+class MixedPrecisionCholesky {
+public:
+    using size_type = typename Matrix<T>::size_type;
+
+    static constexpr int kMaxRefinements = 10;
+    // A refinement step has to cut the residual at least by this factor
+    static constexpr T kMinReduction = T(0.5);
+
+private:
+    Matrix<T> _A;
+    T _shift = T(0);
+    Matrix<Low> _ALow;
+    Cholesky<Low> _low;
+    Cholesky<T> _high;
+    bool _useHigh = false;
+    int _refinements = 0;
+
+    // Scratch of solveInto
+    mutable Matrix<T> _r;
+    mutable Matrix<Low> _rLow;
+    mutable Matrix<Low> _dLow;
+
+    void decompose();
+    // Lazily factorizes in T, for a stalled refinement
+    void fallBack();
+
+public:
+    // Empty, factorize() must be called before use
+    MixedPrecisionCholesky() = default;
+
+    explicit MixedPrecisionCholesky(const Matrix<T>& A, T shift = T(0));
+
+    // A must be square and symmetric
+    void factorize(const Matrix<T>& A, T shift = T(0));
+
+    // Factorizes A + shift * I for the A of the last factorize()
+    void refactorize(T shift);
+
+    size_type size() const { return _A.rows_size(); }
+    T shift() const { return _shift; }
+
+    // False when neither precision could factorize A + shift * I
+    bool isPositiveDefinite() const { return _useHigh ? _high.isPositiveDefinite() : _low.isPositiveDefinite(); }
+
+    // True once solves go through the T factor
+    bool usesFallback() const { return _useHigh; }
+
+    // Refinement steps of the last solve, 0 after a fallback solve
+    int refinementSteps() const { return _refinements; }
+
+    // x = (A + shift * I)^{-1} b for a column vector b. Throws if A is not
+    // positive definite. Not thread safe, the scratch is shared.
+    void solveInto(const Matrix<T>& b, Matrix<T>& x);
+    Matrix<T> solve(const Matrix<T>& b);
+};
+
+template <std::floating_point T, std::floating_point Low>
+MixedPrecisionCholesky<T, Low>::MixedPrecisionCholesky(const Matrix<T>& A, T shift)
+{
+    factorize(A, shift);
+}
+
+template <std::floating_point T, std::floating_point Low>
+void MixedPrecisionCholesky<T, Low>::factorize(const Matrix<T>& A, T shift)
+{
+    if (A.rows_size() != A.cols_size()) {
+        throw std::invalid_argument("MixedPrecisionCholesky: matrix must be square");
+    }
+    if (A.rows_size() == 0) {
+        throw std::runtime_error("MixedPrecisionCholesky: matrix is empty");
+    }
+    _A = A;
+    size_type n = A.rows_size();
+    _ALow.resize(n, n);
+    for (size_type i = 0; i < n; ++i) {
+        const T* a = A.rowData(i);
+        Low* l = _ALow.rowData(i);
+        for (size_type j = 0; j < n; ++j) {
+            l[j] = static_cast<Low>(a[j]);
+        }
+    }
+    _shift = shift;
+    decompose();
+}
+
+template <std::floating_point T, std::floating_point Low>
+void MixedPrecisionCholesky<T, Low>::refactorize(T shift)
+{
+    if (_A.rows_size() == 0) {
+        throw std::runtime_error("MixedPrecisionCholesky: nothing was factorized");
+    }
+    _shift = shift;
+    decompose();
+}
+
+template <std::floating_point T, std::floating_point Low>
+void MixedPrecisionCholesky<T, Low>::decompose()
+{
+    MATH_SCOPED_TIMER("MixedPrecisionCholesky::factorize");
+    _low.factorize(_ALow, static_cast<Low>(_shift));
+    _useHigh = false;
+    if (!_low.isPositiveDefinite()) {
+        fallBack();
+    }
+}
+
+template <std::floating_point T, std::floating_point Low>
+void MixedPrecisionCholesky<T, Low>::fallBack()
+{
+    MATH_COUNTER_ADD("MixedPrecisionCholesky::fallbacks", 1);
+    _high.factorize(_A, _shift);
+    _useHigh = true;
+}
+
+template <std::floating_point T, std::floating_point Low>
+void MixedPrecisionCholesky<T, Low>::solveInto(const Matrix<T>& b, Matrix<T>& x)
+{
+    size_type n = _A.rows_size();
+    if (b.rows_size() != n || b.cols_size() != 1) {
+        throw std::invalid_argument("MixedPrecisionCholesky::solve: b must be a column vector with A.rows rows");
+    }
+    if (!isPositiveDefinite()) {
+        throw std::runtime_error("MixedPrecisionCholesky::solve: matrix is not positive definite");
+    }
+    if (&b == &x) {
+        throw std::invalid_argument("MixedPrecisionCholesky::solve: result must not alias b");
+    }
+    MATH_SCOPED_TIMER("MixedPrecisionCholesky::solve");
+    _refinements = 0;
+    if (_useHigh) {
+        _high.solveInto(b, x);
+        return;
+    }
+
+    _r = b;
+    _rLow.resize(n, 1);
+    x.resize(n, 1);
+    x.setZeroes();
+    T* r = _r.rowData(0);
+    T* xs = x.rowData(0);
+
+    // Stop at the backward error of a T solve: |r| <= n eps (|A| |x| + |b|)
+    T normA = T(0);
+    for (size_type i = 0; i < n; ++i) {
+        T rowSum = std::abs(_shift);
+        const T* a = _A.rowData(i);
+        for (size_type j = 0; j < n; ++j) {
+            rowSum += std::abs(a[j]);
+        }
+        normA = std::max(normA, rowSum);
+    }
+    T normB = T(0);
+    for (size_type i = 0; i < n; ++i) {
+        normB = std::max(normB, std::abs(r[i]));
+    }
+    const T eps = static_cast<T>(n) * std::numeric_limits<T>::epsilon();
+
+    T previous = std::numeric_limits<T>::infinity();
+    for (int step = 0;; ++step) {
+        T normR = T(0);
+        for (size_type i = 0; i < n; ++i) {
+            normR = std::max(normR, std::abs(r[i]));
+        }
+        T normX = T(0);
+        for (size_type i = 0; i < n; ++i) {
+            normX = std::max(normX, std::abs(xs[i]));
+        }
+        if (normR <= eps * (normA * normX + normB)) {
+            break;
+        }
+        if (step > kMaxRefinements || !(normR <= kMinReduction * previous) || !std::isfinite(normR)) {
+            // Low precision cannot resolve this system, redo it in T
+            MATH_HISTOGRAM_RECORD("MixedPrecisionCholesky::stalledAfter", step);
+            fallBack();
+            _refinements = 0;
+            _high.solveInto(b, x);
+            return;
+        }
+        previous = normR;
+
+        // x += solve_Low(r), r = b - (A + shift I) x
+        for (size_type i = 0; i < n; ++i) {
+            _rLow.rowData(i)[0] = static_cast<Low>(r[i]);
+        }
+        _low.solveInto(_rLow, _dLow);
+        const Low* d = _dLow.rowData(0);
+        for (size_type i = 0; i < n; ++i) {
+            xs[i] += static_cast<T>(d[i]);
+        }
+        _r = b;
+        Matrix<T>::gemv(_A, x, _r, T(-1), T(1));
+        for (size_type i = 0; i < n; ++i) {
+            r[i] -= _shift * xs[i];
+        }
+        _refinements = step;
+    }
+    MATH_HISTOGRAM_RECORD("MixedPrecisionCholesky::refinements", _refinements);
+}
+
+template <std::floating_point T, std::floating_point Low>
+Matrix<T> MixedPrecisionCholesky<T, Low>::solve(const Matrix<T>& b)
+{
+    Matrix<T> x;
+    solveInto(b, x);
+    return x;
+}
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_MIXEDPRECISIONCHOLESKY_H_
@@ -6,6 +6,7 @@
 #include <utility>
 #include <algorithm>
 #include "Matrix.h"
+#include "TSQR.h"
 
 // A = QR
 // A^{+} = Q^{-1}R^{T}
@@ -15,6 +16,19 @@ private:
 	Matrix<> _A;
 	Matrix<> _Q;
 	Matrix<> _R;
+	// Column-major working copy of A and Q while Gram-Schmidt runs, kept
+	// between factorizations, and projection scratch
+	Matrix<double, ColMajor> _V;
+	Matrix<double, ColMajor> _Qc;
+	std::vector<double> _h;
+
+	// Gram-Schmidt variants work on the columns of _V and _Qc, contiguous
+	// vectors of length m, with matrix-vector kernels
+	void startGramSchmidt();
+	void classicalGramSchmidt(int passes);
+	// One right-looking MGS sweep over _V; accumulate adds to R instead of
+	// overwriting it
+	void modifiedGramSchmidtSweep(bool accumulate);
 
 public:
 	QR(const Matrix<> &_A);
@@ -28,11 +42,16 @@ public:
 	friend bool operator==(const QR& A, const QR& B);
 	friend bool operator!=(const QR& A, const QR& B);
 
+    // CGS2
     void qr();
 
 	// Classical Gram-Schmidt,
     void qrCGS();
 
+    // Classical Gram-Schmidt with one reorthogonalization (CGS2): Q^T v and
+    // v - Q (Q^T v) twice per column. Orthogonal to working precision.
+    void qrCGS2();
+
 	// Modified Gram - Schmidt
 	void qrMGS();
 
@@ -54,6 +73,10 @@ public:
 	// Givens rotation
 	void qrGivens();
 
+    // Tall-skinny Householder QR over row blocks (TSQR.h), for m >= n;
+    // falls back to qrIMGS() for wide matrices
+    void qrTSQR();
+
 	Matrix<> A() const;
 	Matrix<> Q() const;
 	Matrix<> R() const;
@@ -0,0 +1,673 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_SVD_H_
+#define MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_SVD_H_
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Matrix.h"
+
+// A = U S V^T for an m x n matrix A, singular values in descending order.
+// With k = min(m, n) the economy decomposition has U m x k and V n x k,
+// the full one U m x m and V n x n.
+//
+// GolubKahan: Householder bidiagonalization followed by implicit shift QR
+// sweeps on the bidiagonal (Golub-Kahan-Reinsch, as in LINPACK dsvdc).
+// Jacobi: one-sided (Hestenes) Jacobi rotations of the columns of A until
+// they are mutually orthogonal. It has high relative accuracy even for tiny
+// singular values and every sweep is a set of independent column pairs,
+// but it costs several O(m n^2) sweeps, so Auto picks it only for economy
+// decompositions with k <= kJacobiSize. Jacobi leaves the columns of U
+// of exactly zero singular values at zero.
+//
+// Both work on the tall matrix (A or A^T) stored transposed, so that the
+// Householder reflections and rotations run along contiguous rows.
+
+enum class SVDMethod {
+    Auto,
+    GolubKahan,
+    Jacobi
+};
+
+template <std::floating_point T = double>
+class SVD {
+public:
+    using size_type = typename Matrix<T>::size_type;
+
+    static constexpr size_type kJacobiSize = 8;
+    static constexpr int kMaxJacobiSweeps = 60;
+    static constexpr int kMaxQRSweeps = 75;
+
+private:
+    Matrix<T> _U;
+    Matrix<T> _V;
+    std::vector<T> _s;
+    size_type _m = 0;
+    size_type _n = 0;
+    bool _economy = true;
+
+    // The tall matrix transposed and its factors, rows are singular vectors
+    Matrix<T> _Bt;
+    Matrix<T> _Ut;
+    Matrix<T> _Vt;
+    std::vector<T> _e;
+    std::vector<T> _work;
+    // Scratch for the solves, sized in compute()
+    mutable std::vector<T> _projection;
+
+    void golubKahan(size_type M, size_type N, size_type ncu);
+    void jacobi(size_type M, size_type N);
+
+public:
+    // Empty, compute() must be called before use
+    SVD() = default;
+
+    explicit SVD(const Matrix<T>& A, bool economy = true, SVDMethod method = SVDMethod::Auto);
+
+    // Reuses the buffers when the shape is unchanged
+    void compute(const Matrix<T>& A, bool economy = true, SVDMethod method = SVDMethod::Auto);
+
+    const Matrix<T>& U() const { return _U; }
+    const Matrix<T>& V() const { return _V; }
+    const std::vector<T>& singularValues() const { return _s; }
+
+    // k x k for the economy decomposition, m x n for the full one
+    Matrix<T> S() const;
+
+    // max(m, n) * epsilon * s_max, smaller singular values count as zero
+    T tolerance() const;
+
+    // A negative tolerance means tolerance()
+    size_type rank(T tolerance = T(-1)) const;
+
+    // s_max / s_min, infinite for a rank deficient A
+    T conditionNumber() const;
+
+    // Minimum norm least squares solution x = A^{+} b
+    void solveInto(const Matrix<T>& b, Matrix<T>& x, T tolerance = T(-1)) const;
+    Matrix<T> solve(const Matrix<T>& b, T tolerance = T(-1)) const;
+
+    Matrix<T> pseudoInverse(T tolerance = T(-1)) const;
+
+    // x = (A^T A + lambda I)^{-1} g for a column g of length n, the
+    // Levenberg-Marquardt step. O(n k) for every lambda, nothing is refactorized.
+    void solveDampedInto(const Matrix<T>& g, T lambda, Matrix<T>& x) const;
+};
+
+template <std::floating_point T>
+SVD<T>::SVD(const Matrix<T>& A, bool economy, SVDMethod method)
+{
+    compute(A, economy, method);
+}
+
+template <std::floating_point T>
+void SVD<T>::compute(const Matrix<T>& A, bool economy, SVDMethod method)
+{
+    _m = A.rows_size();
+    _n = A.cols_size();
+    _economy = economy;
+    if (_m == 0 || _n == 0) {
+        throw std::runtime_error("SVD: matrix is empty");
+    }
+    MATH_SCOPED_TIMER("SVD::compute");
+    MATH_HISTOGRAM_RECORD("SVD::compute.size", std::min(_m, _n));
+
+    bool tall = _m >= _n;
+    size_type M = tall ? _m : _n;
+    size_type N = tall ? _n : _m;
+    size_type ncu = economy ? N : M;
+    if (tall) {
+        Matrix<T>::transposeInto(A, _Bt);
+    } else {
+        _Bt = A;
+    }
+    _Ut.resize(ncu, M);
+    _Vt.resize(N, N);
+    _s.resize(N);
+    _e.resize(N);
+    _work.resize(M);
+    _projection.resize(N);
+
+    if (method == SVDMethod::Auto) {
+        method = economy && N <= kJacobiSize ? SVDMethod::Jacobi : SVDMethod::GolubKahan;
+    }
+    if (method == SVDMethod::Jacobi && !economy) {
+        throw std::invalid_argument("SVD: Jacobi computes the economy decomposition only");
+    }
+    if (method == SVDMethod::Jacobi) {
+        jacobi(M, N);
+    } else {
+        golubKahan(M, N, ncu);
+    }
+
+    // A = B^T = V_B S U_B^T for a wide A
+    Matrix<T>::transposeInto(tall ? _Ut : _Vt, _U);
+    Matrix<T>::transposeInto(tall ? _Vt : _Ut, _V);
+}
+
+template <std::floating_point T>
+void SVD<T>::golubKahan(size_type M, size_type N, size_type ncu)
+{
+    T** b = _Bt.matrix;
+    T** u = _Ut.matrix;
+    T** v = _Vt.matrix;
+    T* s = _s.data();
+    T* e = _e.data();
+    T* work = _work.data();
+    int m = static_cast<int>(M);
+    int n = static_cast<int>(N);
+    int nu = static_cast<int>(ncu);
+
+    // Reduce B to bidiagonal form, the diagonal goes to s and the
+    // superdiagonal to e
+    int nct = std::min(m - 1, n);
+    int nrt = std::max(0, std::min(n - 2, m));
+    for (int k = 0; k < std::max(nct, nrt); ++k) {
+        if (k < nct) {
+            // Reflection zeroing column k of B below the diagonal
+            T norm = T(0);
+            for (int i = k; i < m; ++i) {
+                norm += b[k][i] * b[k][i];
+            }
+            s[k] = std::sqrt(norm);
+            if (s[k] != T(0)) {
+                if (b[k][k] < T(0)) {
+                    s[k] = -s[k];
+                }
+                for (int i = k; i < m; ++i) {
+                    b[k][i] /= s[k];
+                }
+                b[k][k] += T(1);
+            }
+            s[k] = -s[k];
+        }
+        for (int j = k + 1; j < n; ++j) {
+            if (k < nct && s[k] != T(0)) {
+                T t = T(0);
+                for (int i = k; i < m; ++i) {
+                    t += b[k][i] * b[j][i];
+                }
+                t = -t / b[k][k];
+                for (int i = k; i < m; ++i) {
+                    b[j][i] += t * b[k][i];
+                }
+            }
+            e[j] = b[j][k];
+        }
+        if (k < nct) {
+            std::fill(u[k], u[k] + k, T(0));
+            std::copy(b[k] + k, b[k] + m, u[k] + k);
+        }
+        if (k < nrt) {
+            // Reflection zeroing row k of B right of the superdiagonal
+            T norm = T(0);
+            for (int i = k + 1; i < n; ++i) {
+                norm += e[i] * e[i];
+            }
+            e[k] = std::sqrt(norm);
+            if (e[k] != T(0)) {
+                if (e[k + 1] < T(0)) {
+                    e[k] = -e[k];
+                }
+                for (int i = k + 1; i < n; ++i) {
+                    e[i] /= e[k];
+                }
+                e[k + 1] += T(1);
+            }
+            e[k] = -e[k];
+            if (k + 1 < m && e[k] != T(0)) {
+                std::fill(work + k + 1, work + m, T(0));
+                for (int j = k + 1; j < n; ++j) {
+                    for (int i = k + 1; i < m; ++i) {
+                        work[i] += e[j] * b[j][i];
+                    }
+                }
+                for (int j = k + 1; j < n; ++j) {
+                    T t = -e[j] / e[k + 1];
+                    for (int i = k + 1; i < m; ++i) {
+                        b[j][i] += t * work[i];
+                    }
+                }
+            }
+            for (int i = k + 1; i < n; ++i) {
+                v[k][i] = e[i];
+            }
+        }
+    }
+
+    int p = n;
+    if (nct < n) {
+        s[nct] = b[nct][nct];
+    }
+    if (nrt + 1 < p) {
+        e[nrt] = b[p - 1][nrt];
+    }
+    e[p - 1] = T(0);
+
+    // Accumulate U from the stored reflections
+    for (int j = nct; j < nu; ++j) {
+        std::fill(u[j], u[j] + m, T(0));
+        u[j][j] = T(1);
+    }
+    for (int k = nct - 1; k >= 0; --k) {
+        if (s[k] != T(0)) {
+            for (int j = k + 1; j < nu; ++j) {
+                T t = T(0);
+                for (int i = k; i < m; ++i) {
+                    t += u[k][i] * u[j][i];
+                }
+                t = -t / u[k][k];
+                for (int i = k; i < m; ++i) {
+                    u[j][i] += t * u[k][i];
+                }
+            }
+            for (int i = k; i < m; ++i) {
+                u[k][i] = -u[k][i];
+            }
+            u[k][k] += T(1);
+            std::fill(u[k], u[k] + k, T(0));
+        } else {
+            std::fill(u[k], u[k] + m, T(0));
+            u[k][k] = T(1);
+        }
+    }
+
+    // Accumulate V
+    for (int k = n - 1; k >= 0; --k) {
+        if (k < nrt && e[k] != T(0)) {
+            for (int j = k + 1; j < n; ++j) {
+                T t = T(0);
+                for (int i = k + 1; i < n; ++i) {
+                    t += v[k][i] * v[j][i];
+                }
+                t = -t / v[k][k + 1];
+                for (int i = k + 1; i < n; ++i) {
+                    v[j][i] += t * v[k][i];
+                }
+            }
+        }
+        std::fill(v[k], v[k] + n, T(0));
+        v[k][k] = T(1);
+    }
+
+    // Rotates rows i and j of a: (a_i, a_j) <- (c a_i + s a_j, c a_j - s a_i)
+    auto rotate = [](T* ai, T* aj, int length, T cs, T sn) {
+        for (int r = 0; r < length; ++r) {
+            T t = cs * ai[r] + sn * aj[r];
+            aj[r] = -sn * ai[r] + cs * aj[r];
+            ai[r] = t;
+        }
+    };
+
+    // Implicit shift QR sweeps on the bidiagonal, p shrinks as the
+    // trailing singular values converge
+    int pp = p - 1;
+    int iter = 0;
+    const T eps = std::numeric_limits<T>::epsilon();
+    const T tiny = std::numeric_limits<T>::min() / eps;
+    while (p > 0) {
+        if (iter > kMaxQRSweeps) {
+            throw std::runtime_error("SVD: QR sweeps did not converge");
+        }
+        // kase 1: s[p-1] and e[k-1] negligible, k < p
+        // kase 2: s[k] negligible, k < p
+        // kase 3: e[k-1] negligible, k < p and s[k..p-1] not negligible, QR sweep
+        // kase 4: e[p-2] negligible, s[p-1] converged
+        int k;
+        int kase;
+        for (k = p - 2; k >= 0; --k) {
+            if (std::abs(e[k]) <= tiny + eps * (std::abs(s[k]) + std::abs(s[k + 1]))) {
+                e[k] = T(0);
+                break;
+            }
+        }
+        if (k == p - 2) {
+            kase = 4;
+        } else {
+            int ks;
+            for (ks = p - 1; ks > k; --ks) {
+                T t = (ks != p ? std::abs(e[ks]) : T(0)) + (ks != k + 1 ? std::abs(e[ks - 1]) : T(0));
+                if (std::abs(s[ks]) <= tiny + eps * t) {
+                    s[ks] = T(0);
+                    break;
+                }
+            }
+            if (ks == k) {
+                kase = 3;
+            } else if (ks == p - 1) {
+                kase = 1;
+            } else {
+                kase = 2;
+                k = ks;
+            }
+        }
+        ++k;
+
+        switch (kase) {
+            case 1: {
+                // Deflate the negligible s[p-1]
+                T f = e[p - 2];
+                e[p - 2] = T(0);
+                for (int j = p - 2; j >= k; --j) {
+                    T t = std::hypot(s[j], f);
+                    T cs = s[j] / t;
+                    T sn = f / t;
+                    s[j] = t;
+                    if (j != k) {
+                        f = -sn * e[j - 1];
+                        e[j - 1] = cs * e[j - 1];
+                    }
+                    rotate(v[j], v[p - 1], n, cs, sn);
+                }
+                break;
+            }
+            case 2: {
+                // Split at the negligible s[k-1]
+                T f = e[k - 1];
+                e[k - 1] = T(0);
+                for (int j = k; j < p; ++j) {
+                    T t = std::hypot(s[j], f);
+                    T cs = s[j] / t;
+                    T sn = f / t;
+                    s[j] = t;
+                    f = -sn * e[j];
+                    e[j] = cs * e[j];
+                    rotate(u[j], u[k - 1], m, cs, sn);
+                }
+                break;
+            }
+            case 3: {
+                // Wilkinson shift from the trailing 2 x 2 block
+                T scale = std::max({std::abs(s[p - 1]), std::abs(s[p - 2]), std::abs(e[p - 2]),
+                                    std::abs(s[k]), std::abs(e[k])});
+                T sp = s[p - 1] / scale;
+                T spm1 = s[p - 2] / scale;
+                T epm1 = e[p - 2] / scale;
+                T sk = s[k] / scale;
+                T ek = e[k] / scale;
+                T bb = ((spm1 + sp) * (spm1 - sp) + epm1 * epm1) / T(2);
+                T c = (sp * epm1) * (sp * epm1);
+                T shift = T(0);
+                if (bb != T(0) || c != T(0)) {
+                    shift = std::sqrt(bb * bb + c);
+                    if (bb < T(0)) {
+                        shift = -shift;
+                    }
+                    shift = c / (bb + shift);
+                }
+                T f = (sk + sp) * (sk - sp) + shift;
+                T g = sk * ek;
+
+                // Chase the bulge down the bidiagonal
+                for (int j = k; j < p - 1; ++j) {
+                    T t = std::hypot(f, g);
+                    T cs = f / t;
+                    T sn = g / t;
+                    if (j != k) {
+                        e[j - 1] = t;
+                    }
+                    f = cs * s[j] + sn * e[j];
+                    e[j] = cs * e[j] - sn * s[j];
+                    g = sn * s[j + 1];
+                    s[j + 1] = cs * s[j + 1];
+                    rotate(v[j], v[j + 1], n, cs, sn);
+
+                    t = std::hypot(f, g);
+                    cs = f / t;
+                    sn = g / t;
+                    s[j] = t;
+                    f = cs * e[j] + sn * s[j + 1];
+                    s[j + 1] = -sn * e[j] + cs * s[j + 1];
+                    g = sn * e[j + 1];
+                    e[j + 1] = cs * e[j + 1];
+                    if (j < m - 1) {
+                        rotate(u[j], u[j + 1], m, cs, sn);
+                    }
+                }
+                e[p - 2] = f;
+                ++iter;
+                break;
+            }
+            default: {
+                // Make the singular value positive and move it into place
+                if (s[k] <= T(0)) {
+                    s[k] = s[k] < T(0) ? -s[k] : T(0);
+                    for (int i = 0; i <= pp; ++i) {
+                        v[k][i] = -v[k][i];
+                    }
+                }
+                while (k < pp && s[k] < s[k + 1]) {
+                    std::swap(s[k], s[k + 1]);
+                    std::swap_ranges(v[k], v[k] + n, v[k + 1]);
+                    if (k < m - 1) {
+                        std::swap_ranges(u[k], u[k] + m, u[k + 1]);
+                    }
+                    ++k;
+                }
+                iter = 0;
+                --p;
+                break;
+            }
+        }
+    }
+}
+
+template <std::floating_point T>
+void SVD<T>::jacobi(size_type M, size_type N)
+{
+    T** b = _Bt.matrix;
+    T** u = _Ut.matrix;
+    T** v = _Vt.matrix;
+    for (size_type i = 0; i < N; ++i) {
+        std::fill(v[i], v[i] + N, T(0));
+        v[i][i] = T(1);
+    }
+
+    auto dot = [](const T* x, const T* y, size_type length) {
+        T sum = T(0);
+        for (size_type r = 0; r < length; ++r) {
+            sum += x[r] * y[r];
+        }
+        return sum;
+    };
+    auto rotate = [](T* x, T* y, size_type length, T c, T s) {
+        for (size_type r = 0; r < length; ++r) {
+            T xr = x[r];
+            x[r] = c * xr - s * y[r];
+            y[r] = s * xr + c * y[r];
+        }
+    };
+
+    const T eps = std::numeric_limits<T>::epsilon();
+    bool converged = false;
+    for (int sweep = 0; sweep < kMaxJacobiSweeps && !converged; ++sweep) {
+        converged = true;
+        for (size_type p = 0; p + 1 < N; ++p) {
+            for (size_type q = p + 1; q < N; ++q) {
+                T alpha = dot(b[p], b[p], M);
+                T beta = dot(b[q], b[q], M);
+                T gamma = dot(b[p], b[q], M);
+                if (std::abs(gamma) <= eps * std::sqrt(alpha * beta)) {
+                    continue;
+                }
+                converged = false;
+                // The smaller root of t^2 + 2 zeta t - 1 = 0 orthogonalizes the pair
+                T zeta = (beta - alpha) / (T(2) * gamma);
+                T t = (zeta >= T(0) ? T(1) : T(-1)) / (std::abs(zeta) + std::sqrt(T(1) + zeta * zeta));
+                T c = T(1) / std::sqrt(T(1) + t * t);
+                T s = c * t;
+                rotate(b[p], b[q], M, c, s);
+                rotate(v[p], v[q], N, c, s);
+            }
+        }
+    }
+    if (!converged) {
+        throw std::runtime_error("SVD: Jacobi sweeps did not converge");
+    }
+
+    for (size_type j = 0; j < N; ++j) {
+        _s[j] = std::sqrt(dot(b[j], b[j], M));
+    }
+    // Selection sort keeps the row swaps to at most N
+    for (size_type j = 0; j < N; ++j) {
+        size_type largest = j;
+        for (size_type i = j + 1; i < N; ++i) {
+            if (_s[i] > _s[largest]) {
+                largest = i;
+            }
+        }
+        if (largest != j) {
+            std::swap(_s[j], _s[largest]);
+            std::swap_ranges(b[j], b[j] + M, b[largest]);
+            std::swap_ranges(v[j], v[j] + N, v[largest]);
+        }
+        for (size_type i = 0; i < M; ++i) {
+            u[j][i] = _s[j] == T(0) ? T(0) : b[j][i] / _s[j];
+        }
+    }
+}
+
+template <std::floating_point T>
+Matrix<T> SVD<T>::S() const
+{
+    Matrix<T> res = _economy ? Matrix<T>(_s.size(), _s.size()) : Matrix<T>(_m, _n);
+    for (size_type i = 0; i < _s.size(); ++i) {
+        res(i, i) = _s[i];
+    }
+    return res;
+}
+
+template <std::floating_point T>
+T SVD<T>::tolerance() const
+{
+    if (_s.empty()) {
+        throw std::runtime_error("SVD: nothing was computed");
+    }
+    return static_cast<T>(std::max(_m, _n)) * std::numeric_limits<T>::epsilon() * _s[0];
+}
+
+template <std::floating_point T>
+typename SVD<T>::size_type SVD<T>::rank(T tol) const
+{
+    if (tol < T(0)) {
+        tol = tolerance();
+    }
+    size_type r = 0;
+    while (r < _s.size() && _s[r] > tol) {
+        ++r;
+    }
+    return r;
+}
+
+template <std::floating_point T>
+T SVD<T>::conditionNumber() const
+{
+    if (_s.empty()) {
+        throw std::runtime_error("SVD: nothing was computed");
+    }
+    if (_s.back() == T(0)) {
+        return std::numeric_limits<T>::infinity();
+    }
+    return _s.front() / _s.back();
+}
+
+template <std::floating_point T>
+void SVD<T>::solveInto(const Matrix<T>& b, Matrix<T>& x, T tol) const
+{
+    if (b.rows_size() != _m) {
+        throw std::invalid_argument("SVD::solve: b must have as many rows as A");
+    }
+    if (&b == &x) {
+        throw std::invalid_argument("SVD::solve: b and x must be different matrices");
+    }
+    size_type r = rank(tol);
+    size_type cols = b.cols_size();
+    x.resize(_n, cols);
+    T** U = _U.matrix;
+    T** V = _V.matrix;
+    T* c = _projection.data();
+    for (size_type col = 0; col < cols; ++col) {
+        // c = S^{-1} U^T b over the numerical rank
+        std::fill(c, c + r, T(0));
+        for (size_type i = 0; i < _m; ++i) {
+            T bi = b.matrix[i][col];
+            for (size_type j = 0; j < r; ++j) {
+                c[j] += U[i][j] * bi;
+            }
+        }
+        for (size_type j = 0; j < r; ++j) {
+            c[j] /= _s[j];
+        }
+        for (size_type i = 0; i < _n; ++i) {
+            T sum = T(0);
+            for (size_type j = 0; j < r; ++j) {
+                sum += V[i][j] * c[j];
+            }
+            x.matrix[i][col] = sum;
+        }
+    }
+}
+
+template <std::floating_point T>
+Matrix<T> SVD<T>::solve(const Matrix<T>& b, T tol) const
+{
+    Matrix<T> x;
+    solveInto(b, x, tol);
+    return x;
+}
+
+template <std::floating_point T>
+Matrix<T> SVD<T>::pseudoInverse(T tol) const
+{
+    return solve(Matrix<T>::identity(_m), tol);
+}
+
+template <std::floating_point T>
+void SVD<T>::solveDampedInto(const Matrix<T>& g, T lambda, Matrix<T>& x) const
+{
+    if (g.rows_size() != _n || g.cols_size() != 1) {
+        throw std::invalid_argument("SVD::solveDamped: g must be a column of length n");
+    }
+    if (&g == &x) {
+        throw std::invalid_argument("SVD::solveDamped: g and x must be different matrices");
+    }
+    MATH_SCOPED_TIMER("SVD::solveDamped");
+
+    size_type k = _s.size();
+    x.resize(_n, 1);
+    T** V = _V.matrix;
+    T* c = _projection.data();
+    // c = V^T g
+    std::fill(c, c + k, T(0));
+    for (size_type i = 0; i < _n; ++i) {
+        T gi = g.matrix[i][0];
+        for (size_type j = 0; j < k; ++j) {
+            c[j] += V[i][j] * gi;
+        }
+    }
+    for (size_type i = 0; i < _n; ++i) {
+        T sum = T(0);
+        for (size_type j = 0; j < k; ++j) {
+            T d = _s[j] * _s[j] + lambda;
+            if (d != T(0)) {
+                sum += V[i][j] * (c[j] / d);
+            }
+        }
+        x.matrix[i][0] = sum;
+    }
+    // The part of g outside the row space of A is only damped
+    if (k < _n && lambda != T(0)) {
+        for (size_type i = 0; i < _n; ++i) {
+            T projected = T(0);
+            for (size_type j = 0; j < k; ++j) {
+                projected += V[i][j] * c[j];
+            }
+            x.matrix[i][0] += (g.matrix[i][0] - projected) / lambda;
+        }
+    }
+}
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_SVD_H_
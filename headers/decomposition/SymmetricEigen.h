@@ -0,0 +1,337 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_SYMMETRICEIGEN_H_
+#define MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_SYMMETRICEIGEN_H_
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Matrix.h"
+
+// A = V diag(w) V^T for a symmetric A, eigenvalues w in ascending order and
+// orthonormal eigenvectors in the columns of V. Only the lower triangle of
+// A is read.
+//
+// A is reduced to a tridiagonal T = Q^T A Q with Householder reflections,
+// then implicit QL sweeps with Wilkinson shifts diagonalize T. The vectors
+// are kept as rows (V^T) while they are rotated, so every update runs along
+// contiguous memory.
+//
+// For a few extremal eigenvalues of a large matrix see Lanczos.h.
+
+template <std::floating_point T = double>
+class SymmetricEigen {
+public:
+    using size_type = typename Matrix<T>::size_type;
+
+    static constexpr int kMaxSweeps = 30;
+
+private:
+    Matrix<T> _A;
+    Matrix<T> _Vt;
+    Matrix<T> _V;
+    std::vector<T> _w;
+    std::vector<T> _e;
+    std::vector<T> _work;
+    bool _vectors = false;
+    // Scratch for the solves, sized in compute()
+    mutable std::vector<T> _projection;
+
+    void tridiagonalize();
+
+public:
+    // Empty, compute() must be called before use
+    SymmetricEigen() = default;
+
+    explicit SymmetricEigen(const Matrix<T>& A, bool computeVectors = true);
+
+    // Reuses the buffers when the size is unchanged
+    void compute(const Matrix<T>& A, bool computeVectors = true);
+
+    size_type size() const { return _w.size(); }
+
+    const std::vector<T>& eigenvalues() const { return _w; }
+
+    // Columns are the eigenvectors. Throws when they were not computed.
+    const Matrix<T>& eigenvectors() const;
+
+    // Eigenvalues below -tolerance, a saddle point has at least one
+    size_type negativeCount(T tolerance = T(0)) const;
+
+    // x = V diag(1 / max(|w_i|, floor)) V^T g: the Newton step with every
+    // negative eigenvalue flipped and tiny ones raised to floor, so the
+    // result is a descent direction. Positive eigenvalues above floor are
+    // used as they are.
+    void solveModifiedInto(const Matrix<T>& g, Matrix<T>& x, T floor) const;
+
+    // Eigenvalues of the symmetric tridiagonal matrix with diagonal d and
+    // subdiagonal e[0..n-2] (e[n-1] is scratch), left unsorted in d. When
+    // Zt is given, its rows are rotated along, so rows of Q^T come back
+    // as rows of the eigenvectors of Q T Q^T.
+    static void tridiagonalQL(std::vector<T>& d, std::vector<T>& e, Matrix<T>* Zt);
+};
+
+template <std::floating_point T>
+SymmetricEigen<T>::SymmetricEigen(const Matrix<T>& A, bool computeVectors)
+{
+    compute(A, computeVectors);
+}
+
+template <std::floating_point T>
+void SymmetricEigen<T>::compute(const Matrix<T>& A, bool computeVectors)
+{
+    size_type n = A.rows_size();
+    if (n != A.cols_size()) {
+        throw std::invalid_argument("SymmetricEigen: matrix must be square");
+    }
+    if (n == 0) {
+        throw std::runtime_error("SymmetricEigen: matrix is empty");
+    }
+    MATH_SCOPED_TIMER("SymmetricEigen::compute");
+    MATH_HISTOGRAM_RECORD("SymmetricEigen::compute.size", n);
+
+    _vectors = computeVectors;
+    _A = A;
+    _w.resize(n);
+    _e.resize(n);
+    _work.resize(n);
+    _projection.resize(n);
+    if (_vectors) {
+        _Vt.resize(n, n);
+    }
+    tridiagonalize();
+    tridiagonalQL(_w, _e, _vectors ? &_Vt : nullptr);
+
+    // Selection sort, at most n row swaps
+    for (size_type j = 0; j < n; ++j) {
+        size_type smallest = j;
+        for (size_type i = j + 1; i < n; ++i) {
+            if (_w[i] < _w[smallest]) {
+                smallest = i;
+            }
+        }
+        if (smallest != j) {
+            std::swap(_w[j], _w[smallest]);
+            if (_vectors) {
+                std::swap_ranges(_Vt.matrix[j], _Vt.matrix[j] + n, _Vt.matrix[smallest]);
+            }
+        }
+    }
+    if (_vectors) {
+        Matrix<T>::transposeInto(_Vt, _V);
+    }
+}
+
+// Householder reduction of _A to tridiagonal form, diagonal to _w and
+// subdiagonal to _e. With vectors Q^T = H_{n-3} ... H_0 goes to _Vt.
+template <std::floating_point T>
+void SymmetricEigen<T>::tridiagonalize()
+{
+    size_type n = _A.rows_size();
+    T** a = _A.matrix;
+    T* p = _work.data();
+    // Mirror the lower triangle, the reflections below use whole rows
+    for (size_type i = 0; i < n; ++i) {
+        for (size_type j = i + 1; j < n; ++j) {
+            a[i][j] = a[j][i];
+        }
+    }
+    if (_vectors) {
+        for (size_type i = 0; i < n; ++i) {
+            std::fill(_Vt.matrix[i], _Vt.matrix[i] + n, T(0));
+            _Vt.matrix[i][i] = T(1);
+        }
+    }
+
+    for (size_type k = 0; k + 2 < n; ++k) {
+        // v = x - alpha e_1 for x = a[k][k+1..n), stored in place of x
+        T* v = a[k];
+        T norm = T(0);
+        for (size_type i = k + 1; i < n; ++i) {
+            norm += v[i] * v[i];
+        }
+        norm = std::sqrt(norm);
+        T alpha = v[k + 1] > T(0) ? -norm : norm;
+        _e[k] = alpha;
+        _w[k] = v[k];
+        if (norm == T(0)) {
+            continue;
+        }
+        v[k + 1] -= alpha;
+        T vNorm2 = T(0);
+        for (size_type i = k + 1; i < n; ++i) {
+            vNorm2 += v[i] * v[i];
+        }
+        T beta = T(2) / vNorm2;
+
+        // A22 <- H A22 H = A22 - v w^T - w v^T, w = p - (beta / 2)(p^T v) v, p = beta A22 v
+        T pv = T(0);
+        for (size_type i = k + 1; i < n; ++i) {
+            T sum = T(0);
+            for (size_type j = k + 1; j < n; ++j) {
+                sum += a[i][j] * v[j];
+            }
+            p[i] = beta * sum;
+            pv += p[i] * v[i];
+        }
+        T half = beta * pv / T(2);
+        for (size_type i = k + 1; i < n; ++i) {
+            p[i] -= half * v[i];
+        }
+        for (size_type i = k + 1; i < n; ++i) {
+            for (size_type j = k + 1; j < n; ++j) {
+                a[i][j] -= v[i] * p[j] + p[i] * v[j];
+            }
+        }
+
+        if (_vectors) {
+            // Q^T <- H_k Q^T, touching rows k+1..n
+            T** q = _Vt.matrix;
+            std::fill(p, p + n, T(0));
+            for (size_type i = k + 1; i < n; ++i) {
+                for (size_type c = 0; c < n; ++c) {
+                    p[c] += v[i] * q[i][c];
+                }
+            }
+            for (size_type i = k + 1; i < n; ++i) {
+                T scale = beta * v[i];
+                for (size_type c = 0; c < n; ++c) {
+                    q[i][c] -= scale * p[c];
+                }
+            }
+        }
+    }
+    if (n >= 2) {
+        _e[n - 2] = a[n - 1][n - 2];
+        _w[n - 2] = a[n - 2][n - 2];
+    }
+    _w[n - 1] = a[n - 1][n - 1];
+    _e[n - 1] = T(0);
+}
+
+template <std::floating_point T>
+void SymmetricEigen<T>::tridiagonalQL(std::vector<T>& d, std::vector<T>& e, Matrix<T>* Zt)
+{
+    int n = static_cast<int>(d.size());
+    if (n == 0) {
+        return;
+    }
+    e[n - 1] = T(0);
+    const T eps = std::numeric_limits<T>::epsilon();
+    for (int l = 0; l < n; ++l) {
+        int iter = 0;
+        int m;
+        do {
+            for (m = l; m < n - 1; ++m) {
+                T dd = std::abs(d[m]) + std::abs(d[m + 1]);
+                if (std::abs(e[m]) <= eps * dd) {
+                    break;
+                }
+            }
+            if (m == l) {
+                break;
+            }
+            if (iter++ == kMaxSweeps) {
+                throw std::runtime_error("SymmetricEigen: QL sweeps did not converge");
+            }
+            // Wilkinson shift
+            T g = (d[l + 1] - d[l]) / (T(2) * e[l]);
+            T r = std::hypot(g, T(1));
+            g = d[m] - d[l] + e[l] / (g + (g >= T(0) ? r : -r));
+            T s = T(1);
+            T c = T(1);
+            T p = T(0);
+            int i;
+            for (i = m - 1; i >= l; --i) {
+                T f = s * e[i];
+                T b = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if (r == T(0)) {
+                    // Underflow, deflate and start over
+                    d[i + 1] -= p;
+                    e[m] = T(0);
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + T(2) * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+                if (Zt) {
+                    T* zi = Zt->matrix[i];
+                    T* zi1 = Zt->matrix[i + 1];
+                    for (size_type k = 0; k < Zt->cols_size(); ++k) {
+                        T z = zi1[k];
+                        zi1[k] = s * zi[k] + c * z;
+                        zi[k] = c * zi[k] - s * z;
+                    }
+                }
+            }
+            if (r == T(0) && i >= l) {
+                continue;
+            }
+            d[l] -= p;
+            e[l] = g;
+            e[m] = T(0);
+        } while (m != l);
+    }
+}
+
+template <std::floating_point T>
+const Matrix<T>& SymmetricEigen<T>::eigenvectors() const
+{
+    if (!_vectors) {
+        throw std::runtime_error("SymmetricEigen: eigenvectors were not computed");
+    }
+    return _V;
+}
+
+template <std::floating_point T>
+typename SymmetricEigen<T>::size_type SymmetricEigen<T>::negativeCount(T tolerance) const
+{
+    size_type count = 0;
+    while (count < _w.size() && _w[count] < -tolerance) {
+        ++count;
+    }
+    return count;
+}
+
+template <std::floating_point T>
+void SymmetricEigen<T>::solveModifiedInto(const Matrix<T>& g, Matrix<T>& x, T floor) const
+{
+    size_type n = _w.size();
+    if (g.rows_size() != n || g.cols_size() != 1) {
+        throw std::invalid_argument("SymmetricEigen::solveModified: g must be a column of length n");
+    }
+    if (&g == &x) {
+        throw std::invalid_argument("SymmetricEigen::solveModified: g and x must be different matrices");
+    }
+    if (!_vectors) {
+        throw std::runtime_error("SymmetricEigen: eigenvectors were not computed");
+    }
+    T** vt = _Vt.matrix;
+    T* c = _projection.data();
+    for (size_type j = 0; j < n; ++j) {
+        T sum = T(0);
+        for (size_type i = 0; i < n; ++i) {
+            sum += vt[j][i] * g.matrix[i][0];
+        }
+        c[j] = sum / std::max(std::abs(_w[j]), floor);
+    }
+    x.resize(n, 1);
+    for (size_type i = 0; i < n; ++i) {
+        x.matrix[i][0] = T(0);
+    }
+    for (size_type j = 0; j < n; ++j) {
+        for (size_type i = 0; i < n; ++i) {
+            x.matrix[i][0] += vt[j][i] * c[j];
+        }
+    }
+}
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_SYMMETRICEIGEN_H_
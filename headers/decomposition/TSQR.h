@@ -0,0 +1,485 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_TSQR_H_
+#define MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_TSQR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "Matrix.h"
+#include "ThreadPool.h"
+
+// Tall-skinny QR, A = Q R for an m x n A with m >= n, R upper triangular
+// with a nonnegative diagonal and Q with orthonormal columns (thin, m x n).
+//
+// A is split into blocks of rows that are factorized independently with
+// Householder reflections, on ThreadPool::shared() when there are several.
+// The n x n R factors are then stacked pairwise and factorized again, up a
+// binary tree, until one R is left. Only that tree of small factors is
+// combined, every block of A is read once.
+//
+// Q is formed only when asked for. Least squares needs just R: factorizing
+// [A | b] instead of A leaves Q^T b in the last column of R, and
+// solveAugmentedInto() back-substitutes it. solveNormalInto() solves
+// R^T R x = g, without forming A^T A but with its squared condition number.
+
+template <std::floating_point T = double>
+class TSQR {
+public:
+    using size_type = typename Matrix<T>::size_type;
+
+    // Blocks are at least this tall, and at least 4n
+    static constexpr size_type kMinBlockRows = 128;
+
+private:
+    // One Householder factorization, a block of A or two stacked R factors
+    struct Node {
+        // Reflectors below the diagonal, R above it
+        Matrix<T> A;
+        Matrix<T> R;
+        // Thin Q of this node, only with computeQ
+        Matrix<T> Q;
+        std::vector<T> beta;
+        std::vector<T> work;
+        // An odd node out is passed up the tree unchanged
+        bool passThrough = false;
+    };
+
+    size_type _m = 0;
+    size_type _n = 0;
+    size_type _blockRows = 0;
+    bool _computeQ = false;
+    std::vector<size_type> _offsets;
+    // _levels[0] are the blocks of A, the last level is the root
+    std::vector<std::vector<Node>> _levels;
+    // Coefficients that map a node's Q onto the final Q, top-down
+    std::vector<std::vector<Matrix<T>>> _coefficients;
+    Matrix<T> _R;
+    Matrix<T> _Q;
+
+    static void householder(Node& node, bool computeQ);
+    template <typename Body>
+    static void forEach(size_type count, Body&& body);
+    void formQ();
+
+public:
+    // Empty, factorize() must be called before use
+    TSQR() = default;
+
+    explicit TSQR(const Matrix<T>& A, bool computeQ = false);
+
+    // Reuses the buffers when the shape is unchanged
+    void factorize(const Matrix<T>& A, bool computeQ = false);
+
+    // Rows per block, 0 (the default) picks max(kMinBlockRows, 4n)
+    void setBlockRows(size_type rows) { _blockRows = rows; }
+
+    size_type blockCount() const { return _levels.empty() ? 0 : _levels.front().size(); }
+
+    const Matrix<T>& R() const { return _R; }
+
+    // Throws when the last factorize() did not compute Q
+    const Matrix<T>& Q() const;
+
+    // False when a diagonal entry of R is below max(m, n) * epsilon * max|r_ii|
+    bool isFullRank() const { return isFullRank(_n); }
+
+    // The same over the leading columns of A only
+    bool isFullRank(size_type columns) const;
+
+    // After factorize([A | B]) with A the leading columns of the matrix:
+    // the least squares x = argmin ||A x - B||, R_11^{-1} (Q^T B)_{1..columns}
+    // from R alone. Throws if A is rank deficient.
+    void solveAugmentedInto(size_type columns, Matrix<T>& x) const;
+
+    // x = (R^T R)^{-1} g = (A^T A)^{-1} g. Throws if A is rank deficient.
+    void solveNormalInto(const Matrix<T>& g, Matrix<T>& x) const;
+
+    // Least squares x = R^{-1} Q^T b, needs Q
+    void solveInto(const Matrix<T>& b, Matrix<T>& x) const;
+    Matrix<T> solve(const Matrix<T>& b) const;
+};
+
+template <std::floating_point T>
+TSQR<T>::TSQR(const Matrix<T>& A, bool computeQ)
+{
+    factorize(A, computeQ);
+}
+
+template <std::floating_point T>
+template <typename Body>
+void TSQR<T>::forEach(size_type count, Body&& body)
+{
+    if (count == 1) {
+        body(size_type(0));
+        return;
+    }
+    ThreadPool::shared().parallelFor(count, [&](size_t i) { body(i); });
+}
+
+template <std::floating_point T>
+void TSQR<T>::factorize(const Matrix<T>& A, bool computeQ)
+{
+    size_type m = A.rows_size();
+    size_type n = A.cols_size();
+    if (m == 0 || n == 0) {
+        throw std::runtime_error("TSQR: matrix is empty");
+    }
+    if (m < n) {
+        throw std::invalid_argument("TSQR: matrix must have at least as many rows as columns");
+    }
+    MATH_SCOPED_TIMER("TSQR::factorize");
+    MATH_HISTOGRAM_RECORD("TSQR::factorize.rows", m);
+    _m = m;
+    _n = n;
+    _computeQ = computeQ;
+
+    size_type blockRows = std::max(_blockRows == 0 ? std::max(kMinBlockRows, 4 * n) : _blockRows, n);
+    size_type blocks = std::max<size_type>(1, m / blockRows);
+    _offsets.resize(blocks + 1);
+    for (size_type b = 0; b < blocks; ++b) {
+        _offsets[b] = b * blockRows;
+    }
+    // The last block takes the remainder
+    _offsets[blocks] = m;
+
+    // Tree shape, each level halves the node count
+    size_type levels = 1;
+    for (size_type count = blocks; count > 1; count = (count + 1) / 2) {
+        ++levels;
+    }
+    _levels.resize(levels);
+    _levels[0].resize(blocks);
+    for (size_type l = 1, count = blocks; l < levels; ++l) {
+        count = (count + 1) / 2;
+        _levels[l].resize(count);
+    }
+
+    forEach(blocks, [&](size_type b) {
+        Node& node = _levels[0][b];
+        size_type rows = _offsets[b + 1] - _offsets[b];
+        node.A.resize(rows, n);
+        for (size_type i = 0; i < rows; ++i) {
+            std::copy(A.rowData(_offsets[b] + i), A.rowData(_offsets[b] + i) + n, node.A.rowData(i));
+        }
+        householder(node, computeQ);
+    });
+
+    for (size_type l = 1; l < levels; ++l) {
+        std::vector<Node>& below = _levels[l - 1];
+        forEach(_levels[l].size(), [&](size_type j) {
+            Node& node = _levels[l][j];
+            node.passThrough = 2 * j + 1 == below.size();
+            if (node.passThrough) {
+                node.R = below[2 * j].R;
+                return;
+            }
+            node.A.resize(2 * n, n);
+            for (size_type i = 0; i < n; ++i) {
+                std::copy(below[2 * j].R.rowData(i), below[2 * j].R.rowData(i) + n, node.A.rowData(i));
+                std::copy(below[2 * j + 1].R.rowData(i), below[2 * j + 1].R.rowData(i) + n, node.A.rowData(n + i));
+            }
+            householder(node, computeQ);
+        });
+    }
+
+    _R = _levels.back().front().R;
+    if (computeQ) {
+        formQ();
+    }
+    // Unique factors: flip rows of R (and columns of Q) with a negative diagonal
+    for (size_type k = 0; k < n; ++k) {
+        if (_R.rowData(k)[k] >= T(0)) {
+            continue;
+        }
+        for (size_type j = k; j < n; ++j) {
+            _R.rowData(k)[j] = -_R.rowData(k)[j];
+        }
+        if (computeQ) {
+            for (size_type i = 0; i < m; ++i) {
+                _Q.rowData(i)[k] = -_Q.rowData(i)[k];
+            }
+        }
+    }
+}
+
+// Householder QR of node.A in place. Every update streams whole rows: the
+// reflector is a column, so w^T = v^T A is accumulated row by row.
+template <std::floating_point T>
+void TSQR<T>::householder(Node& node, bool computeQ)
+{
+    Matrix<T>& A = node.A;
+    size_type rows = A.rows_size();
+    size_type n = A.cols_size();
+    node.beta.resize(n);
+    node.work.resize(n);
+    node.R.resize(n, n);
+    T* w = node.work.data();
+
+    for (size_type k = 0; k < n; ++k) {
+        T norm = T(0);
+        for (size_type i = k; i < rows; ++i) {
+            T a = A.rowData(i)[k];
+            norm += a * a;
+        }
+        norm = std::sqrt(norm);
+        T* rk = A.rowData(k);
+        T alpha = rk[k] > T(0) ? -norm : norm;
+        T* r = node.R.rowData(k);
+        std::fill(r, r + k, T(0));
+        r[k] = alpha;
+        if (norm == T(0)) {
+            node.beta[k] = T(0);
+            std::copy(rk + k + 1, rk + n, r + k + 1);
+            continue;
+        }
+        // v = x - alpha e_1 overwrites column k, v^T v = 2 norm (norm + |x_0|)
+        T vNorm2 = T(2) * norm * (norm + std::abs(rk[k]));
+        rk[k] -= alpha;
+        T beta = T(2) / vNorm2;
+        node.beta[k] = beta;
+
+        std::fill(w + k + 1, w + n, T(0));
+        for (size_type i = k; i < rows; ++i) {
+            const T* a = A.rowData(i);
+            T v = a[k];
+            for (size_type j = k + 1; j < n; ++j) {
+                w[j] += v * a[j];
+            }
+        }
+        for (size_type i = k; i < rows; ++i) {
+            T* a = A.rowData(i);
+            T v = beta * a[k];
+            for (size_type j = k + 1; j < n; ++j) {
+                a[j] -= v * w[j];
+            }
+        }
+        std::copy(rk + k + 1, rk + n, r + k + 1);
+    }
+
+    if (!computeQ) {
+        return;
+    }
+    // Q = H_0 ... H_{n-1} [I; 0], the last reflector is applied first
+    Matrix<T>& Q = node.Q;
+    Q.resize(rows, n);
+    for (size_type i = 0; i < rows; ++i) {
+        std::fill(Q.rowData(i), Q.rowData(i) + n, T(0));
+    }
+    for (size_type k = 0; k < n; ++k) {
+        Q.rowData(k)[k] = T(1);
+    }
+    for (size_type k = n; k-- > 0;) {
+        T beta = node.beta[k];
+        if (beta == T(0)) {
+            continue;
+        }
+        std::fill(w + k, w + n, T(0));
+        for (size_type i = k; i < rows; ++i) {
+            T v = A.rowData(i)[k];
+            const T* q = Q.rowData(i);
+            for (size_type j = k; j < n; ++j) {
+                w[j] += v * q[j];
+            }
+        }
+        for (size_type i = k; i < rows; ++i) {
+            T v = beta * A.rowData(i)[k];
+            T* q = Q.rowData(i);
+            for (size_type j = k; j < n; ++j) {
+                q[j] -= v * w[j];
+            }
+        }
+    }
+}
+
+// Walks the tree top-down: a node's Q times its coefficient matrix is split
+// between its two children, the blocks finally write their rows of Q.
+template <std::floating_point T>
+void TSQR<T>::formQ()
+{
+    size_type n = _n;
+    size_type levels = _levels.size();
+    _coefficients.resize(levels);
+    for (size_type l = 0; l < levels; ++l) {
+        _coefficients[l].resize(_levels[l].size());
+    }
+    _coefficients.back().front() = Matrix<T>::identity(n);
+
+    Matrix<T> product;
+    for (size_type l = levels - 1; l > 0; --l) {
+        for (size_type j = 0; j < _levels[l].size(); ++j) {
+            const Node& node = _levels[l][j];
+            const Matrix<T>& C = _coefficients[l][j];
+            if (node.passThrough) {
+                _coefficients[l - 1][2 * j] = C;
+                continue;
+            }
+            Matrix<T>::multiplyInto(node.Q, C, product);
+            Matrix<T>& left = _coefficients[l - 1][2 * j];
+            Matrix<T>& right = _coefficients[l - 1][2 * j + 1];
+            left.resize(n, n);
+            right.resize(n, n);
+            for (size_type i = 0; i < n; ++i) {
+                std::copy(product.rowData(i), product.rowData(i) + n, left.rowData(i));
+                std::copy(product.rowData(n + i), product.rowData(n + i) + n, right.rowData(i));
+            }
+        }
+    }
+
+    _Q.resize(_m, n);
+    forEach(_levels[0].size(), [&](size_type b) {
+        const Matrix<T>& Qb = _levels[0][b].Q;
+        const Matrix<T>& C = _coefficients[0][b];
+        for (size_type i = 0; i < Qb.rows_size(); ++i) {
+            T* q = _Q.rowData(_offsets[b] + i);
+            std::fill(q, q + n, T(0));
+            const T* qb = Qb.rowData(i);
+            for (size_type k = 0; k < n; ++k) {
+                const T* c = C.rowData(k);
+                for (size_type j = 0; j < n; ++j) {
+                    q[j] += qb[k] * c[j];
+                }
+            }
+        }
+    });
+}
+
+template <std::floating_point T>
+const Matrix<T>& TSQR<T>::Q() const
+{
+    if (!_computeQ) {
+        throw std::runtime_error("TSQR: Q was not computed");
+    }
+    return _Q;
+}
+
+template <std::floating_point T>
+bool TSQR<T>::isFullRank(size_type columns) const
+{
+    columns = std::min(columns, _n);
+    T largest = T(0);
+    T smallest = std::numeric_limits<T>::infinity();
+    for (size_type k = 0; k < columns; ++k) {
+        T d = std::abs(_R.rowData(k)[k]);
+        largest = std::max(largest, d);
+        smallest = std::min(smallest, d);
+    }
+    // Rounding leaves a dependent column about m * eps * max|r_ii| of norm
+    T tolerance = static_cast<T>(std::max(_m, columns)) * std::numeric_limits<T>::epsilon() * largest;
+    return columns > 0 && smallest > tolerance;
+}
+
+template <std::floating_point T>
+void TSQR<T>::solveNormalInto(const Matrix<T>& g, Matrix<T>& x) const
+{
+    if (g.rows_size() != _n) {
+        throw std::invalid_argument("TSQR::solveNormal: g must have as many rows as A has columns");
+    }
+    if (!isFullRank()) {
+        throw std::runtime_error("TSQR::solveNormal: matrix is rank deficient");
+    }
+    MATH_SCOPED_TIMER("TSQR::solve");
+    if (&g != &x) {
+        x = g;
+    }
+    size_type k = g.cols_size();
+    // R^T y = g, row i of R^T is column i of R
+    for (size_type i = 0; i < _n; ++i) {
+        const T* r = _R.rowData(i);
+        T* yi = x.rowData(i);
+        for (size_type c = 0; c < k; ++c) {
+            yi[c] /= r[i];
+        }
+        for (size_type j = i + 1; j < _n; ++j) {
+            T* yj = x.rowData(j);
+            for (size_type c = 0; c < k; ++c) {
+                yj[c] -= r[j] * yi[c];
+            }
+        }
+    }
+    // R x = y
+    for (size_type i = _n; i-- > 0;) {
+        const T* r = _R.rowData(i);
+        T* xi = x.rowData(i);
+        for (size_type j = i + 1; j < _n; ++j) {
+            const T* xj = x.rowData(j);
+            for (size_type c = 0; c < k; ++c) {
+                xi[c] -= r[j] * xj[c];
+            }
+        }
+        for (size_type c = 0; c < k; ++c) {
+            xi[c] /= r[i];
+        }
+    }
+}
+
+template <std::floating_point T>
+void TSQR<T>::solveAugmentedInto(size_type columns, Matrix<T>& x) const
+{
+    if (columns == 0 || columns >= _n) {
+        throw std::invalid_argument("TSQR::solveAugmented: the matrix must have columns beyond A");
+    }
+    if (!isFullRank(columns)) {
+        throw std::runtime_error("TSQR::solveAugmented: matrix is rank deficient");
+    }
+    MATH_SCOPED_TIMER("TSQR::solve");
+    size_type k = _n - columns;
+    x.resize(columns, k);
+    for (size_type i = 0; i < columns; ++i) {
+        std::copy(_R.rowData(i) + columns, _R.rowData(i) + _n, x.rowData(i));
+    }
+    // R_11 x = (Q^T B)_{1..columns}
+    for (size_type i = columns; i-- > 0;) {
+        const T* r = _R.rowData(i);
+        T* xi = x.rowData(i);
+        for (size_type j = i + 1; j < columns; ++j) {
+            const T* xj = x.rowData(j);
+            for (size_type c = 0; c < k; ++c) {
+                xi[c] -= r[j] * xj[c];
+            }
+        }
+        for (size_type c = 0; c < k; ++c) {
+            xi[c] /= r[i];
+        }
+    }
+}
+
+template <std::floating_point T>
+void TSQR<T>::solveInto(const Matrix<T>& b, Matrix<T>& x) const
+{
+    if (b.rows_size() != _m) {
+        throw std::invalid_argument("TSQR::solve: b must have as many rows as A");
+    }
+    if (&b == &x) {
+        throw std::invalid_argument("TSQR::solve: b and x must be different matrices");
+    }
+    if (!isFullRank()) {
+        throw std::runtime_error("TSQR::solve: matrix is rank deficient");
+    }
+    Matrix<T>::gemm_tn(Q(), b, x);
+    size_type k = b.cols_size();
+    for (size_type i = _n; i-- > 0;) {
+        const T* r = _R.rowData(i);
+        T* xi = x.rowData(i);
+        for (size_type j = i + 1; j < _n; ++j) {
+            const T* xj = x.rowData(j);
+            for (size_type c = 0; c < k; ++c) {
+                xi[c] -= r[j] * xj[c];
+            }
+        }
+        for (size_type c = 0; c < k; ++c) {
+            xi[c] /= r[i];
+        }
+    }
+}
+
+template <std::floating_point T>
+Matrix<T> TSQR<T>::solve(const Matrix<T>& b) const
+{
+    Matrix<T> x;
+    solveInto(b, x);
+    return x;
+}
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_DECOMPOSITION_TSQR_H_
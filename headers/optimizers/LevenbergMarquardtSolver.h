@@ -3,12 +3,26 @@
 
 #include "Optimizer.h"
 #include "LSMTask.h"
-#include "QR.h"
+#include "Cholesky.h"
+#include "MixedPrecisionCholesky.h"
+#include "LDLT.h"
+#include "SVD.h"
 #include <vector>
 #include <cmath>
 #include <stdexcept>
 
 class LMSolver : public Optimizer {
+public:
+    // How the damped normal equations (J^T J + lambda I) delta = J^T r are solved
+    enum class Factorization {
+        // Cholesky of J^T J + lambda I for every tried lambda
+        Cholesky,
+        // SVD of J once per linearization, every tried lambda is then O(n^2)
+        SVD,
+        // As Cholesky, factorized in float and refined to double accuracy
+        MixedPrecision
+    };
+
 private:
     LSMTask *c_task;
     std::vector<double> m_result;
@@ -20,6 +34,24 @@ private:
     double epsilon1;
     double epsilon2;
     int maxIterations;
+    Factorization m_factorization = Factorization::Cholesky;
+
+    // Buffers of one iteration, sized in setTask and reused afterwards, so
+    // that iterations after the first do not allocate
+    struct Workspace {
+        Matrix<> residuals;
+        Matrix<> jacobian;
+        Matrix<> gradient;
+        Matrix<> hessian;
+        Matrix<> delta;
+        std::vector<double> newParams;
+        // J^T J + lambda I, a rejected step only refactorizes with a new lambda
+        Cholesky<> cholesky;
+        MixedPrecisionCholesky<> mixed;
+        // Fallback when rounding makes the damped hessian lose definiteness
+        LDLT<> ldlt;
+        SVD<> svd;
+    } m_work;
 
 public:
     LMSolver(double initLambda = 1.0, double b_increase = 2.0, double b_decrease = 2.0,
@@ -37,6 +69,8 @@ public:
     double getCurrentError() const override;
 
     bool isConverged() const override;
+
+    void setFactorization(Factorization factorization) { m_factorization = factorization; }
 };
 
 #endif // ! MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_LEVENBERGMARQUARDTSOLVER_H_
@@ -6,13 +6,37 @@
 
 #include "Optimizer.h"
 #include "LSMTask.h"
-#include "QR.h"
+#include "Cholesky.h"
+#include "MixedPrecisionCholesky.h"
+#include "SVD.h"
+#include "TSQR.h"
 
 class NewtonGaussSolver : public Optimizer {
+public:
+    // How the least squares step delta = argmin ||J delta - r|| is found
+    enum class Factorization {
+        // Cholesky of the normal equations J^T J delta = J^T r
+        Cholesky,
+        // Tall-skinny QR of [J | r], delta from R and Q^T r by back
+        // substitution. J^T J is never formed, so the error grows with
+        // cond(J) rather than cond(J)^2: better for nearly dependent
+        // constraints
+        QR,
+        // Cholesky of J^T J in float, refined to double accuracy
+        MixedPrecision
+    };
+
+private:
     LSMTask *task;
     std::vector<double> result;
     bool converged;
     int maxIterations;
+    Factorization m_factorization = Factorization::Cholesky;
+    TSQR<> m_tsqr;
+    // [J | r] for the QR step
+    Matrix<> m_augmented;
+    MixedPrecisionCholesky<> m_mixed;
+
 public:
     NewtonGaussSolver(int maxItr = 1000);
 
@@ -25,6 +49,8 @@ public:
     void setTask(Task *task) override;
 
     double getCurrentError() const override;
+
+    void setFactorization(Factorization factorization) { m_factorization = factorization; }
 };
 
 #endif // ! MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_NEWTONGAUSSESOLVER_H_
@@ -2,12 +2,16 @@
 #define MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_NEWTONOPTIMIZER_H_
 
 #include "Optimizer.h"
-#include "../decomposition/QR.h"
+#include "../decomposition/SymmetricEigen.h"
 class NewtonOptimizer : public Optimizer {
     Task *task;
     std::vector<double> result;
     bool converged;
     int maxIterations;
+    // Eigenvalues of the Hessian are raised to at least this times the
+    // largest absolute eigenvalue before the step is taken
+    double curvatureFloor = 1e-8;
+    SymmetricEigen<> eigen;
 public:
     NewtonOptimizer(int maxItr = 1000);
 
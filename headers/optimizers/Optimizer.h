@@ -2,9 +2,13 @@
 #define MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_OPTIMIZER_H_
 
 #include "TaskF.h"
+#include "OptimizerObserver.h"
 #include <vector>
 
 class Optimizer {
+protected:
+    OptimizerObserver *m_observer = nullptr;
+
 public:
     virtual ~Optimizer() = default;
 
@@ -17,6 +21,9 @@ public:
     virtual bool isConverged() const = 0;
 
     virtual double getCurrentError() const = 0;
+
+    // Not owned, nullptr detaches. Without an observer no timing is done.
+    void setObserver(OptimizerObserver *observer) { m_observer = observer; }
 };
 
-#endif // ! MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_OPTIMIZER_H_
\ No newline at end of file
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_OPTIMIZER_H_
@@ -0,0 +1,92 @@
+#ifndef MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_OPTIMIZEROBSERVER_H_
+#define MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_OPTIMIZEROBSERVER_H_
+
+#include <chrono>
+#include <ostream>
+
+// What an optimizer did in one iteration. Times are in seconds.
+struct IterationReport {
+    int iteration = 0;
+    // Error after the iteration (the error of the kept point for rejected steps)
+    double error = 0.0;
+    double gradientNorm = 0.0;
+    double stepNorm = 0.0;
+    // Damping used for the step, 0 for undamped methods
+    double lambda = 0.0;
+    bool accepted = true;
+    // Negative eigenvalues of the Hessian, nonzero near a saddle point (Newton only)
+    int negativeCurvature = 0;
+    // Building gradient, jacobian and hessian
+    double assemblyTime = 0.0;
+    // Factorizing the system and solving for the step
+    double factorizationTime = 0.0;
+    // Applying the step and evaluating the new error
+    double updateTime = 0.0;
+};
+
+class OptimizerObserver {
+public:
+    virtual ~OptimizerObserver() = default;
+
+    virtual void onIteration(const IterationReport &report) = 0;
+
+    // iterations is the number of onIteration() calls, the same count for
+    // a solve that converged and one that ran out of iterations
+    virtual void onFinish(int iterations, bool converged) {}
+};
+
+// Prints one line per iteration, e.g. for debugging a solve from a test
+class StreamObserver : public OptimizerObserver {
+    std::ostream &out;
+
+public:
+    explicit StreamObserver(std::ostream &out) : out(out) {}
+
+    void onIteration(const IterationReport &report) override {
+        out << "iteration " << report.iteration
+            << ": error " << report.error
+            << ", |g| " << report.gradientNorm
+            << ", |dx| " << report.stepNorm
+            << ", lambda " << report.lambda
+            << (report.accepted ? ", accepted" : ", rejected");
+        if (report.negativeCurvature > 0) {
+            out << ", negative curvature " << report.negativeCurvature;
+        }
+        out << ", assembly " << report.assemblyTime
+            << "s, factorization " << report.factorizationTime
+            << "s, update " << report.updateTime << "s\n";
+    }
+
+    void onFinish(int iterations, bool converged) override {
+        out << (converged ? "converged after " : "stopped after ") << iterations << " iterations\n";
+    }
+};
+
+// Splits an iteration into phases. Reads the clock only when enabled, so an
+// optimizer without an observer pays a predictable branch per phase.
+class IterationTimer {
+    using Clock = std::chrono::steady_clock;
+
+    bool enabled;
+    Clock::time_point last;
+
+public:
+    explicit IterationTimer(bool enabled) : enabled(enabled) {
+        if (enabled) {
+            last = Clock::now();
+        }
+    }
+
+    // Seconds since the previous lap (or construction)
+    double lap() {
+        if (!enabled) {
+            return 0.0;
+        }
+        Clock::time_point now = Clock::now();
+        double seconds = std::chrono::duration<double>(now - last).count();
+        last = now;
+        return seconds;
+    }
+};
+
+#endif // ! MINIMIZEROPTIMIZER_HEADERS_OPTIMIZERS_OPTIMIZEROBSERVER_H_
@@ -0,0 +1,289 @@
+#include "BatchEvaluator.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include "ErrorFunctions.h"
+
+namespace {
+
+// Tape slots of the calling thread, count values per instruction
+thread_local std::vector<double> batchSlots;
+
+// The residual classes only wrap the graph they build
+const Function* unwrap(const Function* node) {
+    while (auto* error = dynamic_cast<const ErrorFunctions*>(node)) {
+        node = error->child(0);
+    }
+    return node;
+}
+
+template <typename F>
+void forEach(double* y, const double* a, size_t count, F f) {
+    for (size_t p = 0; p < count; ++p) {
+        y[p] = f(a[p]);
+    }
+}
+
+template <typename F>
+void forEach(double* y, const double* a, const double* b, size_t count, F f) {
+    for (size_t p = 0; p < count; ++p) {
+        y[p] = f(a[p], b[p]);
+    }
+}
+
+bool any(const double* a, size_t count, bool (*test)(double)) {
+    for (size_t p = 0; p < count; ++p) {
+        if (test(a[p])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// -------------------- BatchEvaluator Implementations --------------------
+
+// Exact types only: a subclass may evaluate differently
+bool BatchEvaluator::kindOf(const Function* node, Op& op) {
+    static const std::unordered_map<const std::type_info*, Op> kinds = {
+        {&typeid(Constant), Op::Constant}, {&typeid(Variable), Op::Input},
+        {&typeid(Addition), Op::Add}, {&typeid(Subtraction), Op::Sub},
+        {&typeid(Multiplication), Op::Mul}, {&typeid(Division), Op::Div},
+        {&typeid(Power), Op::Pow}, {&typeid(Negation), Op::Neg},
+        {&typeid(Abs), Op::Abs}, {&typeid(Sign), Op::Sign}, {&typeid(Mod), Op::Mod},
+        {&typeid(Exp), Op::Exp}, {&typeid(Ln), Op::Ln}, {&typeid(Log), Op::Log},
+        {&typeid(Sqrt), Op::Sqrt}, {&typeid(Sin), Op::Sin}, {&typeid(Cos), Op::Cos},
+        {&typeid(Asin), Op::Asin}, {&typeid(Acos), Op::Acos}, {&typeid(Tan), Op::Tan},
+        {&typeid(Atan), Op::Atan}, {&typeid(Cot), Op::Cot}, {&typeid(Acot), Op::Acot},
+        {&typeid(Max), Op::Max}, {&typeid(Min), Op::Min},
+    };
+    auto it = kinds.find(&typeid(*node));
+    if (it == kinds.end()) {
+        return false;
+    }
+    op = it->second;
+    return true;
+}
+
+bool BatchEvaluator::supports(const Function* root) {
+    std::vector<const Function*> stack = {root};
+    while (!stack.empty()) {
+        const Function* node = unwrap(stack.back());
+        stack.pop_back();
+        Op op;
+        if (!kindOf(node, op)) {
+            return false;
+        }
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            stack.push_back(node->child(i));
+        }
+    }
+    return true;
+}
+
+BatchEvaluator::BatchEvaluator(const std::vector<Function*>& roots, const std::vector<Variable*>& x)
+    : m_inputCount(x.size()) {
+    std::unordered_map<const double*, size_t> inputOf;
+    for (size_t j = 0; j < x.size(); ++j) {
+        inputOf.emplace(x[j]->address(), j);
+    }
+    // Tape position of every node compiled for the current root
+    std::unordered_map<const Function*, uint32_t> slotOf;
+    for (const Function* root : roots) {
+        if (!supports(root)) {
+            throw std::invalid_argument("BatchEvaluator: graph has nodes of unknown type");
+        }
+        size_t begin = m_tape.size();
+        slotOf.clear();
+        std::vector<size_t> reads;
+        // Post order, a node is emitted once its operands are
+        std::vector<std::pair<const Function*, bool>> stack = {{unwrap(root), false}};
+        while (!stack.empty()) {
+            auto [node, expanded] = stack.back();
+            stack.pop_back();
+            if (slotOf.count(node)) {
+                continue;
+            }
+            if (!expanded) {
+                stack.emplace_back(node, true);
+                for (size_t i = node->childCount(); i-- > 0;) {
+                    stack.emplace_back(unwrap(node->child(i)), false);
+                }
+                continue;
+            }
+            Instruction instruction;
+            kindOf(node, instruction.op);
+            if (instruction.op == Op::Constant) {
+                instruction.constant = node->evaluate();
+            } else if (instruction.op == Op::Input) {
+                auto* var = static_cast<const Variable*>(node);
+                auto it = inputOf.find(var->address());
+                if (it != inputOf.end()) {
+                    instruction.input = it->second;
+                    reads.push_back(it->second);
+                } else {
+                    instruction.op = Op::External;
+                    instruction.external = var;
+                }
+            }
+            if (node->childCount() > 0) {
+                instruction.a = slotOf.at(unwrap(node->child(0)));
+            }
+            if (node->childCount() > 1) {
+                instruction.b = slotOf.at(unwrap(node->child(1)));
+            }
+            slotOf.emplace(node, static_cast<uint32_t>(m_tape.size() - begin));
+            m_tape.push_back(instruction);
+        }
+        m_offsets.push_back(m_tape.size());
+        // Two handles of one variable are two nodes
+        std::sort(reads.begin(), reads.end());
+        reads.erase(std::unique(reads.begin(), reads.end()), reads.end());
+        m_inputsOf.push_back(std::move(reads));
+    }
+}
+
+void BatchEvaluator::evaluate(size_t root, size_t count, const double* const* inputs, double* out) const {
+    if (root >= rootCount()) {
+        throw std::out_of_range("BatchEvaluator: root index out of range");
+    }
+    size_t begin = m_offsets[root];
+    size_t length = m_offsets[root + 1] - begin;
+    if (batchSlots.size() < length * count) {
+        batchSlots.resize(length * count);
+    }
+    double* slots = batchSlots.data();
+    bool fast = m_mode == MathMode::Fast;
+
+    for (size_t k = 0; k < length; ++k) {
+        const Instruction& in = m_tape[begin + k];
+        double* y = slots + k * count;
+        const double* a = slots + in.a * count;
+        const double* b = slots + in.b * count;
+        switch (in.op) {
+        case Op::Constant:
+            std::fill(y, y + count, in.constant);
+            break;
+        case Op::Input:
+            std::copy(inputs[in.input], inputs[in.input] + count, y);
+            break;
+        case Op::External:
+            std::fill(y, y + count, in.external->evaluate());
+            break;
+        case Op::Add:
+            forEach(y, a, b, count, [](double l, double r) { return l + r; });
+            break;
+        case Op::Sub:
+            forEach(y, a, b, count, [](double l, double r) { return l - r; });
+            break;
+        case Op::Mul:
+            forEach(y, a, b, count, [](double l, double r) { return l * r; });
+            break;
+        case Op::Div:
+            if (any(b, count, [](double v) { return v == 0.0; })) {
+                throw std::runtime_error("Division by zero");
+            }
+            forEach(y, a, b, count, [](double l, double r) { return l / r; });
+            break;
+        case Op::Pow:
+            forEach(y, a, b, count, [](double l, double r) { return std::pow(l, r); });
+            break;
+        case Op::Neg:
+            forEach(y, a, count, [](double v) { return -1 * v; });
+            break;
+        case Op::Abs:
+            forEach(y, a, count, [](double v) { return std::abs(v); });
+            break;
+        case Op::Sign:
+            forEach(y, a, count, [](double v) { return v > 0.0 ? 1.0 : (v < 0.0 ? -1.0 : 0.0); });
+            break;
+        case Op::Mod:
+            if (any(b, count, [](double v) { return v == 0.0; })) {
+                throw std::domain_error("Division by zero in Modulo function.");
+            }
+            forEach(y, a, b, count, [](double l, double r) { return std::fmod(l, r); });
+            break;
+        case Op::Exp:
+            if (fast) {
+                fast_math::exp(a, y, count);
+            } else {
+                forEach(y, a, count, [](double v) { return std::exp(v); });
+            }
+            break;
+        case Op::Ln:
+            if (any(a, count, [](double v) { return v <= 0.0; })) {
+                throw std::runtime_error("Logarithm of non-positive value");
+            }
+            if (fast) {
+                fast_math::log(a, y, count);
+            } else {
+                forEach(y, a, count, [](double v) { return std::log(v); });
+            }
+            break;
+        case Op::Log:
+            if (any(a, count, [](double v) { return v <= 0.0 || v == 1.0; })) {
+                throw std::runtime_error("Invalid left for logarithm");
+            }
+            if (any(b, count, [](double v) { return v <= 0.0; })) {
+                throw std::runtime_error("Logarithm of non-positive value");
+            }
+            forEach(y, a, b, count, [](double l, double r) { return std::log(r) / std::log(l); });
+            break;
+        case Op::Sqrt:
+            forEach(y, a, count, [](double v) { return std::sqrt(v); });
+            break;
+        case Op::Sin:
+            if (fast) {
+                fast_math::sin(a, y, count);
+            } else {
+                forEach(y, a, count, [](double v) { return std::sin(v); });
+            }
+            break;
+        case Op::Cos:
+            if (fast) {
+                fast_math::cos(a, y, count);
+            } else {
+                forEach(y, a, count, [](double v) { return std::cos(v); });
+            }
+            break;
+        case Op::Asin:
+            forEach(y, a, count, [](double v) { return std::asin(v); });
+            break;
+        case Op::Acos:
+            if (fast) {
+                fast_math::acos(a, y, count);
+            } else {
+                forEach(y, a, count, [](double v) { return std::acos(v); });
+            }
+            break;
+        case Op::Tan:
+            forEach(y, a, count, [](double v) { return std::tan(v); });
+            break;
+        case Op::Atan:
+            if (fast) {
+                fast_math::atan(a, y, count);
+            } else {
+                forEach(y, a, count, [](double v) { return std::atan(v); });
+            }
+            break;
+        case Op::Cot:
+            forEach(y, a, count, [](double v) { return 1.0 / std::tan(v); });
+            break;
+        case Op::Acot:
+            forEach(y, a, count, [](double v) { return (M_PI / 2.0) - std::atan(v); });
+            break;
+        case Op::Max:
+            forEach(y, a, b, count, [](double l, double r) { return std::max(l, r); });
+            break;
+        case Op::Min:
+            forEach(y, a, b, count, [](double l, double r) { return std::min(l, r); });
+            break;
+        }
+    }
+    const double* result = slots + (length - 1) * count;
+    std::copy(result, result + count, out);
+}
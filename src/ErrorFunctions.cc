@@ -155,3 +155,21 @@ SectionSectionAngleError::SectionSectionAngleError(std::vector<Variable *> x, do
 Function *SectionSectionAngleError::clone() const {
     return new SectionSectionAngleError(m_X, v_error);
 }
+
+//------------------------- POINTONCIRCLE IMPLEMENTATION -------------------------
+PointOnCircleError::PointOnCircleError(std::vector<Variable *> x) : ErrorFunctions(x) {
+    if (x.size() != 5) {
+        throw std::invalid_argument("PointOnCircleError: wrong number of x");
+    }
+    // xp yp xc yc r
+    Function *sq = new Constant(0.5);
+    Function *pow2 = new Constant(2);
+    Function *A = new Subtraction(x[0], x[2]);
+    Function *B = new Subtraction(x[1], x[3]);
+    Function *dist = new Power(new Addition(new Power(A, pow2), new Power(B, pow2)), sq);
+    c_f = new Subtraction(dist, x[4]);
+}
+
+Function *PointOnCircleError::clone() const {
+    return new PointOnCircleError(m_X);
+}
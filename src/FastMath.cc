@@ -0,0 +1,74 @@
+#include "FastMath.h"
+
+namespace fast_math {
+
+void exp(const double* in, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = exp(in[i]);
+    }
+}
+
+// Two lanes of SSE2 do not pay for the division and the selects, glibc's
+// table driven log is faster there
+void log(const double* in, double* out, size_t n) {
+#ifdef __AVX2__
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = log(in[i]);
+    }
+#else
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = std::log(in[i]);
+    }
+#endif
+}
+
+namespace {
+
+bool trigInRange(const double* in, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (!(std::abs(in[i]) <= kMaxTrigArgument)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void sin(const double* in, double* out, size_t n) {
+    if (!trigInRange(in, n)) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = sin(in[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = sinReduced(in[i]);
+    }
+}
+
+void cos(const double* in, double* out, size_t n) {
+    if (!trigInRange(in, n)) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = cos(in[i]);
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = cosReduced(in[i]);
+    }
+}
+
+void atan(const double* in, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = atan(in[i]);
+    }
+}
+
+void acos(const double* in, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = acos(in[i]);
+    }
+}
+
+} // namespace fast_math
@@ -0,0 +1,203 @@
+#include "FiniteDifference.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+#include "Instrumentation.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Input arrays of the row being evaluated by the calling thread, indexed by
+// variable. Only the entries of the row's inputs are current.
+thread_local std::vector<const double *> batchInputs;
+
+} // namespace
+
+FiniteDifferenceJacobian::FiniteDifferenceJacobian(std::vector<Function *> functions, std::vector<Variable *> x)
+    : FiniteDifferenceJacobian(functions, x, DependencyAnalysis(x).jacobianPattern(functions)) {}
+
+FiniteDifferenceJacobian::FiniteDifferenceJacobian(std::vector<Function *> functions, std::vector<Variable *> x,
+                                                   SparsityPattern pattern)
+    : m_functions(std::move(functions)), m_X(std::move(x)), m_pattern(std::move(pattern)) {
+    if (m_pattern.rows() != m_functions.size() || m_pattern.cols() != m_X.size()) {
+        throw std::invalid_argument("FiniteDifferenceJacobian: pattern does not match the functions and variables");
+    }
+    if (std::all_of(m_functions.begin(), m_functions.end(), BatchEvaluator::supports)) {
+        m_batch.emplace(m_functions, m_X);
+        for (size_t i = 0; i < m_functions.size(); ++i) {
+            ++m_batchPoints;
+            for (size_t j : m_batch->inputsOf(i)) {
+                m_batchPoints += m_pattern.contains(i, j) ? 1 : 0;
+            }
+        }
+        return;
+    }
+    m_rowsOf = m_pattern.transpose();
+    m_coloring = ColumnColoring(m_pattern);
+    if (!m_X.empty() && m_X[0]->store() && m_X[0]->store()->size() == m_X.size()) {
+        m_store = m_X[0]->store();
+        for (size_t j = 0; j < m_X.size(); ++j) {
+            if (m_X[j]->store() != m_store || m_X[j]->index() != j) {
+                m_store = nullptr;
+                break;
+            }
+        }
+    }
+    std::unordered_set<const Function *> seen;
+    std::vector<const Function *> stack(m_functions.begin(), m_functions.end());
+    while (!stack.empty()) {
+        const Function *node = stack.back();
+        stack.pop_back();
+        if (!seen.insert(node).second) {
+            continue;
+        }
+        m_nodes.push_back(node);
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            stack.push_back(node->child(i));
+        }
+    }
+}
+
+bool FiniteDifferenceJacobian::tracked() const {
+    // A tracker may be attached after construction, so this is asked per call
+    return std::any_of(m_nodes.begin(), m_nodes.end(), DependencyTracker::isTracked);
+}
+
+void FiniteDifferenceJacobian::setMathMode(MathMode mode) {
+    if (m_batch) {
+        m_batch->setMathMode(mode);
+    }
+}
+
+double FiniteDifferenceJacobian::step(double x) {
+    double h = std::sqrt(std::numeric_limits<double>::epsilon()) * std::max(1.0, std::abs(x));
+    // The step that x + h actually takes in floating point
+    return (x + h) - x;
+}
+
+void FiniteDifferenceJacobian::evaluate(Matrix<> &residuals, Matrix<> &jac, bool parallel) const {
+    MATH_SCOPED_TIMER("FiniteDifferenceJacobian::evaluate");
+    residuals.resize(m_functions.size(), 1);
+    jac.resize(m_functions.size(), m_X.size());
+    jac.setZeroes();
+    if (m_batch) {
+        MATH_COUNTER_ADD("FiniteDifferenceJacobian::evaluate.points", static_cast<int64_t>(m_batchPoints));
+        evaluateBatched(residuals, jac, parallel);
+        return;
+    }
+    MATH_COUNTER_ADD("FiniteDifferenceJacobian::evaluate.colors", static_cast<int64_t>(colorCount()));
+    for (size_t i = 0; i < m_functions.size(); ++i) {
+        residuals(i, 0) = m_functions[i]->value();
+    }
+    if (parallel && m_store && colorCount() > 1 && !ThreadPool::inParallelRegion() && !tracked()) {
+        evaluateParallel(residuals, jac);
+    } else {
+        evaluateSerial(residuals, jac);
+    }
+}
+
+void FiniteDifferenceJacobian::evaluateBatched(Matrix<> &residuals, Matrix<> &jac, bool parallel) const {
+    size_t n = m_X.size();
+    std::vector<double> base(n);
+    std::vector<double> steps(n);
+    std::vector<double> perturbed(n);
+    for (size_t j = 0; j < n; ++j) {
+        base[j] = m_X[j]->evaluate();
+        steps[j] = step(base[j]);
+        perturbed[j] = base[j] + steps[j];
+    }
+    // Point 0 of row i is the current x, point c + 1 moves the column c of
+    // the row that its residual reads. Columns of the pattern it does not
+    // read keep a zero, as their difference would be.
+    auto rows = [&](size_t begin, size_t end) {
+        std::vector<const double *> &inputs = batchInputs;
+        if (inputs.size() < n) {
+            inputs.resize(n);
+        }
+        std::vector<size_t> moved;
+        std::vector<double> points;
+        std::vector<double> values;
+        for (size_t i = begin; i < end; ++i) {
+            const auto &reads = m_batch->inputsOf(i);
+            moved.clear();
+            for (size_t k = 0; k < reads.size(); ++k) {
+                if (m_pattern.contains(i, reads[k])) {
+                    moved.push_back(k);
+                }
+            }
+            size_t count = moved.size() + 1;
+            points.resize(reads.size() * count);
+            values.resize(count);
+            for (size_t k = 0; k < reads.size(); ++k) {
+                double *x = points.data() + k * count;
+                std::fill(x, x + count, base[reads[k]]);
+                inputs[reads[k]] = x;
+            }
+            for (size_t c = 0; c < moved.size(); ++c) {
+                size_t k = moved[c];
+                points[k * count + c + 1] = perturbed[reads[k]];
+            }
+            m_batch->evaluate(i, count, inputs.data(), values.data());
+            residuals(i, 0) = values[0];
+            for (size_t c = 0; c < moved.size(); ++c) {
+                size_t j = reads[moved[c]];
+                jac(i, j) = (values[c + 1] - values[0]) / steps[j];
+            }
+        }
+    };
+    constexpr size_t kRowsPerTask = 16;
+    size_t tasks = (m_functions.size() + kRowsPerTask - 1) / kRowsPerTask;
+    if (parallel && tasks > 1 && !ThreadPool::inParallelRegion()) {
+        ThreadPool::shared().parallelFor(tasks, [&](size_t t) {
+            rows(t * kRowsPerTask, std::min(m_functions.size(), (t + 1) * kRowsPerTask));
+        });
+    } else {
+        rows(0, m_functions.size());
+    }
+}
+
+void FiniteDifferenceJacobian::evaluateSerial(const Matrix<> &residuals, Matrix<> &jac) const {
+    std::vector<double> saved;
+    std::vector<double> steps;
+    for (const auto &group : m_coloring.groups) {
+        saved.clear();
+        steps.clear();
+        for (size_t j : group) {
+            double x = m_X[j]->evaluate();
+            saved.push_back(x);
+            steps.push_back(step(x));
+            m_X[j]->setValue(x + steps.back());
+        }
+        for (size_t c = 0; c < group.size(); ++c) {
+            size_t j = group[c];
+            for (size_t i : m_rowsOf.row(j)) {
+                jac(i, j) = (m_functions[i]->value() - residuals(i, 0)) / steps[c];
+            }
+        }
+        for (size_t c = 0; c < group.size(); ++c) {
+            m_X[group[c]]->setValue(saved[c]);
+        }
+    }
+}
+
+void FiniteDifferenceJacobian::evaluateParallel(const Matrix<> &residuals, Matrix<> &jac) const {
+    // Columns of a group are disjoint from the other groups, so are the
+    // entries of jac every task writes
+    const std::vector<double> &values = m_store->values();
+    ThreadPool::shared().parallelFor(colorCount(), [&](size_t color) {
+        std::vector<double> x = values;
+        const auto &group = m_coloring.groups[color];
+        for (size_t j : group) {
+            x[j] += step(values[j]);
+        }
+        VariableStore::Override perturbed(*m_store, x.data());
+        for (size_t j : group) {
+            double h = x[j] - values[j];
+            for (size_t i : m_rowsOf.row(j)) {
+                jac(i, j) = (m_functions[i]->value() - residuals(i, 0)) / h;
+            }
+        }
+    });
+}
@@ -1,11 +1,145 @@
 #include "Function.h"
+#include <algorithm>
+#include <utility>
+#include "Instrumentation.h"
+
+#ifdef MATH_INSTRUMENTATION
+namespace {
+// Depth of evaluate() on this thread: whole trees are timed, every node is counted
+thread_local int evaluateDepth = 0;
+}
+#define FUNCTION_EVALUATE_PROBE()                                      \
+    MATH_NESTED_SCOPED_TIMER("Function::evaluate", evaluateDepth);     \
+    MATH_COUNTER_ADD("Function::evaluate.nodes", 1)
+#else
+#define FUNCTION_EVALUATE_PROBE() ((void) 0)
+#endif
+
+#ifdef MATH_ALLOCATION_TRACKING
+// -------------------- Function Implementations --------------------
+
+void* Function::operator new(std::size_t bytes) {
+    void* ptr = ::operator new(bytes);
+    MATH_RECORD_ALLOCATION(instrumentation::AllocationKind::Function, bytes);
+    return ptr;
+}
+
+void Function::operator delete(void* ptr, std::size_t bytes) {
+    MATH_RECORD_DEALLOCATION(instrumentation::AllocationKind::Function, bytes);
+    ::operator delete(ptr);
+}
+#endif
+
+// -------------------- Function Implementations --------------------
+
+double Function::refresh() const {
+    if (!m_cached) {
+        return evaluate();
+    }
+    m_cache = evaluate();
+    for (size_t i = 0; i < childCount(); ++i) {
+        const Function* operand = child(i);
+        if (operand->m_cached && operand->m_dirty) {
+            operand->refresh();
+        }
+    }
+    m_dirty = false;
+    return m_cache;
+}
+
+void Function::markDirty() {
+    if (m_dirty) {
+        return;
+    }
+    m_dirty = true;
+    for (Function* parent : m_parents) {
+        parent->markDirty();
+    }
+}
+
+// -------------------- DependencyTracker Implementations --------------------
+
+void DependencyTracker::track(Function* root) {
+    MATH_SCOPED_TIMER("DependencyTracker::track");
+    if (isTracked(root)) {
+        return;
+    }
+    // Post order, a node is settled once everything below it is
+    std::vector<std::pair<Function*, bool>> stack = {{root, false}};
+    while (!stack.empty()) {
+        auto [node, expanded] = stack.back();
+        if (expanded) {
+            stack.pop_back();
+            bool cached = node->cacheable();
+            for (size_t i = 0; i < node->childCount() && cached; ++i) {
+                Function* child = node->child(i);
+                cached = child->m_cached || dynamic_cast<Variable*>(child) != nullptr;
+            }
+            node->m_cached = cached;
+            continue;
+        }
+        if (isTracked(node)) {
+            // Pushed twice before its first visit
+            stack.pop_back();
+            continue;
+        }
+        m_nodes.push_back(node);
+        if (auto* var = dynamic_cast<Variable*>(node)) {
+            // A read of the double is cheaper than a cache, variables stay uncached
+            std::vector<Variable*>& group = m_groups[aliasKey(var)];
+            group.push_back(var);
+            var->m_aliases = &group;
+            stack.pop_back();
+            continue;
+        }
+        node->m_tracked = true;
+        node->m_dirty = true;
+        stack.back().second = true;
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            Function* child = node->child(i);
+            child->m_parents.push_back(node);
+            if (!isTracked(child)) {
+                stack.emplace_back(child, false);
+            }
+        }
+    }
+}
+
+DependencyTracker::AliasKey DependencyTracker::aliasKey(const Variable* var) {
+    if (var->m_store) {
+        return {var->m_store, var->m_index};
+    }
+    return {var->m_value, 0};
+}
+
+bool DependencyTracker::isTracked(const Function* node) {
+    if (auto* var = dynamic_cast<const Variable*>(node)) {
+        return var->m_aliases != nullptr;
+    }
+    return node->m_tracked;
+}
+
+void DependencyTracker::release() {
+    for (Function* node : m_nodes) {
+        node->m_tracked = false;
+        node->m_cached = false;
+        node->m_dirty = true;
+        node->m_parents.clear();
+        if (auto* var = dynamic_cast<Variable*>(node)) {
+            var->m_aliases = nullptr;
+        }
+    }
+    m_nodes.clear();
+    m_groups.clear();
+}
 
 // -------------------- Constant Implementations --------------------
 
-Constant::Constant(double value) : value(value) {}
+Constant::Constant(double value) : m_value(value) {}
 
 double Constant::evaluate() const {
-    return value;
+    FUNCTION_EVALUATE_PROBE();
+    return m_value;
 }
 
 Function* Constant::derivative(Variable* /*var*/) const {
@@ -13,15 +147,35 @@ Function* Constant::derivative(Variable* /*var*/) const {
 }
 
 Function* Constant::clone() const {
-    return new Constant(value);
+    return new Constant(m_value);
 }
 
 // -------------------- Variable Implementations --------------------
 
-Variable::Variable(double* value) : value(value) {}
+namespace {
+// Set by VariableStore::Override
+thread_local const VariableStore* overriddenStore = nullptr;
+thread_local const double* overrideValues = nullptr;
+}
+
+Variable::Variable(double* value) : m_value(value) {}
+
+Variable::Variable(VariableStore* store, size_t index) : m_value(nullptr), m_store(store), m_index(index) {
+    if (index >= store->size()) {
+        throw std::out_of_range("Variable: index is out of the store");
+    }
+}
+
+double* Variable::address() const {
+    return m_store ? m_store->data() + m_index : m_value;
+}
 
 double Variable::evaluate() const {
-    return *value;
+    FUNCTION_EVALUATE_PROBE();
+    if (m_store) {
+        return m_store == overriddenStore ? overrideValues[m_index] : m_store->data()[m_index];
+    }
+    return *m_value;
 }
 
 Function* Variable::derivative(Variable* var) const {
@@ -32,21 +186,57 @@ Function* Variable::derivative(Variable* var) const {
 }
 
 Function* Variable::clone() const {
-    return new Variable(value);
+    return m_store ? new Variable(m_store, m_index) : new Variable(m_value);
 }
 
 bool Variable::operator==(Variable* other) const {
-    return this->value == other->value;
+    return address() == other->address();
 }
 
 void Variable::setValue(double value) {
-    *this->value = value;
+    double* target = address();
+    if (*target == value) {
+        return;
+    }
+    *target = value;
+    if (m_aliases) {
+        for (Variable* alias : *m_aliases) {
+            for (Function* parent : alias->m_parents) {
+                parent->markDirty();
+            }
+        }
+    }
+}
+
+// -------------------- VariableStore Implementations --------------------
+
+Variable* VariableStore::variable(size_t index) {
+    return new Variable(this, index);
+}
+
+void VariableStore::assign(const std::vector<double>& values) {
+    if (values.size() != m_values.size()) {
+        throw std::invalid_argument("VariableStore: not right vector of values");
+    }
+    std::copy(values.begin(), values.end(), m_values.begin());
+}
+
+VariableStore::Override::Override(const VariableStore& store, const double* values)
+    : m_previousStore(overriddenStore), m_previousValues(overrideValues) {
+    overriddenStore = &store;
+    overrideValues = values;
+}
+
+VariableStore::Override::~Override() {
+    overriddenStore = m_previousStore;
+    overrideValues = m_previousValues;
 }
 
 // -------------------- Addition Implementations --------------------
 
 double Addition::evaluate() const {
-    return left->evaluate() + right->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    return left->value() + right->value();
 }
 
 Function* Addition::derivative(Variable* var) const {
@@ -65,7 +255,8 @@ Function* Addition::clone() const {
 
 
 double Subtraction::evaluate() const {
-    return left->evaluate() - right->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    return left->value() - right->value();
 }
 
 Function* Subtraction::derivative(Variable* var) const {
@@ -83,7 +274,8 @@ Function* Subtraction::clone() const {
 
 
 double Multiplication::evaluate() const {
-    return left->evaluate() * right->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    return left->value() * right->value();
 }
 
 Function* Multiplication::derivative(Variable* var) const {
@@ -101,11 +293,12 @@ Function* Multiplication::clone() const {
 // -------------------- Division Implementations --------------------
 
 double Division::evaluate() const {
-    double den = right->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double den = right->value();
     if (den == 0.0) {
         throw std::runtime_error("Division by zero");
     }
-    return left->evaluate() / den;
+    return left->value() / den;
 }
 
 Function* Division::derivative(Variable* var) const {
@@ -136,7 +329,8 @@ Function* Division::clone() const {
 // -------------------- Power Implementations --------------------
 
 double Power::evaluate() const {
-    return std::pow(left->evaluate(), right->evaluate());
+    FUNCTION_EVALUATE_PROBE();
+    return std::pow(left->value(), right->value());
 }
 
 Function* Power::derivative(Variable* var) const {
@@ -155,7 +349,8 @@ Function* Power::clone() const {
 // -------------------- Negation Implementations --------------------
 
 double Negation::evaluate() const {
-    return -1 * operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    return -1 * operand->value();
 }
 
 Function* Negation::derivative(Variable* var) const {
@@ -170,7 +365,8 @@ Function* Negation::clone() const {
 // -------------------- Abs Implementations --------------------
 
 double Abs::evaluate() const {
-    return std::abs(operand->evaluate());
+    FUNCTION_EVALUATE_PROBE();
+    return std::abs(operand->value());
 }
 
 Function* Abs::derivative(Variable* var) const {
@@ -188,7 +384,8 @@ Function* Abs::clone() const {
 // -------------------- Sign Implementations --------------------
 
 double Sign::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     if (arg_value > 0.0) {
         return 1.0;
     } else if (arg_value < 0.0) {
@@ -210,8 +407,9 @@ Function* Sign::clone() const {
 // -------------------- Modulo Implementations --------------------
 
 double Mod::evaluate() const {
-    double num = left->evaluate();
-    double den = right->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double num = left->value();
+    double den = right->value();
 
     if (den == 0.0) {
         throw std::domain_error("Division by zero in Modulo function.");
@@ -231,7 +429,8 @@ Function* Mod::clone() const {
 // -------------------- rightial Implementations --------------------
 
 double Exp::evaluate() const {
-    return std::exp(operand->evaluate());
+    FUNCTION_EVALUATE_PROBE();
+    return std::exp(operand->value());
 }
 
 Function* Exp::derivative(Variable* var) const {
@@ -247,7 +446,8 @@ Function* Exp::clone() const {
 // -------------------- Ln Implementations --------------------
 
 double Ln::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     if (arg_value <= 0.0) {
         throw std::runtime_error("Logarithm of non-positive value");
     }
@@ -268,8 +468,9 @@ Function* Ln::clone() const {
 
 
 double Log::evaluate() const {
-    double left_val = left->evaluate();
-    double arg_val = right->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double left_val = left->value();
+    double arg_val = right->value();
     if (left_val <= 0.0 || left_val == 1.0) {
         throw std::runtime_error("Invalid left for logarithm");
     }
@@ -295,7 +496,8 @@ Function* Log::clone() const {
 // -------------------- Sqrt Implementations --------------------
 
 double Sqrt::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     return std::sqrt(arg_value);
 }
 
@@ -322,7 +524,8 @@ Function *Sqrt::clone() const {
 // -------------------- Sin Implementations --------------------
 
 double Sin::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     return std::sin(arg_value);
 }
 
@@ -339,7 +542,8 @@ Function *Sin::clone() const {
 // -------------------- Cos Implementations --------------------
 
 double Cos::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     return std::cos(arg_value);
 }
 
@@ -359,7 +563,8 @@ Function *Cos::clone() const {
 
 
 double Asin::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     return std::asin(arg_value);
 }
 
@@ -386,7 +591,8 @@ Function *Asin::clone() const {
 // -------------------- Acos Implementations --------------------
 
 double Acos::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     return std::acos(arg_value);
 }
 
@@ -414,7 +620,8 @@ Function *Acos::clone() const {
 
 
 double Tan::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     return std::tan(arg_value);
 }
 
@@ -441,7 +648,8 @@ Function *Tan::clone() const {
 // -------------------- Atan Implementations --------------------
 
 double Atan::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     return std::atan(arg_value);
 }
 
@@ -470,7 +678,8 @@ Function *Atan::clone() const {
 // -------------------- Cot Implementations --------------------
 
 double Cot::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     return 1.0 / std::tan(arg_value);
 }
 
@@ -501,7 +710,8 @@ Function *Cot::clone() const {
 
 // -------------------- Acot Implementations --------------------
 double Acot::evaluate() const {
-    double arg_value = operand->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double arg_value = operand->value();
     // Acot(x) = π/2 - atan(x)
     return (M_PI / 2.0) - std::atan(arg_value);
 }
@@ -535,14 +745,15 @@ Function *Acot::clone() const {
 
 
 double Max::evaluate() const {
-    double left_val = left->evaluate();
-    double right_val = right->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double left_val = left->value();
+    double right_val = right->value();
     return std::max(left_val, right_val);
 }
 
 Function *Max::derivative(Variable *var) const {
-    double left_val = left->evaluate();
-    double right_val = right->evaluate();
+    double left_val = left->value();
+    double right_val = right->value();
 
     if (left_val > right_val) {
         return left->derivative(var);
@@ -563,14 +774,15 @@ Function *Max::clone() const {
 
 
 double Min::evaluate() const {
-    double left_val = left->evaluate();
-    double right_val = right->evaluate();
+    FUNCTION_EVALUATE_PROBE();
+    double left_val = left->value();
+    double right_val = right->value();
     return std::min(left_val, right_val);
 }
 
 Function *Min::derivative(Variable *var) const {
-    double left_val = left->evaluate();
-    double right_val = right->evaluate();
+    double left_val = left->value();
+    double right_val = right->value();
 
     if (left_val < right_val) {
         return left->derivative(var);
@@ -13,19 +13,37 @@ void GradientOptimizer::setTask(Task* tsk) {
 void GradientOptimizer::optimize() {
     if (!task) return;
 
-    for (int iter = 0; iter < maxIterations; ++iter) {
+    int iter = 0;
+    while (iter < maxIterations) {
+        IterationTimer timer(m_observer != nullptr);
         Matrix<> grad = task->gradient();
+        double assemblyTime = timer.lap();
 
         for (size_t i = 0; i < grad.rows_size(); ++i) {
             result[i] -= learningRate * grad(i, 0);
         }
         double update = task->setError(result);
 
+        if (m_observer) {
+            IterationReport report;
+            report.iteration = iter;
+            report.error = update;
+            report.gradientNorm = grad.norm();
+            report.stepNorm = learningRate * report.gradientNorm;
+            report.assemblyTime = assemblyTime;
+            report.updateTime = timer.lap();
+            m_observer->onIteration(report);
+        }
+        ++iter;
+
         if (update < 1e-6) {
             converged = true;
             break;
         }
     }
+    if (m_observer) {
+        m_observer->onFinish(iter, converged);
+    }
 }
 
 std::vector<double> GradientOptimizer::getResult() const {
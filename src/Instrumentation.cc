@@ -0,0 +1,383 @@
+//
+// Registry of the Math instrumentation probes.
+//
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace instrumentation {
+
+namespace {
+
+template <typename T>
+void atomicMin(std::atomic<T> &target, T value) {
+    T current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+template <typename T>
+void atomicMax(std::atomic<T> &target, T value) {
+    T current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void atomicAdd(std::atomic<double> &target, double value) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+    }
+}
+
+// Innermost allocation scope of this thread
+thread_local AllocationScope *currentScope = nullptr;
+
+void countAllocation(AllocationCounts &counts, int64_t bytes) {
+    ++counts.allocations;
+    counts.allocatedBytes += bytes;
+    counts.liveBytes += bytes;
+    counts.peakBytes = std::max(counts.peakBytes, counts.liveBytes);
+}
+
+void countDeallocation(AllocationCounts &counts, int64_t bytes) {
+    ++counts.deallocations;
+    counts.freedBytes += bytes;
+    counts.liveBytes -= bytes;
+}
+
+// Small stable thread ids for the trace viewer
+int threadNumber() {
+    static std::atomic<int> next{0};
+    thread_local int number = next.fetch_add(1);
+    return number;
+}
+
+void writeString(std::ostream &out, const std::string &s) {
+    out << '"';
+    for (char c: s) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+template <typename Entry, typename Write>
+void writeSection(std::ostream &out, const char *title,
+                  const std::map<std::string, std::unique_ptr<Entry>> &entries, Write write) {
+    out << "  ";
+    writeString(out, title);
+    out << ": {";
+    bool first = true;
+    for (const auto &[name, entry]: entries) {
+        out << (first ? "\n    " : ",\n    ");
+        writeString(out, name);
+        out << ": ";
+        write(*entry);
+        first = false;
+    }
+    out << (first ? "}" : "\n  }");
+}
+
+} // namespace
+
+// -------------------- Timer Implementations --------------------
+
+void Timer::record(int64_t ns) {
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(ns, std::memory_order_relaxed);
+    atomicMin(m_min, ns);
+    atomicMax(m_max, ns);
+}
+
+void Timer::reset() {
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_min.store(INT64_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+// -------------------- Histogram Implementations --------------------
+
+int Histogram::bucket(double value) {
+    if (!(value > 0.0)) {
+        return 0;
+    }
+    int exponent;
+    std::frexp(value, &exponent);
+    return std::clamp(exponent + kOffset, 0, kBuckets - 1);
+}
+
+double Histogram::upperBound(int bucket) {
+    return std::ldexp(1.0, bucket - kOffset);
+}
+
+void Histogram::record(double value) {
+    if (m_count.fetch_add(1, std::memory_order_relaxed) == 0) {
+        m_min.store(value, std::memory_order_relaxed);
+        m_max.store(value, std::memory_order_relaxed);
+    } else {
+        atomicMin(m_min, value);
+        atomicMax(m_max, value);
+    }
+    m_buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    atomicAdd(m_sum, value);
+}
+
+void Histogram::reset() {
+    for (auto &b: m_buckets) {
+        b.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0.0, std::memory_order_relaxed);
+    m_min.store(0.0, std::memory_order_relaxed);
+    m_max.store(0.0, std::memory_order_relaxed);
+}
+
+// -------------------- Allocation Implementations --------------------
+
+const char *allocationKindName(AllocationKind kind) {
+    switch (kind) {
+        case AllocationKind::Matrix:
+            return "Matrix";
+        case AllocationKind::Function:
+            return "Function";
+    }
+    return "Unknown";
+}
+
+void AllocationTracker::allocated(int64_t bytes) {
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+    m_allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    int64_t live = m_liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    atomicMax(m_peakBytes, live);
+}
+
+void AllocationTracker::freed(int64_t bytes) {
+    m_deallocations.fetch_add(1, std::memory_order_relaxed);
+    m_freedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    m_liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+AllocationCounts AllocationTracker::counts() const {
+    AllocationCounts counts;
+    counts.allocations = m_allocations.load(std::memory_order_relaxed);
+    counts.deallocations = m_deallocations.load(std::memory_order_relaxed);
+    counts.allocatedBytes = m_allocatedBytes.load(std::memory_order_relaxed);
+    counts.freedBytes = m_freedBytes.load(std::memory_order_relaxed);
+    counts.liveBytes = m_liveBytes.load(std::memory_order_relaxed);
+    counts.peakBytes = m_peakBytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+void AllocationTracker::reset() {
+    m_allocations.store(0, std::memory_order_relaxed);
+    m_deallocations.store(0, std::memory_order_relaxed);
+    m_allocatedBytes.store(0, std::memory_order_relaxed);
+    m_freedBytes.store(0, std::memory_order_relaxed);
+    m_peakBytes.store(m_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope(const char *name) : m_name(name), m_parent(currentScope) {
+    currentScope = this;
+}
+
+AllocationScope::~AllocationScope() {
+    currentScope = m_parent;
+    if (m_name == nullptr) {
+        return;
+    }
+    Registry &registry = Registry::instance();
+    std::string name(m_name);
+    registry.counter(name + ".allocations").add(m_total.allocations);
+    registry.counter(name + ".bytes").add(m_total.allocatedBytes);
+    registry.histogram(name + ".peakBytes").record(static_cast<double>(m_total.peakBytes));
+}
+
+void AllocationScope::allocated(int kind, int64_t bytes) {
+    countAllocation(m_counts[kind], bytes);
+    countAllocation(m_total, bytes);
+}
+
+void AllocationScope::freed(int kind, int64_t bytes) {
+    countDeallocation(m_counts[kind], bytes);
+    countDeallocation(m_total, bytes);
+}
+
+void recordAllocation(AllocationKind kind, size_t bytes) {
+    Registry::instance().allocations(kind).allocated(static_cast<int64_t>(bytes));
+    for (AllocationScope *scope = currentScope; scope != nullptr; scope = scope->m_parent) {
+        scope->allocated(static_cast<int>(kind), static_cast<int64_t>(bytes));
+    }
+}
+
+void recordDeallocation(AllocationKind kind, size_t bytes) {
+    Registry::instance().allocations(kind).freed(static_cast<int64_t>(bytes));
+    for (AllocationScope *scope = currentScope; scope != nullptr; scope = scope->m_parent) {
+        scope->freed(static_cast<int>(kind), static_cast<int64_t>(bytes));
+    }
+}
+
+// -------------------- Registry Implementations --------------------
+
+Registry::Registry() : m_epoch(Clock::now()) {}
+
+Registry &Registry::instance() {
+    static Registry registry;
+    return registry;
+}
+
+Counter &Registry::counter(const std::string &name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &entry = m_counters[name];
+    if (!entry) {
+        entry = std::make_unique<Counter>();
+    }
+    return *entry;
+}
+
+Timer &Registry::timer(const std::string &name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &entry = m_timers[name];
+    if (!entry) {
+        entry = std::make_unique<Timer>();
+    }
+    return *entry;
+}
+
+Histogram &Registry::histogram(const std::string &name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &entry = m_histograms[name];
+    if (!entry) {
+        entry = std::make_unique<Histogram>();
+    }
+    return *entry;
+}
+
+void Registry::addTraceEvent(const char *name, Clock::time_point start, Clock::time_point end) {
+    int thread = threadNumber();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_events.size() >= kMaxTraceEvents) {
+        ++m_droppedEvents;
+        return;
+    }
+    m_events.push_back({name,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(start - m_epoch).count(),
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+                        thread});
+}
+
+std::vector<TraceEvent> Registry::traceEvents() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events;
+}
+
+void Registry::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &[name, entry]: m_counters) {
+        entry->reset();
+    }
+    for (auto &[name, entry]: m_timers) {
+        entry->reset();
+    }
+    for (auto &[name, entry]: m_histograms) {
+        entry->reset();
+    }
+    for (auto &tracker: m_allocations) {
+        tracker.reset();
+    }
+    m_events.clear();
+    m_droppedEvents = 0;
+}
+
+void Registry::writeJson(std::ostream &out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << "{\n";
+    writeSection(out, "counters", m_counters, [&](const Counter &c) {
+        out << c.value();
+    });
+    out << ",\n";
+    writeSection(out, "timers", m_timers, [&](const Timer &t) {
+        out << "{\"count\": " << t.count() << ", \"total_ns\": " << t.totalNs()
+            << ", \"min_ns\": " << t.minNs() << ", \"max_ns\": " << t.maxNs()
+            << ", \"mean_ns\": " << (t.count() ? t.totalNs() / t.count() : 0) << "}";
+    });
+    out << ",\n";
+    writeSection(out, "histograms", m_histograms, [&](const Histogram &h) {
+        out << "{\"count\": " << h.count() << ", \"sum\": " << h.sum()
+            << ", \"min\": " << h.min() << ", \"max\": " << h.max() << ", \"buckets\": [";
+        bool first = true;
+        for (int b = 0; b < Histogram::kBuckets; ++b) {
+            if (h.bucketCount(b) == 0) {
+                continue;
+            }
+            out << (first ? "" : ", ") << "{\"le\": " << Histogram::upperBound(b)
+                << ", \"count\": " << h.bucketCount(b) << "}";
+            first = false;
+        }
+        out << "]}";
+    });
+    out << ",\n  \"allocations\": {";
+    for (int kind = 0; kind < kAllocationKinds; ++kind) {
+        AllocationCounts c = m_allocations[kind].counts();
+        out << (kind == 0 ? "\n    " : ",\n    ");
+        writeString(out, allocationKindName(static_cast<AllocationKind>(kind)));
+        out << ": {\"allocations\": " << c.allocations << ", \"deallocations\": " << c.deallocations
+            << ", \"allocated_bytes\": " << c.allocatedBytes << ", \"freed_bytes\": " << c.freedBytes
+            << ", \"live_bytes\": " << c.liveBytes << ", \"peak_bytes\": " << c.peakBytes << "}";
+    }
+    out << "\n  }";
+    out << ",\n  \"dropped_trace_events\": " << m_droppedEvents << "\n}\n";
+}
+
+void Registry::writeChromeTrace(std::ostream &out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    for (const auto &event: m_events) {
+        out << (first ? "\n  " : ",\n  ") << "{\"name\": ";
+        writeString(out, event.name);
+        out << ", \"cat\": \"math\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+            << ", \"ts\": " << static_cast<double>(event.startNs) / 1000.0
+            << ", \"dur\": " << static_cast<double>(event.durationNs) / 1000.0 << "}";
+        first = false;
+    }
+    // Final counter values as one counter event each, so they show up as tracks
+    int64_t end = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_epoch).count();
+    for (const auto &[name, counter]: m_counters) {
+        out << (first ? "\n  " : ",\n  ") << "{\"name\": ";
+        writeString(out, name);
+        out << ", \"cat\": \"math\", \"ph\": \"C\", \"pid\": 1, \"tid\": 0, \"ts\": "
+            << static_cast<double>(end) / 1000.0 << ", \"args\": {\"value\": " << counter->value() << "}}";
+        first = false;
+    }
+    out << "\n]}\n";
+}
+
+// -------------------- ScopedTimer Implementations --------------------
+
+ScopedTimer::~ScopedTimer() {
+    Clock::time_point end = Clock::now();
+    m_timer.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count());
+    Registry &registry = Registry::instance();
+    if (registry.tracing()) {
+        registry.addTraceEvent(m_name, m_start, end);
+    }
+}
+
+NestedScopedTimer::~NestedScopedTimer() {
+    if (--m_depth != 0) {
+        return;
+    }
+    Clock::time_point end = Clock::now();
+    m_timer.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count());
+    Registry &registry = Registry::instance();
+    if (registry.tracing()) {
+        registry.addTraceEvent(m_name, m_start, end);
+    }
+}
+
+} // namespace instrumentation
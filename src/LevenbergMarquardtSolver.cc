@@ -16,6 +16,15 @@ void LMSolver::setTask(Task *task) {
     }
     m_result = c_task->getValues();
     currentError = c_task->getError();
+
+    size_t m = c_task->residualCount();
+    size_t n = m_result.size();
+    m_work.residuals.resize(m, 1);
+    m_work.jacobian.resize(m, n);
+    m_work.gradient.resize(n, 1);
+    m_work.hessian.resize(n, n);
+    m_work.delta.resize(n, 1);
+    m_work.newParams.resize(n);
 }
 
 double LMSolver::getCurrentError() const {
@@ -28,45 +37,105 @@ bool LMSolver::isConverged() const {
 
 void LMSolver::optimize() {
     int iteration = 0;
-    Matrix<> gradient;
-    Matrix<> hessian;
+    Workspace &w = m_work;
+    // The task is linearized again only after an accepted step
+    bool linearized = false;
+    double gradientNorm = 0.0;
 
     while (iteration < maxIterations) {
-        auto [residuals, jacobian] = c_task->linearizeFunction();
-        gradient = jacobian.transpose() * residuals;
-        if (gradient.norm() < epsilon1) {
-            converged = true;
-            break;
+        IterationTimer timer(m_observer != nullptr);
+        bool retry = linearized;
+        if (!linearized) {
+            c_task->linearizeInto(w.residuals, w.jacobian);
+            Matrix<>::gemv_t(w.jacobian, w.residuals, w.gradient);
+            gradientNorm = w.gradient.norm();
+            if (gradientNorm < epsilon1) {
+                converged = true;
+                break;
+            }
+            if (m_factorization != Factorization::SVD) {
+                Matrix<>::syrk(w.jacobian, w.hessian);
+            }
+            linearized = true;
         }
+        double assemblyTime = timer.lap();
 
-        hessian = jacobian.transpose() * jacobian;
-        Matrix<> dampedHessian = hessian + Matrix<>::identity(hessian.rows_size(), hessian.cols_size()) * lambda;
-        QR dH(dampedHessian);
-        dH.qr();
-        Matrix<> delta = dH.pseudoInverse() * gradient;
+        double usedLambda = lambda;
+        if (m_factorization == Factorization::SVD) {
+            if (!retry) {
+                w.svd.compute(w.jacobian);
+            }
+            w.svd.solveDampedInto(w.gradient, lambda, w.delta);
+        } else if (m_factorization == Factorization::MixedPrecision) {
+            if (retry) {
+                w.mixed.refactorize(lambda);
+            } else {
+                w.mixed.factorize(w.hessian, lambda);
+            }
+            if (w.mixed.isPositiveDefinite()) {
+                w.mixed.solveInto(w.gradient, w.delta);
+            } else {
+                w.ldlt.factorize(w.hessian, lambda);
+                w.ldlt.solveInto(w.gradient, w.delta);
+            }
+        } else {
+            if (retry) {
+                w.cholesky.refactorize(lambda);
+            } else {
+                w.cholesky.factorize(w.hessian, lambda);
+            }
+            if (w.cholesky.isPositiveDefinite()) {
+                w.cholesky.solveInto(w.gradient, w.delta);
+            } else {
+                w.ldlt.factorize(w.hessian, lambda);
+                w.ldlt.solveInto(w.gradient, w.delta);
+            }
+        }
+        double factorizationTime = timer.lap();
 
-        Matrix<> newResult = Matrix<>(m_result).transpose() - delta;
-        std::vector<double> newParams(newResult.rows_size());
-        for (int i = 0; i < newResult.rows_size(); ++i) {
-            newParams[i] = newResult(i, 0);
+        for (size_t i = 0; i < w.newParams.size(); ++i) {
+            w.newParams[i] = m_result[i] - w.delta(i, 0);
         }
 
-        double newError = c_task->setError(newParams);
-        if (newError < currentError) {
-            m_result = newParams;
+        double newError = c_task->setError(w.newParams);
+        bool accepted = newError < currentError;
+        if (accepted) {
+            m_result = w.newParams;
             currentError = newError;
             lambda /= b_decrease;
+            linearized = false;
         } else {
+            // setError moved the task to the rejected point, restore the kept one
+            c_task->setError(m_result);
             lambda *= b_increase;
         }
 
-        Matrix<> dParams = newResult - Matrix<>(m_result).transpose();
-        if (gradient.norm() < epsilon1 && dParams.norm() < epsilon2) {
+        if (m_observer) {
+            IterationReport report;
+            report.iteration = iteration;
+            report.error = currentError;
+            report.gradientNorm = gradientNorm;
+            report.stepNorm = w.delta.norm();
+            report.lambda = usedLambda;
+            report.accepted = accepted;
+            report.assemblyTime = assemblyTime;
+            report.factorizationTime = factorizationTime;
+            report.updateTime = timer.lap();
+            m_observer->onIteration(report);
+        }
+        ++iteration;
+
+        // distance between the tried point and the kept one
+        double dParamsNorm = 0.0;
+        for (size_t i = 0; i < w.newParams.size(); ++i) {
+            dParamsNorm += (w.newParams[i] - m_result[i]) * (w.newParams[i] - m_result[i]);
+        }
+        if (gradientNorm < epsilon1 && std::sqrt(dParamsNorm) < epsilon2) {
             converged = true;
             break;
         }
-
-        ++iteration;
     }
-    std::cout << "Levenberg-Marquardt converged after " << iteration << " iterations." << std::endl;
+    if (m_observer) {
+        m_observer->onFinish(iteration, converged);
+    }
 }
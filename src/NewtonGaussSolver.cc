@@ -1,4 +1,5 @@
 #include "NewtonGaussSolver.h"
+#include <algorithm>
 
 NewtonGaussSolver::NewtonGaussSolver(int maxItr)
         : task(nullptr), converged(false), maxIterations(maxItr) {}
@@ -11,26 +12,6 @@ void NewtonGaussSolver::setTask(Task *task) {
     result = this->task->getValues();
 }
 
-// inverse method substitutions for upper-triangle matrix R and vector y
-Matrix<> backSubstitution(const Matrix<> &R, const Matrix<> &y) {
-    size_t n = R.rows_size();
-    Matrix<> x(n, 1);
-    // Go from last to first
-    for (int i = static_cast<int>(n) - 1; i >= 0; --i) {
-        double sum = y(i, 0);
-        for (size_t j = i + 1; j < n; ++j) {
-            sum -= R(i, j) * x(j, 0);
-        }
-        if (std::fabs(R(i, i)) < 1e-14) {
-            // Singular matrix, can set x(i,0) = 0 or throw
-            x(i, 0) = 0.0;
-        } else {
-            x(i, 0) = sum / R(i, i);
-        }
-    }
-    return x;
-}
-
 void NewtonGaussSolver::optimize() {
     if (!task) {
         throw std::runtime_error("Task is not set");
@@ -41,32 +22,64 @@ void NewtonGaussSolver::optimize() {
     converged = false;
 
     while (iteration < maxIterations) {
+        IterationTimer timer(m_observer != nullptr);
         auto [residuals, J] = task->linearizeFunction();
 
         result = task->getValues();
 
-        Matrix<> JT = J.transpose();
-        Matrix<> H = JT * J;
-        Matrix<> g = JT * residuals;
-
-        QR qrSolver(H);
-        qrSolver.qr();
-        Matrix<> Q = qrSolver.Q();  // n x n
-        Matrix<> R = qrSolver.R();  // n x n
-
-        Matrix<> Qt = Q.transpose();
-        Matrix<> y = Qt * g;        // n x 1
-
-        Matrix<> delta = backSubstitution(R, y);
+        Matrix<> g;
+        Matrix<>::gemv_t(J, residuals, g);
+        Matrix<> H;
+        if (m_factorization != Factorization::QR) {
+            Matrix<>::syrk(J, H);
+        }
+        double assemblyTime = timer.lap();
+
+        // J^T J is only semidefinite for a rank deficient J, the minimum
+        // norm step J^{+} r then comes from the SVD of J
+        Matrix<> delta;
+        bool solved = false;
+        if (m_factorization == Factorization::QR) {
+            size_t m = J.rows_size();
+            size_t n = J.cols_size();
+            if (m >= n) {
+                // A zero row keeps a square J tall enough, it changes no
+                // least squares solution
+                m_augmented.resize(std::max(m, n + 1), n + 1);
+                m_augmented.setZeroes();
+                for (size_t i = 0; i < m; ++i) {
+                    std::copy(J.rowData(i), J.rowData(i) + n, m_augmented.rowData(i));
+                    m_augmented(i, n) = residuals(i, 0);
+                }
+                m_tsqr.factorize(m_augmented);
+                if (m_tsqr.isFullRank(n)) {
+                    m_tsqr.solveAugmentedInto(n, delta);
+                    solved = true;
+                }
+            }
+        } else if (m_factorization == Factorization::MixedPrecision) {
+            m_mixed.factorize(H);
+            if (m_mixed.isPositiveDefinite()) {
+                m_mixed.solveInto(g, delta);
+                solved = true;
+            }
+        } else {
+            Cholesky<> cholesky(H);
+            if (cholesky.isPositiveDefinite()) {
+                cholesky.solveInto(g, delta);
+                solved = true;
+            }
+        }
+        if (!solved) {
+            SVD<>(J).solveInto(residuals, delta);
+        }
+        double factorizationTime = timer.lap();
 
         for (size_t i = 0; i < result.size(); ++i) {
             result[i] -= delta(i, 0);
         }
 
-        task->setError(result);
-
-        double currentError = task->getError();
-        // std::cout << currentError << '\n';
+        double currentError = task->setError(result);
 
         double delta_norm = 0.0;
         for (size_t i = 0; i < delta.rows_size(); ++i) {
@@ -74,14 +87,28 @@ void NewtonGaussSolver::optimize() {
         }
         delta_norm = std::sqrt(delta_norm);
 
+        if (m_observer) {
+            IterationReport report;
+            report.iteration = iteration;
+            report.error = currentError;
+            report.gradientNorm = g.norm();
+            report.stepNorm = delta_norm;
+            report.assemblyTime = assemblyTime;
+            report.factorizationTime = factorizationTime;
+            report.updateTime = timer.lap();
+            m_observer->onIteration(report);
+        }
+        ++iteration;
+
         if (delta_norm < epsilon) {
             converged = true;
             break;
         }
-        ++iteration;
     }
 
-    std::cout << "Newton-Gauss converged after " << iteration << " iterations." << std::endl;
+    if (m_observer) {
+        m_observer->onFinish(iteration, converged);
+    }
 }
 
 std::vector<double> NewtonGaussSolver::getResult() const {
@@ -3,6 +3,9 @@
 //
 #include "NewtonOptimizer.h"
 
+#include <algorithm>
+#include <cmath>
+
 NewtonOptimizer::NewtonOptimizer(int maxItr): maxIterations(maxItr), task(nullptr), converged(false){}
 void NewtonOptimizer::setTask(Task *task){
     this->task = task;
@@ -12,29 +15,44 @@ void NewtonOptimizer::optimize(){
     if(task == nullptr) return;
     int itr = 0;
     while(itr < maxIterations) {
-        itr++;
+        IterationTimer timer(m_observer != nullptr);
         result = task->getValues();
         Matrix<> grad = task->gradient();
-        double norm = 0;
-        for (int i = 0; i < grad.cols_size(); i++) {
-            norm += grad(i, 0) * grad(i, 0);
-        }
-        norm = std::sqrt(norm);
-        if (norm < 1e-6) {
+        if (grad.norm() < 1e-6) {
             converged = true;
             break;
         }
         Matrix<> hess = task->hessian();
-        QR qrH = hess;
-        qrH.qr();
-        Matrix<> HInv = qrH.pseudoInverse();
-        Matrix<> step = (HInv + Matrix<>::identity(HInv.cols_size()) * 0.0001) * grad;
+        double assemblyTime = timer.lap();
+        // Modified Newton: negative eigenvalues are flipped so that the step
+        // is a descent direction even away from a minimum
+        eigen.compute(hess);
+        const auto &w = eigen.eigenvalues();
+        double floor = curvatureFloor * std::max({std::abs(w.front()), std::abs(w.back()), 1.0});
+        Matrix<> step;
+        eigen.solveModifiedInto(grad, step, floor);
+        double factorizationTime = timer.lap();
         for (int i = 0; i < result.size(); i++) {
             result[i] -= step(i, 0);
         }
         double err = task->setError(result);
+        if (m_observer) {
+            IterationReport report;
+            report.iteration = itr;
+            report.error = err;
+            report.gradientNorm = grad.norm();
+            report.stepNorm = step.norm();
+            report.negativeCurvature = static_cast<int>(eigen.negativeCount(floor));
+            report.assemblyTime = assemblyTime;
+            report.factorizationTime = factorizationTime;
+            report.updateTime = timer.lap();
+            m_observer->onIteration(report);
+        }
+        itr++;
+    }
+    if (m_observer) {
+        m_observer->onFinish(itr, converged);
     }
-    std::cout << "NewtonOptimizer: " << itr << " iterations" << std::endl;
 }
 bool NewtonOptimizer::isConverged() const {
     return converged;
@@ -1,4 +1,7 @@
 #include "QR.h"
+#include <utility>
+#include <vector>
+#include "FixedMatrix.h"
 
 QR::QR(const Matrix<>& _A) {
     if (_A.rows_size() < 1 || _A.cols_size() < 1) {
@@ -10,7 +13,7 @@ QR::QR(const Matrix<>& _A) {
 QR::QR(const QR &other) : _A(other._A), _Q(other._Q), _R(other._R) {}
 
 void QR::qr() {
-    qrIMGS();
+    qrCGS2();
 }
 
 QR::QR(QR &&other) noexcept : _A(std::move(other._A)), _Q(std::move(other._Q)), _R(std::move(other._R)) {}
@@ -39,132 +42,223 @@ bool operator!=(const QR &A, const QR &B) {
     return !(A == B);
 }
 
-void QR::qrCGS() {
-    size_t m = _A.rows_size();
-    size_t n = _A.cols_size();
-    size_t min_mn = std::min(m, n);
+namespace {
 
-    _Q = Matrix<>(m, min_mn);
-    _R = Matrix<>(min_mn, n);
+// Gram-Schmidt kernels on column-major panels: every vector is a contiguous
+// column of m values. Sums keep kLanes independent partial results, which the compiler
+// maps onto packed SIMD registers without reassociating a single sum.
+constexpr size_t kLanes = 4;
 
-    for (size_t i = 0; i < n; ++i) {
-        std::vector<double> v_i = _A.getCol(i);
-        std::vector<double> u_i = v_i;
-
-        for (size_t j = 0; j < min_mn && j < i; ++j) {
-            std::vector<double> e_j = _Q.getCol(j);
-            double proj_scalar = 0.0;
+double dot(const double* a, const double* b, size_t m) {
+    double acc[kLanes] = {};
+    size_t k = 0;
+    for (; k + kLanes <= m; k += kLanes) {
+        for (size_t l = 0; l < kLanes; ++l) {
+            acc[l] += a[k + l] * b[k + l];
+        }
+    }
+    double sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    for (; k < m; ++k) {
+        sum += a[k] * b[k];
+    }
+    return sum;
+}
 
-            for (size_t k = 0; k < m; ++k) {
-                proj_scalar += v_i[k] * e_j[k];
+// h = P^T v for the m x rows panel P, four columns share every load of v
+void project(const double* P, size_t rows, size_t m, const double* v, double* h) {
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        const double* p0 = P + i * m;
+        const double* p1 = p0 + m;
+        const double* p2 = p1 + m;
+        const double* p3 = p2 + m;
+        double acc[4][kLanes] = {};
+        size_t k = 0;
+        for (; k + kLanes <= m; k += kLanes) {
+            for (size_t l = 0; l < kLanes; ++l) {
+                double vk = v[k + l];
+                acc[0][l] += p0[k + l] * vk;
+                acc[1][l] += p1[k + l] * vk;
+                acc[2][l] += p2[k + l] * vk;
+                acc[3][l] += p3[k + l] * vk;
             }
+        }
+        for (size_t r = 0; r < 4; ++r) {
+            h[i + r] = (acc[r][0] + acc[r][1]) + (acc[r][2] + acc[r][3]);
+        }
+        for (; k < m; ++k) {
+            h[i] += p0[k] * v[k];
+            h[i + 1] += p1[k] * v[k];
+            h[i + 2] += p2[k] * v[k];
+            h[i + 3] += p3[k] * v[k];
+        }
+    }
+    for (; i < rows; ++i) {
+        h[i] = dot(P + i * m, v, m);
+    }
+}
 
-            _R(j, i) = proj_scalar;
+// v -= P h, one pass over v per four columns of P
+void subtract(const double* P, size_t rows, size_t m, const double* h, double* v) {
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        const double* p0 = P + i * m;
+        const double* p1 = p0 + m;
+        const double* p2 = p1 + m;
+        const double* p3 = p2 + m;
+        double h0 = h[i], h1 = h[i + 1], h2 = h[i + 2], h3 = h[i + 3];
+        for (size_t k = 0; k < m; ++k) {
+            v[k] -= (h0 * p0[k] + h1 * p1[k]) + (h2 * p2[k] + h3 * p3[k]);
+        }
+    }
+    for (; i < rows; ++i) {
+        const double* p = P + i * m;
+        double hi = h[i];
+        for (size_t k = 0; k < m; ++k) {
+            v[k] -= hi * p[k];
+        }
+    }
+}
 
-            for (size_t k = 0; k < m; ++k) {
-                u_i[k] -= proj_scalar * e_j[k];
-            }
+// Column r of the m x rows panel V loses h[r] times q
+void rankOneUpdate(double* V, size_t rows, size_t m, const double* h, const double* q) {
+    for (size_t r = 0; r < rows; ++r) {
+        double* v = V + r * m;
+        double hr = h[r];
+        for (size_t k = 0; k < m; ++k) {
+            v[k] -= hr * q[k];
         }
+    }
+}
 
-        if (i < min_mn) {
-            double normVec = 0.0;
-            for (size_t k = 0; k < m; ++k) {
-                normVec += u_i[k] * u_i[k];
-            }
-            normVec = sqrt(normVec);
+// (x_k, y_k) = G (x_k, y_k) for k in [begin, end), G is a 2x2 rotation
+void rotateRows(const FixedMatrix<double, 2, 2>& G, double* x, double* y, size_t begin, size_t end) {
+    const double* g = G.data();
+    for (size_t k = begin; k < end; ++k) {
+        double xk = x[k];
+        double yk = y[k];
+        x[k] = g[0] * xk + g[1] * yk;
+        y[k] = g[2] * xk + g[3] * yk;
+    }
+}
 
-            if (normVec > 1e-10) {
-                _R(i, i) = normVec;
+} // namespace
 
-                std::vector<double> e_i(m);
-                for (size_t k = 0; k < m; ++k) {
-                    e_i[k] = u_i[k] / normVec;
-                }
+void QR::startGramSchmidt() {
+    size_t m = _A.rows_size();
+    size_t n = _A.cols_size();
+    size_t min_mn = std::min(m, n);
+    // Column-major copies, so every column of A and Q is contiguous
+    _V = _A;
+    _Qc.resize(m, min_mn);
+    _Qc.setZeroes();
+    _R.resize(min_mn, n);
+    _R.setZeroes();
+    _h.resize(n);
+}
 
-                _Q.setCol(e_i, i);
+void QR::classicalGramSchmidt(int passes) {
+    size_t m = _A.rows_size();
+    size_t n = _A.cols_size();
+    size_t min_mn = std::min(m, n);
+    startGramSchmidt();
+    if (min_mn == 0) {
+        _Q.resize(m, 0);
+        return;
+    }
+    const double* Q = _Qc.colData(0);
+    double* h = _h.data();
+
+    for (size_t j = 0; j < n; ++j) {
+        double* v = _V.colData(j);
+        size_t k = std::min(j, min_mn);
+        // R(0:k, j) = Q^T v and v -= Q Q^T v, twice for CGS2
+        for (int pass = 0; pass < passes && k > 0; ++pass) {
+            project(Q, k, m, v, h);
+            subtract(Q, k, m, h, v);
+            for (size_t i = 0; i < k; ++i) {
+                _R.rowData(i)[j] += h[i];
             }
-            else {
-                _R(i, i) = 0.0;
+        }
+        if (j < min_mn) {
+            double normVec = std::sqrt(dot(v, v, m));
+            double* q = _Qc.colData(j);
+            if (normVec > 1e-10) {
+                _R.rowData(j)[j] = normVec;
+                for (size_t s = 0; s < m; ++s) {
+                    q[s] = v[s] / normVec;
+                }
             }
+            // else: R(j, j) and the column of Q stay zero
         }
     }
+    _Q = _Qc;
 }
 
-void QR::qrMGS() {
+void QR::qrCGS() {
+    MATH_SCOPED_TIMER("QR::qrCGS");
+    MATH_HISTOGRAM_RECORD("QR::qr.columns", _A.cols_size());
+    classicalGramSchmidt(1);
+}
+
+void QR::qrCGS2() {
+    MATH_SCOPED_TIMER("QR::qrCGS2");
+    MATH_HISTOGRAM_RECORD("QR::qr.columns", _A.cols_size());
+    classicalGramSchmidt(2);
+}
+
+void QR::modifiedGramSchmidtSweep(bool accumulate) {
     size_t m = _A.rows_size();
     size_t n = _A.cols_size();
     size_t min_mn = std::min(m, n);
-
-    _Q = Matrix<>(m, min_mn); // Orthogonal matrix
-    _R = Matrix<>(min_mn, n); // Upper triangular matrix
-
-    std::vector<std::vector<double>> V(n); // Vectors to be orthogonalized
-
-    // Initialize V with the columns of A
-    for (size_t i = 0; i < n; ++i) {
-        V[i] = _A.getCol(i);
-    }
-
     const double epsilon = 1e-10;
+    double* h = _h.data();
 
     for (size_t j = 0; j < min_mn; ++j) {
-        // Compute R(j, j) = ||V[j]|| (2-norm)
-        double normVec = 0.0;
-        for (size_t k = 0; k < m; ++k) {
-            normVec += V[j][k] * V[j][k];
-        }
-        normVec = sqrt(normVec);
-
-        _R(j, j) = normVec;
-
+        double* v = _V.colData(j);
+        double normVec = std::sqrt(dot(v, v, m));
+        _R.rowData(j)[j] = normVec;
+        double* q = _Qc.colData(j);
         if (normVec > epsilon) {
-            // Normalize Q(:, j) = V[j] / R(j, j)
-            std::vector<double> q_j(m);
-            for (size_t k = 0; k < m; ++k) {
-                q_j[k] = V[j][k] / normVec;
+            for (size_t s = 0; s < m; ++s) {
+                q[s] = v[s] / normVec;
             }
-            _Q.setCol(q_j, j);
-
-            // Update the remaining vectors in V
-            for (size_t k = j + 1; k < n; ++k) {
-                // R(j, k) = Q(:, j)^T * V[k]
-                double dotProduct = 0.0;
-                for (size_t l = 0; l < m; ++l) {
-                    dotProduct += q_j[l] * V[k][l];
-                }
-                _R(j, k) = dotProduct;
-
-                // V[k] = V[k] - R(j, k) * Q(:, j)
-                for (size_t l = 0; l < m; ++l) {
-                    V[k][l] -= dotProduct * q_j[l];
+            // R(j, j+1:n) = q^T V[j+1:n], then V[j+1:n] -= R(j, j+1:n)^T q
+            size_t rest = n - j - 1;
+            if (rest > 0) {
+                double* V = _V.colData(j + 1);
+                project(V, rest, m, q, h);
+                rankOneUpdate(V, rest, m, h, q);
+                double* r = _R.rowData(j) + j + 1;
+                for (size_t k = 0; k < rest; ++k) {
+                    r[k] = accumulate ? r[k] + h[k] : h[k];
                 }
             }
-        }
-        else {
-            std::vector<double> zero_col(m, 0.0);
-            _Q.setCol(zero_col, j);
-
-            for (size_t k = j + 1; k < n; ++k) {
-                _R(j, k) = 0.0;
-            }
+        } else {
+            std::fill(q, q + m, 0.0);
+            std::fill(_R.rowData(j) + j + 1, _R.rowData(j) + n, 0.0);
         }
     }
 }
 
+void QR::qrMGS() {
+    MATH_SCOPED_TIMER("QR::qrMGS");
+    MATH_HISTOGRAM_RECORD("QR::qr.columns", _A.cols_size());
+    startGramSchmidt();
+    modifiedGramSchmidtSweep(false);
+    _Q = _Qc;
+}
+
 void QR::qrIMGS() {
     size_t m = _A.rows_size();
     size_t n = _A.cols_size();
+    MATH_SCOPED_TIMER("QR::qrIMGS");
+    MATH_HISTOGRAM_RECORD("QR::qr.columns", n);
     size_t min_mn = std::min(m, n);
 
-    // init Q and R
-    _Q = Matrix<>(m, min_mn);
-    _R = Matrix<>(min_mn, n);
-
-    // init V with cols A
-    std::vector<std::vector<double>> V(n, std::vector<double>(m));
-    for (size_t i = 0; i < n; ++i) {
-        V[i] = _A.getCol(i);
-    }
+    // Q, R and the working vectors reuse their buffers when the shape repeats,
+    // so refactoring a matrix of the same size does not allocate
+    startGramSchmidt();
 
     const double epsilon = 1e-10; // Orthogonality accuracy
     const int max_iterations = 10;
@@ -172,64 +266,18 @@ void QR::qrIMGS() {
     bool is_orthogonal = false;
 
     while (iteration < max_iterations && !is_orthogonal) {
-        _Q = Matrix<>(m, min_mn);
-        _R = Matrix<>(min_mn, n);
-
-        // Using MGS
-        for (size_t j = 0; j < min_mn; ++j) {
-            // norm V[j]
-            double normVec = 0.0;
-            for (size_t k = 0; k < m; ++k) {
-                normVec += V[j][k] * V[j][k];
-            }
-            normVec = sqrt(normVec);
+        _Qc.setZeroes();
+        _R.setZeroes();
 
-            _R(j, j) = normVec;
-
-            if (normVec > epsilon) {
-                // normalize Q col
-                std::vector<double> q_j(m);
-                for (size_t k = 0; k < m; ++k) {
-                    q_j[k] = V[j][k] / normVec;
-                }
-                _Q.setCol(q_j, j);
-
-                // Orthogonalize other vectors
-                for (size_t k = j + 1; k < n; ++k) {
-                    // Compute R(j, k) = Q(:, j)^T * V[k]
-                    double dotProduct = 0.0;
-                    for (size_t l = 0; l < m; ++l) {
-                        dotProduct += q_j[l] * V[k][l];
-                    }
-                    _R(j, k) = dotProduct;
+        // Using MGS, V keeps what the previous iteration left
+        modifiedGramSchmidtSweep(false);
 
-                    // Update V[k] = V[k] - R(j, k) * Q(:, j)
-                    for (size_t l = 0; l < m; ++l) {
-                        V[k][l] -= dotProduct * q_j[l];
-                    }
-                }
-            }
-            else {
-                // If norm too small, col be zero
-                std::vector<double> zero_col(m, 0.0);
-                _Q.setCol(zero_col, j);
-                for (size_t k = j + 1; k < n; ++k) {
-                    _R(j, k) = 0.0;
-                }
-            }
-        }
-
-        // Check Orthogonality Q matrix
+        // Check Orthogonality Q matrix: Q[0:j]^T q_j for every j
         is_orthogonal = true;
-        for (size_t i = 0; i < min_mn && is_orthogonal; ++i) {
-            for (size_t j = i + 1; j < min_mn && is_orthogonal; ++j) {
-                double dot = 0.0;
-                std::vector<double> col_i = _Q.getCol(i);
-                std::vector<double> col_j = _Q.getCol(j);
-                for (size_t k = 0; k < m; ++k) {
-                    dot += col_i[k] * col_j[k];
-                }
-                if (std::abs(dot) > epsilon) {
+        for (size_t j = 1; j < min_mn && is_orthogonal; ++j) {
+            project(_Qc.colData(0), j, m, _Qc.colData(j), _h.data());
+            for (size_t i = 0; i < j; ++i) {
+                if (std::abs(_h[i]) > epsilon) {
                     is_orthogonal = false;
                 }
             }
@@ -241,11 +289,14 @@ void QR::qrIMGS() {
     if (!is_orthogonal) {
         throw std::runtime_error("Warning: Iterative Gram-Schmidt did not achieve desired orthogonality after ");
     }
+    _Q = _Qc;
 }
 
 void QR::qrBGS() {
     size_t m = _A.rows_size(); // Number of rows in A
     size_t n = _A.cols_size(); // Number of columns in A
+    MATH_SCOPED_TIMER("QR::qrBGS");
+    MATH_HISTOGRAM_RECORD("QR::qr.columns", n);
     size_t min_mn = std::min(m, n); // Minimum of m and n
 
     // Initialize Q and R matrices
@@ -275,7 +326,8 @@ void QR::qrBGS() {
             // Get previous Q columns
             Matrix<> Q_prev = _Q.getSubmatrix(0, 0, m, k); // m x k matrix
             // Compute R_prev = Q_prev^T * A_block
-            Matrix<> R_prev = Q_prev.transpose() * A_block; // k x current_block_size matrix
+            Matrix<> R_prev;
+            Matrix<>::gemm_tn(Q_prev, A_block, R_prev); // k x current_block_size matrix
             // Update A_block = A_block - Q_prev * R_prev
             A_block = A_block - Q_prev * R_prev;
             // Update R matrix with R_prev
@@ -345,7 +397,8 @@ void QR::qrBGS() {
     if (min_mn < n) {
         // Compute R_remaining = Q^T * A_remaining
         Matrix<> A_remaining = _A.getSubmatrix(0, min_mn, m, n - min_mn); // m x (n - min_mn)
-        Matrix<> R_remaining = _Q.transpose() * A_remaining; // min_mn x (n - min_mn)
+        Matrix<> R_remaining;
+        Matrix<>::gemm_tn(_Q, A_remaining, R_remaining); // min_mn x (n - min_mn)
         // Set R_remaining into _R
         _R.setSubmatrix(0, min_mn, R_remaining); // Place R_remaining at position (0, min_mn) in R
     }
@@ -354,115 +407,58 @@ void QR::qrBGS() {
 void QR::qrRGS() {
     size_t m = _A.rows_size(); // Number of rows in A
     size_t n = _A.cols_size(); // Number of columns in A
+    MATH_SCOPED_TIMER("QR::qrRGS");
+    MATH_HISTOGRAM_RECORD("QR::qr.columns", n);
     size_t min_mn = std::min(m, n); // Minimum of m and n
 
-    // Initialize Q and R matrices
-    _Q = Matrix<>(m, min_mn, 0.0); // Q will be m x min(m, n)
-    _R = Matrix<>(min_mn, n, 0.0); // R will be min(m, n) x n
-
-    // Initialize V with columns of A
-    std::vector<std::vector<double>> V(n, std::vector<double>(m));
-    for (size_t i = 0; i < n; ++i) {
-        V[i] = _A.getCol(i);
-    }
+    startGramSchmidt();
 
     const double epsilon = 1e-10; // Tolerance for zero
     const int num_passes = 2; // Number of orthogonalization passes
 
-    // First pass of Modified Gram-Schmidt
+    // Two passes of Modified Gram-Schmidt, the second adds its corrections to R
     for (int pass = 0; pass < num_passes; ++pass) {
-        for (size_t j = 0; j < min_mn; ++j) {
-            // Compute the norm of V[j]
-            double norm = 0.0;
-            for (size_t k = 0; k < m; ++k) {
-                norm += V[j][k] * V[j][k];
-            }
-            norm = sqrt(norm);
-
-            // Set R(j,j)
-            _R(j, j) = norm;
-
-            if (norm > epsilon) {
-                // Normalize Q(:,j)
-                std::vector<double> q_j(m);
-                for (size_t k = 0; k < m; ++k) {
-                    q_j[k] = V[j][k] / norm;
-                }
-                _Q.setCol(q_j, j);
-
-                // Orthogonalize remaining columns
-                for (size_t k = j + 1; k < n; ++k) {
-                    double proj = 0.0;
-                    for (size_t s = 0; s < m; ++s) {
-                        proj += q_j[s] * V[k][s];
-                    }
-                    _R(j, k) += proj;
-
-                    for (size_t s = 0; s < m; ++s) {
-                        V[k][s] -= proj * q_j[s];
-                    }
-                }
-            }
-            else {
-                // If norm is too small, set Q column to zero
-                std::vector<double> zero_col(m, 0.0);
-                _Q.setCol(zero_col, j);
-                for (size_t k = j + 1; k < n; ++k) {
-                    _R(j, k) = 0.0;
-                }
-            }
-        }
+        modifiedGramSchmidtSweep(true);
     }
 
     // Re-orthogonalization pass to improve numerical stability
     for (size_t j = 0; j < min_mn; ++j) {
+        double* q_j = _Qc.colData(j);
         // Orthogonalize Q(:,j) against all previous Q columns
         for (size_t i = 0; i < j; ++i) {
-            std::vector<double> q_i = _Q.getCol(i);
-            std::vector<double> q_j = _Q.getCol(j);
+            const double* q_i = _Qc.colData(i);
 
             // Compute the projection coefficient
-            double proj = 0.0;
-            for (size_t k = 0; k < m; ++k) {
-                proj += q_i[k] * q_j[k];
-            }
+            double proj = dot(q_i, q_j, m);
 
             if (std::abs(proj) > epsilon) {
                 // Update R
-                _R(i, j) += proj;
+                _R.rowData(i)[j] += proj;
 
                 // Subtract the projection from Q(:,j)
                 for (size_t k = 0; k < m; ++k) {
                     q_j[k] -= proj * q_i[k];
                 }
 
-                // Update Q(:,j)
-                _Q.setCol(q_j, j);
-
                 // Recompute the norm of Q(:,j)
-                double norm = 0.0;
-                for (size_t k = 0; k < m; ++k) {
-                    norm += q_j[k] * q_j[k];
-                }
-                norm = sqrt(norm);
+                double norm = std::sqrt(dot(q_j, q_j, m));
 
                 if (norm > epsilon) {
                     // Normalize Q(:,j)
                     for (size_t k = 0; k < m; ++k) {
                         q_j[k] /= norm;
                     }
-                    _Q.setCol(q_j, j);
-                    _R(j, j) = norm;
+                    _R.rowData(j)[j] = norm;
                 }
                 else {
                     // If norm is too small, set Q column to zero
-                    std::vector<double> zero_col(m, 0.0);
-                    _Q.setCol(zero_col, j);
-                    _R(j, j) = 0.0;
+                    std::fill(q_j, q_j + m, 0.0);
+                    _R.rowData(j)[j] = 0.0;
                 }
             }
         }
     }
+    _Q = _Qc;
 }
 
 void QR::qrCGSP() {
@@ -474,13 +470,75 @@ void QR::qrHouseholder() {
 }
 
 void QR::qrGivens() {
+    size_t m = _A.rows_size();
+    size_t n = _A.cols_size();
+    MATH_SCOPED_TIMER("QR::qrGivens");
+    MATH_HISTOGRAM_RECORD("QR::qr.columns", n);
+    size_t min_mn = std::min(m, n);
+
+    // Rotations of neighbouring rows zero each column bottom-up, the (c, s)
+    // of each is kept for Q
+    Matrix<> work(_A);
+    std::vector<std::pair<double, double>> rotations;
+    rotations.reserve(min_mn * m);
+    for (size_t j = 0; j < min_mn; ++j) {
+        for (size_t i = m - 1; i > j; --i) {
+            double a = work.rowData(i - 1)[j];
+            double b = work.rowData(i)[j];
+            if (b == 0.0) {
+                rotations.emplace_back(1.0, 0.0);
+                continue;
+            }
+            double r = std::hypot(a, b);
+            double c = a / r;
+            double s = b / r;
+            const FixedMatrix<double, 2, 2> G = {{c, s}, {-s, c}};
+            rotateRows(G, work.rowData(i - 1), work.rowData(i), j, n);
+            work.rowData(i)[j] = 0.0;
+            rotations.emplace_back(c, s);
+        }
+    }
 
+    // Thin Q = G_1^T ... G_K^T [I; 0], the last rotation is applied first.
+    // Rows below j are still zero left of column j when the rotations of
+    // column j are reached, so those only touch columns j and up.
+    _Q.resize(m, min_mn);
+    _Q.setZeroes();
+    for (size_t j = 0; j < min_mn; ++j) {
+        _Q.rowData(j)[j] = 1.0;
+    }
+    size_t next = rotations.size();
+    for (size_t j = min_mn; j-- > 0;) {
+        for (size_t i = j + 1; i < m; ++i) {
+            auto [c, s] = rotations[--next];
+            if (s == 0.0) {
+                continue;
+            }
+            const FixedMatrix<double, 2, 2> Gt = {{c, -s}, {s, c}};
+            rotateRows(Gt, _Q.rowData(i - 1), _Q.rowData(i), j, min_mn);
+        }
+    }
+    _R.resize(min_mn, n);
+    for (size_t i = 0; i < min_mn; ++i) {
+        std::copy(work.rowData(i), work.rowData(i) + n, _R.rowData(i));
+    }
+}
+
+void QR::qrTSQR() {
+    if (_A.rows_size() < _A.cols_size()) {
+        qrIMGS();
+        return;
+    }
+    TSQR<> tsqr(_A, true);
+    _Q = tsqr.Q();
+    _R = tsqr.R();
 }
 
 Matrix<> QR::solve(const Matrix<>& b) const // TODO: write test
 {
     // Compute Q^T * b
-    Matrix<> Qt_b = Q().transpose() * b;
+    Matrix<> Qt_b;
+    Matrix<>::gemm_tn(_Q, b, Qt_b);
 
     // Solve Rx = Qt_b for x using back-substitution
     Matrix<> x = (R().inverse(), Qt_b);
@@ -490,6 +548,7 @@ Matrix<> QR::solve(const Matrix<>& b) const // TODO: write test
 Matrix<> QR::pseudoInverse() const // TODO: write test
 {
     // A^{+} = R^{-1} * Q^T
+    MATH_SCOPED_TIMER("QR::pseudoInverse");
     Matrix<> R = (_R + Matrix<>::identity(_R.rows_size()) * 1e-8);
     /*
     std::cout << "R: " << std::endl;
@@ -0,0 +1,302 @@
+//
+// Synthetic CAD sketches for solver tests and benchmarks.
+//
+#include "SketchGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "ErrorFunctions.h"
+
+namespace {
+
+enum class ConstraintType {
+    Distance,
+    Parallel,
+    Perpendicular,
+    Angle,
+    PointOnCircle
+};
+
+struct ConstraintSpec {
+    ConstraintType type;
+    std::vector<size_t> vars;
+    double value;
+};
+
+struct SectionSpec {
+    size_t from;
+    size_t to;
+};
+
+// Directions are multiples of 15 degrees, like the snapping of a CAD editor
+constexpr double kAngleStep = M_PI / 12.0;
+// Typical section length, the noise of the start point is relative to it
+constexpr double kTypicalLength = 40.0;
+// Coupling constraints connect sections at most this far apart in creation order
+constexpr size_t kCouplingWindow = 16;
+
+Function *makeConstraint(const ConstraintSpec &spec, const std::vector<Variable *> &x) {
+    std::vector<Variable *> vars;
+    vars.reserve(spec.vars.size());
+    for (size_t index: spec.vars) {
+        vars.push_back(x[index]);
+    }
+    switch (spec.type) {
+        case ConstraintType::Distance:
+            return new PointPointDistanceError(vars, spec.value);
+        case ConstraintType::Parallel:
+            return new SectionSectionParallelError(vars);
+        case ConstraintType::Perpendicular:
+            return new SectionSectionPerpendicularError(vars);
+        case ConstraintType::Angle:
+            return new SectionSectionAngleError(vars, spec.value);
+        case ConstraintType::PointOnCircle:
+            return new PointOnCircleError(vars);
+    }
+    throw std::logic_error("SketchGenerator: unknown constraint type");
+}
+
+class Builder {
+    const SketchOptions &options;
+    std::mt19937 gen;
+
+    double uniform(double from, double to) {
+        return std::uniform_real_distribution<double>(from, to)(gen);
+    }
+
+    size_t index(size_t from, size_t to) {
+        return std::uniform_int_distribution<size_t>(from, to)(gen);
+    }
+
+    double pointDistance(size_t p, size_t q) const {
+        return std::hypot(truth[2 * q] - truth[2 * p], truth[2 * q + 1] - truth[2 * p + 1]);
+    }
+
+    std::vector<size_t> sectionVars(const SectionSpec &s) const {
+        return {2 * s.from, 2 * s.from + 1, 2 * s.to, 2 * s.to + 1};
+    }
+
+    void addDistance(size_t p, size_t q) {
+        specs.push_back({ConstraintType::Distance, {2 * p, 2 * p + 1, 2 * q, 2 * q + 1}, pointDistance(p, q)});
+    }
+
+    // Constrains the relation two sections have in the true geometry. Returns
+    // false for nearly parallel pairs, where the angle error is singular.
+    bool addRelation(const SectionSpec &a, const SectionSpec &b) {
+        double vx = truth[2 * a.to] - truth[2 * a.from];
+        double vy = truth[2 * a.to + 1] - truth[2 * a.from + 1];
+        double wx = truth[2 * b.to] - truth[2 * b.from];
+        double wy = truth[2 * b.to + 1] - truth[2 * b.from + 1];
+        double cosAngle = (vx * wx + vy * wy) / (std::hypot(vx, vy) * std::hypot(wx, wy));
+        double angle = std::acos(std::clamp(cosAngle, -1.0, 1.0));
+        double steps = std::round(angle / kAngleStep);
+
+        std::vector<size_t> vars = sectionVars(a);
+        std::vector<size_t> second = sectionVars(b);
+        vars.insert(vars.end(), second.begin(), second.end());
+
+        if (steps == 0 || steps == 12) {
+            specs.push_back({ConstraintType::Parallel, vars, 0.0});
+        } else if (steps == 6) {
+            specs.push_back({ConstraintType::Perpendicular, vars, 0.0});
+        } else if (steps == 1 || steps == 11) {
+            return false;
+        } else {
+            specs.push_back({ConstraintType::Angle, vars, angle * 180.0 / M_PI});
+        }
+        return true;
+    }
+
+    // Polylines of 2..8 points laid out on a coarse grid
+    void buildPolylines(size_t points) {
+        size_t cells = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(points) / 4.0))) + 1;
+        size_t p = 0;
+        size_t chain = 0;
+        while (p < points) {
+            size_t length = std::min(index(2, 8), points - p);
+            double x = 400.0 * static_cast<double>(chain % cells) + uniform(-50.0, 50.0);
+            double y = 400.0 * static_cast<double>(chain / cells) + uniform(-50.0, 50.0);
+            int direction = static_cast<int>(index(0, 23));
+            static const int turns[] = {-6, -4, -3, -2, 0, 2, 3, 4, 6};
+
+            for (size_t k = 0; k < length; ++k, ++p) {
+                if (k > 0) {
+                    direction += turns[index(0, 8)];
+                    double len = uniform(0.5, 1.5) * kTypicalLength;
+                    x += len * std::cos(direction * kAngleStep);
+                    y += len * std::sin(direction * kAngleStep);
+                    sections.push_back({p - 1, p});
+                }
+                truth[2 * p] = x;
+                truth[2 * p + 1] = y;
+            }
+            ++chain;
+        }
+    }
+
+    // Each circle passes through an existing point and has its center pinned
+    // by the distance to a neighbouring point
+    void buildCircles(size_t points, size_t circles) {
+        for (size_t c = 0; c < circles; ++c) {
+            size_t base = 2 * points + 3 * c;
+            double radius = uniform(0.25, 1.0) * kTypicalLength;
+            if (points == 0) {
+                truth[base] = uniform(0.0, 400.0);
+                truth[base + 1] = uniform(0.0, 400.0);
+                truth[base + 2] = radius;
+                continue;
+            }
+            size_t anchor = index(0, points - 1);
+            double phi = uniform(0.0, 2.0 * M_PI);
+            truth[base] = truth[2 * anchor] + radius * std::cos(phi);
+            truth[base + 1] = truth[2 * anchor + 1] + radius * std::sin(phi);
+            truth[base + 2] = radius;
+            specs.push_back({ConstraintType::PointOnCircle,
+                             {2 * anchor, 2 * anchor + 1, base, base + 1, base + 2}, 0.0});
+
+            if (points > 1) {
+                size_t other = (anchor + index(1, std::min<size_t>(5, points - 1))) % points;
+                double d = std::hypot(truth[base] - truth[2 * other], truth[base + 1] - truth[2 * other + 1]);
+                specs.push_back({ConstraintType::Distance, {base, base + 1, 2 * other, 2 * other + 1}, d});
+            }
+        }
+    }
+
+    void buildSectionConstraints() {
+        for (size_t s = 0; s < sections.size(); ++s) {
+            addDistance(sections[s].from, sections[s].to);
+            // Neighbouring sections of the same polyline share a point
+            if (s > 0 && sections[s - 1].to == sections[s].from) {
+                addRelation(sections[s - 1], sections[s]);
+            }
+        }
+        if (sections.size() < 2) {
+            return;
+        }
+        auto coupling = static_cast<size_t>(std::llround(options.couplingDensity * sections.size()));
+        for (size_t k = 0; k < coupling; ++k) {
+            size_t a = index(0, sections.size() - 1);
+            size_t offset = index(1, std::min(kCouplingWindow, sections.size() - 1));
+            size_t b = (a + offset) % sections.size();
+            if (uniform(0.0, 1.0) < 0.7 && addRelation(sections[a], sections[b])) {
+                continue;
+            }
+            if (sections[a].from != sections[b].to) {
+                addDistance(sections[a].from, sections[b].to);
+            }
+        }
+    }
+
+    void addRedundancy() {
+        auto extra = static_cast<size_t>(std::llround(options.redundancy * specs.size()));
+        size_t original = specs.size();
+        for (size_t k = 0; k < extra && original > 0; ++k) {
+            specs.push_back(specs[index(0, original - 1)]);
+        }
+    }
+
+public:
+    explicit Builder(const SketchOptions &options) : options(options), gen(options.seed) {}
+
+    // Lays out the true geometry and measures the constraints on it
+    void build() {
+        size_t n = options.variableCount;
+        // About 15% of the variables belong to circles, the rest to points
+        circles = n * 15 / 100 / 3;
+        if ((n - 3 * circles) % 2 != 0) {
+            ++circles;
+        }
+        points = (n - 3 * circles) / 2;
+
+        truth.assign(n, 0.0);
+        buildPolylines(points);
+        buildCircles(points, circles);
+        buildSectionConstraints();
+        addRedundancy();
+
+        start = truth;
+        double noise = options.perturbation * kTypicalLength;
+        for (auto &value: start) {
+            value += uniform(-noise, noise);
+        }
+    }
+
+    std::vector<double> truth;
+    std::vector<double> start;
+    std::vector<SectionSpec> sections;
+    std::vector<ConstraintSpec> specs;
+    size_t points = 0;
+    size_t circles = 0;
+};
+
+} // namespace
+
+// -------------------- Sketch Implementations --------------------
+
+Sketch::~Sketch() {
+    for (auto constraint: m_constraints) {
+        delete constraint;
+    }
+    for (auto variable: m_X) {
+        delete variable;
+    }
+}
+
+std::vector<double> Sketch::values() const {
+    return m_store.values();
+}
+
+void Sketch::setValues(const std::vector<double> &x) {
+    if (x.size() != m_X.size()) {
+        throw std::invalid_argument("Sketch: not right vector of variables");
+    }
+    // Through the variables, so that incrementally evaluated tasks see it
+    for (size_t i = 0; i < x.size(); ++i) {
+        m_X[i]->setValue(x[i]);
+    }
+}
+
+std::unique_ptr<LSMTask> Sketch::makeTask(Differentiation differentiation) {
+    if (m_constraints.empty()) {
+        throw std::runtime_error("Sketch: constraints were already handed over to a task");
+    }
+    auto task = std::make_unique<LSMTask>(m_constraints, m_X, differentiation);
+    m_constraints.clear();
+    return task;
+}
+
+// -------------------- SketchGenerator Implementations --------------------
+
+SketchGenerator::SketchGenerator(const SketchOptions &options) : m_options(options) {
+    if (options.variableCount < 4) {
+        throw std::invalid_argument("SketchGenerator: a sketch needs at least 4 variables");
+    }
+    if (options.couplingDensity < 0 || options.redundancy < 0 || options.perturbation < 0) {
+        throw std::invalid_argument("SketchGenerator: options must be non-negative");
+    }
+}
+
+std::unique_ptr<Sketch> SketchGenerator::generate() const {
+    Builder builder(m_options);
+    builder.build();
+
+    auto sketch = std::make_unique<Sketch>();
+    size_t n = m_options.variableCount;
+    sketch->m_points = builder.points;
+    sketch->m_sections = builder.sections.size();
+    sketch->m_circles = builder.circles;
+    sketch->m_solution = builder.truth;
+    sketch->m_store = VariableStore(builder.start);
+    sketch->m_X.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        sketch->m_X.push_back(sketch->m_store.variable(i));
+    }
+    sketch->m_constraints.reserve(builder.specs.size());
+    for (const auto &spec: builder.specs) {
+        sketch->m_constraints.push_back(makeConstraint(spec, sketch->m_X));
+    }
+    return sketch;
+}
@@ -0,0 +1,166 @@
+#include "Sparsity.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+#include "Instrumentation.h"
+
+// -------------------- SparsityPattern Implementations --------------------
+
+SparsityPattern::SparsityPattern(size_t cols, std::vector<std::vector<size_t>> rows)
+    : m_rows(rows.size()), m_cols(cols) {
+    m_offsets.reserve(rows.size() + 1);
+    for (auto& row : rows) {
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+        if (!row.empty() && row.back() >= cols) {
+            throw std::out_of_range("SparsityPattern: column index is out of range");
+        }
+        m_columns.insert(m_columns.end(), row.begin(), row.end());
+        m_offsets.push_back(m_columns.size());
+    }
+}
+
+SparsityPattern SparsityPattern::dense(size_t rows, size_t cols) {
+    SparsityPattern pattern;
+    pattern.m_rows = rows;
+    pattern.m_cols = cols;
+    pattern.m_offsets.reserve(rows + 1);
+    pattern.m_columns.reserve(rows * cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            pattern.m_columns.push_back(j);
+        }
+        pattern.m_offsets.push_back(pattern.m_columns.size());
+    }
+    return pattern;
+}
+
+double SparsityPattern::density() const {
+    if (m_rows == 0 || m_cols == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(nonZeros()) / (static_cast<double>(m_rows) * static_cast<double>(m_cols));
+}
+
+bool SparsityPattern::contains(size_t i, size_t j) const {
+    if (i >= m_rows) {
+        return false;
+    }
+    auto columns = row(i);
+    return std::binary_search(columns.begin(), columns.end(), j);
+}
+
+SparsityPattern SparsityPattern::transpose() const {
+    std::vector<std::vector<size_t>> rowsOf(m_cols);
+    for (size_t i = 0; i < m_rows; ++i) {
+        for (size_t j : row(i)) {
+            rowsOf[j].push_back(i);
+        }
+    }
+    return SparsityPattern(m_rows, std::move(rowsOf));
+}
+
+SparsityPattern SparsityPattern::hessianOfSquares() const {
+    // Row j of the Hessian is the union of the rows of f holding j, costs
+    // the sum of the squared row lengths
+    SparsityPattern rowsOf = transpose();
+    std::vector<std::vector<size_t>> hessian(m_cols);
+    std::vector<size_t> seenFor(m_cols, m_cols);
+    for (size_t j = 0; j < m_cols; ++j) {
+        for (size_t i : rowsOf.row(j)) {
+            for (size_t k : row(i)) {
+                if (seenFor[k] != j) {
+                    seenFor[k] = j;
+                    hessian[j].push_back(k);
+                }
+            }
+        }
+    }
+    return SparsityPattern(m_cols, std::move(hessian));
+}
+
+// -------------------- ColumnColoring Implementations --------------------
+
+ColumnColoring::ColumnColoring(const SparsityPattern& pattern) : colorOf(pattern.cols()) {
+    SparsityPattern rowsOf = pattern.transpose();
+    std::vector<size_t> order(pattern.cols());
+    for (size_t j = 0; j < order.size(); ++j) {
+        order[j] = j;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return rowsOf.row(a).size() > rowsOf.row(b).size();
+    });
+
+    // Colors taken by a column sharing a row with j, marked with j
+    std::vector<size_t> takenFor;
+    constexpr size_t kUncolored = static_cast<size_t>(-1);
+    std::fill(colorOf.begin(), colorOf.end(), kUncolored);
+    for (size_t j : order) {
+        for (size_t i : rowsOf.row(j)) {
+            for (size_t k : pattern.row(i)) {
+                if (colorOf[k] != kUncolored) {
+                    takenFor[colorOf[k]] = j;
+                }
+            }
+        }
+        size_t color = 0;
+        while (color < takenFor.size() && takenFor[color] == j) {
+            ++color;
+        }
+        if (color == groups.size()) {
+            groups.emplace_back();
+            takenFor.push_back(kUncolored);
+        }
+        colorOf[j] = color;
+        groups[color].push_back(j);
+    }
+    for (auto& group : groups) {
+        std::sort(group.begin(), group.end());
+    }
+}
+
+// -------------------- DependencyAnalysis Implementations --------------------
+
+DependencyAnalysis::DependencyAnalysis(const std::vector<Variable*>& x) : m_seenInPass(x.size(), 0) {
+    m_index.reserve(x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        m_index.emplace(x[i]->address(), i);
+    }
+}
+
+std::vector<size_t> DependencyAnalysis::dependencies(const Function* f) {
+    ++m_pass;
+    std::unordered_set<const Function*> visited = {f};
+    m_stack.assign(1, f);
+    std::vector<size_t> result;
+    while (!m_stack.empty()) {
+        const Function* node = m_stack.back();
+        m_stack.pop_back();
+        if (auto* var = dynamic_cast<const Variable*>(node)) {
+            auto it = m_index.find(var->address());
+            if (it != m_index.end() && m_seenInPass[it->second] != m_pass) {
+                m_seenInPass[it->second] = m_pass;
+                result.push_back(it->second);
+            }
+            continue;
+        }
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            const Function* child = node->child(i);
+            if (visited.insert(child).second) {
+                m_stack.push_back(child);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+SparsityPattern DependencyAnalysis::jacobianPattern(const std::vector<Function*>& functions) {
+    MATH_SCOPED_TIMER("DependencyAnalysis::jacobianPattern");
+    std::vector<std::vector<size_t>> rows;
+    rows.reserve(functions.size());
+    for (const Function* f : functions) {
+        rows.push_back(dependencies(f));
+    }
+    return SparsityPattern(m_seenInPass.size(), std::move(rows));
+}
@@ -0,0 +1,163 @@
+//
+// Worker threads shared by the Matrix kernels.
+//
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+
+namespace {
+
+// Greater than zero on workers, inside loop bodies and under SerialScope
+thread_local int parallelDepth = 0;
+
+struct DepthGuard {
+    DepthGuard() { ++parallelDepth; }
+    ~DepthGuard() { --parallelDepth; }
+};
+
+size_t defaultThreadCount() {
+    if (const char *env = std::getenv("MATH_THREADS")) {
+        long threads = std::strtol(env, nullptr, 10);
+        if (threads > 0) {
+            return static_cast<size_t>(threads);
+        }
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+struct ThreadPool::Job {
+    const std::function<void(size_t)> *body;
+    size_t count;
+    std::atomic<size_t> next{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+ThreadPool::ThreadPool(size_t threads) {
+    start(threads == 0 ? defaultThreadCount() : threads);
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::start(size_t threads) {
+    m_stop = false;
+    for (size_t i = 1; i < threads; ++i) {
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto &worker: m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void ThreadPool::setThreadCount(size_t threads) {
+    std::lock_guard<std::mutex> submit(m_submit);
+    stop();
+    start(threads == 0 ? defaultThreadCount() : threads);
+}
+
+void ThreadPool::workerLoop() {
+    parallelDepth = 1;
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [&] { return m_stop || (m_job != nullptr && m_generation != seen); });
+        if (m_stop) {
+            return;
+        }
+        seen = m_generation;
+        Job *job = m_job;
+        ++m_active;
+        lock.unlock();
+        run(*job);
+        lock.lock();
+        if (--m_active == 0) {
+            m_done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::run(Job &job) {
+    DepthGuard guard;
+    for (size_t i = job.next.fetch_add(1); i < job.count; i = job.next.fetch_add(1)) {
+        try {
+            (*job.body)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.errorMutex);
+            if (!job.error) {
+                job.error = std::current_exception();
+            }
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &body) {
+    auto serial = [&] {
+        DepthGuard guard;
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+    };
+    if (count <= 1 || m_workers.empty() || parallelDepth > 0) {
+        serial();
+        return;
+    }
+    // Another thread has the pool, waiting for it would only serialize anyway
+    std::unique_lock<std::mutex> submit(m_submit, std::try_to_lock);
+    if (!submit.owns_lock()) {
+        serial();
+        return;
+    }
+
+    Job job;
+    job.body = &body;
+    job.count = count;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        ++m_generation;
+    }
+    m_wake.notify_all();
+    run(job);
+    {
+        // Every index is taken, wait for the workers still inside the job
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job = nullptr;
+        m_done.wait(lock, [&] { return m_active == 0; });
+    }
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+bool ThreadPool::inParallelRegion() {
+    return parallelDepth > 0;
+}
+
+ThreadPool::SerialScope::SerialScope() {
+    ++parallelDepth;
+}
+
+ThreadPool::SerialScope::~SerialScope() {
+    --parallelDepth;
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+#include "BatchEvaluator.h"
+#include "ErrorFunctions.h"
+#include "SketchGenerator.h"
+
+namespace {
+
+// A node type the evaluator does not know
+class Twice : public Function {
+public:
+    Function *operand;
+
+    explicit Twice(Function *operand) : operand(operand) {}
+    ~Twice() override { delete operand; }
+
+    double evaluate() const override { return 2.0 * operand->value(); }
+    size_t childCount() const override { return 1; }
+    Function *child(size_t) const override { return operand; }
+    Function *derivative(Variable *var) const override { return new Multiplication(new Constant(2.0), operand->derivative(var)); }
+    Function *clone() const override { return new Twice(operand->clone()); }
+};
+
+// Columns of points, inputs[j][p] is x_j at point p
+struct Points {
+    std::vector<std::vector<double>> columns;
+    std::vector<const double *> inputs;
+
+    Points(const std::vector<Variable *> &x, size_t count, unsigned seed) : columns(x.size()) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> shift(-0.05, 0.05);
+        for (size_t j = 0; j < x.size(); ++j) {
+            for (size_t p = 0; p < count; ++p) {
+                columns[j].push_back(x[j]->evaluate() + shift(rng));
+            }
+            inputs.push_back(columns[j].data());
+        }
+    }
+};
+
+} // namespace
+
+TEST(BatchEvaluatorTest, StrictMatchesEvaluateBitwise) {
+    SketchOptions options;
+    options.seed = 11;
+    options.variableCount = 40;
+    auto sketch = SketchGenerator(options).generate();
+    const auto &constraints = sketch->constraints();
+    const auto &x = sketch->variables();
+    BatchEvaluator batch(constraints, x);
+    EXPECT_EQ(batch.rootCount(), constraints.size());
+
+    constexpr size_t kPoints = 17;
+    Points points(x, kPoints, 3);
+    std::vector<double> saved;
+    for (auto var: x) {
+        saved.push_back(var->evaluate());
+    }
+    std::vector<double> out(kPoints);
+    for (size_t r = 0; r < constraints.size(); ++r) {
+        batch.evaluate(r, kPoints, points.inputs.data(), out.data());
+        for (size_t p = 0; p < kPoints; ++p) {
+            for (size_t j = 0; j < x.size(); ++j) {
+                x[j]->setValue(points.columns[j][p]);
+            }
+            EXPECT_EQ(out[p], constraints[r]->evaluate()) << "root " << r << " point " << p;
+        }
+    }
+    for (size_t j = 0; j < x.size(); ++j) {
+        x[j]->setValue(saved[j]);
+    }
+}
+
+TEST(BatchEvaluatorTest, FastIsCloseToStrict) {
+    SketchOptions options;
+    options.seed = 12;
+    options.variableCount = 40;
+    auto sketch = SketchGenerator(options).generate();
+    const auto &constraints = sketch->constraints();
+    BatchEvaluator strict(constraints, sketch->variables());
+    BatchEvaluator fast(constraints, sketch->variables());
+    fast.setMathMode(MathMode::Fast);
+    EXPECT_EQ(fast.mathMode(), MathMode::Fast);
+
+    constexpr size_t kPoints = 33;
+    Points points(sketch->variables(), kPoints, 4);
+    std::vector<double> expected(kPoints), actual(kPoints);
+    for (size_t r = 0; r < constraints.size(); ++r) {
+        strict.evaluate(r, kPoints, points.inputs.data(), expected.data());
+        fast.evaluate(r, kPoints, points.inputs.data(), actual.data());
+        for (size_t p = 0; p < kPoints; ++p) {
+            EXPECT_NEAR(actual[p], expected[p], 1e-12 * std::max(1.0, std::abs(expected[p])));
+        }
+    }
+}
+
+TEST(BatchEvaluatorTest, SharedNodesAndOtherVariables) {
+    double a = 2.0;
+    double b = 5.0;
+    Variable x(&a);
+    Variable y(&b);
+    // (x + 1) * (x + 1) - y with the sum shared, y not in x
+    Function *sum = new Addition(x.clone(), new Constant(1.0));
+    Function *f = new Subtraction(new Multiplication(sum, sum), y.clone());
+    BatchEvaluator batch({f}, {&x});
+    EXPECT_EQ(batch.instructionCount(), 6u);
+
+    double values[] = {0.0, 1.0, -3.0};
+    const double *inputs[] = {values};
+    double out[3];
+    batch.evaluate(0, 3, inputs, out);
+    EXPECT_EQ(out[0], -4.0);
+    EXPECT_EQ(out[1], -1.0);
+    EXPECT_EQ(out[2], -1.0);
+
+    // y is read at every call
+    b = 1.0;
+    batch.evaluate(0, 3, inputs, out);
+    EXPECT_EQ(out[0], 0.0);
+    EXPECT_EQ(a, 2.0);
+}
+
+TEST(BatchEvaluatorTest, ThrowsWhereEvaluateWould) {
+    double a = 1.0;
+    Variable x(&a);
+    Function *ln = new Ln(x.clone());
+    Function *quotient = new Division(new Constant(1.0), x.clone());
+    BatchEvaluator batch({ln, quotient}, {&x});
+    double values[] = {2.0, 0.0};
+    const double *inputs[] = {values};
+    double out[2];
+    EXPECT_THROW(batch.evaluate(0, 2, inputs, out), std::runtime_error);
+    EXPECT_THROW(batch.evaluate(1, 2, inputs, out), std::runtime_error);
+    EXPECT_NO_THROW(batch.evaluate(1, 1, inputs, out));
+    EXPECT_EQ(out[0], 0.5);
+    EXPECT_THROW(batch.evaluate(2, 1, inputs, out), std::out_of_range);
+    delete ln;
+    delete quotient;
+}
+
+TEST(BatchEvaluatorTest, UnknownNodeTypes) {
+    double a = 1.0;
+    Variable x(&a);
+    Twice twice(new Sin(x.clone()));
+    Function *wrapped = new Addition(&twice, new Constant(1.0));
+    EXPECT_FALSE(BatchEvaluator::supports(&twice));
+    EXPECT_FALSE(BatchEvaluator::supports(wrapped));
+    EXPECT_TRUE(BatchEvaluator::supports(twice.operand));
+    EXPECT_THROW(BatchEvaluator({wrapped}, {&x}), std::invalid_argument);
+}
@@ -0,0 +1,99 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "Cholesky.h"
+#include "TestHelpers.h"
+
+// J^T J + I for a random tall J
+static Matrix<> spdMatrix(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix<> J(2 * n, n);
+    for (size_t i = 0; i < 2 * n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            J(i, j) = dist(gen);
+        }
+    }
+    Matrix<> A = J.transpose() * J;
+    A.addDiagonal(1.0);
+    return A;
+}
+
+TEST(CholeskyTest, FactorsSmallMatrix) {
+    Matrix<> A = {
+            {4, 2, 2},
+            {2, 5, 3},
+            {2, 3, 6}
+    };
+    Cholesky<> chol(A);
+    ASSERT_TRUE(chol.isPositiveDefinite());
+
+    Matrix<> L = chol.L();
+    EXPECT_EQ(L(0, 0), 2.0);
+    EXPECT_EQ(L(0, 1), 0.0);
+    EXPECT_LT(maxAbsDifference(L * L.transpose(), A), 1e-14);
+    EXPECT_NEAR(chol.determinant(), A.determinant(), 1e-12);
+}
+
+TEST(CholeskyTest, ReconstructsAcrossBlocks) {
+    size_t n = 2 * Cholesky<>::kBlockSize + 5;
+    Matrix<> A = spdMatrix(n, 1);
+    Cholesky<> chol(A);
+    ASSERT_TRUE(chol.isPositiveDefinite());
+
+    Matrix<> L = chol.L();
+    EXPECT_LT(maxAbsDifference(L * L.transpose(), A), 1e-11);
+}
+
+TEST(CholeskyTest, SolvesInPlace) {
+    size_t n = 40;
+    Matrix<> A = spdMatrix(n, 2);
+    Matrix<> x = Matrix<>::random(n, 2, -1.0, 1.0);
+    Matrix<> b = A * x;
+
+    Cholesky<> chol(A);
+    EXPECT_LT(maxAbsDifference(chol.solve(b), x), 1e-10);
+    chol.solveInto(b, b);
+    EXPECT_LT(maxAbsDifference(b, x), 1e-10);
+    EXPECT_THROW(chol.solve(Matrix<>(n + 1, 1)), std::invalid_argument);
+}
+
+TEST(CholeskyTest, RefactorizesWithShift) {
+    size_t n = 20;
+    Matrix<> A = spdMatrix(n, 3);
+    Matrix<> b = Matrix<>::random(n, 1, -1.0, 1.0);
+
+    Cholesky<> chol(A);
+    for (double shift: {0.5, 4.0, 1e3}) {
+        chol.refactorize(shift);
+        ASSERT_TRUE(chol.isPositiveDefinite());
+        EXPECT_EQ(chol.shift(), shift);
+
+        Matrix<> shifted = A;
+        shifted.addDiagonal(shift);
+        EXPECT_LT(maxAbsDifference(shifted * chol.solve(b), b), 1e-10);
+    }
+}
+
+TEST(CholeskyTest, ReportsIndefiniteMatrices) {
+    Matrix<> A = {
+            {1, 2},
+            {2, 1}
+    };
+    Cholesky<> chol(A);
+    EXPECT_FALSE(chol.isPositiveDefinite());
+    EXPECT_THROW(chol.solve(Matrix<>(2, 1)), std::runtime_error);
+
+    // a large enough shift makes it definite
+    chol.refactorize(2.0);
+    EXPECT_TRUE(chol.isPositiveDefinite());
+}
+
+TEST(CholeskyTest, RejectsBadInput) {
+    EXPECT_THROW(Cholesky<>(Matrix<>(2, 3)), std::invalid_argument);
+    EXPECT_THROW(Cholesky<>(Matrix<>()), std::runtime_error);
+    Cholesky<> empty;
+    EXPECT_THROW(empty.refactorize(1.0), std::runtime_error);
+}
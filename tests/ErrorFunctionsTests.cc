@@ -195,4 +195,28 @@ TEST(SectionSectionAngleErrorTest, IncorrectVariableCount) {
     };
 
     EXPECT_THROW(SectionSectionAngleError errorFunc(variables, 90.0), std::invalid_argument);
-}
\ No newline at end of file
+}
+
+//------------------------- POINTONCIRCLE TESTS -------------------------
+TEST(PointOnCircleErrorTest, CorrectZeroErrorValue) {
+    double px[] = {3.0}; double py[] = {4.0};  // Point (3,4)
+    double cx[] = {0.0}; double cy[] = {0.0};  // Center (0,0)
+    double r[] = {5.0};
+
+    std::vector<Variable*> variables = {
+            new Variable(px), new Variable(py),
+            new Variable(cx), new Variable(cy),
+            new Variable(r)
+    };
+
+    PointOnCircleError errorFunc(variables);
+    EXPECT_NEAR(errorFunc.evaluate(), 0.0, 1e-9);
+    r[0] = 4.0;
+    EXPECT_NEAR(errorFunc.evaluate(), 1.0, 1e-9);
+}
+
+TEST(PointOnCircleErrorTest, IncorrectVariableCount) {
+    double p1[] = {1.0}; double p2[] = {1.0};
+    std::vector<Variable*> incorrectVariables = { new Variable(p1), new Variable(p2) };
+    EXPECT_THROW(PointOnCircleError errorFunc(incorrectVariables), std::invalid_argument);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cmath>
+#include <random>
+
+#include "FastMath.h"
+
+namespace {
+
+// Distance in units in the last place, 0 for two NaNs
+int64_t ulps(double a, double b) {
+    if (std::isnan(a) && std::isnan(b)) {
+        return 0;
+    }
+    auto ordered = [](double x) {
+        int64_t bits = std::bit_cast<int64_t>(x);
+        return bits < 0 ? std::numeric_limits<int64_t>::min() - bits : bits;
+    };
+    return std::abs(ordered(a) - ordered(b));
+}
+
+// Largest error of fast against strict on random samples of [lo, hi], of
+// 2^x when exponent is set
+template <typename Fast, typename Strict>
+int64_t maxUlps(Fast fast, Strict strict, double lo, double hi, bool exponent = false) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    int64_t worst = 0;
+    for (int i = 0; i < 200000; ++i) {
+        double x = exponent ? std::exp2(dist(rng)) : dist(rng);
+        worst = std::max(worst, ulps(fast(x), strict(x)));
+    }
+    return worst;
+}
+
+} // namespace
+
+TEST(FastMathTest, DocumentedUlpBounds) {
+    auto fexp = [](double x) { return fast_math::exp(x); };
+    auto sexp = [](double x) { return std::exp(x); };
+    EXPECT_LE(maxUlps(fexp, sexp, -745.0, 709.7), 1);
+    EXPECT_LE(maxUlps(fexp, sexp, -2.0, 2.0), 1);
+
+    auto flog = [](double x) { return fast_math::log(x); };
+    auto slog = [](double x) { return std::log(x); };
+    EXPECT_LE(maxUlps(flog, slog, -1074.0, 1023.0, true), 1);
+    EXPECT_LE(maxUlps(flog, slog, 0.5, 2.0), 1);
+
+    auto fsin = [](double x) { return fast_math::sin(x); };
+    auto ssin = [](double x) { return std::sin(x); };
+    auto fcos = [](double x) { return fast_math::cos(x); };
+    auto scos = [](double x) { return std::cos(x); };
+    EXPECT_LE(maxUlps(fsin, ssin, -10.0, 10.0), 1);
+    EXPECT_LE(maxUlps(fcos, scos, -10.0, 10.0), 1);
+    EXPECT_LE(maxUlps(fsin, ssin, -fast_math::kMaxTrigArgument, fast_math::kMaxTrigArgument), 2);
+    EXPECT_LE(maxUlps(fcos, scos, -fast_math::kMaxTrigArgument, fast_math::kMaxTrigArgument), 2);
+
+    auto fatan = [](double x) { return fast_math::atan(x); };
+    auto satan = [](double x) { return std::atan(x); };
+    EXPECT_LE(maxUlps(fatan, satan, -4.0, 4.0), 2);
+    EXPECT_LE(maxUlps(fatan, satan, -60.0, 60.0, true), 2);
+
+    auto facos = [](double x) { return fast_math::acos(x); };
+    auto sacos = [](double x) { return std::acos(x); };
+    EXPECT_LE(maxUlps(facos, sacos, -1.0, 1.0), 1);
+}
+
+TEST(FastMathTest, SpecialValues) {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_EQ(fast_math::exp(0.0), 1.0);
+    EXPECT_EQ(fast_math::exp(710.0), inf);
+    EXPECT_EQ(fast_math::exp(-inf), 0.0);
+    EXPECT_EQ(fast_math::exp(-745.0), std::exp(-745.0));
+    EXPECT_TRUE(std::isnan(fast_math::exp(nan)));
+
+    EXPECT_EQ(fast_math::log(1.0), 0.0);
+    EXPECT_EQ(fast_math::log(0.0), -inf);
+    EXPECT_EQ(fast_math::log(inf), inf);
+    EXPECT_EQ(fast_math::log(5e-324), std::log(5e-324));
+    EXPECT_TRUE(std::isnan(fast_math::log(-1.0)));
+
+    EXPECT_EQ(std::signbit(fast_math::sin(-0.0)), true);
+    EXPECT_EQ(fast_math::cos(0.0), 1.0);
+    EXPECT_EQ(fast_math::sin(1e300), std::sin(1e300));
+    EXPECT_TRUE(std::isnan(fast_math::sin(inf)));
+
+    EXPECT_EQ(fast_math::atan(inf), std::atan(inf));
+    EXPECT_EQ(fast_math::atan(-1.0), std::atan(-1.0));
+    EXPECT_EQ(fast_math::acos(1.0), 0.0);
+    EXPECT_EQ(fast_math::acos(-1.0), std::acos(-1.0));
+    EXPECT_TRUE(std::isnan(fast_math::acos(1.5)));
+}
+
+// Up to the contraction into FMAs, which may differ between the loops
+TEST(FastMathTest, BatchedMatchScalar) {
+    std::vector<double> x(1001);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = -5.0 + 0.01 * static_cast<double>(i);
+    }
+    std::vector<double> out(x.size());
+    fast_math::sin(x.data(), out.data(), x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_LE(ulps(out[i], fast_math::sin(x[i])), 1);
+    }
+    fast_math::exp(x.data(), out.data(), x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_LE(ulps(out[i], fast_math::exp(x[i])), 1);
+    }
+
+    // In place, with an argument for the libm fallback
+    std::vector<double> y = x;
+    y[500] = 1e300;
+    fast_math::cos(y.data(), y.data(), y.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_LE(ulps(y[i], fast_math::cos(i == 500 ? 1e300 : x[i])), 1);
+    }
+}
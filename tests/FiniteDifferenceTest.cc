@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "FiniteDifference.h"
+#include "LSMTask.h"
+#include "SketchGenerator.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Counts the evaluations of the wrapped residual
+class CountingResidual : public Function {
+public:
+    Function *operand;
+    mutable int computations = 0;
+
+    explicit CountingResidual(Function *operand) : operand(operand) {}
+    ~CountingResidual() override { delete operand; }
+
+    double evaluate() const override {
+        ++computations;
+        return operand->value();
+    }
+
+    size_t childCount() const override { return 1; }
+    Function *child(size_t) const override { return operand; }
+
+    Function *derivative(Variable *var) const override { return operand->derivative(var); }
+    Function *clone() const override { throw std::logic_error("not clonable"); }
+};
+
+// r_i = x_{i-1} + x_i^2 - sin(x_{i+1}), a tridiagonal Jacobian. Counted
+// residuals are not batched, the counter is an unknown node type.
+struct Tridiagonal {
+    VariableStore store;
+    std::vector<Variable *> x;
+    std::vector<Function *> residuals;
+
+    explicit Tridiagonal(size_t n, bool counted = true) {
+        for (size_t i = 0; i < n; ++i) {
+            store.add(0.1 * static_cast<double>(i) - 1.0);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            x.push_back(store.variable(i));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            Function *r = new Power(x[i]->clone(), new Constant(2.0));
+            if (i > 0) {
+                r = new Addition(x[i - 1]->clone(), r);
+            }
+            if (i + 1 < n) {
+                r = new Subtraction(r, new Sin(x[i + 1]->clone()));
+            }
+            residuals.push_back(counted ? new CountingResidual(r) : r);
+        }
+    }
+
+    ~Tridiagonal() {
+        for (auto r: residuals) {
+            delete r;
+        }
+        for (auto var: x) {
+            delete var;
+        }
+    }
+
+    double exact(size_t i, size_t j) const {
+        if (j + 1 == i) {
+            return 1.0;
+        }
+        if (j == i) {
+            return 2.0 * store[i];
+        }
+        if (j == i + 1) {
+            return -std::cos(store[i + 1]);
+        }
+        return 0.0;
+    }
+};
+
+} // namespace
+
+TEST(ColumnColoringTest, GroupsShareNoRow) {
+    Tridiagonal problem(40);
+    SparsityPattern pattern = DependencyAnalysis(problem.x).jacobianPattern(problem.residuals);
+    ColumnColoring coloring(pattern);
+    EXPECT_EQ(coloring.colorCount(), 3u);
+
+    std::vector<int> seen(pattern.cols(), 0);
+    for (size_t color = 0; color < coloring.colorCount(); ++color) {
+        std::vector<int> rowUsed(pattern.rows(), 0);
+        for (size_t j : coloring.groups[color]) {
+            EXPECT_EQ(coloring.colorOf[j], color);
+            ++seen[j];
+        }
+        for (size_t i = 0; i < pattern.rows(); ++i) {
+            for (size_t j : pattern.row(i)) {
+                if (coloring.colorOf[j] == color) {
+                    EXPECT_EQ(rowUsed[i]++, 0) << "row " << i << " color " << color;
+                }
+            }
+        }
+    }
+    EXPECT_EQ(seen, std::vector<int>(pattern.cols(), 1));
+
+    // A dense row needs a color per column
+    EXPECT_EQ(ColumnColoring(SparsityPattern::dense(2, 5)).colorCount(), 5u);
+}
+
+TEST(FiniteDifferenceJacobianTest, TridiagonalInColorCountEvaluations) {
+    Tridiagonal problem(40);
+    FiniteDifferenceJacobian fd(problem.residuals, problem.x);
+    ASSERT_EQ(fd.colorCount(), 3u);
+
+    Matrix<> residuals, jac;
+    fd.evaluate(residuals, jac, false);
+    for (size_t i = 0; i < 40; ++i) {
+        EXPECT_DOUBLE_EQ(residuals(i, 0), problem.residuals[i]->evaluate());
+        for (size_t j = 0; j < 40; ++j) {
+            EXPECT_NEAR(jac(i, j), problem.exact(i, j), 1e-6) << i << ", " << j;
+        }
+    }
+    // Values are restored, and no residual was evaluated more than
+    // colorCount() + 1 times (plus the one above)
+    EXPECT_DOUBLE_EQ(problem.store[0], -1.0);
+    for (auto r: problem.residuals) {
+        EXPECT_LE(static_cast<CountingResidual *>(r)->computations, 3 + 1 + 1);
+    }
+}
+
+TEST(FiniteDifferenceJacobianTest, ParallelMatchesSerial) {
+    Tridiagonal problem(200);
+    FiniteDifferenceJacobian fd(problem.residuals, problem.x);
+    Matrix<> residuals, serial, parallel;
+    fd.evaluate(residuals, serial, false);
+
+    size_t previous = ThreadPool::shared().threadCount();
+    ThreadPool::shared().setThreadCount(4);
+    fd.evaluate(residuals, parallel, true);
+    ThreadPool::shared().setThreadCount(previous);
+    EXPECT_EQ(parallel, serial);
+    EXPECT_DOUBLE_EQ(problem.store[0], -1.0);
+}
+
+TEST(FiniteDifferenceJacobianTest, LSMTaskMatchesSymbolic) {
+    SketchOptions options;
+    options.seed = 6;
+    options.variableCount = 60;
+    auto symbolicSketch = SketchGenerator(options).generate();
+    auto fdSketch = SketchGenerator(options).generate();
+    auto symbolic = symbolicSketch->makeTask();
+    auto fd = fdSketch->makeTask(Differentiation::FiniteDifference);
+    EXPECT_EQ(fd->differentiation(), Differentiation::FiniteDifference);
+
+    Matrix<> residuals, jac, fdResiduals, fdJac;
+    symbolic->linearizeInto(residuals, jac);
+    fd->linearizeInto(fdResiduals, fdJac);
+    EXPECT_EQ(fdResiduals, residuals);
+    double scale = 0.0;
+    for (size_t i = 0; i < jac.rows_size(); ++i) {
+        for (size_t j = 0; j < jac.cols_size(); ++j) {
+            scale = std::max(scale, std::abs(jac(i, j)));
+        }
+    }
+    for (size_t i = 0; i < jac.rows_size(); ++i) {
+        for (size_t j = 0; j < jac.cols_size(); ++j) {
+            EXPECT_NEAR(fdJac(i, j), jac(i, j), 1e-6 * std::max(1.0, scale)) << i << ", " << j;
+        }
+    }
+    EXPECT_EQ(fd->getValues(), symbolic->getValues());
+
+    // Incremental mode reads the same tapes
+    fd->setIncremental(true);
+    Matrix<> incrementalJac;
+    fd->linearizeInto(fdResiduals, incrementalJac);
+    EXPECT_EQ(incrementalJac, fdJac);
+}
+
+TEST(FiniteDifferenceJacobianTest, BatchedMatchesGrouped) {
+    Tridiagonal counted(100);
+    Tridiagonal plain(100, false);
+    FiniteDifferenceJacobian grouped(counted.residuals, counted.x);
+    FiniteDifferenceJacobian batched(plain.residuals, plain.x);
+    EXPECT_FALSE(grouped.isBatched());
+    ASSERT_TRUE(batched.isBatched());
+    EXPECT_EQ(batched.colorCount(), 0u);
+
+    Matrix<> residuals, jac, batchedResiduals, batchedJac;
+    grouped.evaluate(residuals, jac, false);
+    batched.evaluate(batchedResiduals, batchedJac, false);
+    EXPECT_EQ(batchedResiduals, residuals);
+    EXPECT_EQ(batchedJac, jac);
+    EXPECT_DOUBLE_EQ(plain.store[0], -1.0);
+
+    size_t previous = ThreadPool::shared().threadCount();
+    ThreadPool::shared().setThreadCount(4);
+    Matrix<> parallelJac;
+    batched.evaluate(batchedResiduals, parallelJac, true);
+    ThreadPool::shared().setThreadCount(previous);
+    EXPECT_EQ(parallelJac, jac);
+
+    // The fast kernels move sin by an ulp or two, the difference quotient
+    // divides that by h ~ 1e-8
+    batched.setMathMode(MathMode::Fast);
+    batched.evaluate(batchedResiduals, batchedJac, false);
+    for (size_t i = 0; i < 100; ++i) {
+        EXPECT_NEAR(batchedResiduals(i, 0), residuals(i, 0), 1e-14);
+        for (size_t j = 0; j < 100; ++j) {
+            EXPECT_NEAR(batchedJac(i, j), plain.exact(i, j), 1e-6) << i << ", " << j;
+        }
+    }
+}
+
+TEST(FiniteDifferenceJacobianTest, TrackedGraphsStaySerial) {
+    // An Override does not dirty the caches, the parallel groups would read
+    // the unperturbed values
+    Tridiagonal problem(200);
+    DependencyTracker tracker;
+    for (auto var: problem.x) {
+        tracker.track(var);
+    }
+    for (auto r: problem.residuals) {
+        tracker.track(r);
+    }
+    FiniteDifferenceJacobian fd(problem.residuals, problem.x);
+    ASSERT_FALSE(fd.isBatched());
+
+    size_t previous = ThreadPool::shared().threadCount();
+    ThreadPool::shared().setThreadCount(4);
+    Matrix<> residuals, jac;
+    fd.evaluate(residuals, jac);
+    ThreadPool::shared().setThreadCount(previous);
+    for (size_t i = 0; i < 200; ++i) {
+        for (size_t j = 0; j < 200; ++j) {
+            EXPECT_NEAR(jac(i, j), problem.exact(i, j), 1e-6) << i << ", " << j;
+        }
+    }
+}
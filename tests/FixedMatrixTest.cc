@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "FixedMatrix.h"
+#include "Instrumentation.h"
+
+using Matrix2d = FixedMatrix<double, 2, 2>;
+using Matrix3d = FixedMatrix<double, 3, 3>;
+
+TEST(FixedMatrixTest, ConstructionAndAccess) {
+    Matrix2d zero;
+    EXPECT_EQ(zero, Matrix2d::zeroes());
+    EXPECT_EQ(zero(1, 1), 0.0);
+
+    FixedMatrix<double, 2, 3> A = {{1, 2, 3}, {4, 5, 6}};
+    EXPECT_EQ(A.rows_size(), 2u);
+    EXPECT_EQ(A.cols_size(), 3u);
+    EXPECT_EQ(A(1, 2), 6.0);
+    EXPECT_THROW(A(2, 0), std::out_of_range);
+    EXPECT_THROW((Matrix2d{{1, 2, 3}, {4, 5, 6}}), std::invalid_argument);
+    EXPECT_EQ(Matrix2d(7.0)(0, 1), 7.0);
+}
+
+TEST(FixedMatrixTest, ArithmeticIsConstexpr) {
+    constexpr Matrix2d A = {{1, 2}, {3, 4}};
+    constexpr Matrix2d B = {{0, 1}, {1, 0}};
+    constexpr Matrix2d product = A * B;
+    static_assert(product(0, 0) == 2 && product(0, 1) == 1);
+    static_assert((A + B)(1, 0) == 4);
+    static_assert((A - B)(0, 0) == 1);
+    static_assert((A * 2.0)(1, 1) == 8);
+    static_assert(A.transpose()(0, 1) == 3);
+    static_assert(A.trace() == 5);
+    static_assert(A.determinant() == -2);
+    static_assert(Matrix3d::identity().determinant() == 1);
+    EXPECT_EQ(product, (Matrix2d{{2, 1}, {4, 3}}));
+}
+
+TEST(FixedMatrixTest, RectangularProducts) {
+    FixedMatrix<double, 4, 8> J;
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 8; ++j) {
+            J(i, j) = static_cast<double>(i + 1) * (j % 3 == 0 ? 1.0 : -0.5);
+        }
+    }
+    FixedMatrix<double, 8, 8> normal = J.transpose() * J;
+    Matrix<> expected = J.toMatrix().transpose() * J.toMatrix();
+    for (size_t i = 0; i < 8; ++i) {
+        for (size_t j = 0; j < 8; ++j) {
+            EXPECT_DOUBLE_EQ(normal(i, j), expected(i, j));
+        }
+    }
+}
+
+TEST(FixedMatrixTest, SolveAndInverse) {
+    Matrix3d A = {{4, 1, 2}, {1, 5, 3}, {2, 3, 6}};
+    FixedVector<double, 3> b = {{1}, {2}, {3}};
+    FixedVector<double, 3> x = A.solve(b);
+    FixedVector<double, 3> residual = A * x - b;
+    EXPECT_LT(residual.norm(), 1e-14);
+    EXPECT_NEAR(A.determinant(), Matrix<>({{4, 1, 2}, {1, 5, 3}, {2, 3, 6}}).determinant(), 1e-12);
+
+    Matrix3d I = A * A.inverse();
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(I(i, j), i == j ? 1.0 : 0.0, 1e-15);
+        }
+    }
+
+    // Pivoting handles a zero leading entry
+    Matrix2d P = {{0, 1}, {2, 0}};
+    EXPECT_EQ(P.inverse(), (Matrix2d{{0, 0.5}, {1, 0}}));
+    EXPECT_EQ(P.determinant(), -2.0);
+
+    Matrix2d singular = {{1, 2}, {2, 4}};
+    EXPECT_THROW(singular.inverse(), std::runtime_error);
+    EXPECT_THROW(singular.solve(FixedVector<double, 2>()), std::runtime_error);
+    EXPECT_EQ((Matrix3d{{1, 2, 3}, {2, 4, 6}, {1, 0, 1}}).determinant(), 0.0);
+
+    // 2 x 2 goes through the same test, its closed form would give 2.2e-16
+    Matrix2d nearlySingular = {{1, 1}, {1, 1.0000000000000002}};
+    EXPECT_THROW(nearlySingular.inverse(), std::runtime_error);
+    EXPECT_EQ(nearlySingular.determinant(), 0.0);
+
+    // Badly scaled but regular
+    Matrix2d scaled = {{1e-8, 0}, {0, 1e8}};
+    EXPECT_EQ(scaled.inverse(), (Matrix2d{{1e8, 0}, {0, 1e-8}}));
+    EXPECT_DOUBLE_EQ(scaled.determinant(), 1.0);
+}
+
+TEST(FixedMatrixTest, DynamicMatrixInterop) {
+    Matrix<> A = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+    Matrix2d block = Matrix2d::block(A, 1, 1);
+    EXPECT_EQ(block, (Matrix2d{{5, 6}, {8, 9}}));
+    EXPECT_THROW(Matrix2d::block(A, 2, 0), std::out_of_range);
+
+    block.addTo(A, 0, 0);
+    EXPECT_EQ(A, Matrix<>({{6, 8, 3}, {12, 14, 6}, {7, 8, 9}}));
+    Matrix2d::identity().copyTo(A, 1, 1);
+    EXPECT_EQ(A, Matrix<>({{6, 8, 3}, {12, 1, 0}, {7, 0, 1}}));
+
+    EXPECT_EQ(Matrix2d(Matrix<>({{1, 2}, {3, 4}})), (Matrix2d{{1, 2}, {3, 4}}));
+    EXPECT_THROW(Matrix2d{A}, std::invalid_argument);
+    EXPECT_EQ(block.toMatrix(), Matrix<>({{5, 6}, {8, 9}}));
+}
+
+#ifdef MATH_ALLOCATION_TRACKING
+
+TEST(FixedMatrixTest, ArithmeticDoesNotAllocate) {
+    instrumentation::AllocationScope scope;
+    Matrix3d A = {{4, 1, 2}, {1, 5, 3}, {2, 3, 6}};
+    FixedVector<double, 3> b = {{1}, {2}, {3}};
+    FixedVector<double, 3> x = A.solve(b) + A.inverse() * b;
+    EXPECT_GT(x.norm(), 0.0);
+    EXPECT_EQ(scope.total().allocations, 0);
+}
+
+#endif // MATH_ALLOCATION_TRACKING
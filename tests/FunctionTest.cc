@@ -911,7 +911,198 @@ TEST_F(FunctionTest, TestMin) {
     delete minFunc5;
 }
 
+// Counts how often its operand had to be recomputed
+class CountingNode : public Unary {
+public:
+    mutable int computations = 0;
+
+    explicit CountingNode(Function* argument) : Unary(argument) {}
+
+    double evaluate() const override {
+        ++computations;
+        return operand->value();
+    }
+
+    Function* derivative(Variable* var) const override { return operand->derivative(var); }
+
+    Function* clone() const override { return new CountingNode(operand->clone()); }
+};
+
+TEST_F(FunctionTest, TrackedNodesRecomputeOnlyWhenDirty) {
+    double x_val = 1.0;
+    double y_val = 2.0;
+    Variable x(&x_val);
+    Variable y(&y_val);
+    CountingNode fx(new Sin(&x));
+    CountingNode fy(new Exp(&y));
+    Addition sum(&fx, &fy);
+
+    DependencyTracker tracker;
+    tracker.track(&sum);
+    EXPECT_EQ(tracker.nodeCount(), 7u);
+    EXPECT_DOUBLE_EQ(sum.value(), std::sin(1.0) + std::exp(2.0));
+    EXPECT_DOUBLE_EQ(sum.value(), std::sin(1.0) + std::exp(2.0));
+    EXPECT_EQ(fx.computations, 1);
+    EXPECT_EQ(fy.computations, 1);
+
+    x.setValue(0.5);
+    EXPECT_DOUBLE_EQ(sum.value(), std::sin(0.5) + std::exp(2.0));
+    EXPECT_EQ(fx.computations, 2);
+    EXPECT_EQ(fy.computations, 1);
+
+    // Same value, nothing to recompute
+    x.setValue(0.5);
+    sum.value();
+    EXPECT_EQ(fx.computations, 2);
+
+    tracker.release();
+    sum.value();
+    EXPECT_EQ(fx.computations, 3);
+    EXPECT_EQ(fy.computations, 2);
+}
+
+TEST_F(FunctionTest, TrackedAliasesShareChanges) {
+    // The derivative holds its own Variable nodes for x
+    double x_val = 2.0;
+    Variable x(&x_val);
+    Function* f = new Multiplication(x.clone(), x.clone());
+    Function* df = f->derivative(&x);
+
+    DependencyTracker tracker;
+    tracker.track(&x);
+    tracker.track(f);
+    tracker.track(df);
+    EXPECT_DOUBLE_EQ(f->value(), 4.0);
+    EXPECT_DOUBLE_EQ(df->value(), 4.0);
+
+    x.setValue(3.0);
+    EXPECT_DOUBLE_EQ(f->value(), 9.0);
+    EXPECT_DOUBLE_EQ(df->value(), 6.0);
+
+    // The cache does not see writes bypassing setValue
+    x_val = 5.0;
+    EXPECT_DOUBLE_EQ(f->value(), 9.0);
+    tracker.release();
+    EXPECT_DOUBLE_EQ(f->value(), 25.0);
+}
+
+// Written against the plain evaluate() interface, reads its operand uncached
+class LegacyNode : public Unary {
+public:
+    explicit LegacyNode(Function* argument) : Unary(argument) {}
+
+    double evaluate() const override { return 2.0 * operand->evaluate(); }
+
+    Function* derivative(Variable* var) const override { return operand->derivative(var); }
+
+    Function* clone() const override { return new LegacyNode(operand->clone()); }
+};
+
+// Reads a double the graph does not know about
+class HiddenInput : public Function {
+public:
+    const double* input;
+
+    explicit HiddenInput(const double* input) : input(input) {}
+
+    double evaluate() const override { return *input; }
+
+    Function* derivative(Variable*) const override { return new Constant(0.0); }
+
+    Function* clone() const override { return new HiddenInput(input); }
+};
+
+TEST_F(FunctionTest, TrackedSubclassesStayCorrect) {
+    double x_val = 1.0;
+    double hidden = 3.0;
+    Variable x(&x_val);
+    Exp ex(&x);
+    LegacyNode legacy(&ex);
+    HiddenInput input(&hidden);
+    Addition sum(&legacy, &input);
+    Negation root(&sum);
+
+    DependencyTracker tracker;
+    tracker.track(&root);
+    EXPECT_DOUBLE_EQ(root.value(), -(2.0 * std::exp(1.0) + 3.0));
+    for (double v : {0.5, -1.0, 2.0}) {
+        x.setValue(v);
+        EXPECT_DOUBLE_EQ(root.value(), -(2.0 * std::exp(v) + 3.0));
+    }
+
+    // Nodes above a HiddenInput are not cached
+    hidden = 4.0;
+    EXPECT_DOUBLE_EQ(root.value(), -(2.0 * std::exp(2.0) + 4.0));
+    EXPECT_DOUBLE_EQ(legacy.value(), 2.0 * std::exp(2.0));
+}
+
+TEST_F(FunctionTest, VariableStoreHandles) {
+    VariableStore store({1.0, 2.0});
+    Variable* x = store.variable(0);
+    Variable* y = store.variable(1);
+    EXPECT_EQ(x->store(), &store);
+    EXPECT_EQ(y->index(), 1u);
+    EXPECT_THROW(store.variable(2), std::out_of_range);
+
+    Function* f = new Multiplication(x->clone(), y->clone());
+    Function* df = f->derivative(x);
+    EXPECT_DOUBLE_EQ(f->evaluate(), 2.0);
+    EXPECT_DOUBLE_EQ(df->evaluate(), 2.0);
+
+    // Handles follow the array when it grows and moves
+    for (int i = 0; i < 100; ++i) {
+        store.add(i);
+    }
+    store[0] = 3.0;
+    EXPECT_DOUBLE_EQ(f->evaluate(), 6.0);
+    y->setValue(4.0);
+    EXPECT_DOUBLE_EQ(store[1], 4.0);
+    EXPECT_DOUBLE_EQ(df->evaluate(), 4.0);
+
+    store.assign(std::vector<double>(store.size(), 1.0));
+    EXPECT_DOUBLE_EQ(f->evaluate(), 1.0);
+    EXPECT_THROW(store.assign({1.0}), std::invalid_argument);
+
+    // Same entry of another store is another variable
+    VariableStore copy = store;
+    Variable same(&store, 0);
+    Variable other(&copy, 0);
+    EXPECT_TRUE(*x == &same);
+    EXPECT_FALSE(*x == &other);
+    delete f;
+    delete df;
+    delete x;
+    delete y;
+}
+
+TEST_F(FunctionTest, TrackedStoreHandlesSurviveGrowth) {
+    VariableStore store({1.0});
+    Variable* x = store.variable(0);
+    Function* f = new Multiplication(x->clone(), new Constant(2.0));
+
+    DependencyTracker tracker;
+    tracker.track(x);
+    tracker.track(f);
+    EXPECT_DOUBLE_EQ(f->value(), 2.0);
+
+    // The array moves, trees tracked afterwards join the same group
+    for (int i = 0; i < 100; ++i) {
+        store.add(i);
+    }
+    Function* g = new Addition(x->clone(), new Constant(1.0));
+    tracker.track(g);
+    EXPECT_DOUBLE_EQ(g->value(), 2.0);
+
+    x->setValue(5.0);
+    EXPECT_DOUBLE_EQ(f->value(), 10.0);
+    EXPECT_DOUBLE_EQ(g->value(), 6.0);
+    tracker.release();
+    delete f;
+    delete g;
+    delete x;
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
@@ -0,0 +1,264 @@
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "Instrumentation.h"
+#include "LSMTask.h"
+#include "LevenbergMarquardtSolver.h"
+#include "QR.h"
+#include "SketchGenerator.h"
+
+using instrumentation::Histogram;
+using instrumentation::Registry;
+
+TEST(InstrumentationTest, CounterAccumulates) {
+    auto &counter = Registry::instance().counter("test.counter");
+    counter.reset();
+    counter.add(3);
+    counter.add(4);
+    EXPECT_EQ(counter.value(), 7);
+    EXPECT_EQ(&counter, &Registry::instance().counter("test.counter"));
+}
+
+TEST(InstrumentationTest, TimerKeepsStatistics) {
+    auto &timer = Registry::instance().timer("test.timer");
+    timer.reset();
+    EXPECT_EQ(timer.minNs(), 0);
+    timer.record(30);
+    timer.record(10);
+    timer.record(20);
+    EXPECT_EQ(timer.count(), 3);
+    EXPECT_EQ(timer.totalNs(), 60);
+    EXPECT_EQ(timer.minNs(), 10);
+    EXPECT_EQ(timer.maxNs(), 30);
+}
+
+TEST(InstrumentationTest, HistogramBuckets) {
+    EXPECT_EQ(Histogram::bucket(0.0), 0);
+    EXPECT_EQ(Histogram::bucket(-1.0), 0);
+    // 1 lies in [1, 2), 3 in [2, 4)
+    EXPECT_EQ(Histogram::upperBound(Histogram::bucket(1.0)), 2.0);
+    EXPECT_EQ(Histogram::upperBound(Histogram::bucket(3.0)), 4.0);
+    EXPECT_EQ(Histogram::bucket(1e300), Histogram::kBuckets - 1);
+
+    auto &histogram = Registry::instance().histogram("test.histogram");
+    histogram.reset();
+    for (double value: {1.0, 3.0, 3.5, 100.0}) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.count(), 4);
+    EXPECT_DOUBLE_EQ(histogram.sum(), 107.5);
+    EXPECT_EQ(histogram.min(), 1.0);
+    EXPECT_EQ(histogram.max(), 100.0);
+    EXPECT_EQ(histogram.bucketCount(Histogram::bucket(3.0)), 2);
+}
+
+TEST(InstrumentationTest, ScopedTimerRecordsTrace) {
+    auto &registry = Registry::instance();
+    registry.reset();
+    registry.setTracing(true);
+    auto &timer = registry.timer("test.scope");
+    {
+        instrumentation::ScopedTimer scope(timer, "test.scope");
+    }
+    registry.setTracing(false);
+    {
+        instrumentation::ScopedTimer scope(timer, "test.scope");
+    }
+    EXPECT_EQ(timer.count(), 2);
+    auto events = registry.traceEvents();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_STREQ(events[0].name, "test.scope");
+    EXPECT_GE(events[0].durationNs, 0);
+}
+
+TEST(InstrumentationTest, NestedTimerTimesOutermostCall) {
+    auto &timer = Registry::instance().timer("test.nested");
+    timer.reset();
+    int depth = 0;
+    {
+        instrumentation::NestedScopedTimer outer(timer, "test.nested", depth);
+        instrumentation::NestedScopedTimer inner(timer, "test.nested", depth);
+        EXPECT_EQ(depth, 2);
+    }
+    EXPECT_EQ(depth, 0);
+    EXPECT_EQ(timer.count(), 1);
+}
+
+TEST(InstrumentationTest, JsonAndChromeTraceDumps) {
+    auto &registry = Registry::instance();
+    registry.reset();
+    registry.counter("test.dump \"quoted\"").add(5);
+    registry.setTracing(true);
+    {
+        instrumentation::ScopedTimer scope(registry.timer("test.dump.timer"), "test.dump.timer");
+    }
+    registry.setTracing(false);
+
+    std::ostringstream json;
+    registry.writeJson(json);
+    EXPECT_NE(json.str().find("\"counters\": {"), std::string::npos);
+    EXPECT_NE(json.str().find("\"test.dump \\\"quoted\\\"\": 5"), std::string::npos);
+    EXPECT_NE(json.str().find("\"test.dump.timer\": {\"count\": 1"), std::string::npos);
+
+    std::ostringstream trace;
+    registry.writeChromeTrace(trace);
+    EXPECT_EQ(trace.str().rfind("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", 0), 0u);
+    EXPECT_NE(trace.str().find("\"name\": \"test.dump.timer\", \"cat\": \"math\", \"ph\": \"X\""),
+              std::string::npos);
+    EXPECT_NE(trace.str().find("\"ph\": \"C\""), std::string::npos);
+}
+
+TEST(InstrumentationTest, AllocationScopesNest) {
+    using instrumentation::AllocationKind;
+    using instrumentation::AllocationScope;
+    using instrumentation::recordAllocation;
+    using instrumentation::recordDeallocation;
+
+    auto &tracker = Registry::instance().allocations(AllocationKind::Matrix);
+    tracker.reset();
+    int64_t live = tracker.counts().liveBytes;
+    {
+        AllocationScope outer("test.outer");
+        recordAllocation(AllocationKind::Matrix, 100);
+        {
+            AllocationScope inner;
+            recordAllocation(AllocationKind::Function, 40);
+            recordDeallocation(AllocationKind::Matrix, 100);
+            EXPECT_EQ(inner.total().allocations, 1);
+            EXPECT_EQ(inner.total().liveBytes, -60);
+            EXPECT_EQ(inner.total().peakBytes, 40);
+        }
+        recordAllocation(AllocationKind::Matrix, 30);
+
+        const auto &matrix = outer.counts(AllocationKind::Matrix);
+        EXPECT_EQ(matrix.allocations, 2);
+        EXPECT_EQ(matrix.deallocations, 1);
+        EXPECT_EQ(matrix.allocatedBytes, 130);
+        EXPECT_EQ(matrix.freedBytes, 100);
+        EXPECT_EQ(matrix.liveBytes, 30);
+        EXPECT_EQ(matrix.peakBytes, 100);
+        EXPECT_EQ(outer.counts(AllocationKind::Function).allocations, 1);
+        EXPECT_EQ(outer.total().peakBytes, 140);
+        recordDeallocation(AllocationKind::Matrix, 30);
+        recordDeallocation(AllocationKind::Function, 40);
+    }
+    EXPECT_EQ(tracker.counts().allocations, 2);
+    EXPECT_EQ(tracker.counts().liveBytes, live);
+    EXPECT_EQ(tracker.counts().peakBytes, live + 100);
+    EXPECT_EQ(Registry::instance().counter("test.outer.allocations").value(), 3);
+    EXPECT_EQ(Registry::instance().histogram("test.outer.peakBytes").max(), 140.0);
+}
+
+#ifdef MATH_ALLOCATION_TRACKING
+
+TEST(InstrumentationTest, TracksMatrixAndFunctionAllocations) {
+    using instrumentation::AllocationKind;
+    instrumentation::AllocationScope scope;
+    {
+        Matrix<> A(3, 4);
+        Matrix<> B = A;
+        Matrix<> C = std::move(B);
+    }
+    const auto &matrix = scope.counts(AllocationKind::Matrix);
+    EXPECT_EQ(matrix.allocations, 2);
+    EXPECT_EQ(matrix.deallocations, 2);
+    EXPECT_EQ(matrix.allocatedBytes, 2 * 3 * static_cast<int64_t>(sizeof(double*) + 4 * sizeof(double)));
+    EXPECT_EQ(matrix.liveBytes, 0);
+
+    double a = 1.0;
+    Function *f = new Addition(new Constant(1.0), new Constant(2.0));
+    Variable x(&a);
+    Function *d = x.derivative(&x);
+    EXPECT_EQ(scope.counts(AllocationKind::Function).allocations, 4);
+    EXPECT_EQ(scope.counts(AllocationKind::Function).allocatedBytes,
+              static_cast<int64_t>(sizeof(Addition) + 3 * sizeof(Constant)));
+    delete d;
+    delete f;
+    EXPECT_EQ(scope.counts(AllocationKind::Function).deallocations, 2);
+}
+
+// Matrix allocations counted so far, sampled at every LM iteration
+class AllocationSampler : public OptimizerObserver {
+public:
+    std::vector<int64_t> samples;
+
+    void onIteration(const IterationReport &) override {
+        samples.push_back(Registry::instance().allocations(instrumentation::AllocationKind::Matrix)
+                                  .counts().allocations);
+    }
+};
+
+TEST(InstrumentationTest, LevenbergMarquardtIterationsDoNotAllocate) {
+    SketchOptions options;
+    options.seed = 3;
+    options.variableCount = 24;
+    options.perturbation = 0.02;
+    auto sketch = SketchGenerator(options).generate();
+    auto task = sketch->makeTask();
+
+    AllocationSampler sampler;
+    LMSolver optimizer;
+    optimizer.setObserver(&sampler);
+    optimizer.setTask(task.get());
+    optimizer.optimize();
+
+    ASSERT_GT(sampler.samples.size(), 2u);
+    // the factorizations take their buffers in the first iteration
+    for (size_t i = 1; i < sampler.samples.size(); ++i) {
+        EXPECT_EQ(sampler.samples[i], sampler.samples[0]) << "iteration " << i;
+    }
+}
+
+#endif // MATH_ALLOCATION_TRACKING
+
+#ifdef MATH_INSTRUMENTATION
+
+TEST(InstrumentationTest, ProbesInHotPaths) {
+    auto &registry = Registry::instance();
+    registry.reset();
+
+    Matrix<> A = {{4, 1, 0}, {1, 3, 1}, {0, 1, 2}};
+    QR qr(A);
+    qr.qrMGS();
+    Matrix<> product = A * A;
+    Matrix<> inverse = A.inverse();
+
+    double a = 1.0, b = 2.0;
+    Variable *x = new Variable(&a);
+    Variable *y = new Variable(&b);
+    LSMTask task({new Subtraction(new Multiplication(x, y), new Constant(1.0))}, {x, y});
+    registry.reset();
+    task.linearizeFunction();
+
+    EXPECT_EQ(registry.timer("LSMTask::linearizeFunction").count(), 1);
+    EXPECT_EQ(registry.counter("LSMTask::linearizeFunction.jacobianEntries").value(), 2);
+    // one residual tree and two jacobian trees
+    EXPECT_EQ(registry.timer("Function::evaluate").count(), 3);
+    EXPECT_GT(registry.counter("Function::evaluate.nodes").value(), 3);
+
+    registry.reset();
+    qr.qrMGS();
+    A *= A;
+    A.inverse();
+    EXPECT_EQ(registry.timer("QR::qrMGS").count(), 1);
+    EXPECT_EQ(registry.histogram("QR::qr.columns").count(), 1);
+    EXPECT_EQ(registry.timer("Matrix::operator*=").count(), 1);
+    EXPECT_EQ(registry.histogram("Matrix::operator*=.flops").max(), 54.0);
+    EXPECT_EQ(registry.timer("Matrix::inverse").count(), 1);
+}
+
+#else
+
+TEST(InstrumentationTest, ProbesCompiledOut) {
+    auto &registry = Registry::instance();
+    registry.reset();
+    Matrix<> A = {{4, 1}, {1, 3}};
+    A *= A;
+    QR qr(A);
+    qr.qrMGS();
+    EXPECT_EQ(registry.timer("Matrix::operator*=").count(), 0);
+    EXPECT_EQ(registry.timer("QR::qrMGS").count(), 0);
+}
+
+#endif // MATH_INSTRUMENTATION
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "LDLT.h"
+#include "TestHelpers.h"
+
+static Matrix<> diagonal(const std::vector<double>& d) {
+    Matrix<> D(d.size(), d.size());
+    for (size_t i = 0; i < d.size(); ++i) {
+        D(i, i) = d[i];
+    }
+    return D;
+}
+
+TEST(LDLTTest, FactorsDefiniteMatrix) {
+    Matrix<> A = {
+            {4, 2, 2},
+            {2, 5, 3},
+            {2, 3, 6}
+    };
+    LDLT<> ldlt(A);
+    EXPECT_EQ(ldlt.rank(), 3u);
+    EXPECT_TRUE(ldlt.isPositiveSemidefinite());
+
+    Matrix<> L = ldlt.L();
+    EXPECT_LT(maxAbsDifference(L * diagonal(ldlt.D()) * L.transpose(), A), 1e-14);
+
+    Matrix<> x = Matrix<>({1.0, -2.0, 3.0}).transpose();
+    EXPECT_LT(maxAbsDifference(ldlt.solve(A * x), x), 1e-13);
+}
+
+TEST(LDLTTest, SolvesSemidefiniteSystems) {
+    // J^T J of a Jacobian whose last column repeats the first
+    Matrix<> J = {
+            {1, 2, 1},
+            {0, 1, 0},
+            {3, 1, 3},
+            {1, 1, 1}
+    };
+    Matrix<> A = J.transpose() * J;
+    LDLT<> ldlt(A);
+    EXPECT_EQ(ldlt.rank(), 2u);
+    EXPECT_EQ(ldlt.D()[2], 0.0);
+    EXPECT_TRUE(ldlt.isPositiveSemidefinite());
+
+    // the normal equations are consistent for every residual vector
+    Matrix<> r = Matrix<>({1.0, -1.0, 2.0, 0.5}).transpose();
+    Matrix<> b = J.transpose() * r;
+    Matrix<> x = ldlt.solve(b);
+    EXPECT_LT(maxAbsDifference(A * x, b), 1e-12);
+    EXPECT_EQ(x(2, 0), 0.0);
+}
+
+TEST(LDLTTest, RefactorizesWithShift) {
+    Matrix<> A = {
+            {1, 1},
+            {1, 1}
+    };
+    LDLT<> ldlt(A);
+    EXPECT_EQ(ldlt.rank(), 1u);
+
+    ldlt.refactorize(1.0);
+    EXPECT_EQ(ldlt.rank(), 2u);
+    Matrix<> b = Matrix<>({1.0, 2.0}).transpose();
+    Matrix<> shifted = A;
+    shifted.addDiagonal(1.0);
+    EXPECT_LT(maxAbsDifference(shifted * ldlt.solve(b), b), 1e-14);
+}
+
+TEST(LDLTTest, FlagsIndefiniteMatrices) {
+    Matrix<> A = {
+            {1, 2},
+            {2, 1}
+    };
+    LDLT<> ldlt(A);
+    EXPECT_FALSE(ldlt.isPositiveSemidefinite());
+    EXPECT_EQ(ldlt.rank(), 2u);
+
+    Matrix<> b = Matrix<>({3.0, 3.0}).transpose();
+    EXPECT_LT(maxAbsDifference(A * ldlt.solve(b), b), 1e-14);
+}
+
+TEST(LDLTTest, RejectsBadInput) {
+    EXPECT_THROW(LDLT<>(Matrix<>(3, 2)), std::invalid_argument);
+    EXPECT_THROW(LDLT<>(Matrix<>()), std::runtime_error);
+    LDLT<> empty;
+    EXPECT_THROW(empty.refactorize(1.0), std::runtime_error);
+}
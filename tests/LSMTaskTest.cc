@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "Function.h"
 #include "LSMTask.h"
+#include "SketchGenerator.h"
 
 class TestFunction : public ::testing::Test {
 protected:
@@ -197,3 +198,53 @@ TEST_F(TestFunction, LinearizeFunctionZeroValues) {
     // Derivative of f(x) = (x + 2)^3 is 3 * (x + 2)^2, at x = 0 it is 12
     EXPECT_DOUBLE_EQ(jacobian(0, 0), 12.0);
 }
+
+TEST(LSMTaskIncremental, MatchesFullEvaluation) {
+    SketchOptions options;
+    options.seed = 5;
+    options.variableCount = 60;
+    auto sketch = SketchGenerator(options).generate();
+    auto task = sketch->makeTask();
+
+    Matrix<> residuals, jac, fullResiduals, fullJac;
+    std::vector<double> x = task->getValues();
+    double fullError = task->getError();
+    task->linearizeInto(fullResiduals, fullJac);
+
+    Matrix<> fullGradient = task->gradient();
+    task->setIncremental(true);
+    EXPECT_TRUE(task->isIncremental());
+    EXPECT_EQ(task->gradient(), fullGradient);
+    EXPECT_DOUBLE_EQ(task->getError(), fullError);
+    task->linearizeInto(residuals, jac);
+    EXPECT_EQ(residuals, fullResiduals);
+    EXPECT_EQ(jac, fullJac);
+
+    // Drag two variables, then compare with a fresh full evaluation
+    x[3] += 0.25;
+    x[17] -= 0.5;
+    double error = task->setError(x);
+    task->linearizeInto(residuals, jac);
+    Matrix<> gradient = task->gradient();
+
+    task->setIncremental(false);
+    EXPECT_DOUBLE_EQ(task->getError(), error);
+    EXPECT_EQ(gradient, task->gradient());
+    task->linearizeInto(fullResiduals, fullJac);
+    EXPECT_EQ(residuals, fullResiduals);
+    EXPECT_EQ(jac, fullJac);
+}
+
+TEST(LSMTaskTest, StoreValuesAreCopiedAsBlocks) {
+    SketchOptions options;
+    options.seed = 3;
+    options.variableCount = 20;
+    auto sketch = SketchGenerator(options).generate();
+    auto task = sketch->makeTask();
+    EXPECT_EQ(task->getValues(), sketch->store().values());
+
+    std::vector<double> x = sketch->solution();
+    EXPECT_NEAR(task->setError(x), 0.0, 1e-20);
+    EXPECT_EQ(sketch->values(), x);
+    EXPECT_EQ(task->getValues(), x);
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "LU.h"
+#include "TestHelpers.h"
+
+TEST(LUTest, FactorsSmallMatrix) {
+    Matrix<> A = {
+            {1, 4, 7},
+            {2, 8, 8},
+            {3, 6, 9}
+    };
+    LU<> lu(A);
+
+    EXPECT_FALSE(lu.isSingular());
+    // the largest entry of the first column is the first pivot
+    EXPECT_EQ(lu.permutation()[0], 2u);
+    EXPECT_LT(maxAbsDifference(lu.P() * A, lu.L() * lu.U()), 1e-14);
+    EXPECT_NEAR(lu.determinant(), -36.0, 1e-12);
+}
+
+TEST(LUTest, ReconstructsAcrossBlocks) {
+    // larger than one panel, with a partial last block
+    size_t n = 2 * LU<>::kBlockSize + 7;
+    Matrix<> A = randomMatrix(n, n, 1);
+    LU<> lu(A);
+
+    Matrix<> L = lu.L();
+    Matrix<> U = lu.U();
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(L(i, i), 1.0);
+        for (size_t j = 0; j < i; ++j) {
+            // partial pivoting keeps the multipliers bounded
+            EXPECT_LE(std::abs(L(i, j)), 1.0);
+            EXPECT_EQ(U(i, j), 0.0);
+        }
+    }
+    EXPECT_LT(maxAbsDifference(lu.P() * A, L * U), 1e-12);
+}
+
+TEST(LUTest, SolvesSeveralRightHandSides) {
+    size_t n = 50;
+    Matrix<> A = randomMatrix(n, n, 2);
+    Matrix<> X = randomMatrix(n, 3, 3);
+    Matrix<> B = A * X;
+
+    LU<> lu(A);
+    EXPECT_LT(maxAbsDifference(lu.solve(B), X), 1e-10);
+
+    Matrix<> x;
+    lu.solveInto(B, x);
+    EXPECT_LT(maxAbsDifference(x, X), 1e-10);
+    EXPECT_THROW(lu.solveInto(B, B), std::invalid_argument);
+    EXPECT_THROW(lu.solve(Matrix<>(n + 1, 1)), std::invalid_argument);
+}
+
+TEST(LUTest, InverseMatchesMatrixInverse) {
+    size_t n = 40;
+    Matrix<> A = randomMatrix(n, n, 4);
+    Matrix<> inv = LU<>(A).inverse();
+
+    EXPECT_LT(maxAbsDifference(A * inv, Matrix<>::identity(n)), 1e-10);
+    EXPECT_EQ(inv, A.inverse());
+}
+
+TEST(LUTest, DeterminantTracksRowSwaps) {
+    Matrix<> A = {
+            {0, 1},
+            {1, 0}
+    };
+    EXPECT_EQ(LU<>(A).determinant(), -1.0);
+
+    Matrix<> D = {
+            {2, 0, 0},
+            {0, 3, 0},
+            {0, 0, 4}
+    };
+    EXPECT_EQ(LU<>(D).determinant(), 24.0);
+}
+
+TEST(LUTest, DetectsSingularMatrices) {
+    Matrix<> A = {
+            {1, 2, 3},
+            {4, 5, 6},
+            {7, 8, 9}
+    };
+    LU<> lu(A);
+    EXPECT_TRUE(lu.isSingular());
+    EXPECT_EQ(lu.determinant(), 0.0);
+    EXPECT_THROW(lu.inverse(), std::runtime_error);
+    EXPECT_THROW(A.inverse(), std::runtime_error);
+    EXPECT_EQ(A.determinant(), 0.0);
+
+    // the tolerance is relative, a scaled regular matrix stays regular
+    Matrix<> B = {
+            {1e-200, 0},
+            {0, 2e-200}
+    };
+    EXPECT_FALSE(LU<>(B).isSingular());
+}
+
+TEST(LUTest, BadlyScaledMatricesStayRegular) {
+    Matrix<> D = {
+            {1e-8, 0},
+            {0, 1e8}
+    };
+    LU<> lu(D);
+    EXPECT_FALSE(lu.isSingular());
+    EXPECT_DOUBLE_EQ(lu.determinant(), 1.0);
+    Matrix<> inv = lu.inverse();
+    EXPECT_DOUBLE_EQ(inv(0, 0), 1e8);
+    EXPECT_DOUBLE_EQ(inv(1, 1), 1e-8);
+    EXPECT_DOUBLE_EQ(D.determinant(), 1.0);
+
+    // Columns of very different magnitude, well conditioned once scaled
+    size_t n = 40;
+    Matrix<> A = randomMatrix(n, n, 9);
+    Matrix<> X = randomMatrix(n, 1, 10);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            A(i, j) *= std::pow(10.0, static_cast<double>(j % 5) * 4.0 - 8.0);
+        }
+    }
+    LU<> scaled(A);
+    ASSERT_FALSE(scaled.isSingular());
+    Matrix<> B = A * X;
+    Matrix<> x = scaled.solve(B);
+    Matrix<> residual = A * x;
+    EXPECT_LT(maxAbsDifference(residual, B), 1e-10 * B.norm());
+
+    // A zero column is still singular whatever the other columns hold
+    Matrix<> Z = {
+            {1e8, 0},
+            {1, 0}
+    };
+    EXPECT_TRUE(LU<>(Z).isSingular());
+}
+
+TEST(LUTest, RejectsNonSquareAndEmptyMatrices) {
+    EXPECT_THROW(LU<>(Matrix<>(2, 3)), std::invalid_argument);
+    EXPECT_THROW(LU<>(Matrix<>()), std::runtime_error);
+}
+
+TEST(LUTest, RefactorizesInPlace) {
+    LU<> lu;
+    lu.factorize(randomMatrix(10, 10, 5));
+    Matrix<> A = randomMatrix(10, 10, 6);
+    lu.factorize(A);
+    EXPECT_EQ(lu.size(), 10u);
+    EXPECT_LT(maxAbsDifference(lu.P() * A, lu.L() * lu.U()), 1e-13);
+}
+
+TEST(LUTest, IntegerMatrixDeterminant) {
+    Matrix<int> A = {
+            {2, 1, 1},
+            {1, 3, 2},
+            {1, 0, 0}
+    };
+    EXPECT_EQ(A.determinant(), -1);
+
+    LU<float> lu(A);
+    EXPECT_NEAR(lu.determinant(), -1.0f, 1e-5f);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "Lanczos.h"
+#include "SymmetricEigen.h"
+#include "TestHelpers.h"
+
+TEST(LanczosTest, MatchesDenseSolverOnSmallMatrix) {
+    // with as many steps as rows the Krylov space is the whole space
+    Matrix<> A = randomSymmetric(30, 1);
+    SymmetricEigen<> dense(A);
+    Lanczos<> lanczos;
+    lanczos.compute(A, 3, LanczosWhich::Smallest, 30);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(lanczos.eigenvalues()[i], dense.eigenvalues()[i], 1e-10);
+    }
+    lanczos.compute(A, 2, LanczosWhich::Largest, 30);
+    EXPECT_NEAR(lanczos.eigenvalues()[0], dense.eigenvalues()[29], 1e-10);
+    EXPECT_NEAR(lanczos.eigenvalues()[1], dense.eigenvalues()[28], 1e-10);
+}
+
+TEST(LanczosTest, ExtremalPairsOfMatrixFreeOperator) {
+    // diagonal operator 1 .. n-2 with two outliers, applied without forming the matrix
+    const size_t n = 500;
+    auto apply = [n](const double *x, double *y) {
+        for (size_t i = 0; i < n; ++i) {
+            double d = i + 1 < n - 1 ? static_cast<double>(i + 1) : (i + 1 == n - 1 ? 2.0 * n : 3.0 * n);
+            y[i] = d * x[i];
+        }
+    };
+    Lanczos<> lanczos;
+    lanczos.compute(n, apply, 2, LanczosWhich::Largest, 60);
+    EXPECT_NEAR(lanczos.eigenvalues()[0], 3.0 * n, 1e-8);
+    EXPECT_NEAR(lanczos.eigenvalues()[1], 2.0 * n, 1e-8);
+
+    // the residual estimate matches the true residual of the Ritz pair
+    const Matrix<> &Y = lanczos.eigenvectors();
+    std::vector<double> y(n), Ay(n);
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = Y(i, 0);
+    }
+    apply(y.data(), Ay.data());
+    double residual = 0.0;
+    double norm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double r = Ay[i] - lanczos.eigenvalues()[0] * y[i];
+        residual += r * r;
+        norm += y[i] * y[i];
+    }
+    EXPECT_NEAR(norm, 1.0, 1e-10);
+    EXPECT_NEAR(std::sqrt(residual), lanczos.residuals()[0], 1e-8);
+    EXPECT_LT(lanczos.residuals()[0], 1e-6);
+}
+
+TEST(LanczosTest, StopsOnInvariantSubspace) {
+    // the identity has one distinct eigenvalue, a single step spans an invariant subspace
+    Lanczos<> lanczos;
+    lanczos.compute(Matrix<>::identity(10), 3);
+    ASSERT_EQ(lanczos.eigenvalues().size(), 1u);
+    EXPECT_NEAR(lanczos.eigenvalues()[0], 1.0, 1e-14);
+    EXPECT_EQ(lanczos.residuals()[0], 0.0);
+}
+
+TEST(LanczosTest, RejectsBadInput) {
+    Lanczos<> lanczos;
+    EXPECT_THROW(lanczos.compute(Matrix<>(2, 3), 1), std::invalid_argument);
+    EXPECT_THROW(lanczos.compute(Matrix<>::identity(3), 4), std::invalid_argument);
+    EXPECT_THROW(lanczos.compute(Matrix<>::identity(3), 0), std::invalid_argument);
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "MatrixAllocator.h"
+
+using HeapMatrix = Matrix<double, RowMajor, HeapAllocator>;
+
+// Counts the bytes Matrix asks for
+struct CountingAllocator {
+    static inline int64_t live = 0;
+    static void* allocate(size_t bytes) {
+        live += static_cast<int64_t>(bytes);
+        return ::operator new(bytes);
+    }
+    static void deallocate(void* p, size_t bytes) {
+        live -= static_cast<int64_t>(bytes);
+        ::operator delete(p);
+    }
+};
+
+TEST(MatrixAllocatorTest, PoolReusesSameSizedBuffers) {
+    BufferPool* pool = BufferPool::local();
+    ASSERT_NE(pool, nullptr);
+    pool->trim();
+
+    const double* first;
+    {
+        Matrix<> H(40, 40, 1.0);
+        first = H.data();
+    }
+    EXPECT_GT(pool->stats().cachedBytes, 0u);
+    int64_t hits = pool->stats().hits;
+    {
+        // 40 x 41 falls in the same size class
+        Matrix<> H(40, 41);
+        EXPECT_EQ(H.data(), first);
+        EXPECT_EQ(H(39, 40), 0.0);
+    }
+    EXPECT_EQ(pool->stats().hits, hits + 1);
+
+    pool->trim();
+    EXPECT_EQ(pool->stats().cachedBytes, 0u);
+}
+
+TEST(MatrixAllocatorTest, SizeClassesRoundUpAQuarterAtMost) {
+    for (size_t bytes = 1; bytes <= (size_t(1) << BufferPool::kMaxClassBits); bytes += bytes / 7 + 1) {
+        size_t block = BufferPool::blockBytes(bytes);
+        EXPECT_GE(block, bytes);
+        EXPECT_LE(block, std::max<size_t>(size_t(1) << BufferPool::kMinClassBits, bytes + bytes / 4)) << bytes;
+        // Every class size is its own class
+        EXPECT_EQ(BufferPool::blockBytes(block), block);
+    }
+    // A 33 MiB Jacobian takes 40 MiB, not 64
+    EXPECT_EQ(BufferPool::blockBytes(size_t(33) << 20), size_t(40) << 20);
+    EXPECT_EQ(BufferPool::blockBytes((size_t(1) << BufferPool::kMaxClassBits) + 8),
+              (size_t(1) << BufferPool::kMaxClassBits) + 8);
+}
+
+TEST(MatrixAllocatorTest, LargeBuffersBypassThePool) {
+    BufferPool* pool = BufferPool::local();
+    pool->trim();
+    {
+        Matrix<> big(1, (size_t(1) << (BufferPool::kMaxClassBits - 3)) + 1);
+    }
+    EXPECT_EQ(pool->stats().cachedBytes, 0u);
+}
+
+TEST(MatrixAllocatorTest, CacheIsBounded) {
+    BufferPool* pool = BufferPool::local();
+    pool->trim();
+    {
+        std::vector<Matrix<>> matrices;
+        for (size_t i = 0; i < 2 * BufferPool::kMaxCachedPerClass; ++i) {
+            matrices.emplace_back(10, 10);
+        }
+    }
+    EXPECT_LE(pool->stats().cachedBytes, BufferPool::kMaxCachedPerClass * 1024);
+    pool->trim();
+}
+
+TEST(MatrixAllocatorTest, ReleasedOnAnotherThread) {
+    Matrix<> A(16, 16, 2.0);
+    std::thread worker([&] {
+        Matrix<> B(std::move(A));
+        EXPECT_EQ(B(15, 15), 2.0);
+        Matrix<> C(16, 16);
+        EXPECT_EQ(C(0, 0), 0.0);
+    });
+    worker.join();
+    EXPECT_EQ(A.rows_size(), 0u);
+}
+
+TEST(MatrixAllocatorTest, AllocatorParameter) {
+    {
+        Matrix<double, ColMajor, CountingAllocator> A = {{1, 2}, {3, 4}};
+        EXPECT_GT(CountingAllocator::live, 0);
+        Matrix<double, ColMajor, CountingAllocator> B = A * A;
+        EXPECT_EQ(B(1, 0), 15.0);
+        EXPECT_DOUBLE_EQ(A.determinant(), -2.0);
+        EXPECT_DOUBLE_EQ(A.inverse()(0, 1), 1.0);
+    }
+    EXPECT_EQ(CountingAllocator::live, 0);
+
+    HeapMatrix H = {{1, 2, 3}, {4, 5, 6}};
+    Matrix<> P(H);
+    EXPECT_EQ(P, Matrix<>({{1, 2, 3}, {4, 5, 6}}));
+    HeapMatrix back(P.transpose());
+    EXPECT_EQ(back.transpose(), H);
+    Matrix<double, ColMajor> C(H);
+    EXPECT_EQ(C(1, 2), 6.0);
+}
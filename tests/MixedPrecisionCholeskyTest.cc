@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "Cholesky.h"
+#include "MixedPrecisionCholesky.h"
+#include "NewtonGaussSolver.h"
+#include "LevenbergMarquardtSolver.h"
+#include "SketchGenerator.h"
+#include "TestHelpers.h"
+
+// J^T J + I for a random tall J, well conditioned
+static Matrix<> normalMatrix(size_t n, unsigned seed) {
+    Matrix<> J = randomMatrix(2 * n, n, seed);
+    Matrix<> A;
+    Matrix<>::syrk(J, A);
+    A.addDiagonal(1.0);
+    return A;
+}
+
+TEST(MixedPrecisionCholeskyTest, RefinesToDoubleAccuracy) {
+    Matrix<> A = normalMatrix(60, 1);
+    Matrix<> b = randomMatrix(60, 1, 2);
+
+    MixedPrecisionCholesky<> mixed(A);
+    ASSERT_TRUE(mixed.isPositiveDefinite());
+    Matrix<> x = mixed.solve(b);
+    EXPECT_FALSE(mixed.usesFallback());
+    EXPECT_GT(mixed.refinementSteps(), 0);
+    EXPECT_LE(mixed.refinementSteps(), MixedPrecisionCholesky<>::kMaxRefinements);
+
+    Matrix<> expected = Cholesky<>(A).solve(b);
+    EXPECT_LT(maxAbsDifference(x, expected), 1e-12);
+}
+
+TEST(MixedPrecisionCholeskyTest, ShiftAndRefactorize) {
+    Matrix<> A = normalMatrix(30, 3);
+    Matrix<> b = randomMatrix(30, 1, 4);
+
+    MixedPrecisionCholesky<> mixed(A, 0.5);
+    Cholesky<> reference(A, 0.5);
+    EXPECT_LT(maxAbsDifference(mixed.solve(b), reference.solve(b)), 1e-12);
+
+    mixed.refactorize(8.0);
+    reference.refactorize(8.0);
+    EXPECT_EQ(mixed.shift(), 8.0);
+    EXPECT_LT(maxAbsDifference(mixed.solve(b), reference.solve(b)), 1e-12);
+}
+
+TEST(MixedPrecisionCholeskyTest, FallsBackForIllConditioned) {
+    // Hilbert matrix, cond ~1e13 is far beyond float
+    const size_t n = 10;
+    Matrix<> H(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            H(i, j) = 1.0 / static_cast<double>(i + j + 1);
+        }
+    }
+    Matrix<> b = randomMatrix(n, 1, 5);
+
+    MixedPrecisionCholesky<> mixed(H);
+    ASSERT_TRUE(mixed.isPositiveDefinite());
+    Matrix<> x = mixed.solve(b);
+    EXPECT_TRUE(mixed.usesFallback());
+    EXPECT_EQ(x, Cholesky<>(H).solve(b));
+}
+
+TEST(MixedPrecisionCholeskyTest, Errors) {
+    MixedPrecisionCholesky<> mixed;
+    EXPECT_THROW(mixed.factorize(Matrix<>(2, 3)), std::invalid_argument);
+    EXPECT_THROW(mixed.factorize(Matrix<>()), std::runtime_error);
+    EXPECT_THROW(mixed.refactorize(1.0), std::runtime_error);
+
+    mixed.factorize(Matrix<>({{1, 2}, {2, 1}}));
+    EXPECT_FALSE(mixed.isPositiveDefinite());
+    EXPECT_THROW(mixed.solve(Matrix<>(2, 1)), std::runtime_error);
+
+    mixed.factorize(Matrix<>({{2, 1}, {1, 2}}));
+    EXPECT_THROW(mixed.solve(Matrix<>({{1, 1}, {1, 1}})), std::invalid_argument);
+}
+
+TEST(MixedPrecisionCholeskyTest, Solvers) {
+    SketchOptions options;
+    options.seed = 3;
+    options.variableCount = 24;
+    options.perturbation = 0.02;
+
+    auto sketch = SketchGenerator(options).generate();
+    auto task = sketch->makeTask();
+    double initialError = task->getError();
+    NewtonGaussSolver newton(100);
+    newton.setFactorization(NewtonGaussSolver::Factorization::MixedPrecision);
+    newton.setTask(task.get());
+    newton.optimize();
+    EXPECT_LT(newton.getCurrentError(), initialError * 1e-6);
+
+    auto lmSketch = SketchGenerator(options).generate();
+    auto lmTask = lmSketch->makeTask();
+    LMSolver lm;
+    lm.setFactorization(LMSolver::Factorization::MixedPrecision);
+    lm.setTask(lmTask.get());
+    lm.optimize();
+    EXPECT_LT(lm.getCurrentError(), initialError * 1e-6);
+}
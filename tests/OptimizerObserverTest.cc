@@ -0,0 +1,179 @@
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "LevenbergMarquardtSolver.h"
+#include "NewtonGaussSolver.h"
+#include "NewtonOptimizer.h"
+#include "GradientOptimizer.h"
+#include "SketchGenerator.h"
+
+class RecordingObserver : public OptimizerObserver {
+public:
+    std::vector<IterationReport> reports;
+    int finishedIterations = -1;
+    bool finishedConverged = false;
+
+    void onIteration(const IterationReport &report) override {
+        reports.push_back(report);
+    }
+
+    void onFinish(int iterations, bool converged) override {
+        finishedIterations = iterations;
+        finishedConverged = converged;
+    }
+};
+
+static std::unique_ptr<Sketch> smallSketch() {
+    SketchOptions options;
+    options.seed = 3;
+    options.variableCount = 24;
+    options.perturbation = 0.02;
+    return SketchGenerator(options).generate();
+}
+
+TEST(OptimizerObserverTest, LevenbergMarquardtReportsEveryStep) {
+    auto sketch = smallSketch();
+    auto task = sketch->makeTask();
+    RecordingObserver observer;
+    LMSolver optimizer(1.0, 2.0, 2.0, 1e-6, 1e-6, 100);
+    optimizer.setObserver(&observer);
+    optimizer.setTask(task.get());
+    optimizer.optimize();
+
+    ASSERT_FALSE(observer.reports.empty());
+    EXPECT_EQ(observer.finishedIterations, (int) observer.reports.size());
+    EXPECT_EQ(observer.finishedConverged, optimizer.isConverged());
+    EXPECT_EQ(observer.reports.back().error, optimizer.getCurrentError());
+
+    double lambda = 1.0;
+    for (size_t i = 0; i < observer.reports.size(); ++i) {
+        const auto &report = observer.reports[i];
+        EXPECT_EQ(report.iteration, static_cast<int>(i));
+        EXPECT_DOUBLE_EQ(report.lambda, lambda);
+        EXPECT_GT(report.gradientNorm, 0.0);
+        EXPECT_GE(report.stepNorm, 0.0);
+        EXPECT_GE(report.assemblyTime, 0.0);
+        EXPECT_GE(report.factorizationTime, 0.0);
+        EXPECT_GE(report.updateTime, 0.0);
+        // A rejected step keeps the error and increases the damping
+        lambda = report.accepted ? lambda / 2.0 : lambda * 2.0;
+        if (i > 0 && !report.accepted) {
+            EXPECT_EQ(report.error, observer.reports[i - 1].error);
+        }
+    }
+}
+
+TEST(OptimizerObserverTest, NewtonGaussReportsUndampedSteps) {
+    auto sketch = smallSketch();
+    auto task = sketch->makeTask();
+    RecordingObserver observer;
+    NewtonGaussSolver optimizer(5);
+    optimizer.setObserver(&observer);
+    optimizer.setTask(task.get());
+    optimizer.optimize();
+
+    ASSERT_FALSE(observer.reports.empty());
+    EXPECT_EQ(observer.finishedIterations, (int) observer.reports.size());
+    EXPECT_LE(observer.reports.size(), 5u);
+    for (const auto &report: observer.reports) {
+        EXPECT_EQ(report.lambda, 0.0);
+        EXPECT_TRUE(report.accepted);
+    }
+    EXPECT_EQ(observer.finishedConverged, optimizer.isConverged());
+}
+
+TEST(OptimizerObserverTest, NewtonOptimizerReportsGradientNorm) {
+    // f(x, y) = (x - 1)^2 + (y + 2)^2
+    double a = 4.0, b = 4.0;
+    Variable *x = new Variable(&a);
+    Variable *y = new Variable(&b);
+    Function *f = new Addition(new Power(new Subtraction(x, new Constant(1.0)), new Constant(2.0)),
+                               new Power(new Addition(y, new Constant(2.0)), new Constant(2.0)));
+    TaskF task(f, {x, y});
+    RecordingObserver observer;
+    NewtonOptimizer optimizer(10);
+    optimizer.setObserver(&observer);
+    optimizer.setTask(&task);
+    optimizer.optimize();
+
+    ASSERT_FALSE(observer.reports.empty());
+    EXPECT_EQ(observer.finishedIterations, (int) observer.reports.size());
+    // |grad| = 2 * |(3, 6)| at the start point
+    EXPECT_NEAR(observer.reports.front().gradientNorm, 2.0 * std::sqrt(45.0), 1e-9);
+    EXPECT_LT(observer.reports.back().error, 1e-6);
+}
+
+TEST(OptimizerObserverTest, NewtonOptimizerReportsNegativeCurvature) {
+    // f(x, y) = x^2 + y^4 / 4 - y^2 has a saddle at y = 0 and minima -1 at y = +-sqrt(2)
+    double a = 1.0, b = 0.1;
+    Variable *x = new Variable(&a);
+    Variable *y = new Variable(&b);
+    Function *f = new Subtraction(
+            new Addition(new Power(x, new Constant(2.0)),
+                         new Division(new Power(y, new Constant(4.0)), new Constant(4.0))),
+            new Power(y, new Constant(2.0)));
+    TaskF task(f, {x, y});
+    RecordingObserver observer;
+    NewtonOptimizer optimizer(50);
+    optimizer.setObserver(&observer);
+    optimizer.setTask(&task);
+    optimizer.optimize();
+
+    ASSERT_FALSE(observer.reports.empty());
+    EXPECT_EQ(observer.finishedIterations, (int) observer.reports.size());
+    EXPECT_EQ(observer.reports.front().negativeCurvature, 1);
+    EXPECT_EQ(observer.reports.back().negativeCurvature, 0);
+    EXPECT_NEAR(optimizer.getCurrentError(), -1.0, 1e-9);
+}
+
+TEST(OptimizerObserverTest, DetachedObserverIsNotCalled) {
+    double a = 0.0;
+    Variable *x = new Variable(&a);
+    Function *f = new Power(new Subtraction(x, new Constant(3.0)), new Constant(2.0));
+    TaskF task(f, {x});
+    RecordingObserver observer;
+    GradientOptimizer optimizer(0.1, 1000);
+    optimizer.setObserver(&observer);
+    optimizer.setObserver(nullptr);
+    optimizer.setTask(&task);
+    optimizer.optimize();
+
+    EXPECT_TRUE(optimizer.isConverged());
+    EXPECT_TRUE(observer.reports.empty());
+    EXPECT_EQ(observer.finishedIterations, -1);
+}
+
+TEST(OptimizerObserverTest, StreamObserverPrintsIterations) {
+    double a = 0.0;
+    Variable *x = new Variable(&a);
+    Function *f = new Power(new Subtraction(x, new Constant(3.0)), new Constant(2.0));
+    TaskF task(f, {x});
+    std::ostringstream out;
+    StreamObserver observer(out);
+    GradientOptimizer optimizer(0.1, 1000);
+    optimizer.setObserver(&observer);
+    optimizer.setTask(&task);
+    optimizer.optimize();
+
+    EXPECT_NE(out.str().find("iteration 0: error"), std::string::npos);
+    EXPECT_NE(out.str().find("converged after"), std::string::npos);
+    EXPECT_EQ(out.str().find("converged after 0 iterations"), std::string::npos);
+}
+
+TEST(OptimizerObserverTest, GradientOptimizerCountsTheConvergedStep) {
+    double a = 0.0;
+    Variable *x = new Variable(&a);
+    Function *f = new Power(new Subtraction(x, new Constant(3.0)), new Constant(2.0));
+    TaskF task(f, {x});
+    RecordingObserver observer;
+    GradientOptimizer optimizer(0.1, 1000);
+    optimizer.setObserver(&observer);
+    optimizer.setTask(&task);
+    optimizer.optimize();
+
+    ASSERT_TRUE(optimizer.isConverged());
+    EXPECT_TRUE(observer.finishedConverged);
+    EXPECT_EQ(observer.finishedIterations, (int) observer.reports.size());
+    EXPECT_EQ(observer.reports.back().iteration + 1, observer.finishedIterations);
+}
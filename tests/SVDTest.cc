@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "SVD.h"
+#include "Cholesky.h"
+#include "LevenbergMarquardtSolver.h"
+#include "SketchGenerator.h"
+#include "TestHelpers.h"
+
+// Q^T Q == I
+static double orthogonalityError(const Matrix<>& Q) {
+    return maxAbsDifference(Q.transpose() * Q, Matrix<>::identity(Q.cols_size()));
+}
+
+static void expectValidDecomposition(const Matrix<>& A, const SVD<>& svd, bool economy) {
+    size_t k = std::min(A.rows_size(), A.cols_size());
+    EXPECT_EQ(svd.U().rows_size(), A.rows_size());
+    EXPECT_EQ(svd.U().cols_size(), economy ? k : A.rows_size());
+    EXPECT_EQ(svd.V().rows_size(), A.cols_size());
+    EXPECT_EQ(svd.V().cols_size(), economy ? k : A.cols_size());
+
+    const auto &s = svd.singularValues();
+    ASSERT_EQ(s.size(), k);
+    for (size_t i = 0; i + 1 < k; ++i) {
+        EXPECT_GE(s[i], s[i + 1]);
+    }
+    EXPECT_GE(s.back(), 0.0);
+    EXPECT_LT(orthogonalityError(svd.U()), 1e-12);
+    EXPECT_LT(orthogonalityError(svd.V()), 1e-12);
+    EXPECT_LT(maxAbsDifference(svd.U() * svd.S() * svd.V().transpose(), A), 1e-12);
+}
+
+struct Shape {
+    size_t rows;
+    size_t cols;
+};
+
+class SVDShapes : public ::testing::TestWithParam<Shape> {};
+
+TEST_P(SVDShapes, GolubKahanEconomy) {
+    Matrix<> A = randomMatrix(GetParam().rows, GetParam().cols, 1);
+    expectValidDecomposition(A, SVD<>(A, true, SVDMethod::GolubKahan), true);
+}
+
+TEST_P(SVDShapes, GolubKahanFull) {
+    Matrix<> A = randomMatrix(GetParam().rows, GetParam().cols, 2);
+    expectValidDecomposition(A, SVD<>(A, false, SVDMethod::GolubKahan), false);
+}
+
+TEST_P(SVDShapes, JacobiEconomy) {
+    Matrix<> A = randomMatrix(GetParam().rows, GetParam().cols, 3);
+    expectValidDecomposition(A, SVD<>(A, true, SVDMethod::Jacobi), true);
+}
+
+INSTANTIATE_TEST_SUITE_P(SVDTest, SVDShapes, ::testing::Values(
+        Shape{1, 1}, Shape{1, 4}, Shape{5, 1}, Shape{6, 6}, Shape{12, 5}, Shape{5, 12}, Shape{40, 30}));
+
+TEST(SVDTest, MethodsAgreeOnSingularValues) {
+    Matrix<> A = randomMatrix(20, 12, 4);
+    SVD<> gk(A, true, SVDMethod::GolubKahan);
+    SVD<> jacobi(A, true, SVDMethod::Jacobi);
+    for (size_t i = 0; i < 12; ++i) {
+        EXPECT_NEAR(gk.singularValues()[i], jacobi.singularValues()[i], 1e-12);
+    }
+}
+
+TEST(SVDTest, KnownSingularValues) {
+    Matrix<> A = {
+            {3, 0},
+            {0, -4},
+            {0, 0}
+    };
+    SVD<> svd(A);
+    EXPECT_NEAR(svd.singularValues()[0], 4.0, 1e-15);
+    EXPECT_NEAR(svd.singularValues()[1], 3.0, 1e-15);
+    EXPECT_NEAR(svd.conditionNumber(), 4.0 / 3.0, 1e-15);
+}
+
+TEST(SVDTest, DetectsRank) {
+    // rank 3 product of 10 x 3 and 3 x 8 factors
+    Matrix<> A = randomMatrix(10, 3, 5) * randomMatrix(3, 8, 6);
+    for (auto method: {SVDMethod::GolubKahan, SVDMethod::Jacobi}) {
+        SVD<> svd(A, true, method);
+        EXPECT_EQ(svd.rank(), 3u);
+        EXPECT_LT(svd.singularValues()[3], svd.tolerance());
+    }
+    EXPECT_EQ(SVD<>(Matrix<>(4, 3)).rank(), 0u);
+}
+
+TEST(SVDTest, MinimumNormSolution) {
+    // x + y = 2 has the minimum norm solution (1, 1)
+    Matrix<> A = {{1, 1}};
+    Matrix<> b = {2};
+    Matrix<> x = SVD<>(A).solve(b);
+    EXPECT_NEAR(x(0, 0), 1.0, 1e-15);
+    EXPECT_NEAR(x(1, 0), 1.0, 1e-15);
+
+    // a rank deficient least squares problem: the solution has no null space part
+    Matrix<> B = randomMatrix(12, 4, 7) * randomMatrix(4, 6, 8);
+    Matrix<> c = randomMatrix(12, 1, 9);
+    SVD<> svd(B);
+    Matrix<> y = svd.solve(c);
+    Matrix<> normal = B.transpose() * (B * y - c);
+    EXPECT_LT(normal.norm(), 1e-12);
+    Matrix<> projector = svd.pseudoInverse() * B;
+    EXPECT_LT(maxAbsDifference(projector * y, y), 1e-12);
+}
+
+TEST(SVDTest, DampedSolveMatchesCholesky) {
+    for (Shape shape: {Shape{15, 6}, Shape{4, 9}}) {
+        Matrix<> J = randomMatrix(shape.rows, shape.cols, 10);
+        Matrix<> g = randomMatrix(shape.cols, 1, 11);
+        Matrix<> hessian = J.transpose() * J;
+        SVD<> svd(J);
+        Cholesky<> chol(hessian);
+        Matrix<> x;
+        for (double lambda: {1e-3, 1.0, 100.0}) {
+            svd.solveDampedInto(g, lambda, x);
+            chol.refactorize(lambda);
+            EXPECT_LT(maxAbsDifference(x, chol.solve(g)), 1e-9) << shape.rows << "x" << shape.cols;
+        }
+    }
+}
+
+TEST(SVDTest, RejectsBadInput) {
+    EXPECT_THROW(SVD<>(Matrix<>()), std::runtime_error);
+    EXPECT_THROW(SVD<>(Matrix<>(3, 2), false, SVDMethod::Jacobi), std::invalid_argument);
+    SVD<> svd(randomMatrix(3, 2, 12));
+    EXPECT_THROW(svd.solve(Matrix<>(2, 1)), std::invalid_argument);
+    Matrix<> g(2, 1);
+    EXPECT_THROW(svd.solveDampedInto(g, 1.0, g), std::invalid_argument);
+}
+
+TEST(SVDTest, LevenbergMarquardtWithSVD) {
+    SketchOptions options;
+    options.seed = 3;
+    options.variableCount = 24;
+    options.perturbation = 0.02;
+    auto sketch = SketchGenerator(options).generate();
+    auto task = sketch->makeTask();
+    double initialError = task->getError();
+
+    LMSolver optimizer;
+    optimizer.setFactorization(LMSolver::Factorization::SVD);
+    optimizer.setTask(task.get());
+    optimizer.optimize();
+    EXPECT_LT(optimizer.getCurrentError(), initialError * 1e-6);
+}
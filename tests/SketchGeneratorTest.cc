@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "SketchGenerator.h"
+#include "LevenbergMarquardtSolver.h"
+
+static double maxResidual(const Sketch &sketch) {
+    double result = 0.0;
+    for (auto constraint: sketch.constraints()) {
+        result = std::max(result, std::abs(constraint->evaluate()));
+    }
+    return result;
+}
+
+TEST(SketchGeneratorTest, ExactVariableCount) {
+    for (size_t n: {4, 5, 7, 10, 33, 100, 1001}) {
+        SketchOptions options;
+        options.variableCount = n;
+        auto sketch = SketchGenerator(options).generate();
+        EXPECT_EQ(sketch->variables().size(), n);
+        EXPECT_EQ(2 * sketch->pointCount() + 3 * sketch->circleCount(), n);
+    }
+}
+
+TEST(SketchGeneratorTest, SameSeedSameSketch) {
+    SketchOptions options;
+    options.seed = 42;
+    options.variableCount = 200;
+    options.redundancy = 0.1;
+    auto first = SketchGenerator(options).generate();
+    auto second = SketchGenerator(options).generate();
+
+    EXPECT_EQ(first->values(), second->values());
+    EXPECT_EQ(first->solution(), second->solution());
+    ASSERT_EQ(first->constraints().size(), second->constraints().size());
+    for (size_t i = 0; i < first->constraints().size(); ++i) {
+        EXPECT_EQ(first->constraints()[i]->evaluate(), second->constraints()[i]->evaluate());
+    }
+
+    options.seed = 43;
+    auto other = SketchGenerator(options).generate();
+    EXPECT_NE(first->values(), other->values());
+}
+
+TEST(SketchGeneratorTest, SolutionSatisfiesConstraints) {
+    SketchOptions options;
+    options.seed = 7;
+    options.variableCount = 500;
+    options.couplingDensity = 1.0;
+    auto sketch = SketchGenerator(options).generate();
+
+    EXPECT_GT(maxResidual(*sketch), 1e-3);
+    sketch->setValues(sketch->solution());
+    EXPECT_LT(maxResidual(*sketch), 1e-9);
+}
+
+TEST(SketchGeneratorTest, CouplingAndRedundancyAddConstraints) {
+    SketchOptions options;
+    options.variableCount = 300;
+    options.couplingDensity = 0.0;
+    size_t base = SketchGenerator(options).generate()->constraints().size();
+
+    options.couplingDensity = 1.0;
+    size_t coupled = SketchGenerator(options).generate()->constraints().size();
+    EXPECT_GT(coupled, base);
+
+    options.redundancy = 0.5;
+    size_t redundant = SketchGenerator(options).generate()->constraints().size();
+    EXPECT_EQ(redundant, coupled + (coupled + 1) / 2);
+}
+
+TEST(SketchGeneratorTest, ScalesToLargeSketches) {
+    SketchOptions options;
+    options.variableCount = 100000;
+    auto sketch = SketchGenerator(options).generate();
+    EXPECT_EQ(sketch->variables().size(), 100000u);
+    sketch->setValues(sketch->solution());
+    EXPECT_LT(maxResidual(*sketch), 1e-9);
+}
+
+TEST(SketchGeneratorTest, InvalidOptions) {
+    SketchOptions options;
+    options.variableCount = 3;
+    EXPECT_THROW(SketchGenerator{options}, std::invalid_argument);
+    options.variableCount = 10;
+    options.redundancy = -1.0;
+    EXPECT_THROW(SketchGenerator{options}, std::invalid_argument);
+}
+
+TEST(SketchGeneratorTest, SolvedByLevenbergMarquardt) {
+    SketchOptions options;
+    options.seed = 3;
+    options.variableCount = 24;
+    options.perturbation = 0.02;
+    auto sketch = SketchGenerator(options).generate();
+    auto task = sketch->makeTask();
+    EXPECT_TRUE(sketch->constraints().empty());
+    EXPECT_THROW(sketch->makeTask(), std::runtime_error);
+
+    double initialError = task->getError();
+    LMSolver optimizer;
+    optimizer.setTask(task.get());
+    optimizer.optimize();
+    EXPECT_LT(optimizer.getCurrentError(), initialError * 1e-6);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "Sparsity.h"
+#include "ErrorFunctions.h"
+#include "LSMTask.h"
+#include "SketchGenerator.h"
+
+TEST(SparsityPatternTest, CompressedRows) {
+    SparsityPattern pattern(4, {{3, 1, 1}, {}, {0, 2}});
+    EXPECT_EQ(pattern.rows(), 3u);
+    EXPECT_EQ(pattern.cols(), 4u);
+    EXPECT_EQ(pattern.nonZeros(), 4u);
+    EXPECT_EQ(std::vector<size_t>(pattern.row(0).begin(), pattern.row(0).end()), (std::vector<size_t>{1, 3}));
+    EXPECT_TRUE(pattern.row(1).empty());
+    EXPECT_TRUE(pattern.contains(2, 2));
+    EXPECT_FALSE(pattern.contains(0, 0));
+    EXPECT_FALSE(pattern.contains(5, 0));
+    EXPECT_DOUBLE_EQ(pattern.density(), 4.0 / 12.0);
+    EXPECT_THROW(SparsityPattern(2, {{2}}), std::out_of_range);
+    EXPECT_EQ(SparsityPattern::dense(2, 3).nonZeros(), 6u);
+}
+
+TEST(SparsityPatternTest, HessianOfSquares) {
+    // f_0(x_0, x_1), f_1(x_1, x_3): x_2 is free, x_0 and x_3 never meet
+    SparsityPattern jacobian(4, {{0, 1}, {1, 3}});
+    SparsityPattern expected(4, {{0, 1}, {0, 1, 3}, {}, {1, 3}});
+    EXPECT_EQ(jacobian.hessianOfSquares(), expected);
+}
+
+TEST(DependencyAnalysisTest, FindsVariablesThroughClonesAndDerivatives) {
+    VariableStore store({1.0, 2.0, 3.0});
+    std::vector<Variable *> x = {store.variable(0), store.variable(1), store.variable(2)};
+    double outside = 4.0;
+    Variable other(&outside);
+
+    // sin(x_2 * other) + x_0 ^ 2
+    Function *f = new Addition(new Sin(new Multiplication(x[2]->clone(), other.clone())),
+                               new Power(x[0]->clone(), new Constant(2.0)));
+    Function *df = f->derivative(x[0]);
+
+    DependencyAnalysis analysis(x);
+    EXPECT_EQ(analysis.dependencies(f), (std::vector<size_t>{0, 2}));
+    // Structural: the chain rule keeps cos(x_2 * other) * 0 in the tree
+    EXPECT_EQ(analysis.dependencies(df), (std::vector<size_t>{0, 2}));
+
+    Constant c(1.0);
+    SparsityPattern pattern = analysis.jacobianPattern({f, &c, x[1]});
+    EXPECT_EQ(pattern, SparsityPattern(3, {{0, 2}, {}, {1}}));
+    delete f;
+    delete df;
+    for (auto var: x) {
+        delete var;
+    }
+}
+
+TEST(DependencyAnalysisTest, LSMTaskSkipsStructuralZeros) {
+    SketchOptions options;
+    options.seed = 2;
+    options.variableCount = 80;
+    auto sketch = SketchGenerator(options).generate();
+    std::vector<size_t> arity;
+    for (auto constraint: sketch->constraints()) {
+        arity.push_back(static_cast<ErrorFunctions *>(constraint)->getVariables().size());
+    }
+    auto task = sketch->makeTask();
+
+    const SparsityPattern &pattern = task->jacobianSparsity();
+    ASSERT_EQ(pattern.rows(), task->residualCount());
+    EXPECT_EQ(pattern.cols(), 80u);
+    for (size_t i = 0; i < pattern.rows(); ++i) {
+        EXPECT_LE(pattern.row(i).size(), arity[i]);
+    }
+    EXPECT_LT(pattern.density(), 0.2);
+
+    Matrix<> jac = task->jacobian();
+    for (size_t i = 0; i < jac.rows_size(); ++i) {
+        for (size_t j = 0; j < jac.cols_size(); ++j) {
+            if (!pattern.contains(i, j)) {
+                EXPECT_EQ(jac(i, j), 0.0);
+            }
+        }
+    }
+}
+
+TEST(DependencyAnalysisTest, LSMTaskHessianPattern) {
+    // Hessian trees are the derivatives of the whole error, keep it small
+    SketchOptions options;
+    options.seed = 4;
+    options.variableCount = 12;
+    auto sketch = SketchGenerator(options).generate();
+    auto task = sketch->makeTask();
+
+    const SparsityPattern &hessianPattern = task->hessianSparsity();
+    EXPECT_LT(hessianPattern.nonZeros(), 12u * 12u);
+    Matrix<> jac = task->jacobian();
+    Matrix<> hessian = task->hessian();
+    Matrix<> normal = jac.transpose() * jac;
+    for (size_t i = 0; i < normal.rows_size(); ++i) {
+        for (size_t j = 0; j < normal.cols_size(); ++j) {
+            if (normal(i, j) != 0.0) {
+                EXPECT_TRUE(hessianPattern.contains(i, j));
+            }
+            if (!hessianPattern.contains(i, j)) {
+                EXPECT_EQ(hessian(i, j), 0.0);
+            }
+        }
+    }
+}
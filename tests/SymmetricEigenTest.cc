@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "SymmetricEigen.h"
+#include "TestHelpers.h"
+
+static Matrix<> diagonal(const std::vector<double>& d) {
+    Matrix<> D(d.size(), d.size());
+    for (size_t i = 0; i < d.size(); ++i) {
+        D(i, i) = d[i];
+    }
+    return D;
+}
+
+TEST(SymmetricEigenTest, KnownSpectrum) {
+    Matrix<> A = {
+            {2, -1, 0},
+            {-1, 2, -1},
+            {0, -1, 2}
+    };
+    SymmetricEigen<> eigen(A);
+    // 2 - sqrt(2), 2, 2 + sqrt(2)
+    EXPECT_NEAR(eigen.eigenvalues()[0], 2.0 - std::sqrt(2.0), 1e-14);
+    EXPECT_NEAR(eigen.eigenvalues()[1], 2.0, 1e-14);
+    EXPECT_NEAR(eigen.eigenvalues()[2], 2.0 + std::sqrt(2.0), 1e-14);
+    EXPECT_EQ(eigen.negativeCount(), 0u);
+}
+
+TEST(SymmetricEigenTest, ReconstructsRandomMatrices) {
+    for (size_t n: {1, 2, 3, 10, 57}) {
+        Matrix<> A = randomSymmetric(n, static_cast<unsigned>(n));
+        SymmetricEigen<> eigen(A);
+        const Matrix<> &V = eigen.eigenvectors();
+        const auto &w = eigen.eigenvalues();
+
+        EXPECT_TRUE(std::is_sorted(w.begin(), w.end()));
+        EXPECT_LT(maxAbsDifference(V.transpose() * V, Matrix<>::identity(n)), 1e-12) << n;
+        EXPECT_LT(maxAbsDifference(V * diagonal(w) * V.transpose(), A), 1e-12) << n;
+    }
+}
+
+TEST(SymmetricEigenTest, EigenvaluesOnlyMatch) {
+    Matrix<> A = randomSymmetric(20, 7);
+    SymmetricEigen<> full(A);
+    SymmetricEigen<> valuesOnly(A, false);
+    for (size_t i = 0; i < 20; ++i) {
+        EXPECT_NEAR(full.eigenvalues()[i], valuesOnly.eigenvalues()[i], 1e-12);
+    }
+    EXPECT_THROW(valuesOnly.eigenvectors(), std::runtime_error);
+}
+
+TEST(SymmetricEigenTest, ReadsLowerTriangleOnly) {
+    Matrix<> A = {
+            {1, 100},
+            {2, 1}
+    };
+    SymmetricEigen<> eigen(A);
+    EXPECT_NEAR(eigen.eigenvalues()[0], -1.0, 1e-14);
+    EXPECT_NEAR(eigen.eigenvalues()[1], 3.0, 1e-14);
+    EXPECT_EQ(eigen.negativeCount(), 1u);
+}
+
+TEST(SymmetricEigenTest, ModifiedSolveFlipsNegativeCurvature) {
+    // saddle: eigenvalues 4 and -2
+    Matrix<> H = {
+            {4, 0},
+            {0, -2}
+    };
+    SymmetricEigen<> eigen(H);
+    Matrix<> g = Matrix<>({8.0, 4.0}).transpose();
+    Matrix<> x;
+    eigen.solveModifiedInto(g, x, 1e-8);
+    EXPECT_NEAR(x(0, 0), 2.0, 1e-14);
+    // |-2| instead of -2, the step still descends
+    EXPECT_NEAR(x(1, 0), 2.0, 1e-14);
+
+    // a tiny eigenvalue is raised to the floor
+    Matrix<> S = {
+            {1e-12, 0},
+            {0, 1}
+    };
+    eigen.compute(S);
+    eigen.solveModifiedInto(Matrix<>({1.0, 1.0}).transpose(), x, 1e-4);
+    EXPECT_NEAR(x(0, 0), 1e4, 1e-8);
+    EXPECT_NEAR(x(1, 0), 1.0, 1e-14);
+}
+
+TEST(SymmetricEigenTest, RejectsBadInput) {
+    EXPECT_THROW(SymmetricEigen<>(Matrix<>(2, 3)), std::invalid_argument);
+    EXPECT_THROW(SymmetricEigen<>(Matrix<>()), std::runtime_error);
+    SymmetricEigen<> eigen(Matrix<>::identity(2));
+    Matrix<> x;
+    EXPECT_THROW(eigen.solveModifiedInto(Matrix<>(3, 1), x, 1.0), std::invalid_argument);
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "TSQR.h"
+#include "Cholesky.h"
+#include "NewtonGaussSolver.h"
+#include "SketchGenerator.h"
+#include "TestHelpers.h"
+
+static void expectUpperTriangular(const Matrix<>& R) {
+    for (size_t i = 0; i < R.rows_size(); ++i) {
+        EXPECT_GE(R(i, i), 0.0);
+        for (size_t j = 0; j < i; ++j) {
+            EXPECT_EQ(R(i, j), 0.0);
+        }
+    }
+}
+
+// Block sizes from a single block to an odd count that passes nodes up the tree
+class TSQRBlocksTest : public ::testing::TestWithParam<size_t> {};
+
+TEST_P(TSQRBlocksTest, FactorsAreValid) {
+    Matrix<> A = randomMatrix(103, 7, 11);
+    TSQR<> tsqr;
+    tsqr.setBlockRows(GetParam());
+    tsqr.factorize(A, true);
+
+    const Matrix<> &Q = tsqr.Q();
+    const Matrix<> &R = tsqr.R();
+    ASSERT_EQ(Q.rows_size(), 103u);
+    ASSERT_EQ(Q.cols_size(), 7u);
+    ASSERT_EQ(R.rows_size(), 7u);
+    expectUpperTriangular(R);
+    EXPECT_LT(maxAbsDifference(Q.transpose() * Q, Matrix<>::identity(7)), 1e-13);
+    EXPECT_LT(maxAbsDifference(Q * R, A), 1e-13);
+
+    // R is the transposed Cholesky factor of A^T A
+    Cholesky<> cholesky(A.transpose() * A);
+    EXPECT_LT(maxAbsDifference(R, cholesky.L().transpose()), 1e-12);
+}
+
+INSTANTIATE_TEST_SUITE_P(BlockRows, TSQRBlocksTest, ::testing::Values(0, 7, 10, 20, 34));
+
+TEST(TSQRTest, BlockCount) {
+    TSQR<> tsqr;
+    tsqr.setBlockRows(10);
+    tsqr.factorize(randomMatrix(103, 7, 1));
+    // the last block takes the remaining 3 rows
+    EXPECT_EQ(tsqr.blockCount(), 10u);
+    tsqr.setBlockRows(0);
+    tsqr.factorize(randomMatrix(103, 7, 1));
+    EXPECT_EQ(tsqr.blockCount(), 1u);
+}
+
+TEST(TSQRTest, ROnlyMode) {
+    Matrix<> A = randomMatrix(300, 10, 2);
+    TSQR<> full(A, true);
+    TSQR<> rOnly;
+    rOnly.setBlockRows(40);
+    rOnly.factorize(A);
+    EXPECT_LT(maxAbsDifference(rOnly.R(), full.R()), 1e-12);
+    EXPECT_THROW(rOnly.Q(), std::runtime_error);
+    EXPECT_THROW(rOnly.solve(randomMatrix(300, 1, 3)), std::runtime_error);
+}
+
+TEST(TSQRTest, SolvesNormalEquationsAndLeastSquares) {
+    Matrix<> J = randomMatrix(500, 12, 4);
+    Matrix<> r = randomMatrix(500, 1, 5);
+    Matrix<> g;
+    Matrix<>::gemv_t(J, r, g);
+
+    TSQR<> tsqr;
+    tsqr.setBlockRows(48);
+    tsqr.factorize(J, true);
+    ASSERT_TRUE(tsqr.isFullRank());
+
+    Matrix<> expected = Cholesky<>(J.transpose() * J).solve(g);
+    Matrix<> x;
+    tsqr.solveNormalInto(g, x);
+    EXPECT_LT(maxAbsDifference(x, expected), 1e-12);
+    EXPECT_LT(maxAbsDifference(tsqr.solve(r), expected), 1e-12);
+
+    // in place
+    tsqr.solveNormalInto(g, g);
+    EXPECT_LT(maxAbsDifference(g, expected), 1e-12);
+}
+
+TEST(TSQRTest, AugmentedLeastSquaresKeepsAccuracy) {
+    // cond(J) ~ 1e7: the normal equations lose about 14 digits, QR about 7
+    size_t m = 400;
+    size_t n = 6;
+    Matrix<> J = randomMatrix(m, n, 11);
+    Matrix<> noise = randomMatrix(m, 1, 12);
+    for (size_t i = 0; i < m; ++i) {
+        J(i, n - 1) = J(i, 0) + 1e-7 * noise(i, 0);
+    }
+    Matrix<> expected = randomMatrix(n, 1, 13);
+    Matrix<> r = J * expected;
+
+    Matrix<> augmented(m, n + 1);
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            augmented(i, j) = J(i, j);
+        }
+        augmented(i, n) = r(i, 0);
+    }
+    TSQR<> tsqr;
+    tsqr.setBlockRows(64);
+    tsqr.factorize(augmented);
+    // r is in the range of J, the last column adds a zero pivot
+    EXPECT_FALSE(tsqr.isFullRank());
+    ASSERT_TRUE(tsqr.isFullRank(n));
+
+    Matrix<> x;
+    tsqr.solveAugmentedInto(n, x);
+    EXPECT_LT(maxAbsDifference(x, expected), 1e-6);
+
+    Matrix<> g;
+    Matrix<>::gemv_t(J, r, g);
+    tsqr.factorize(J);
+    Matrix<> normal;
+    tsqr.solveNormalInto(g, normal);
+    EXPECT_GT(maxAbsDifference(normal, expected), 100.0 * maxAbsDifference(x, expected));
+
+    EXPECT_THROW(tsqr.solveAugmentedInto(n, x), std::invalid_argument);
+}
+
+TEST(TSQRTest, DetectsRankDeficiency) {
+    Matrix<> A = randomMatrix(60, 4, 6);
+    for (size_t i = 0; i < 60; ++i) {
+        A(i, 3) = A(i, 0) + 2.0 * A(i, 1);
+    }
+    TSQR<> tsqr;
+    tsqr.setBlockRows(8);
+    tsqr.factorize(A);
+    EXPECT_FALSE(tsqr.isFullRank());
+    Matrix<> x;
+    EXPECT_THROW(tsqr.solveNormalInto(Matrix<>(4, 1), x), std::runtime_error);
+}
+
+TEST(TSQRTest, RejectsBadInput) {
+    TSQR<> tsqr;
+    EXPECT_THROW(tsqr.factorize(Matrix<>(3, 4)), std::invalid_argument);
+    EXPECT_THROW(tsqr.factorize(Matrix<>()), std::runtime_error);
+    tsqr.factorize(randomMatrix(10, 3, 7));
+    Matrix<> x;
+    EXPECT_THROW(tsqr.solveNormalInto(Matrix<>(4, 1), x), std::invalid_argument);
+}
+
+TEST(TSQRTest, ParallelBlocksMatchSerial) {
+    Matrix<> A = randomMatrix(2000, 16, 8);
+    size_t previous = ThreadPool::shared().threadCount();
+    ThreadPool::shared().setThreadCount(1);
+    TSQR<> serial;
+    serial.setBlockRows(100);
+    serial.factorize(A, true);
+    ThreadPool::shared().setThreadCount(4);
+    TSQR<> parallel;
+    parallel.setBlockRows(100);
+    parallel.factorize(A, true);
+    ThreadPool::shared().setThreadCount(previous);
+
+    EXPECT_EQ(parallel.R(), serial.R());
+    EXPECT_EQ(parallel.Q(), serial.Q());
+}
+
+TEST(TSQRTest, NewtonGaussWithQR) {
+    SketchOptions options;
+    options.seed = 3;
+    options.variableCount = 24;
+    options.perturbation = 0.02;
+    auto sketch = SketchGenerator(options).generate();
+    auto task = sketch->makeTask();
+    double initialError = task->getError();
+
+    NewtonGaussSolver optimizer(100);
+    optimizer.setFactorization(NewtonGaussSolver::Factorization::QR);
+    optimizer.setTask(task.get());
+    optimizer.optimize();
+    EXPECT_LT(optimizer.getCurrentError(), initialError * 1e-6);
+}
@@ -0,0 +1,55 @@
+#ifndef MINIMIZEROPTIMIZER_TESTS_TESTHELPERS_H_
+#define MINIMIZEROPTIMIZER_TESTS_TESTHELPERS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+
+// Matrices and comparisons shared by the decomposition and solver tests.
+// The random matrices are seeded, a failure reproduces on every run.
+
+// Entries uniform in [-1, 1]
+inline Matrix<> randomMatrix(size_t rows, size_t cols, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix<> A(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            A(i, j) = dist(gen);
+        }
+    }
+    return A;
+}
+
+// Lower triangle uniform in [-1, 1], mirrored
+inline Matrix<> randomSymmetric(size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix<> A(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            A(i, j) = dist(gen);
+            A(j, i) = A(i, j);
+        }
+    }
+    return A;
+}
+
+// max |a_ij - b_ij|, the shapes are expected to match
+inline double maxAbsDifference(const Matrix<>& A, const Matrix<>& B) {
+    EXPECT_EQ(A.rows_size(), B.rows_size());
+    EXPECT_EQ(A.cols_size(), B.cols_size());
+    double diff = 0.0;
+    for (size_t i = 0; i < A.rows_size(); ++i) {
+        for (size_t j = 0; j < A.cols_size(); ++j) {
+            diff = std::max(diff, std::abs(A(i, j) - B(i, j)));
+        }
+    }
+    return diff;
+}
+
+#endif // ! MINIMIZEROPTIMIZER_TESTS_TESTHELPERS_H_
@@ -2,6 +2,7 @@
 #include <initializer_list>
 
 #include "Matrix.h"
+#include "TestHelpers.h"
 
 // default constructor
 TEST(MatrixTests, defaultConstructor) {
@@ -1203,3 +1204,258 @@ TEST(MatrixTests, traceMatrix) {
     EXPECT_EQ(d2, 107);
 }
 
+
+// in-place operations
+TEST(MatrixTests, resizeKeepsOrZeroFills) {
+    Matrix<> A = {{1, 2}, {3, 4}};
+    A.resize(2, 2);
+    EXPECT_EQ(A, Matrix<>({{1, 2}, {3, 4}}));
+    A.resize(3, 1);
+    EXPECT_EQ(A, Matrix<>(3, 1));
+}
+
+TEST(MatrixTests, assignmentReusesSameShape) {
+    Matrix<> A = {{1, 2}, {3, 4}};
+    Matrix<> B = {{5, 6}, {7, 8}};
+    const double *buffer = &A(0, 0);
+    A = B;
+    EXPECT_EQ(&A(0, 0), buffer);
+    EXPECT_EQ(A, B);
+}
+
+TEST(MatrixTests, addDiagonal) {
+    Matrix<> A = {{1, 2, 3}, {4, 5, 6}};
+    A.addDiagonal(10);
+    EXPECT_EQ(A, Matrix<>({{11, 2, 3}, {4, 15, 6}}));
+}
+
+TEST(MatrixTests, multiplyInto) {
+    Matrix<> A = {{1, 2, 3}, {4, 5, 6}};
+    Matrix<> B = {{7, 8}, {9, 10}, {11, 12}};
+    Matrix<> C(2, 2, 100.0);
+    Matrix<>::multiplyInto(A, B, C);
+    EXPECT_EQ(C, A * B);
+    EXPECT_THROW(Matrix<>::multiplyInto(A, A, C), std::invalid_argument);
+    EXPECT_THROW(Matrix<>::multiplyInto(C, C, C), std::invalid_argument);
+}
+
+TEST(MatrixTests, gemv) {
+    Matrix<> A = {{1, 2, 3}, {4, 5, 6}};
+    Matrix<> x = Matrix<>({1, 0, -1}).transpose();
+    Matrix<> y;
+    Matrix<>::gemv(A, x, y);
+    EXPECT_EQ(y, Matrix<>({-2, -2}).transpose());
+    Matrix<>::gemv(A, x, y, 2.0, 1.0);
+    EXPECT_EQ(y, Matrix<>({-6, -6}).transpose());
+    EXPECT_THROW(Matrix<>::gemv(A, y, y), std::invalid_argument);
+}
+
+TEST(MatrixTests, transposeInto) {
+    Matrix<> A = {{1, 2, 3}, {4, 5, 6}};
+    Matrix<> At;
+    Matrix<>::transposeInto(A, At);
+    EXPECT_EQ(At, A.transpose());
+}
+
+TEST(MatrixTests, gemm_tn) {
+    Matrix<> A = {{1, 2}, {0, 4}, {5, 0}};
+    Matrix<> B = {{7, 8, 9}, {10, 11, 12}, {13, 14, 15}};
+    Matrix<> C(2, 3, 100.0);
+    Matrix<>::gemm_tn(A, B, C);
+    EXPECT_EQ(C, A.transpose() * B);
+    EXPECT_THROW(Matrix<>::gemm_tn(A, Matrix<>(2, 2), C), std::invalid_argument);
+    EXPECT_THROW(Matrix<>::gemm_tn(C, A, C), std::invalid_argument);
+}
+
+TEST(MatrixTests, syrk) {
+    Matrix<> A = {{1, 2, 3}, {0, 5, 6}, {7, 0, 9}, {-1, 1, 0}};
+    Matrix<> C(3, 3, 100.0);
+    Matrix<>::syrk(A, C);
+    EXPECT_EQ(C, A.transpose() * A);
+
+    Matrix<> J = Matrix<>::random(40, 13, -1.0, 1.0);
+    Matrix<>::syrk(J, C);
+    Matrix<> expected = J.transpose() * J;
+    for (size_t i = 0; i < 13; ++i) {
+        for (size_t j = 0; j < 13; ++j) {
+            EXPECT_NEAR(C(i, j), expected(i, j), 1e-12);
+            EXPECT_EQ(C(i, j), C(j, i));
+        }
+    }
+    EXPECT_THROW(Matrix<>::syrk(C, C), std::invalid_argument);
+}
+
+TEST(MatrixTests, gemv_t) {
+    Matrix<> A = {{1, 2, 3}, {4, 5, 6}};
+    Matrix<> x = Matrix<>({1, -1}).transpose();
+    Matrix<> y;
+    Matrix<>::gemv_t(A, x, y);
+    EXPECT_EQ(y, Matrix<>({-3, -3, -3}).transpose());
+    Matrix<>::gemv_t(A, x, y, 2.0, 1.0);
+    EXPECT_EQ(y, Matrix<>({-9, -9, -9}).transpose());
+    EXPECT_THROW(Matrix<>::gemv_t(A, y, y), std::invalid_argument);
+    EXPECT_THROW(Matrix<>::gemv_t(A, A.transpose(), y), std::invalid_argument);
+}
+
+using ColMatrix = Matrix<double, ColMajor>;
+
+TEST(MatrixTests, colMajorStorage) {
+    ColMatrix A = {{1, 2, 3}, {4, 5, 6}};
+    EXPECT_FALSE(ColMatrix::isRowMajor);
+    EXPECT_EQ(A.rows_size(), 2);
+    EXPECT_EQ(A.cols_size(), 3);
+    EXPECT_EQ(A(1, 2), 6);
+    const double expected[] = {1, 4, 2, 5, 3, 6};
+    EXPECT_TRUE(std::equal(expected, expected + 6, A.data()));
+    EXPECT_EQ(A.colData(1)[1], 5);
+    EXPECT_EQ(A.getCol(2), std::vector<double>({3, 6}));
+    EXPECT_THROW(A(2, 0), std::out_of_range);
+}
+
+TEST(MatrixTests, layoutConversion) {
+    Matrix<> A = {{1, 2, 3}, {4, 5, 6}};
+    ColMatrix C(A);
+    EXPECT_EQ(C, ColMatrix({{1, 2, 3}, {4, 5, 6}}));
+    Matrix<> back;
+    back = C;
+    EXPECT_EQ(back, A);
+    // Same shape reuses the buffer
+    const double* buffer = back.data();
+    back = C;
+    EXPECT_EQ(back.data(), buffer);
+}
+
+TEST(MatrixTests, colMajorOperators) {
+    ColMatrix A = {{1, 2}, {3, 4}};
+    ColMatrix B = {{5, 6}, {7, 8}};
+    EXPECT_EQ(A + B, ColMatrix({{6, 8}, {10, 12}}));
+    EXPECT_EQ(B - A, ColMatrix({{4, 4}, {4, 4}}));
+    EXPECT_EQ(A * B, ColMatrix({{19, 22}, {43, 50}}));
+    EXPECT_EQ(A * 2.0, ColMatrix({{2, 4}, {6, 8}}));
+    EXPECT_EQ(A.transpose(), ColMatrix({{1, 3}, {2, 4}}));
+    EXPECT_DOUBLE_EQ(A.determinant(), -2.0);
+    EXPECT_LT(maxAbsDifference(Matrix<>(A * A.inverse()), Matrix<>::identity(2)), 1e-15);
+}
+
+TEST(MatrixTests, colMajorKernelsMatchRowMajor) {
+    Matrix<> A = Matrix<>::random(37, 23, -1.0, 1.0);
+    Matrix<> B = Matrix<>::random(23, 41, -1.0, 1.0);
+    Matrix<> x = Matrix<>::random(23, 1, -1.0, 1.0);
+    Matrix<> r = Matrix<>::random(37, 1, -1.0, 1.0);
+    ColMatrix Ac(A), Bc(B), xc(x), rc(r), C;
+
+    ColMatrix::multiplyInto(Ac, Bc, C);
+    EXPECT_LT(maxAbsDifference(Matrix<>(C), A * B), 1e-13);
+    ColMatrix::gemm_tn(Ac, Ac, C);
+    EXPECT_LT(maxAbsDifference(Matrix<>(C), A.transpose() * A), 1e-13);
+    ColMatrix::syrk(Ac, C);
+    EXPECT_LT(maxAbsDifference(Matrix<>(C), A.transpose() * A), 1e-13);
+    ColMatrix::gemv(Ac, xc, C);
+    EXPECT_LT(maxAbsDifference(Matrix<>(C), A * x), 1e-13);
+    ColMatrix::gemv_t(Ac, rc, C, 2.0);
+    EXPECT_LT(maxAbsDifference(Matrix<>(C), A.transpose() * r * 2.0), 1e-13);
+}
+
+TEST(MatrixTests, mixedLayoutProducts) {
+    Matrix<> A = Matrix<>::random(19, 11, -1.0, 1.0);
+    Matrix<> B = Matrix<>::random(11, 7, -1.0, 1.0);
+    Matrix<> expected = A * B;
+    Matrix<> rowResult = A * ColMatrix(B);
+    EXPECT_LT(maxAbsDifference(rowResult, expected), 1e-13);
+    ColMatrix colResult = ColMatrix(A) * B;
+    EXPECT_LT(maxAbsDifference(Matrix<>(colResult), expected), 1e-13);
+    EXPECT_THROW(A * ColMatrix(A), std::invalid_argument);
+}
+
+TEST(MatrixTests, rvalueOperatorsReuseBuffers) {
+    Matrix<> A = {{1, 2}, {3, 4}};
+    Matrix<> B = {{5, 6}, {7, 8}};
+
+    Matrix<> sum = A;
+    const double *buffer = sum.data();
+    sum = std::move(sum) + B;
+    EXPECT_EQ(sum.data(), buffer);
+    EXPECT_EQ(sum, Matrix<>({{6, 8}, {10, 12}}));
+
+    Matrix<> right = B;
+    buffer = right.data();
+    Matrix<> difference = A - std::move(right);
+    EXPECT_EQ(difference.data(), buffer);
+    EXPECT_EQ(difference, Matrix<>({{-4, -4}, {-4, -4}}));
+
+    Matrix<> scaled = (A * B) * 2.0 - 1.0;
+    EXPECT_EQ(scaled, Matrix<>({{37, 43}, {85, 99}}));
+    EXPECT_EQ((A + B) / 2.0 + A - (B - A), Matrix<>({{0, 2}, {4, 6}}));
+    EXPECT_EQ(A + (B + B), Matrix<>({{11, 14}, {17, 20}}));
+    EXPECT_THROW(Matrix<>(A) / 0.0, std::runtime_error);
+    EXPECT_THROW(Matrix<>(A) + Matrix<>(3, 1), std::invalid_argument);
+    EXPECT_THROW(A - Matrix<>(3, 1), std::invalid_argument);
+
+    // Operands are untouched by the const& overloads
+    EXPECT_EQ(A, Matrix<>({{1, 2}, {3, 4}}));
+    EXPECT_EQ(B, Matrix<>({{5, 6}, {7, 8}}));
+}
+
+#ifdef MATH_ALLOCATION_TRACKING
+
+TEST(MatrixTests, chainedExpressionsAllocateOnce) {
+    Matrix<> A = {{1, 2}, {3, 4}};
+    Matrix<> x(2, 1, 1.0);
+    Matrix<> b(2, 1, 2.0);
+    instrumentation::AllocationScope scope;
+    Matrix<> r = A * x * 2.0 - b + b / 2.0;
+    EXPECT_EQ(r(0, 0), 5.0);
+    EXPECT_EQ(r(1, 0), 13.0);
+    // The product, and the copy b / 2.0
+    EXPECT_EQ(scope.total().allocations, 2);
+    A *= A;
+    EXPECT_EQ(scope.total().allocations, 3);
+}
+
+#endif // MATH_ALLOCATION_TRACKING
+
+TEST(MatrixTests, adjugateMatchesCofactors) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix<> A(6, 6);
+    for (size_t i = 0; i < 6; ++i) {
+        for (size_t j = 0; j < 6; ++j) {
+            A(i, j) = dist(gen);
+        }
+    }
+    Matrix<> adj = A.adjugate();
+    Matrix<> M = Matrix<>::minors(A);
+    for (size_t i = 0; i < 6; ++i) {
+        for (size_t j = 0; j < 6; ++j) {
+            double cofactor = ((i + j) % 2 == 0 ? 1.0 : -1.0) * A.minor(i, j);
+            EXPECT_NEAR(adj(j, i), cofactor, 1e-13);
+            EXPECT_NEAR(M(i, j), A.minor(i, j), 1e-13);
+        }
+    }
+    Matrix<> I = A * adj / A.determinant();
+    EXPECT_LT(maxAbsDifference(I, Matrix<>::identity(6)), 1e-13);
+
+    EXPECT_EQ(Matrix<>(1, 1, 5.0).adjugate(), Matrix<>(1, 1, 1.0));
+    EXPECT_THROW(Matrix<>(2, 3).adjugate(), std::invalid_argument);
+    EXPECT_THROW(Matrix<>().adjugate(), std::runtime_error);
+}
+
+TEST(MatrixTests, adjugateOfSingularMatrices) {
+    // Rank 2, adj(A) is the rank one cofactor matrix
+    Matrix<int> A = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+    EXPECT_EQ(A.adjugate(), Matrix<int>({{-3, 6, -3}, {6, -12, 6}, {-3, 6, -3}}));
+    EXPECT_EQ(A.minors(), Matrix<int>({{-3, -6, -3}, {-6, -12, -6}, {-3, -6, -3}}));
+
+    Matrix<> B = {{2, -1, 0}, {4, -2, 0}, {1, 3, 5}};
+    Matrix<> adjB = B.adjugate();
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            double cofactor = ((i + j) % 2 == 0 ? 1.0 : -1.0) * B.minor(j, i);
+            EXPECT_NEAR(adjB(i, j), cofactor, 1e-13);
+        }
+    }
+
+    // Rank 1, every 2 x 2 minor vanishes
+    Matrix<> C = {{1, 2, 3}, {2, 4, 6}, {-1, -2, -3}};
+    EXPECT_LT(maxAbsDifference(C.adjugate(), Matrix<>(3, 3)), 1e-14);
+}
@@ -1,7 +1,10 @@
+#include <limits>
+
 #include <gtest/gtest.h>
 
 #include "Matrix.h"
 #include "QR.h"
+#include "TestHelpers.h"
 
 TEST(defaultStructureQRClass, matrixConstructor) {
     Matrix<> A = {
@@ -1547,3 +1550,168 @@ TEST(QR_RGS, qrRGS_part4) {
         }
     }
 }
+
+// QR_TSQR
+
+TEST(QR_TSQR, qrTSQR_part1) {
+    Matrix<> A = {
+            {1, 2},
+            {3, 4},
+            {5, 6}
+    };
+    QR qr(A);
+    qr.qrTSQR();
+
+    // VolframAlpha result
+    Matrix<> Q = {
+            { 0.169031, 0.897085},
+            { 0.507093, 0.276026},
+            { 0.845154, -0.345033}
+    };
+
+    double eps = 1e-5;
+
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            EXPECT_TRUE(qr.Q()(i, j) > Q(i, j) - eps && qr.Q()(i, j) < Q(i, j) + eps);
+        }
+    }
+
+    // VolframAlpha result
+    Matrix<> R = {
+            { 5.91608, 7.43736},
+            { 0.0, 0.828079}
+    };
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            EXPECT_TRUE(qr.R()(i, j) > R(i, j) - eps && qr.R()(i, j) < R(i, j) + eps);
+        }
+    }
+}
+
+TEST(QR_CGS2, qrCGS2_reconstructsAndIsOrthogonal) {
+    size_t m = 200;
+    size_t n = 30;
+    Matrix<> A = randomMatrix(m, n, 11);
+    QR qr(A);
+    qr.qrCGS2();
+    Matrix<> Q = qr.Q();
+    Matrix<> R = qr.R();
+    // Backward stable: errors of n eps, relative to A for the product
+    double tolerance = 10.0 * static_cast<double>(n) * std::numeric_limits<double>::epsilon();
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_GT(R(i, i), 0.0);
+        for (size_t j = 0; j < i; ++j) {
+            EXPECT_EQ(R(i, j), 0.0);
+        }
+    }
+    EXPECT_LT(maxAbsDifference(Q.transpose() * Q, Matrix<>::identity(n)), tolerance);
+    EXPECT_LT(maxAbsDifference(Q * R, A), tolerance * A.norm());
+}
+
+TEST(QR_CGS2, qrCGS2_orthogonalWhereMGSIsNot) {
+    // Columns with singular values from 1 down to 1e-8, above the threshold
+    // that zeroes a column
+    size_t m = 80;
+    size_t n = 12;
+    Matrix<> U = randomMatrix(m, n, 1);
+    QR basis(U);
+    basis.qrCGS2();
+    Matrix<> A = basis.Q();
+    for (size_t j = 0; j < n; ++j) {
+        double scale = std::pow(10.0, -8.0 * j / (n - 1));
+        for (size_t i = 0; i < m; ++i) {
+            A(i, j) *= scale;
+        }
+    }
+    // mix the columns, so the small ones are not already orthogonal
+    A = A * randomMatrix(n, n, 2);
+
+    auto orthogonalityError = [n](const Matrix<> &Q) {
+        Matrix<> QtQ = Q.transpose() * Q;
+        double error = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                error = std::max(error, std::abs(QtQ(i, j) - (i == j ? 1.0 : 0.0)));
+            }
+        }
+        return error;
+    };
+    QR cgs2(A);
+    cgs2.qrCGS2();
+    QR mgs(A);
+    mgs.qrMGS();
+    EXPECT_LT(orthogonalityError(cgs2.Q()), 1e-13);
+    EXPECT_LT(orthogonalityError(cgs2.Q()), orthogonalityError(mgs.Q()));
+}
+
+TEST(QR_CGS2, qrCGS2_rankDeficientColumnStaysZero) {
+    Matrix<> A = {
+            {1, 2, 3},
+            {4, 8, 5},
+            {7, 14, 6},
+            {1, 2, 0}
+    };
+    QR qr(A);
+    qr.qrCGS2();
+    EXPECT_EQ(qr.R()(1, 1), 0.0);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(qr.Q()(i, 1), 0.0);
+    }
+    Matrix<> QR_ = qr.Q() * qr.R();
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(QR_(i, j), A(i, j), 1e-12);
+        }
+    }
+}
+
+TEST(QR_Givens, qrGivens_part1) {
+    Matrix<> A = {{2, -1, 0}, {1, 3, 1}, {0, 1, 4}, {1, 0, 1}, {3, 2, -2}};
+    QR qr(A);
+    qr.qrGivens();
+    Matrix<> Q = qr.Q();
+    Matrix<> R = qr.R();
+    ASSERT_EQ(Q.rows_size(), 5u);
+    ASSERT_EQ(Q.cols_size(), 3u);
+    ASSERT_EQ(R.rows_size(), 3u);
+    Matrix<> QtQ = Q.transpose() * Q;
+    Matrix<> QR_ = Q * R;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            EXPECT_EQ(R(i, j), 0.0);
+        }
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(QtQ(i, j), i == j ? 1.0 : 0.0, 1e-14);
+        }
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(QR_(i, j), A(i, j), 1e-13);
+        }
+    }
+}
+
+TEST(QR_Givens, qrGivens_tallIsThin) {
+    size_t m = 300;
+    size_t n = 8;
+    Matrix<> A = randomMatrix(m, n, 5);
+    QR qr(A);
+    qr.qrGivens();
+    Matrix<> Q = qr.Q();
+    ASSERT_EQ(Q.rows_size(), m);
+    ASSERT_EQ(Q.cols_size(), n);
+    Matrix<> QtQ = Q.transpose() * Q;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            EXPECT_NEAR(QtQ(i, j), i == j ? 1.0 : 0.0, 1e-13);
+        }
+    }
+    Matrix<> QR_ = Q * qr.R();
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            EXPECT_NEAR(QR_(i, j), A(i, j), 1e-13);
+        }
+    }
+}
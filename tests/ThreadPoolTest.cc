@@ -0,0 +1,132 @@
+#include <atomic>
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "ThreadPool.h"
+#include "TestHelpers.h"
+
+// Runs the shared pool with a given thread count for one test
+class SharedPoolThreads {
+    size_t m_previous;
+
+public:
+    explicit SharedPoolThreads(size_t threads) : m_previous(ThreadPool::shared().threadCount()) {
+        ThreadPool::shared().setThreadCount(threads);
+    }
+
+    ~SharedPoolThreads() { ThreadPool::shared().setThreadCount(m_previous); }
+};
+
+TEST(ThreadPoolTest, VisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.threadCount(), 4u);
+    std::vector<std::atomic<int>> visits(1000);
+    pool.parallelFor(visits.size(), [&](size_t i) { visits[i].fetch_add(1); });
+    for (const auto &v: visits) {
+        EXPECT_EQ(v.load(), 1);
+    }
+    // The pool is reusable
+    pool.parallelFor(visits.size(), [&](size_t i) { visits[i].fetch_add(1); });
+    for (const auto &v: visits) {
+        EXPECT_EQ(v.load(), 2);
+    }
+}
+
+TEST(ThreadPoolTest, RethrowsTheFirstException) {
+    ThreadPool pool(3);
+    std::atomic<int> done{0};
+    EXPECT_THROW(pool.parallelFor(100, [&](size_t i) {
+        if (i == 17) {
+            throw std::runtime_error("body failed");
+        }
+        done.fetch_add(1);
+    }), std::runtime_error);
+    // The other indices still ran
+    EXPECT_EQ(done.load(), 99);
+}
+
+TEST(ThreadPoolTest, NestedLoopsRunSerially) {
+    ThreadPool pool(4);
+    std::atomic<int> total{0};
+    std::atomic<bool> nestedOnOtherThread{false};
+    pool.parallelFor(8, [&](size_t) {
+        EXPECT_TRUE(ThreadPool::inParallelRegion());
+        auto outer = std::this_thread::get_id();
+        pool.parallelFor(8, [&](size_t) {
+            if (std::this_thread::get_id() != outer) {
+                nestedOnOtherThread = true;
+            }
+            total.fetch_add(1);
+        });
+    });
+    EXPECT_EQ(total.load(), 64);
+    EXPECT_FALSE(nestedOnOtherThread.load());
+    EXPECT_FALSE(ThreadPool::inParallelRegion());
+}
+
+TEST(ThreadPoolTest, SerialScopeKeepsLoopsOnTheCaller) {
+    ThreadPool pool(4);
+    auto caller = std::this_thread::get_id();
+    std::atomic<bool> otherThread{false};
+    {
+        ThreadPool::SerialScope scope;
+        EXPECT_TRUE(ThreadPool::inParallelRegion());
+        pool.parallelFor(100, [&](size_t) {
+            if (std::this_thread::get_id() != caller) {
+                otherThread = true;
+            }
+        });
+    }
+    EXPECT_FALSE(otherThread.load());
+    EXPECT_FALSE(ThreadPool::inParallelRegion());
+}
+
+TEST(ThreadPoolTest, SetThreadCount) {
+    ThreadPool pool(2);
+    pool.setThreadCount(5);
+    EXPECT_EQ(pool.threadCount(), 5u);
+    pool.setThreadCount(1);
+    EXPECT_EQ(pool.threadCount(), 1u);
+    int sum = 0;
+    pool.parallelFor(10, [&](size_t i) { sum += static_cast<int>(i); });
+    EXPECT_EQ(sum, 45);
+}
+
+TEST(ThreadPoolTest, ParallelKernelsMatchSerial) {
+    Matrix<> A = randomMatrix(150, 130, 1);
+    Matrix<> B = randomMatrix(130, 300, 2);
+    // Every product is above matrix_parallel::kMinFlops
+    Matrix<> J = randomMatrix(2000, 90, 3);
+    Matrix<> r = randomMatrix(2000, 1, 4);
+    Matrix<> x = randomMatrix(300, 1, 5);
+    Matrix<> big = randomMatrix(300, 300, 6);
+    Matrix<> wide = randomMatrix(600, 300, 7);
+
+    Matrix<> product, productTN, normal, gemvResult, gemvTResult;
+    Matrix<> sum, scaled;
+    {
+        SharedPoolThreads threads(1);
+        Matrix<>::multiplyInto(A, B, product);
+        Matrix<>::gemm_tn(J, J, productTN);
+        Matrix<>::syrk(J, normal);
+        Matrix<>::gemv(wide, x, gemvResult);
+        Matrix<>::gemv_t(J, r, gemvTResult);
+        sum = big + big;
+        scaled = big * 3.0;
+    }
+    SharedPoolThreads threads(4);
+    Matrix<> C;
+    Matrix<>::multiplyInto(A, B, C);
+    EXPECT_EQ(C, product);
+    Matrix<>::gemm_tn(J, J, C);
+    EXPECT_EQ(C, productTN);
+    Matrix<>::syrk(J, C);
+    EXPECT_EQ(C, normal);
+    Matrix<>::gemv(wide, x, C);
+    EXPECT_EQ(C, gemvResult);
+    Matrix<>::gemv_t(J, r, C);
+    EXPECT_EQ(C, gemvTResult);
+    EXPECT_EQ(big + big, sum);
+    EXPECT_EQ(big * 3.0, scaled);
+    EXPECT_EQ(A * B, product);
+}